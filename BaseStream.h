@@ -4,14 +4,36 @@
 #include <memory.h>
 #include <assert.h>
 
+struct string_section;
+namespace base { struct path_section; }
+
 struct BaseStream
 {
+	BaseStream()
+		: float_epsilon(0.0f),
+		strings(nullptr),
+		paths(nullptr)
+	{}
+
 	virtual uint64_t get_pos() const = 0;
 	virtual void set_pos(uint64_t) = 0;
 	virtual void reset_buf_pos() = 0;
 	virtual void write_to_stream(const void *src, size_t s) = 0;
 	virtual void read_from_stream(void *dest, size_t s) = 0;
 
+	// streams that are backed by memory can return the next s bytes without copying them.
+	// advances like read_from_stream.  returns nullptr if the stream can't
+	virtual const char *read_in_place(size_t s) { return nullptr; }
+
+	// encoders of float histories (see history_codec.h) may move values by up to this much. 0 is lossless
+	float float_epsilon;
+
+	// when set, interned strings are written as ids into it instead of inline (see interned_strings.h)
+	string_section *strings;
+
+	// when set, URLs are written as ids into it instead of inline (see url_named.h)
+	base::path_section *paths;
+
 	template <typename Container>
 	void contiguous_container_out_to_stream(const Container &container)
 	{
@@ -51,11 +73,24 @@ struct BaseStream
 		read_from_stream(&size, sizeof(size));
 		container.clear();
 		container.reserve(size);
-		for (int i = 0; i < size; i++)
+		typename Container::value_type val;
+		const char *src = read_in_place(size * sizeof(val));
+		if (src)
+		{
+			// bulk path: no per value stream call
+			for (int i = 0; i < size; i++)
+			{
+				memcpy(&val, src + i * sizeof(val), sizeof(val));	// src may not be aligned
+				container.push_back(val);
+			}
+		}
+		else
 		{
-			typename Container::value_type val;
-			read_from_stream(&val, sizeof(val));
-			container.push_back(val);
+			for (int i = 0; i < size; i++)
+			{
+				read_from_stream(&val, sizeof(val));
+				container.push_back(val);
+			}
 		}
 	}
 };
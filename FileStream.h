@@ -74,6 +74,30 @@ struct FileStream : public BaseStream
 		_fseeki64(m_file, 0, 0);
 	}
 
+	uint64_t get_file_size()
+	{
+		uint64_t pos = get_pos();
+		_fseeki64(m_file, 0, SEEK_END);
+		uint64_t size = get_pos();
+		set_pos(pos);
+		return size;
+	}
+
+	// push buffered writes to the os so they survive the process going away
+	void flush()
+	{
+		fflush(m_file);
+	}
+
+	void close()
+	{
+		if (m_file)
+		{
+			fclose(m_file);
+			m_file = 0;
+		}
+	}
+
 	// write value to buf and advance pointer
 	void write_to_stream(const void *src, size_t s) override
 	{
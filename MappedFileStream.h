@@ -0,0 +1,103 @@
+// 
+// read only stream over a memory mapped file.  reads are memcpys out of the mapped view
+// instead of a fread per field and contiguous data can be handed out in place.
+//
+#pragma once
+#include "BaseStream.h"
+#include "log.h"
+#include <cstdint>
+
+struct MappedFileStream : public BaseStream
+{
+	MappedFileStream()
+		: m_view(nullptr),
+		m_size(0),
+		m_handle(nullptr),
+		m_pos(0)
+	{}
+
+	~MappedFileStream()
+	{
+		close();
+	}
+
+	MappedFileStream(MappedFileStream &) = delete;
+
+	bool open_file_for_read(const char *filename)
+	{
+		close();
+		m_view = plat::map_file_for_read(filename, &m_size, &m_handle);
+		if (!m_view)
+		{
+			log_printf("map of %s for read failed\n", filename);
+			return false;
+		}
+		return true;
+	}
+
+	void close()
+	{
+		if (m_view)
+		{
+			plat::unmap_file(m_view, m_size, m_handle);
+			m_view = nullptr;
+			m_size = 0;
+			m_handle = nullptr;
+		}
+		m_pos = 0;
+	}
+
+	uint64_t get_file_size() const
+	{
+		return m_size;
+	}
+
+	uint64_t get_pos() const override
+	{
+		return m_pos;
+	}
+
+	void set_pos(uint64_t pos) override
+	{
+		m_pos = pos;
+	}
+
+	void reset_buf_pos() override
+	{
+		m_pos = 0;
+	}
+
+	void write_to_stream(const void *src, size_t s) override
+	{
+		assert(0); // read only
+	}
+
+	void read_from_stream(void *dest, size_t s) override
+	{
+		if (m_pos + s > m_size)
+		{
+			log_printf("read past end of mapped file\n");
+			memset(dest, 0, s);
+			m_pos = m_size;
+			return;
+		}
+		memcpy(dest, m_view + m_pos, s);
+		m_pos += s;
+	}
+
+	const char *read_in_place(size_t s) override
+	{
+		if (m_pos + s > m_size)
+		{
+			return nullptr;
+		}
+		const char *p = m_view + m_pos;
+		m_pos += s;
+		return p;
+	}
+
+	const char *m_view;
+	uint64_t m_size;
+	void *m_handle;
+	uint64_t m_pos;
+};
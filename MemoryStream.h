@@ -50,6 +50,16 @@ struct MemoryStream : public BaseStream
 		::memcpy(dest, &encoded_buf[buf_pos], (int)s);
 		buf_pos += (int)s;
 	}
+
+	const char *read_in_place(size_t s) override
+	{
+		if (!encoded_buf || buf_pos + s > buf_size)
+			return nullptr;
+		const char *p = &encoded_buf[buf_pos];
+		buf_pos += s;
+		return p;
+	}
+
 	const uint64_t buf_size;
 	char *encoded_buf;
 	uint64_t buf_pos;
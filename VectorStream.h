@@ -0,0 +1,74 @@
+//
+// serialization to a growable block of memory.  used when the size of what is being
+// encoded isn't known up front (eg. sections that are encoded in parallel and then
+// written out back to back).
+//
+#pragma once
+#include "BaseStream.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct VectorStream : public BaseStream
+{
+	VectorStream()
+		: buf_pos(0)
+	{}
+
+	VectorStream(VectorStream &) = delete;
+
+	uint64_t get_pos() const override
+	{
+		return buf_pos;
+	}
+
+	void set_pos(uint64_t new_pos) override
+	{
+		buf_pos = new_pos;
+	}
+
+	void reset_buf_pos() override
+	{
+		buf_pos = 0;
+	}
+
+	// write value to buf and advance pointer. grows the buffer as needed
+	void write_to_stream(const void *src, size_t s) override
+	{
+		if (s > 0)
+		{
+			if (buf_pos + s > buf.size())
+			{
+				buf.resize(size_t(buf_pos + s));
+			}
+			::memcpy(&buf[size_t(buf_pos)], src, s);
+			buf_pos += s;
+		}
+	}
+
+	// write internal value out to stream and advance pointer
+	void read_from_stream(void *dest, size_t s) override
+	{
+		assert(buf_pos + s <= buf.size());
+		if (s > 0)
+		{
+			::memcpy(dest, &buf[size_t(buf_pos)], s);
+			buf_pos += s;
+		}
+	}
+
+	const char *read_in_place(size_t s) override
+	{
+		if (buf_pos + s > buf.size())
+			return nullptr;
+		const char *p = buf.data() + buf_pos;
+		buf_pos += s;
+		return p;
+	}
+
+	const char *data() const { return buf.data(); }
+	uint64_t size() const { return buf.size(); }
+
+	std::vector<char> buf;
+	uint64_t buf_pos;
+};
@@ -12,6 +12,7 @@
 #include "tbb/spin_mutex.h"
 #include "BaseStream.h"
 #include <map>
+#include <limits>
 
 // has an index supports virtual serialization
 
@@ -47,6 +48,12 @@ public:
 	virtual const base::URL& get_serialization_url(void) const = 0;
 	virtual void encode(BaseStream &e) const = 0;
 	virtual void decode(BaseStream &e) = 0;
+
+	// journal support: write the single entry recorded at time index t / append a single entry.
+	// encode_entry writes nothing if there's no entry at t, so writers check has_entry first
+	virtual bool has_entry(time_index_t t) const = 0;
+	virtual void encode_entry(BaseStream &e, time_index_t t) const = 0;
+	virtual void decode_entry(BaseStream &e) = 0;
 };
 
 // register objects by an id so they can be found for serialization and deserialization
@@ -74,7 +81,9 @@ public:
 		map_lock.unlock(); 
 #endif
 		auto iter = registered.push_back(p); 
-		serialization_id id = size_as_serialization_id(std::distance(registered.begin(), iter));
+		auto index = std::distance(registered.begin(), iter);
+		assert(uint64_t(index) <= std::numeric_limits<serialization_id>::max());
+		serialization_id id = size_as_serialization_id(index);
 		p->set_serialization_index(id);
 		return id;
 	}
@@ -104,6 +113,6 @@ public:
 	tbb::spin_mutex map_lock;
 	std::map<base::URL, RegisteredSerializable*> map;
 #endif
-	serialization_id GetNumRegistered() { return static_cast<serialization_id>(registered.size()); }
+	serialization_id GetNumRegistered() { return size_as_serialization_id(registered.size()); }
 	tbb::concurrent_vector <RegisteredSerializable *> registered;
 };
@@ -5,6 +5,10 @@
 #include "time_containers.h"
 #include "vr_schema.h"
 #include "vr_keys.h"
+#include "poll_schedule.h"
+#include "resource_cache.h"
+#include "overlay_image_scheduler.h"
+#include "cold_segments.h"
 #include <chrono>
 #include <mutex>
 
@@ -47,6 +51,16 @@ private:
 	friend struct capture_traverser; // for deserialization
 	time_index_t m_last_updated_frame_number;
 public:
+	// keep the interned strings the histories refer to and the paths of the node URLs (see
+	// interned_strings.h and url_named.h).  declared before everything that holds them
+	string_table::reference m_strings;
+	base::path_table::reference m_paths;
+
+	// what the histories, lists and result vectors allocate from.  declared before them so it goes
+	// after them, and takes everything with it (see slab_allocator.h).  updates and loads make it
+	// current while they run
+	slab m_slab;
+
 	void increment_last_updated_frame() { m_last_updated_frame_number++; }
 
 	time_index_t get_last_updated_frame() const { return m_last_updated_frame_number; }
@@ -73,9 +87,26 @@ public:
 	// it's an id to object pointer map so needs to be rebuilt on load
 	SerializableRegistry m_state_registry;  
 
+	// decompressed cold history segments and the counters.  declared before the state so it
+	// outlives the histories that point at it.  set from the CaptureConfig; not copied
+	cold_segment_cache m_cold_segments;
+
 	// used to base timestamps at zero. 
 	std::chrono::time_point<std::chrono::steady_clock> m_start;	
 
+	// children spawned by each update. the full save re-creates structure from the state section,
+	// only the journal needs these
+	VRSpawnVector m_spawns;
+
+	// which subtrees updates query and when.  set from the CaptureConfig like m_keys
+	poll_schedule m_poll_schedule;
+
+	// what the resources looked like when last loaded.  not copied; a copy just reloads them once
+	resource_cache m_resource_cache;
+
+	// which overlay images updates fetch and what they last were.  set from the CaptureConfig.
+	// not copied either
+	overlay_image_scheduler m_overlay_images;
 
 	//
 	// data that is saved
@@ -91,7 +122,38 @@ public:
 	VRKeysUpdateVector	m_keys_updates;			// sparse vector of strings showing new configuration events (updates keys)
 	VRUpdateVector		m_state_update_bits;	// sparse vector of bitfields of updates (updates m_state)
 		
+	// the members are made with m_slab current: the scope argument lasts until the constructor
+	// it delegates to is done
 	capture()
+		: capture(slab::scope(&m_slab))
+	{}
+
+	capture(const capture &rhs)
+		: capture(rhs, slab::scope(&m_slab))
+	{}
+
+	capture &operator =(const capture &rhs)
+	{
+		slab::scope scope(&m_slab);
+		m_last_updated_frame_number = rhs.m_last_updated_frame_number;
+		m_state_registry = rhs.m_state_registry;
+		m_start = rhs.m_start;
+		m_spawns = rhs.m_spawns;
+		m_poll_schedule = rhs.m_poll_schedule;
+		m_resource_cache.clear();
+		m_overlay_images.clear();
+		m_save_summary = rhs.m_save_summary;
+		m_keys = rhs.m_keys;
+		m_state = rhs.m_state;
+		m_vr_events = rhs.m_vr_events;
+		m_time_stamps = rhs.m_time_stamps;
+		m_keys_updates = rhs.m_keys_updates;
+		m_state_update_bits = rhs.m_state_update_bits;
+		return *this;
+	}
+
+private:
+	explicit capture(const slab::scope &)
 		:
 		m_last_updated_frame_number(-1),
 		m_state(base::URL("vr", "/vr"), &m_state_registry),
@@ -99,11 +161,13 @@ public:
 	{
 	}
 
-	capture(const capture &rhs)
+	capture(const capture &rhs, const slab::scope &)
 		: 
 			m_last_updated_frame_number(rhs.m_last_updated_frame_number),
 			m_state_registry(rhs.m_state_registry),
 			m_start(rhs.m_start),
+			m_spawns(rhs.m_spawns),
+			m_poll_schedule(rhs.m_poll_schedule),
 			m_save_summary(rhs.m_save_summary),
 			m_keys(rhs.m_keys),
 			m_state(rhs.m_state),
@@ -112,21 +176,6 @@ public:
 			m_keys_updates(rhs.m_keys_updates),
 			m_state_update_bits(rhs.m_state_update_bits)
 	{}
-
-	capture &operator =(const capture &rhs)
-	{
-		m_last_updated_frame_number = rhs.m_last_updated_frame_number;
-		m_state_registry = rhs.m_state_registry;
-		m_start = rhs.m_start;
-		m_save_summary = rhs.m_save_summary;
-		m_keys = rhs.m_keys;
-		m_state = rhs.m_state;
-		m_vr_events = rhs.m_vr_events;
-		m_time_stamps = rhs.m_time_stamps;
-		m_keys_updates = rhs.m_keys_updates;
-		m_state_update_bits = rhs.m_state_update_bits;
-		return *this;
-	}
 };
 
 inline bool operator ==(const capture &a, const capture &b)
@@ -0,0 +1,54 @@
+//
+// capture_compress_visitor: compresses the cold segments of every history (see cold_segments.h)
+//
+#pragma once
+#include "time_containers.h"
+#include "vr_types.h"
+#include "capture_config.h"
+#include "cold_segments.h"
+
+struct capture_compress_visitor
+{
+	capture_compress_visitor(time_index_t cold_before, cold_segment_cache *cache)
+		:	m_cold_before(cold_before),
+			m_cache(cache)
+	{}
+
+	time_index_t m_cold_before;		// segments that only hold samples before this are compressed
+	cold_segment_cache *m_cache;
+
+	//
+	// visit interfaces
+	//
+	static const bool visit_source_interfaces() { return false; }
+	static const bool spawn_children() { return false; }
+	static const bool reload_render_models() { return false; }
+	static const bool recheck_distortion() { return false; }
+	static const bool poll(poll_subtree s, int item) { return true; }
+
+	inline void start_group_node(const base::URL &url_name, int group_id_index) {}
+	inline void end_group_node(const base::URL &group_id_name, int group_id_index) {}
+
+	template <typename T>
+	inline void start_vector(const base::URL &vector_name, T &vec) {}
+
+	template <typename T>
+	inline void end_vector(const base::URL &vector_name, T &vec) {}
+
+	template <typename HistoryVectorType, typename ResultType>
+	void visit_node(const HistoryVectorType &history, const ResultType &latest_result)
+	{
+		assert(0);
+	}
+
+	template <typename HistoryVectorType>
+	void visit_node(HistoryVectorType &history_node)
+	{
+		history_node.compress_cold_segments(m_cold_before - 1, m_cache);
+	}
+
+	template <typename ParentVectorType> void spawn_child(ParentVectorType &vector, const std::string &child_name)
+	{
+		assert(0);
+	}
+};
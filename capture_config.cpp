@@ -50,4 +50,55 @@ void CaptureConfig::set_default()
 
 	memset(&custom_settings, 0, sizeof(custom_settings));
 	memset(&custom_tracked_device_properties, 0, sizeof(custom_tracked_device_properties));
+
+	// poses and frame timings every frame.  the rest hardly changes and costs many calls
+	poll_rates[POLL_SYSTEM] = { POLL_EVERY_FRAME, 1 };
+	poll_rates[POLL_DEVICE_PROPERTIES] = { POLL_EVERY_N_FRAMES, 90 };
+	poll_rates[POLL_APPLICATIONS] = { POLL_EVERY_N_MS, 1000 };
+	poll_rates[POLL_MIME_TYPES] = { POLL_EVERY_N_MS, 5000 };
+	poll_rates[POLL_SETTINGS] = { POLL_EVERY_N_MS, 2000 };
+	poll_rates[POLL_CHAPERONE] = { POLL_EVERY_N_FRAMES, 10 };
+	poll_rates[POLL_CHAPERONE_SETUP] = { POLL_EVERY_N_MS, 1000 };
+	poll_rates[POLL_COMPOSITOR] = { POLL_EVERY_FRAME, 1 };
+	poll_rates[POLL_OVERLAYS] = { POLL_EVERY_N_FRAMES, 10 };
+	poll_rates[POLL_RENDER_MODELS] = { POLL_EVERY_N_MS, 5000 };
+	poll_rates[POLL_EXTENDED_DISPLAY] = { POLL_EVERY_N_MS, 5000 };
+	poll_rates[POLL_TRACKED_CAMERA] = { POLL_EVERY_N_MS, 1000 };
+	poll_rates[POLL_RESOURCES] = { POLL_EVERY_N_MS, 10000 };
+	poll_rates[POLL_DRIVER_MANAGER] = { POLL_EVERY_N_MS, 10000 };
+
+	overlay_image_bytes_per_frame = 4 * 1024 * 1024;
+
+	cold_segment_age_frames = 90 * 60;
+	cold_segment_cache_bytes = 64 * 1024 * 1024;
+	cold_segment_resident_bytes = 512 * 1024 * 1024;
+	cold_segment_pass_bytes = 2 * 1024 * 1024;
+}
+
+// these are invalidated by invalidate_for_event (poll_events.h).  the ones without events
+// (overlays, resources, ...) keep their rates
+void CaptureConfig::set_poll_on_events(int sweep_ms)
+{
+	static const poll_subtree evented[] =
+	{
+		POLL_DEVICE_PROPERTIES,
+		POLL_APPLICATIONS,
+		POLL_MIME_TYPES,
+		POLL_SETTINGS,
+		POLL_CHAPERONE,
+		POLL_CHAPERONE_SETUP,
+		POLL_RENDER_MODELS,
+	};
+	for (poll_subtree s : evented)
+	{
+		poll_rates[s] = { POLL_ON_DEMAND, sweep_ms };
+	}
+}
+
+void CaptureConfig::set_poll_every_frame()
+{
+	for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+	{
+		poll_rates[i] = { POLL_EVERY_FRAME, 1 };
+	}
 }
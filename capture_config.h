@@ -1,4 +1,41 @@
 #pragma once
+#include <stdint.h>
+
+// subtrees of the schema that can be polled at their own rate (see poll_schedule.h).
+// the ones with items (devices, applications, ...) spread the items across frames
+enum poll_subtree
+{
+	POLL_SYSTEM,				// system node: poses, controller state, eyes, spatial sorts
+	POLL_DEVICE_PROPERTIES,		// per device: tracked device properties and component names
+	POLL_APPLICATIONS,			// application list, scene state, and per application
+	POLL_MIME_TYPES,			// per mime type
+	POLL_SETTINGS,				// per settings section
+	POLL_CHAPERONE,
+	POLL_CHAPERONE_SETUP,
+	POLL_COMPOSITOR,
+	POLL_OVERLAYS,				// overlay list, dashboard state, and per overlay
+	POLL_RENDER_MODELS,			// render model list, and per render model
+	POLL_EXTENDED_DISPLAY,
+	POLL_TRACKED_CAMERA,
+	POLL_RESOURCES,				// per resource
+	POLL_DRIVER_MANAGER,
+	NUM_POLL_SUBTREES
+};
+
+enum poll_rate_type
+{
+	POLL_EVERY_FRAME,
+	POLL_EVERY_N_FRAMES,
+	POLL_EVERY_N_MS,			// by the update time stamps
+	POLL_ON_DEMAND,				// on the first update, when requested or invalidated (poll_schedule, poll_events.h)
+								// and every period ms as a safety sweep (0 for none)
+};
+
+struct poll_rate
+{
+	poll_rate_type type;
+	int period;					// frames or ms (on demand: the sweep)
+};
 
 
 // need to pipe in callers areas of interest:
@@ -76,6 +113,27 @@ struct CaptureConfig	// external configuration input
 		int *float_values;
 	} custom_tracked_device_properties;
 
-	void set_default();
+	// how often each subtree is queried by updates
+	poll_rate poll_rates[NUM_POLL_SUBTREES];
+
+	// overlay image bytes fetched per update.  the overlays take turns (overlay_image_scheduler.h)
+	uint32_t overlay_image_bytes_per_frame;
+
+	// history segments that only hold samples older than this many frames are compressed by the
+	// maintenance pass (cold_segments.h).  0 turns it off
+	int cold_segment_age_frames;
+	// decompressed segments kept for readers
+	uint64_t cold_segment_cache_bytes;
+	// cold segments kept in memory.  past this the oldest are spilled to a memory mapped scratch
+	// file and paged back in when they're read, so recordings are limited by disk rather than by
+	// memory.  0 keeps them all in memory
+	uint64_t cold_segment_resident_bytes;
+	// bytes a maintenance pass compresses, and then spills, at most.  passes hold the update lock
+	// (capture_controller), so this bounds how long an update can wait on one.  what's left over
+	// is done by the next passes.  0 is unbounded
+	uint64_t cold_segment_pass_bytes;
 
+	void set_default();
+	void set_poll_every_frame();	// every subtree every frame, like before the schedule
+	void set_poll_on_events(int sweep_ms);	// subtrees that openvr events cover are polled on demand
 };
\ No newline at end of file
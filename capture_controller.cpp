@@ -1,125 +1,108 @@
 #include "capture_controller.h"
+#include "poll_events.h"
 #include <chrono>
 
 using us = std::chrono::duration<int64_t, std::micro>;
 
 capture_controller::capture_controller()
+	: m_stop_maintenance(false)
 {
 }
 
+capture_controller::~capture_controller()
+{
+	stop_maintenance();
+}
+
 void capture_controller::init(capture *c, const openvr_broker::open_vr_interfaces &interfaces)
 {
 	m_model = c;
 	m_interfaces = interfaces;
 }
 
-struct capture_controller::pending_controller_update
+static void apply_event(capture *target, const VREncodableEvent &event)
 {
-	virtual void apply(capture *) = 0;
-};
+	target->m_vr_events.emplace_back(target->get_last_updated_frame() + 1, event);
+	invalidate_for_event(event, &target->m_keys, &target->m_poll_schedule);	// re-poll what it changed
+}
 
-struct pending_event_update : public capture_controller::pending_controller_update
+static void apply_overlay_event(capture *target, vr::VROverlayHandle_t handle, const vr::VREvent_t &event)
 {
-	pending_event_update(time_point_t a, const vr::VREvent_t& b)
-		: m_time(a), m_event(b)
-	{}
-
-	void apply(capture *target) override
-	{
-		target->m_vr_events.emplace_back(target->get_last_updated_frame() + 1, m_event);
-
-		us frame_time = std::chrono::duration_cast<std::chrono::microseconds>(m_time - target->m_start);
-		target->m_time_stamps.emplace_back(frame_time.count());
-		target->increment_last_updated_frame();
-	}
-
-	time_point_t m_time;
-	VREncodableEvent m_event;
-};
+	// TODO(sean): finish overlay events
+	assert(0); // the key has to do it's work
+	// find the overlay for this id. add this event to the overlay
+}
 
-struct pending_overlay_event_update : public capture_controller::pending_controller_update
+static void apply_key_update(capture *target, const VRKeysUpdate &key_update)
 {
-	pending_overlay_event_update(time_point_t a, vr::VROverlayHandle_t b, const vr::VREvent_t& c)
-		: m_time(a), m_handle(b), m_event(c)
-	{}
-
-	void apply(capture *target) override
+	switch (key_update.update_type)
 	{
-		// TODO(sean): finish overlay events
-		assert(0); // the key has to do it's work
-		// find the overlay for this id. add this event to the overlay
-
-		us frame_time = std::chrono::duration_cast<std::chrono::microseconds>(m_time - target->m_start);
-		target->m_time_stamps.emplace_back(frame_time.count());
-		target->increment_last_updated_frame();
+		case VRKeysUpdate::NEW_APP_KEY:
+			target->m_keys.GetApplicationsIndexer().add_app_key(key_update.sparam1.c_str());
+			break;
+		
+		case VRKeysUpdate::NEW_SETTING:
+			target->m_keys.GetSettingsIndexer().AddCustomSetting(
+				key_update.sparam1.c_str(), 
+				static_cast<SettingsIndexer::SectionSettingType>(key_update.iparam1), 
+				key_update.sparam2.c_str());
+			break;
+		case VRKeysUpdate::NEW_DEVICE_PROPERTY:
+			target->m_keys.GetDevicePropertiesIndexer().AddCustomProperty(
+				static_cast<PropertiesIndexer::PropertySettingType>(key_update.iparam1),
+				key_update.sparam1.c_str(),
+				key_update.iparam2);
+			break;
+		case VRKeysUpdate::NEW_RESOURCE:
+			target->m_keys.GetResourcesIndexer().add_resource(key_update.sparam1.c_str(), key_update.sparam2.c_str());
+			break;
+		case VRKeysUpdate::NEW_OVERLAY:
+			target->m_keys.GetOverlayIndexer().add_overlay_key(key_update.sparam1.c_str());
+			break;
+		case VRKeysUpdate::MODIFY_NEARZ_FARZ:
+			target->m_keys.UpdateNearFar(key_update.fparam1, key_update.fparam2);
+			break;
+		default:
+			assert(0);  //
 	}
 
-	time_point_t m_time;
-	vr::VROverlayHandle_t m_handle;
-	vr::VREvent_t m_event;
-};
+	target->m_keys_updates.emplace_back(target->get_last_updated_frame() + 1, key_update);
+}
 
-struct pending_key_update : public capture_controller::pending_controller_update
+void capture_controller::pending_controller_update::apply(capture *target)
 {
-	pending_key_update(time_point_t a, const VRKeysUpdate& b)
-		: m_time(a), m_key_update(b)
-	{}
-
-	void apply(capture *target) override
+	switch (type)
 	{
-		switch (m_key_update.update_type)
-		{
-			case VRKeysUpdate::NEW_APP_KEY:
-				target->m_keys.GetApplicationsIndexer().add_app_key(m_key_update.sparam1.c_str());
-				break;
-			
-			case VRKeysUpdate::NEW_SETTING:
-				target->m_keys.GetSettingsIndexer().AddCustomSetting(
-					m_key_update.sparam1.c_str(), 
-					static_cast<SettingsIndexer::SectionSettingType>(m_key_update.iparam1), 
-					m_key_update.sparam2.c_str());
-				break;
-			case VRKeysUpdate::NEW_DEVICE_PROPERTY:
-				target->m_keys.GetDevicePropertiesIndexer().AddCustomProperty(
-					static_cast<PropertiesIndexer::PropertySettingType>(m_key_update.iparam1),
-					m_key_update.sparam1.c_str(),
-					m_key_update.iparam2);
-				break;
-			case VRKeysUpdate::NEW_RESOURCE:
-				target->m_keys.GetResourcesIndexer().add_resource(m_key_update.sparam1.c_str(), m_key_update.sparam2.c_str());
-				break;
-			case VRKeysUpdate::NEW_OVERLAY:
-				target->m_keys.GetOverlayIndexer().add_overlay_key(m_key_update.sparam1.c_str());
-				break;
-			case VRKeysUpdate::MODIFY_NEARZ_FARZ:
-				target->m_keys.UpdateNearFar(m_key_update.fparam1, m_key_update.fparam2);
-				break;
-			default:
-				assert(0);  //
-		}
-
-		target->m_keys_updates.emplace_back(target->get_last_updated_frame() + 1, m_key_update);
-		us frame_time = std::chrono::duration_cast<std::chrono::microseconds>(m_time - target->m_start);
-		target->m_time_stamps.emplace_back(frame_time.count());
-		target->increment_last_updated_frame();
+	case PENDING_EVENT:
+		apply_event(target, event);
+		break;
+	case PENDING_OVERLAY_EVENT:
+		apply_overlay_event(target, overlay_handle, event);
+		break;
+	case PENDING_KEY:
+		apply_key_update(target, key_update);
+		break;
 	}
 
-	time_point_t m_time;
-	VRKeysUpdate m_key_update;
-};
+	// each one is a frame of it's own
+	us frame_time = std::chrono::duration_cast<std::chrono::microseconds>(time - target->m_start);
+	target->m_time_stamps.emplace_back(frame_time.count());
+	target->increment_last_updated_frame();
+}
 
 void capture_controller::update()
 {
-	// apply queued events to the capture
+	// apply queued events to the capture.  what they add allocates from it's slab
 	m_queue_lock.lock();
+	slab::scope scope(&m_model->m_slab);
 
-	for (auto pending_update : m_pending_updates)
+	for (pending_controller_update &pending_update : m_pending_updates)
 	{
-		pending_update->apply(m_model);
-		delete pending_update;
+		pending_update.apply(m_model);
 	}
 	m_pending_updates.clear();
-	
+	scope.end();
+
 	m_queue_lock.unlock();
 
 	m_update_lock.lock();
@@ -131,29 +114,91 @@ void capture_controller::update()
 	using us = std::chrono::duration<int64_t, std::micro>;
 	us frame_time = std::chrono::duration_cast<std::chrono::microseconds>(start - m_model->m_start);
 	m_traverser.update_capture_sequential(m_model, &m_interfaces, frame_time.count());
+	m_traverser.append_capture_journal(m_model);		// no-op unless a journal was started
 	m_update_lock.unlock();
 }
 
+bool capture_controller::start_journal(const char *filename)
+{
+	m_update_lock.lock();
+	bool rc = m_traverser.open_capture_journal(m_model, filename);
+	m_update_lock.unlock();
+	return rc;
+}
+
+void capture_controller::stop_journal()
+{
+	m_update_lock.lock();
+	m_traverser.close_capture_journal(m_model);
+	m_update_lock.unlock();
+}
+
+void capture_controller::run_maintenance()
+{
+	m_update_lock.lock();
+	m_traverser.compress_cold_segments(m_model);
+	m_update_lock.unlock();
+}
+
+void capture_controller::start_maintenance(int period_ms)
+{
+	stop_maintenance();
+	m_stop_maintenance = false;
+	m_maintenance_thread = std::thread([this, period_ms]
+	{
+		std::unique_lock<std::mutex> lock(m_maintenance_lock);
+		while (!m_maintenance_wake.wait_for(lock, std::chrono::milliseconds(period_ms), [this] { return m_stop_maintenance; }))
+		{
+			lock.unlock();
+			run_maintenance();
+			lock.lock();
+		}
+	});
+}
+
+void capture_controller::stop_maintenance()
+{
+	if (!m_maintenance_thread.joinable())
+	{
+		return;
+	}
+	m_maintenance_lock.lock();
+	m_stop_maintenance = true;
+	m_maintenance_lock.unlock();
+	m_maintenance_wake.notify_all();
+	m_maintenance_thread.join();
+}
+
 void capture_controller::enqueue_new_key(const VRKeysUpdate &update)
 {
 	m_queue_lock.lock();
-	auto key_update = new pending_key_update(std::chrono::steady_clock::now(), update);
-	m_pending_updates.push_back(key_update);
+	m_pending_updates.emplace_back();
+	pending_controller_update &key_update = m_pending_updates.back();
+	key_update.type = pending_controller_update::PENDING_KEY;
+	key_update.time = std::chrono::steady_clock::now();
+	key_update.key_update = update;
 	m_queue_lock.unlock();
 }
 
 void capture_controller::enqueue_event(const vr::VREvent_t &event_in)
 {
 	m_queue_lock.lock();
-	auto event_update = new pending_event_update(std::chrono::steady_clock::now(), event_in);
-	m_pending_updates.push_back(event_update);
+	m_pending_updates.emplace_back();
+	pending_controller_update &event_update = m_pending_updates.back();
+	event_update.type = pending_controller_update::PENDING_EVENT;
+	event_update.time = std::chrono::steady_clock::now();
+	event_update.event = event_in;
 	m_queue_lock.unlock();
 }
 
 void capture_controller::enqueue_overlay_event(vr::VROverlayHandle_t overlay_handle, const vr::VREvent_t &event_in)
 {
 	m_queue_lock.lock();
-	auto event_update = new pending_overlay_event_update(std::chrono::steady_clock::now(), overlay_handle, event_in);
-	m_pending_updates.push_back(event_update);
+	m_pending_updates.emplace_back();
+	pending_controller_update &event_update = m_pending_updates.back();
+	event_update.type = pending_controller_update::PENDING_OVERLAY_EVENT;
+	event_update.time = std::chrono::steady_clock::now();
+	event_update.overlay_handle = overlay_handle;
+	event_update.event = event_in;
 	m_queue_lock.unlock();
 }
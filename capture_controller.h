@@ -12,10 +12,13 @@
 #include "capture.h"
 #include "capture_traverser.h"
 #include "openvr_broker.h"
+#include <condition_variable>
+#include <thread>
 
 struct capture_controller
 {
 	capture_controller();
+	~capture_controller();
 	
 	// use an existing model
 	void init(capture *c, const openvr_broker::open_vr_interfaces &interfaces);
@@ -30,8 +33,35 @@ struct capture_controller
 	void enqueue_new_key(const VRKeysUpdate &update);
 	void enqueue_event(const vr::VREvent_t &event_in);
 	void enqueue_overlay_event(vr::VROverlayHandle_t overlay_handle, const vr::VREvent_t &event_in);
+
+	// persist the capture to filename as it is updated. see capture_traverser::open_capture_journal
+	bool start_journal(const char *filename);
+	void stop_journal();
+
+	// compresses the cold history segments (cold_segments.h) every period_ms on a thread of
+	// it's own.  the passes take the update lock, so they run between updates
+	void start_maintenance(int period_ms);
+	void stop_maintenance();
+	void run_maintenance();		// one pass now
 	
-	struct pending_controller_update;
+	// an event or key update waiting for the next update().  they are queued by value in a
+	// vector that is cleared (not freed) by update(), so queueing doesn't allocate once it's grown
+	struct pending_controller_update
+	{
+		enum pending_type
+		{
+			PENDING_EVENT,
+			PENDING_OVERLAY_EVENT,
+			PENDING_KEY,
+		};
+		pending_type type;
+		time_point_t time;
+		VREncodableEvent event;					// PENDING_EVENT and PENDING_OVERLAY_EVENT
+		vr::VROverlayHandle_t overlay_handle;	// PENDING_OVERLAY_EVENT
+		VRKeysUpdate key_update;				// PENDING_KEY
+
+		void apply(capture *target);
+	};
 private:
 	capture *m_model;
 	capture_traverser m_traverser;
@@ -42,6 +72,10 @@ private:
 
 	// serializes access to the update queue.  A single queue is used to preserve time order
 	std::mutex m_queue_lock;
-	std::vector<pending_controller_update *> m_pending_updates;
-	
+	std::vector<pending_controller_update> m_pending_updates;
+
+	std::thread m_maintenance_thread;
+	std::mutex m_maintenance_lock;
+	std::condition_variable m_maintenance_wake;
+	bool m_stop_maintenance;
 };
@@ -4,6 +4,7 @@
 #pragma once
 #include "time_containers.h"
 #include "vr_types.h"
+#include "capture_config.h"
 
 struct capture_decode_visitor 
 {
@@ -19,6 +20,7 @@ struct capture_decode_visitor
 	static const bool spawn_children() { return false; }
 	static const bool reload_render_models() { return false; }
 	static const bool recheck_distortion() { return false; }
+	static const bool poll(poll_subtree s, int item) { return true; }
 
 	inline void start_group_node(const base::URL &url_name, int group_id_index) {}
 	inline void end_group_node(const base::URL &group_id_name, int group_id_index) {}
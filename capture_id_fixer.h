@@ -4,6 +4,7 @@
 #pragma once
 #include "time_containers.h"
 #include "vr_types.h"
+#include "capture_config.h"
 #include <unordered_map>
 
 struct capture_id_fixer 
@@ -11,7 +12,7 @@ struct capture_id_fixer
 	capture_id_fixer()
 	{}
 
-	std::unordered_map<std::string, serialization_id> url2id;
+	std::unordered_map<uint32_t, serialization_id> path2id;		// path id (see url_named.h) to serialization id
 	SerializableRegistry *registry;
 
 	//
@@ -21,14 +22,15 @@ struct capture_id_fixer
 	static const bool spawn_children() { return false; }
 	static const bool reload_render_models() { return false; }
 	static const bool recheck_distortion() { return false; }
+	static const bool poll(poll_subtree s, int item) { return true; }
 
 	inline void start_group_node(const base::URL &url_name, int group_id_index) {}
 	inline void end_group_node(const base::URL &group_id_name, int group_id_index) {}
 
-	serialization_id get_id(const std::string &url)
+	serialization_id get_id(const base::URL &url)
 	{
-		auto iter = url2id.find(url);
-		if (iter == url2id.end())
+		auto iter = path2id.find(url.get_path_id());
+		if (iter == path2id.end())
 		{
 			// assert - if this fails, make sure you initialized the node in the constructor with it's url name
 			assert(0);
@@ -38,7 +40,7 @@ struct capture_id_fixer
 
 	inline void start_vector(const base::URL &vector_name, RegisteredSerializable &vec) 
 	{
-		serialization_id id = get_id(vec.get_serialization_url().get_full_path());
+		serialization_id id = get_id(vec.get_serialization_url());
 		vec.set_serialization_index(id);
 		registry->Register(&vec, id);
 	}
@@ -54,7 +56,7 @@ struct capture_id_fixer
 
 	void visit_node(RegisteredSerializable &node)
 	{
-		serialization_id id = get_id(node.get_serialization_url().get_full_path());
+		serialization_id id = get_id(node.get_serialization_url());
 		node.set_serialization_index(id);
 		registry->Register(&node, id);
 	}
@@ -0,0 +1,78 @@
+//
+// capture_spawn_visitor : re-create children that were spawned after a snapshot was written.
+//                         used when replaying a capture journal.  the ids assigned here are
+//                         temporary, the id fixer assigns the recorded ones afterwards.
+//
+#pragma once
+#include "time_containers.h"
+#include "vr_types.h"
+#include "capture_config.h"
+#include <unordered_map>
+
+struct capture_spawn_visitor
+{
+	capture_spawn_visitor()
+		: registry(nullptr)
+	{}
+
+	// parent vector full path -> child names in the order they were spawned
+	std::unordered_map<std::string, std::vector<std::string>> pending_spawns;
+	SerializableRegistry *registry;
+
+	void add_spawn(const VRSpawnRecord &spawn)
+	{
+		pending_spawns[spawn.parent_path].push_back(spawn.child_name);
+	}
+
+	//
+	// visit interfaces
+	//
+	static const bool visit_source_interfaces() { return false; }
+	static const bool spawn_children() { return false; }
+	static const bool reload_render_models() { return false; }
+	static const bool recheck_distortion() { return false; }
+	static const bool poll(poll_subtree s, int item) { return true; }
+
+	inline void start_group_node(const base::URL &url_name, int group_id_index) {}
+	inline void end_group_node(const base::URL &group_id_name, int group_id_index) {}
+
+	// every vector is started before it's children are visited, so spawning here
+	// also lets nested spawns (children of spawned children) be found further down
+	template <typename T>
+	inline void start_vector(const base::URL &vector_name, T &vec)
+	{
+		if (pending_spawns.empty())
+		{
+			return;		// don't build full paths for nothing
+		}
+		auto iter = pending_spawns.find(vector_name.get_full_path());
+		if (iter != pending_spawns.end())
+		{
+			vec.reserve(vec.size() + iter->second.size());
+			for (const std::string &child_name : iter->second)
+			{
+				base::URL child_url(vec.make_url_for_child(child_name));
+				vec.emplace_back(child_url, registry);
+			}
+			pending_spawns.erase(iter);
+		}
+	}
+
+	template <typename T>
+	inline void end_vector(const base::URL &vector_name, T &vec) {}
+
+	template <typename HistoryVectorType, typename ResultType>
+	void visit_node(HistoryVectorType &history, const ResultType &latest_result)
+	{
+		assert(0);
+	}
+
+	template <typename HistoryVectorType>
+	void visit_node(HistoryVectorType &history_node) {}
+
+	template <typename ParentVectorType>
+	void spawn_child(ParentVectorType &parent_vector, const std::string &child_name)
+	{
+		assert(0);
+	}
+};
@@ -7,6 +7,8 @@
 #include "capture_encoder.h"
 #include "capture_decoder.h"
 #include "capture_id_fixer.h"
+#include "capture_compressor.h"
+#include "capture_spawner.h"
 #include "tbb/tick_count.h"
 #include "tbb/task_scheduler_init.h"
 #include "tbb/task_group.h"
@@ -14,18 +16,29 @@
 #include "openvr_serialization.h"
 #include "MemoryStream.h"
 #include "FileStream.h"
+#include "MappedFileStream.h"
+#include "VectorStream.h"
+#include "lz4.h"
+#include "lz4hc.h"
 #include <fstream>
 #include <algorithm>
+#include <atomic>
 
 using namespace vr_result;
 
 class named_task_group : public tbb::task_group
 {
 public:
+	// the task allocates from the slab that's current where it's spawned (see slab_allocator.h)
 	template<typename F>
 	void run(const char *name, const F& f)
 	{
-		tbb::task_group::run(f);
+		slab *s = slab::current();
+		tbb::task_group::run([s, f]()
+		{
+			slab::scope scope(s);
+			f();
+		});
 	}
 };
 
@@ -48,6 +61,8 @@ public:
 	void wait() {}
 };
 
+// the wrappers only hold the interface pointers, so they are kept between updates and only
+// re-made when the interfaces (or caches) change
 struct WrapperSet
 {
 	WrapperSet()
@@ -64,25 +79,36 @@ struct WrapperSet
 	tracked_camera_wrapper(nullptr),
 	resources_wrapper(nullptr),
 	driver_manager_wrapper(nullptr)
-	{}
+	{
+		memset(&assigned_interfaces, 0, sizeof(assigned_interfaces));
+	}
 
-	void assign(openvr_broker::open_vr_interfaces *interfaces)
+	void assign(openvr_broker::open_vr_interfaces *interfaces, resource_cache *cache, overlay_image_scheduler *images)
 	{
+		if (system_wrapper &&
+			memcmp(&assigned_interfaces, interfaces, sizeof(assigned_interfaces)) == 0 &&
+			resources_wrapper->cache == cache &&
+			overlay_wrapper->images == images)
+		{
+			return;
+		}
+		release();
+		assigned_interfaces = *interfaces;
 		system_wrapper = new SystemWrapper(interfaces->sysi);
 		application_wrapper = new ApplicationsWrapper(interfaces->appi);
 		settings_wrapper = new SettingsWrapper(interfaces->seti);
 		chaperone_wrapper = new ChaperoneWrapper(interfaces->chapi);
 		chaperone_setup_wrapper = new ChaperoneSetupWrapper(interfaces->chapsi);
 		compositor_wrapper = new CompositorWrapper(interfaces->compi);
-		overlay_wrapper = new OverlayWrapper(interfaces->ovi);
+		overlay_wrapper = new OverlayWrapper(interfaces->ovi, images);
 		rendermodel_wrapper = new RenderModelsWrapper(interfaces->remi);
 		extended_display_wrapper = new ExtendedDisplayWrapper(interfaces->exdi);
 		tracked_camera_wrapper = new TrackedCameraWrapper(interfaces->taci);
-		resources_wrapper = new ResourcesWrapper(interfaces->resi);
+		resources_wrapper = new ResourcesWrapper(interfaces->resi, cache);
 		driver_manager_wrapper = new DriverManagerWrapper(interfaces->drivi);
 	}
 
-	~WrapperSet()
+	void release()
 	{
 		delete system_wrapper;
 		delete application_wrapper;
@@ -96,6 +122,23 @@ struct WrapperSet
 		delete tracked_camera_wrapper;
 		delete resources_wrapper;
 		delete driver_manager_wrapper;
+		system_wrapper = nullptr;
+		application_wrapper = nullptr;
+		settings_wrapper = nullptr;
+		chaperone_wrapper = nullptr;
+		chaperone_setup_wrapper = nullptr;
+		compositor_wrapper = nullptr;
+		overlay_wrapper = nullptr;
+		rendermodel_wrapper = nullptr;
+		extended_display_wrapper = nullptr;
+		tracked_camera_wrapper = nullptr;
+		resources_wrapper = nullptr;
+		driver_manager_wrapper = nullptr;
+	}
+
+	~WrapperSet()
+	{
+		release();
 	}
 	SystemWrapper			*system_wrapper;
 	ApplicationsWrapper		*application_wrapper;
@@ -109,245 +152,161 @@ struct WrapperSet
 	TrackedCameraWrapper	*tracked_camera_wrapper;
 	ResourcesWrapper		*resources_wrapper;
 	DriverManagerWrapper	*driver_manager_wrapper;
+	openvr_broker::open_vr_interfaces assigned_interfaces;
 };
 
-template <typename TaskGroup, typename visitor_fn>
-static void traverse_history_graph(visitor_fn *visitor, capture *outer_state, WrapperSet *wrappers)
+// the top level nodes of vr_state, in traversal order.  the state section of a capture file
+// stores each one in it's own block so they can be encoded and decoded independently
+enum top_level_node
+{
+	SYSTEM_NODE,
+	APPLICATIONS_NODE,
+	SETTINGS_NODE,
+	CHAPERONE_NODE,
+	CHAPERONE_SETUP_NODE,
+	COMPOSITOR_NODE,
+	OVERLAY_NODE,
+	RENDER_MODELS_NODE,
+	EXTENDED_DISPLAY_NODE,
+	TRACKED_CAMERA_NODE,
+	RESOURCES_NODE,
+	DRIVER_MANAGER_NODE,
+	NUM_TOP_LEVEL_NODES
+};
+
+static const char *top_level_node_names[NUM_TOP_LEVEL_NODES] =
+{
+	"visit_system_node",
+	"visit_application_node",
+	"visit_settings_node",
+	"visit_chaperone_node",
+	"visit_chaperone_setup",
+	"visit_compositor_state",
+	"visit_overlay_state",
+	"visit_rendermodel_state",
+	"visit_extended_display_state",
+	"visit_tracked_camera_state",
+	"visit_resources_state",
+	"visit_driver_manager_state",
+};
+
+// the poll rate that covers each whole top level node.  NUM_POLL_SUBTREES for the ones that
+// check the rates of their own parts (see traverse_graph.h)
+static const poll_subtree top_level_node_polls[NUM_TOP_LEVEL_NODES] =
+{
+	POLL_SYSTEM,
+	NUM_POLL_SUBTREES,
+	NUM_POLL_SUBTREES,
+	POLL_CHAPERONE,
+	POLL_CHAPERONE_SETUP,
+	POLL_COMPOSITOR,
+	NUM_POLL_SUBTREES,
+	NUM_POLL_SUBTREES,
+	POLL_EXTENDED_DISPLAY,
+	POLL_TRACKED_CAMERA,
+	NUM_POLL_SUBTREES,
+	POLL_DRIVER_MANAGER,
+};
+
+// visit a single top level node.  g is used for any nested tasks
+template <typename visitor_fn, typename TaskGroup>
+static void traverse_top_level_node(int node, visitor_fn *visitor, capture *outer_state, WrapperSet *wrappers, TaskGroup &g)
 {
 	vr_state *s = &outer_state->m_state;
 	vr_keys *keys = &outer_state->m_keys;
 
-	TaskGroup g;
-	
-	g.run("visit_system_node",
-		[&visitor, s, wrappers, keys, &g] {
+	switch (node)
+	{
+	case SYSTEM_NODE:
 		visit_system_node(visitor, &s->system_node, wrappers->system_wrapper, wrappers->rendermodel_wrapper, keys, g);
-	});
-
-	g.run("visit_application_node", 
-		[&visitor, s, wrappers, keys, &g] {
+		break;
+	case APPLICATIONS_NODE:
 		visit_applications_node(visitor, &s->applications_node, wrappers->application_wrapper, keys, g);
-	});
-
-	g.run("visit_settings_node",
-		[&visitor, s, wrappers, keys, &g] {
+		break;
+	case SETTINGS_NODE:
 		visit_settings_node(visitor, &s->settings_node, wrappers->settings_wrapper, keys, g);
-	});
-
-	g.run("visit_chaperone_node",
-		[&visitor, s, wrappers, keys, &g] {
+		break;
+	case CHAPERONE_NODE:
 		visit_chaperone_node(visitor, &s->chaperone_node, wrappers->chaperone_wrapper, keys);
-	});
-
-	g.run("visit_chaperone_setup",
-		[&visitor, s, wrappers, keys, &g] { 
+		break;
+	case CHAPERONE_SETUP_NODE:
 		visit_chaperone_setup_node(visitor, &s->chaperone_setup_node, wrappers->chaperone_setup_wrapper);
-	});
-
-	g.run("visit_compositor_state",
-		[&visitor, s, wrappers, keys, &g] {
+		break;
+	case COMPOSITOR_NODE:
 		visit_compositor_state(visitor, &s->compositor_node, wrappers->compositor_wrapper, keys, g);
-	});
-
-	g.run("visit_overlay_state",
-		[&visitor, s, wrappers, keys, &g] {
+		break;
+	case OVERLAY_NODE:
 		visit_overlay_state(visitor, &s->overlay_node, wrappers->overlay_wrapper, keys, g);
-	});
-
-	visit_rendermodel_state(visitor, &s->render_models_node, wrappers->rendermodel_wrapper, keys, g);
-
-	g.run("visit_extended_display_state",
-		[&visitor, s, wrappers, keys] {
+		break;
+	case RENDER_MODELS_NODE:
+		visit_rendermodel_state(visitor, &s->render_models_node, wrappers->rendermodel_wrapper, keys, g);
+		break;
+	case EXTENDED_DISPLAY_NODE:
 		visit_extended_display_state(visitor, &s->extended_display_node, wrappers->extended_display_wrapper);
-	});
-	g.run("visit_tracked_camera_state",
-		[&visitor, s, wrappers, keys] {
+		break;
+	case TRACKED_CAMERA_NODE:
 		visit_trackedcamera_state(visitor, &s->tracked_camera_node, wrappers->tracked_camera_wrapper, keys);
-	});
-	g.run("visit_resources_state",
-		[&visitor, s, wrappers, keys] {
+		break;
+	case RESOURCES_NODE:
 		visit_resources_state(visitor, &s->resources_node, wrappers->resources_wrapper, keys);
-	});
-	g.run("visit_driver_manager_state",
-		[&visitor, s, wrappers, keys] {
+		break;
+	case DRIVER_MANAGER_NODE:
 		visit_driver_manager_state(visitor, &s->driver_manager_node, wrappers->driver_manager_wrapper, keys);
-	});
-	g.wait();
+		break;
+	default:
+		assert(0);
+		break;
+	}
 }
 
-struct capture_traverser::impl
+template <typename TaskGroup, typename visitor_fn>
+static void traverse_history_graph(visitor_fn *visitor, capture *outer_state, WrapperSet *wrappers)
 {
-	WrapperSet null_wrappers;
-
-	// since the objects are not constructed in a deterministic order, we need to save it
-	// so it can be restored on re-load
-	uint64_t calc_registry_id_table_size(capture *capture)
-	{
-		MemoryStream count_stream(nullptr, 0, true);
-		encode_registry_table(count_stream, capture);
-		return count_stream.buf_pos;
-	}
-
-	void encode_registry_table(BaseStream &stream, capture *capture)
+	TaskGroup g;
+	for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
 	{
-		int num_entries = capture->m_state_registry.GetNumRegistered();
-		stream.write_to_stream(&num_entries, sizeof(num_entries));
-		for (int i = 0; i < num_entries; i++)
+		if (top_level_node_polls[node] != NUM_POLL_SUBTREES && !visitor->poll(top_level_node_polls[node], -1))
 		{
-			RegisteredSerializable *r = capture->m_state_registry.registered[i];
-			stream.contiguous_container_out_to_stream(r->get_serialization_url().get_full_path());
+			continue;
 		}
-	}
-
-	void fixup_registry_ids(BaseStream &e, capture *capture)
-	{
-		int num_entries;
-		e.read_from_stream(&num_entries, sizeof(num_entries));
-		capture_id_fixer visitor;
-		capture->m_state_registry.clear();
-		capture->m_state_registry.reserve(num_entries);
-		visitor.registry = &capture->m_state_registry;
-		for (int i = 0; i < num_entries; i++)
+		if (node == RENDER_MODELS_NODE)
 		{
-			std::string full_url;
-			e.contiguous_container_from_stream(full_url);
-			visitor.url2id.insert({ full_url, i });
+			// render models already split their instances into tasks, so it's visited in place
+			traverse_top_level_node(node, visitor, outer_state, wrappers, g);
+		}
+		else
+		{
+			g.run(top_level_node_names[node],
+				[visitor, outer_state, wrappers, node, &g] {
+				traverse_top_level_node(node, visitor, outer_state, wrappers, g);
+			});
 		}
-		traverse_history_graph<ExecuteImmediatelyTaskGroup>(&visitor, capture, &null_wrappers);
-
-	}
-
-	uint64_t calc_keys_size(capture *capture)
-	{
-		// state size
-		MemoryStream count_stream(nullptr, 0, true);
-		capture->m_keys.encode(count_stream);
-		return count_stream.buf_pos;
-	}
-
-	uint64_t calc_state_size(capture *capture)
-	{
-		// state size
-		MemoryStream count_stream(nullptr, 0, true);
-		capture_encode_visitor visitor;
-		visitor.m_stream = &count_stream;
-		traverse_history_graph<ExecuteImmediatelyTaskGroup>(&visitor, capture, &null_wrappers);
-		return count_stream.buf_pos;
-	}
-
-	uint64_t calc_vr_events_size(capture *capture)
-	{
-		MemoryStream count_stream(nullptr, 0, true);
-		capture->m_vr_events.encode(count_stream);
-		return count_stream.buf_pos;
-	}
-
-	uint64_t calc_time_stamps_size(capture *capture)
-	{
-		MemoryStream count_stream(nullptr, 0, true);
-		count_stream.forward_container_out_to_stream(capture->m_time_stamps);
-		return count_stream.buf_pos;
-	}
-
-	uint64_t calc_keys_updates_size(capture *capture)
-	{
-		MemoryStream count_stream(nullptr, 0, true);
-		capture->m_keys_updates.encode(count_stream);
-		return count_stream.buf_pos;
-	}
-
-	uint64_t calc_state_update_bits_size(capture *capture)
-	{
-		MemoryStream count_stream(nullptr, 0, true);
-		capture->m_state_update_bits.encode(count_stream);
-		return count_stream.buf_pos;
 	}
-};
-
-capture_traverser::capture_traverser()
-{
-	m_pimpl = new capture_traverser::impl;
+	g.wait();
 }
 
-capture_traverser::~capture_traverser()
-{
-	delete m_pimpl;
-}
+// the header starts with a fixed magic and then the version, so a reader can tell an old capture
+// from something that isn't a capture.  up to 0xd the version was the magic
+static const uint32_t HEADER_MAGIC = 0x50414356;	// "VCAP"
+static const uint32_t HEADER_VERSION = 0xe;	// 0x8: state section is split per top level node, 0x9: compressed sections, 0xa: delta encoded float histories, 0xb: overlay 0's image isn't stored twice, 0xc: strings section, 0xd: paths section, 0xe: 32 bit serialization ids, sparse update bits and this header
 
-struct ConfigObserver : KeysObserver
-{
-	void NewVRKeysUpdate(const VRKeysUpdate &e) final
-	{
-		config_events.push_back(e);
-	}
-	tbb::concurrent_vector<VRKeysUpdate> config_events;
-};
+// compressed sections are split into blocks of this many uncompressed bytes
+static const uint32_t CAPTURE_BLOCK_SIZE = 1024 * 1024;
 
-void capture_traverser::update_capture(capture *capture,
-	openvr_broker::open_vr_interfaces *interfaces,
-	time_stamp_t update_time,
-	bool parallel)
+// what a section looks like before compression.  all zero when the file isn't compressed
+struct section_info_t
 {
-	time_index_t last_updated = capture->get_last_updated_frame();
-	capture_update_visitor update_visitor(last_updated + 1);			// setup the visitor with the new frame number
-	update_visitor.registry = &capture->m_state_registry;				// setup the visitor so he can register any new state objects
-
-	ConfigObserver config_observer;
-	capture->m_keys.RegisterObserver(&config_observer);
-
-	WrapperSet wrappers;
-	wrappers.assign(interfaces);
-
-	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-	if (parallel)
-	{
-		traverse_history_graph<named_task_group>(&update_visitor, capture, &wrappers);
-	}
-	else
-	{
-		traverse_history_graph<ExecuteImmediatelyTaskGroup>(&update_visitor, capture, &wrappers);
-	}
-	
-	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-	bool quiet = true;
-	if (!quiet)
-	{
-		log_printf("parallel update took %lld us.\n",
-			std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
-	}
-
-	//
-	// after updating the frame, finalize any per frame stats and then advance the frame number
-	//
-
-	// after update, log any new keys discovered:
-	capture->m_keys.UnRegisterObserver(&config_observer);
-	for (VRKeysUpdate& e : config_observer.config_events)
-	{
-		capture->m_keys_updates.emplace_back(update_visitor.get_frame_number(), e);
-	}
-
-	// after update, log updated nodes
-	if (!update_visitor.updated_node_bits.empty())
-	{
-		// any items that updated
-		capture->m_state_update_bits.emplace_back(update_visitor.get_frame_number(), update_visitor.updated_node_bits);
-	}
-	
-	// after update, log the frame_time
-	capture->m_time_stamps.push_back(update_time);
-
-	// after update, finally update m_last_updated_frame_number
-	capture->increment_last_updated_frame();
-}
-
-
-static const uint32_t HEADER_MAGIC = 0x7;
+	uint64_t uncompressed_size;
+	uint32_t block_table_crc;	// the block table holds the crc of each block
+	uint32_t pad;
+};
 
 // file format starts with a header:
 struct header_t
 {
 	uint32_t magic;
+	uint32_t version;
+	uint32_t header_size;		// sizeof(header_t)
 	uint32_t crc;
 	uint64_t summary_offset;
 	uint64_t summary_size;
@@ -366,8 +325,25 @@ struct header_t
 	uint64_t keys_updates_size;
 	uint64_t state_update_bits_offset;
 	uint64_t state_update_bits_size;
+	uint64_t strings_offset;	// the values of the string histories in the state section
+	uint64_t strings_size;
+	uint64_t paths_offset;		// the URLs in the state and registry sections
+	uint64_t paths_size;
 	uint64_t updates_offset;	// no size since it's streaming
 
+	// compression. the summary is never compressed
+	uint32_t compression;		// capture_compression
+	uint32_t block_size;
+	section_info_t registry_info;
+	section_info_t keys_info;
+	section_info_t state_info;
+	section_info_t events_info;
+	section_info_t time_stamps_info;
+	section_info_t keys_updates_info;
+	section_info_t state_update_bits_info;
+	section_info_t strings_info;
+	section_info_t paths_info;
+
 	void encode(BaseStream &e) const
 	{
 		e.write_to_stream(this, sizeof(*this));
@@ -382,6 +358,15 @@ struct header_t
 	{
 		if (magic != HEADER_MAGIC)
 		{
+			if (magic <= 0xd)
+			{
+				log_printf("capture version %u is too old to load\n", magic);
+			}
+			return false;
+		}
+		if (version != HEADER_VERSION || header_size != sizeof(*this))
+		{
+			log_printf("capture version %u (header %u bytes) can't be loaded by version %u\n", version, header_size, HEADER_VERSION);
 			return false;
 		}
 		uint32_t tmp = crc;
@@ -396,166 +381,1375 @@ struct header_t
 	}
 };
 
+// what the state and registry sections refer to by id.  collected while they are encoded and
+// written after them, read before them.  sections encoded as parallel tasks each collect into
+// their own and are merged after
+struct capture_tables
+{
+	string_section strings;		// see interned_strings.h
+	base::path_section paths;	// see url_named.h
+
+	void merge(const capture_tables &rhs)
+	{
+		strings.merge(rhs.strings);
+		paths.merge(rhs.paths);
+	}
+
+	void attach(BaseStream &stream)
+	{
+		stream.strings = &strings;
+		stream.paths = &paths;
+	}
+
+	void detach(BaseStream &stream)
+	{
+		stream.strings = nullptr;
+		stream.paths = nullptr;
+	}
+};
+
 inline uint64_t pad_size(uint64_t in)
 {
 	return in;
 	// for valgrind, try and not use padding at allreturn (in + 3) & ~0x3;
 }
 
-bool capture_traverser::save_capture_to_binary_file(capture *capture, const char *filename)
+// sections are written back to back starting at the next padded position
+inline void begin_section(BaseStream &stream, uint64_t *offset)
 {
-	bool rc = true;
-	header_t header;
-	memset(&header, 0, sizeof(header));
-	header.magic = HEADER_MAGIC;
-	header.summary_size		 = sizeof(save_summary);
-	header.registry_size = m_pimpl->calc_registry_id_table_size(capture);
-	header.keys_size		 = m_pimpl->calc_keys_size(capture);
-	header.state_size		 = m_pimpl->calc_state_size(capture);
-	header.events_size		 = m_pimpl->calc_vr_events_size(capture);
-	header.time_stamps_size	 = m_pimpl->calc_time_stamps_size(capture);
-	header.keys_updates_size = m_pimpl->calc_keys_updates_size(capture);
-	header.state_update_bits_size = m_pimpl->calc_state_update_bits_size(capture);
-
-	header.summary_offset           = sizeof(header);
-	header.registry_offset          = header.summary_offset     + pad_size(header.summary_size);
-	header.keys_offset              = header.registry_offset	+ pad_size(header.registry_size);
-	header.state_offset             = header.keys_offset		+ pad_size(header.keys_size);
-	header.events_offset            = header.state_offset		+ pad_size(header.state_size);
-	header.time_stamps_offset       = header.events_offset		+ pad_size(header.events_size);
-	header.keys_updates_offset      = header.time_stamps_offset + pad_size(header.time_stamps_size);
-	header.state_update_bits_offset = header.keys_updates_offset + pad_size(header.keys_updates_size);
-	header.updates_offset           = header.state_update_bits_offset + pad_size(header.state_update_bits_size);
-
-	std::time_t start = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-#ifdef _WIN32
-	ctime_s(capture->m_save_summary.start_date_string, sizeof(capture->m_save_summary.start_date_string), &start);
-#else
-	strcpy(capture->m_save_summary.start_date_string, ctime(&start));
-#endif
-	capture->m_save_summary.last_encoded_frame = capture->get_last_updated_frame();
+	*offset = pad_size(stream.get_pos());
+	stream.set_pos(*offset);
+}
 
-	// LAST STEP after writing into the header is to write the crc
-	header.crc = crc32buf((char *)&header, sizeof(header));
+inline void end_section(BaseStream &stream, uint64_t offset, uint64_t *size)
+{
+	*size = stream.get_pos() - offset;
+}
 
-	// make sure the size fits in whatever size_t is
-	assert(size_t(header.updates_offset) == header.updates_offset);
-	FileStream f;
-	
-	if (f.open_file_for_write_plus(filename))
+//
+// compressed sections:
+//
+//	int num_blocks, compressed_block_t blocks[num_blocks], block 0 ... block num_blocks-1
+//
+// each block is compressed on it's own so blocks can be decompressed in parallel and a
+// reader can find any block from the table without decompressing the ones before it.
+//
+struct compressed_block_t
+{
+	uint32_t uncompressed_size;
+	uint32_t stored_size;		// == uncompressed_size when the block didn't compress and is stored as is
+	uint32_t crc;				// crc of the uncompressed block
+};
+
+struct compressed_section
+{
+	std::vector<compressed_block_t> blocks;
+	std::vector<std::vector<char>> data;
+};
+
+static void compress_block(capture_compression compression, const char *src, int src_size,
+							compressed_block_t *block, std::vector<char> *dest)
+{
+	block->uncompressed_size = src_size;
+	block->crc = crc32buf(src, src_size);
+	dest->resize(LZ4_COMPRESSBOUND(src_size));
+	int compressed_size;
+	if (compression == CAPTURE_COMPRESSION_LZ4HC)
 	{
-		BaseStream &stream = f;
-		{
-			header.encode(stream);
-		}
-		{
-			stream.set_pos(header.summary_offset);
-			capture->m_save_summary.encode(stream);
-		}
-		{
-			stream.set_pos(header.registry_offset);
-			m_pimpl->encode_registry_table(stream, capture);
-		}
-		{
-			stream.set_pos(header.keys_offset);
-			capture->m_keys.encode(stream);
-		}
-		{
-			stream.set_pos(header.state_offset);
-			capture_encode_visitor visitor;
-			visitor.m_stream = &stream;
-			traverse_history_graph<ExecuteImmediatelyTaskGroup>(&visitor, capture, &m_pimpl->null_wrappers);
-		}
-		{
-			stream.set_pos(header.events_offset);
-			capture->m_vr_events.encode(stream);
-		}
-		{
-			stream.set_pos(header.time_stamps_offset);
-			stream.forward_container_out_to_stream(capture->m_time_stamps);
-		}
-		{
-			stream.set_pos(header.keys_updates_offset);
-			capture->m_keys_updates.encode(stream);
-		}
-		{
-			stream.set_pos(header.state_update_bits_offset);
-			capture->m_state_update_bits.encode(stream);
-		}
+		compressed_size = LZ4_compress_HC(src, dest->data(), src_size, size_as_int(dest->size()), LZ4HC_CLEVEL_DEFAULT);
 	}
 	else
 	{
-		rc = false;
+		compressed_size = LZ4_compress_default(src, dest->data(), src_size, size_as_int(dest->size()));
 	}
-	return rc;
+
+	if (compressed_size <= 0 || compressed_size >= src_size)
+	{
+		dest->assign(src, src + src_size);
+	}
+	else
+	{
+		dest->resize(compressed_size);
+	}
+	block->stored_size = uint32_t(dest->size());
 }
 
-bool capture_traverser::load_capture_from_binary_file(capture *capture, const char *filename)
+static bool decompress_block(const char *src, char *dest, const compressed_block_t &block)
 {
-	bool rc = true;
-
-	FileStream stream;
-	if (!stream.open_file_for_read(filename))
+	if (block.stored_size == block.uncompressed_size)
 	{
-		rc = false;
+		memcpy(dest, src, block.uncompressed_size);
 	}
-	else
+	else if (LZ4_decompress_safe(src, dest, block.stored_size, block.uncompressed_size) != int(block.uncompressed_size))
 	{
-		header_t header;
-		stream.set_pos(0);
-		header.decode(stream);
-		if (!header.verify()) // checks the magic value and the CRC
-		{
-			return false; // header is invalid
-		}
-		else
-		{
-			stream.set_pos(header.summary_offset);
-			capture->m_save_summary.decode(stream);
-		}
-		{
-			stream.set_pos(header.keys_offset);
-			capture->m_keys.decode(stream);
-		}
-		{
-			stream.set_pos(header.state_offset);
-			capture_decode_visitor visitor;
-			visitor.m_stream = &stream;
-			visitor.registry = &capture->m_state_registry;
-			traverse_history_graph<ExecuteImmediatelyTaskGroup>(&visitor, capture, &m_pimpl->null_wrappers);
-		}
-		{
-			stream.set_pos(header.events_offset);
-			capture->m_vr_events.decode(stream);
-		}
-		{
-			stream.set_pos(header.time_stamps_offset);
-			stream.forward_container_from_stream(capture->m_time_stamps);
-		}
-		{
-			stream.set_pos(header.keys_updates_offset);
-			capture->m_keys_updates.decode(stream);
-		}
-		{
-			stream.set_pos(header.state_update_bits_offset);
-			capture->m_state_update_bits.decode(stream);
-		}
+		return false;
+	}
+	return crc32buf(dest, block.uncompressed_size) == block.crc;
+}
 
-		// fixup the registry
-		{
-			stream.set_pos(header.registry_offset);
-			m_pimpl->fixup_registry_ids(stream, capture);
-		}
+// split a section into blocks and compress them as tasks on g
+template <typename TaskGroup>
+static void compress_section(TaskGroup &g, capture_compression compression, const VectorStream &in, compressed_section *out)
+{
+	size_t num_blocks = size_t((in.size() + CAPTURE_BLOCK_SIZE - 1) / CAPTURE_BLOCK_SIZE);
+	out->blocks.resize(num_blocks);
+	out->data.resize(num_blocks);
+	for (size_t i = 0; i < num_blocks; i++)
+	{
+		const char *src = in.data() + i * CAPTURE_BLOCK_SIZE;
+		int src_size = size_as_int(std::min<uint64_t>(CAPTURE_BLOCK_SIZE, in.size() - i * CAPTURE_BLOCK_SIZE));
+		compressed_block_t *block = &out->blocks[i];
+		std::vector<char> *dest = &out->data[i];
+		g.run("compress_block", [compression, src, src_size, block, dest] {
+			compress_block(compression, src, src_size, block, dest);
+		});
+	}
+}
 
-		// apply chunks here
+static void write_compressed_section(BaseStream &stream, const compressed_section &section, uint64_t uncompressed_size,
+							uint64_t *offset, uint64_t *size, section_info_t *info)
+{
+	begin_section(stream, offset);
+	int num_blocks = size_as_int(section.blocks.size());
+	stream.write_to_stream(&num_blocks, sizeof(num_blocks));
+	stream.write_to_stream(section.blocks.data(), sizeof(compressed_block_t) * section.blocks.size());
+	for (const std::vector<char> &block_data : section.data)
+	{
+		stream.write_to_stream(block_data.data(), block_data.size());
+	}
+	end_section(stream, *offset, size);
+	info->uncompressed_size = uncompressed_size;
+	info->block_table_crc = crc32buf(reinterpret_cast<const char *>(section.blocks.data()), sizeof(compressed_block_t) * section.blocks.size());
+}
+
+//
+// journal:
+//  a journal file is a normal save (the snapshot taken when the journal was opened) followed
+//  by chunks appended at header.updates_offset.  each append only writes what changed since
+//  the last append so the cost per frame is proportional to the number of updated nodes.
+//
+//  a reader stops at the first chunk that is incomplete or fails it's crc (eg. the process
+//  died in the middle of an append) so a capture can be recovered up to the last whole frame.
+//
+static const uint32_t JOURNAL_CHUNK_MAGIC = 0x4a524e4c;
+
+// each append writes one chunk covering the frames recorded since the previous append:
+//
+//	structure	 (int has_keys, [keys], int num_spawns, [spawns], int num_registry_entries, [id, url])
+//	per frame	 (time stamp, int num_keys_updates, [keys updates], int num_events, [events],
+//				  int num_update_bits, [update bits, an entry for each set bit])
+//
+// the structure of a chunk is read before any of the entries so that a reader can spawn
+// all the nodes first and then decode the entries into them.
+struct journal_chunk_header_t
+{
+	uint32_t magic;
+	uint32_t crc;				// crc of the payload
+	time_index_t first_frame;
+	int num_frames;
+	uint64_t structure_size;	// the per frame part of the payload starts here
+	uint64_t payload_size;
+
+	void encode(BaseStream &e) const
+	{
+		e.write_to_stream(this, sizeof(*this));
+	}
+
+	void decode(BaseStream &e)
+	{
+		e.read_from_stream(this, sizeof(*this));
+	}
+};
+
+// a valid chunk found while scanning the journal
+struct journal_chunk
+{
+	uint64_t payload_offset;
+	journal_chunk_header_t header;
+};
+
+// what the journal writer has already written
+struct journal_cursor
+{
+	journal_cursor()
+		:	is_open(false),
+			last_frame(-1),
+			num_registered(0),
+			num_spawns(0),
+			num_events(0),
+			num_keys_updates(0),
+			num_update_bits(0)
+	{}
+
+	bool is_open;
+	time_index_t last_frame;
+	int num_registered;
+	int num_spawns;
+	int num_events;
+	int num_keys_updates;
+	int num_update_bits;
+};
+
+// sparse vectors are sorted by time index so the entries for a frame are contiguous
+template <typename VectorType>
+static int end_of_frame_entries(const VectorType &v, int begin, time_index_t frame)
+{
+	int end = begin;
+	while (end < size_as_int(v.size()) && v.container[end].get_time_index() == frame)
+	{
+		end++;
+	}
+	return end;
+}
+
+struct ConfigObserver : KeysObserver
+{
+	void NewVRKeysUpdate(const VRKeysUpdate &e) final
+	{
+		config_events.push_back(e);
+	}
+	tbb::concurrent_vector<VRKeysUpdate> config_events;
+};
+
+struct capture_traverser::impl
+{
+	impl()
+		: compression(CAPTURE_COMPRESSION_NONE),
+		float_epsilon(0.0f),
+		update_visitor(0)
+	{}
+
+	WrapperSet null_wrappers;
+	capture_compression compression;	// used by saves and journal snapshots
+	float float_epsilon;				// lossy pose/matrix histories. see history_codec.h
+
+	// kept between updates (and reset by each one) so a steady state update doesn't allocate
+	WrapperSet update_wrappers;
+	capture_update_visitor update_visitor;
+	ConfigObserver config_observer;
+	VRBitset updated_node_bits;
+
+	// since the objects are not constructed in a deterministic order, we need to save it
+	// so it can be restored on re-load.  the URL of each id, as an id into the paths section
+	void encode_registry_table(BaseStream &stream, capture *capture, capture_tables *tables)
+	{
+		tables->attach(stream);
+		int num_entries = capture->m_state_registry.GetNumRegistered();
+		stream.write_to_stream(&num_entries, sizeof(num_entries));
+		for (int i = 0; i < num_entries; i++)
+		{
+			RegisteredSerializable *r = capture->m_state_registry.registered[i];
+			r->get_serialization_url().encode(stream);
+		}
+		tables->detach(stream);
+	}
+
+	void read_registry_table(BaseStream &e, capture_tables *tables, capture_id_fixer *visitor)
+	{
+		tables->attach(e);
+		int num_entries;
+		e.read_from_stream(&num_entries, sizeof(num_entries));
+		visitor->path2id.reserve(num_entries);
+		for (int i = 0; i < num_entries; i++)
+		{
+			base::URL url;
+			url.decode(e);
+			visitor->path2id.insert({ url.get_path_id(), i });
+		}
+		tables->detach(e);
+	}
+
+	// visitor->path2id holds the saved table (and any ids added by the journal)
+	void fixup_registry_ids(capture *capture, capture_id_fixer *visitor)
+	{
+		capture->m_state_registry.clear();
+		capture->m_state_registry.reserve(size_as_serialization_id(visitor->path2id.size()));
+		visitor->registry = &capture->m_state_registry;
+		traverse_history_graph<ExecuteImmediatelyTaskGroup>(visitor, capture, &null_wrappers);
+	}
+
+	// the state section is a table of the size of each top level node followed by the nodes:
+	//
+	//	int num_nodes, uint64_t node_size[num_nodes], node 0 ... node num_nodes-1
+	//
+	void write_state_table(BaseStream &stream, const uint64_t *node_sizes)
+	{
+		int num_nodes = NUM_TOP_LEVEL_NODES;
+		stream.write_to_stream(&num_nodes, sizeof(num_nodes));
+		stream.write_to_stream(node_sizes, sizeof(uint64_t) * NUM_TOP_LEVEL_NODES);
+	}
+
+	// the string values and URLs are written as ids and collected in tables
+	void encode_state_node(int node, capture *capture, BaseStream &stream, capture_tables *tables)
+	{
+		// the nested tasks of a node all write to the same stream so they run in order
+		ExecuteImmediatelyTaskGroup g;
+		capture_encode_visitor visitor;
+		visitor.m_stream = &stream;
+		stream.float_epsilon = float_epsilon;
+		tables->attach(stream);
+		traverse_top_level_node(node, &visitor, capture, &null_wrappers, g);
+		tables->detach(stream);
+	}
+
+	void decode_state_node(int node, capture *capture, BaseStream &stream, capture_tables *tables)
+	{
+		ExecuteImmediatelyTaskGroup g;
+		capture_decode_visitor visitor;
+		visitor.m_stream = &stream;
+		tables->attach(stream);
+		visitor.registry = &capture->m_state_registry;	// ids are assigned in any order. replay_journal fixes them up
+		traverse_top_level_node(node, &visitor, capture, &null_wrappers, g);
+	}
+
+
+	// sequential save: each section is streamed once and the state table is written over it's
+	// placeholder once the node sizes are known
+	void write_sections_sequential(BaseStream &stream, capture *capture, header_t *header)
+	{
+		capture_tables tables;
+		{
+			begin_section(stream, &header->registry_offset);
+			encode_registry_table(stream, capture, &tables);
+			end_section(stream, header->registry_offset, &header->registry_size);
+		}
+		{
+			begin_section(stream, &header->keys_offset);
+			capture->m_keys.encode(stream);
+			end_section(stream, header->keys_offset, &header->keys_size);
+		}
+		{
+			begin_section(stream, &header->state_offset);
+			uint64_t node_sizes[NUM_TOP_LEVEL_NODES] = {};
+			write_state_table(stream, node_sizes);
+			for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+			{
+				uint64_t node_offset = stream.get_pos();
+				encode_state_node(node, capture, stream, &tables);
+				node_sizes[node] = stream.get_pos() - node_offset;
+			}
+			uint64_t end = stream.get_pos();
+			stream.set_pos(header->state_offset);
+			write_state_table(stream, node_sizes);
+			stream.set_pos(end);
+			end_section(stream, header->state_offset, &header->state_size);
+		}
+		{
+			begin_section(stream, &header->strings_offset);
+			tables.strings.encode(stream);
+			end_section(stream, header->strings_offset, &header->strings_size);
+		}
+		{
+			begin_section(stream, &header->paths_offset);
+			tables.paths.encode(stream);
+			end_section(stream, header->paths_offset, &header->paths_size);
+		}
+		{
+			begin_section(stream, &header->events_offset);
+			capture->m_vr_events.encode(stream);
+			end_section(stream, header->events_offset, &header->events_size);
+		}
+		{
+			begin_section(stream, &header->time_stamps_offset);
+			stream.forward_container_out_to_stream(capture->m_time_stamps);
+			end_section(stream, header->time_stamps_offset, &header->time_stamps_size);
+		}
+		{
+			begin_section(stream, &header->keys_updates_offset);
+			capture->m_keys_updates.encode(stream);
+			end_section(stream, header->keys_updates_offset, &header->keys_updates_size);
+		}
+		{
+			begin_section(stream, &header->state_update_bits_offset);
+			capture->m_state_update_bits.encode(stream);
+			end_section(stream, header->state_update_bits_offset, &header->state_update_bits_size);
+		}
+	}
+
+	// sections encoded into their own buffers so they can be encoded (and compressed) in parallel
+	struct section_buffers
+	{
+		VectorStream registry;
+		VectorStream keys;
+		VectorStream state_nodes[NUM_TOP_LEVEL_NODES];
+		VectorStream events;
+		VectorStream time_stamps;
+		VectorStream keys_updates;
+		VectorStream state_update_bits;
+		VectorStream strings;
+		VectorStream paths;
+	};
+
+	void write_section(BaseStream &stream, const VectorStream &buffer, uint64_t *offset, uint64_t *size)
+	{
+		begin_section(stream, offset);
+		stream.write_to_stream(buffer.data(), size_t(buffer.size()));
+		end_section(stream, *offset, size);
+	}
+
+	// buffered save: the sections (and the top level nodes of the state section) are independent so they
+	// are encoded as tasks and then written back to back.  costs a copy of the file in memory.
+	template <typename TaskGroup>
+	void write_sections_buffered(BaseStream &stream, capture *capture, capture_compression compression, header_t *header)
+	{
+		section_buffers buffers;
+		section_buffers *b = &buffers;
+		capture_tables registry_tables;		// filled in by the registry and the state nodes as they encode
+		capture_tables node_tables[NUM_TOP_LEVEL_NODES];
+		capture_tables *rt = &registry_tables;
+		capture_tables *nt = node_tables;
+		{
+			TaskGroup g;
+			g.run("encode_registry_table", [this, capture, b, rt] { encode_registry_table(b->registry, capture, rt); });
+			g.run("encode_keys", [capture, b] { capture->m_keys.encode(b->keys); });
+			for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+			{
+				g.run(top_level_node_names[node], [this, capture, b, node, nt] { encode_state_node(node, capture, b->state_nodes[node], &nt[node]); });
+			}
+			g.run("encode_events", [capture, b] { capture->m_vr_events.encode(b->events); });
+			g.run("encode_time_stamps", [capture, b] { b->time_stamps.forward_container_out_to_stream(capture->m_time_stamps); });
+			g.run("encode_keys_updates", [capture, b] { capture->m_keys_updates.encode(b->keys_updates); });
+			g.run("encode_state_update_bits", [capture, b] { capture->m_state_update_bits.encode(b->state_update_bits); });
+			g.wait();
+		}
+		capture_tables tables;
+		tables.merge(registry_tables);
+		for (const capture_tables &t : node_tables)
+		{
+			tables.merge(t);
+		}
+		tables.strings.encode(buffers.strings);
+		tables.paths.encode(buffers.paths);
+
+		uint64_t node_sizes[NUM_TOP_LEVEL_NODES];
+		for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+		{
+			node_sizes[node] = buffers.state_nodes[node].size();
+		}
+
+		if (compression == CAPTURE_COMPRESSION_NONE)
+		{
+			write_section(stream, buffers.registry, &header->registry_offset, &header->registry_size);
+			write_section(stream, buffers.keys, &header->keys_offset, &header->keys_size);
+			{
+				begin_section(stream, &header->state_offset);
+				write_state_table(stream, node_sizes);
+				for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+				{
+					stream.write_to_stream(buffers.state_nodes[node].data(), size_t(node_sizes[node]));
+				}
+				end_section(stream, header->state_offset, &header->state_size);
+			}
+			write_section(stream, buffers.events, &header->events_offset, &header->events_size);
+			write_section(stream, buffers.time_stamps, &header->time_stamps_offset, &header->time_stamps_size);
+			write_section(stream, buffers.keys_updates, &header->keys_updates_offset, &header->keys_updates_size);
+			write_section(stream, buffers.state_update_bits, &header->state_update_bits_offset, &header->state_update_bits_size);
+			write_section(stream, buffers.strings, &header->strings_offset, &header->strings_size);
+			write_section(stream, buffers.paths, &header->paths_offset, &header->paths_size);
+			return;
+		}
+
+		// the state section is compressed as one piece so blocks aren't limited to a node
+		VectorStream state;
+		write_state_table(state, node_sizes);
+		for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+		{
+			state.write_to_stream(buffers.state_nodes[node].data(), size_t(node_sizes[node]));
+			buffers.state_nodes[node].buf = std::vector<char>();
+		}
+
+		compressed_section registry, keys, state_blocks, events, time_stamps, keys_updates, state_update_bits, strings_blocks, paths_blocks;
+		{
+			TaskGroup g;
+			compress_section(g, compression, buffers.registry, &registry);
+			compress_section(g, compression, buffers.keys, &keys);
+			compress_section(g, compression, state, &state_blocks);
+			compress_section(g, compression, buffers.events, &events);
+			compress_section(g, compression, buffers.time_stamps, &time_stamps);
+			compress_section(g, compression, buffers.keys_updates, &keys_updates);
+			compress_section(g, compression, buffers.state_update_bits, &state_update_bits);
+			compress_section(g, compression, buffers.strings, &strings_blocks);
+			compress_section(g, compression, buffers.paths, &paths_blocks);
+			g.wait();
+		}
+		write_compressed_section(stream, registry, buffers.registry.size(), &header->registry_offset, &header->registry_size, &header->registry_info);
+		write_compressed_section(stream, keys, buffers.keys.size(), &header->keys_offset, &header->keys_size, &header->keys_info);
+		write_compressed_section(stream, state_blocks, state.size(), &header->state_offset, &header->state_size, &header->state_info);
+		write_compressed_section(stream, events, buffers.events.size(), &header->events_offset, &header->events_size, &header->events_info);
+		write_compressed_section(stream, time_stamps, buffers.time_stamps.size(), &header->time_stamps_offset, &header->time_stamps_size, &header->time_stamps_info);
+		write_compressed_section(stream, keys_updates, buffers.keys_updates.size(), &header->keys_updates_offset, &header->keys_updates_size, &header->keys_updates_info);
+		write_compressed_section(stream, state_update_bits, buffers.state_update_bits.size(), &header->state_update_bits_offset, &header->state_update_bits_size, &header->state_update_bits_info);
+		write_compressed_section(stream, strings_blocks, buffers.strings.size(), &header->strings_offset, &header->strings_size, &header->strings_info);
+		write_compressed_section(stream, paths_blocks, buffers.paths.size(), &header->paths_offset, &header->paths_size, &header->paths_info);
+	}
+
+	// each section is written once.  it's offset and size are recorded as it is written
+	// and the header is written over the placeholder at the end
+	void write_capture(BaseStream &stream, capture *capture, bool parallel, header_t *header_out)
+	{
+		header_t header;
+		memset(&header, 0, sizeof(header));
+		header.magic = HEADER_MAGIC;
+		header.version = HEADER_VERSION;
+		header.header_size = sizeof(header);
+		header.compression = compression;
+		header.block_size = compression == CAPTURE_COMPRESSION_NONE ? 0 : CAPTURE_BLOCK_SIZE;
+
+		std::time_t start = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+#ifdef _WIN32
+		ctime_s(capture->m_save_summary.start_date_string, sizeof(capture->m_save_summary.start_date_string), &start);
+#else
+		strcpy(capture->m_save_summary.start_date_string, ctime(&start));
+#endif
+		capture->m_save_summary.last_encoded_frame = capture->get_last_updated_frame();
+
+		// placeholder. a save that doesn't finish leaves a header that fails verify()
+		stream.set_pos(0);
+		header.encode(stream);
+		{
+			begin_section(stream, &header.summary_offset);
+			capture->m_save_summary.encode(stream);
+			end_section(stream, header.summary_offset, &header.summary_size);
+		}
+		if (parallel)
+		{
+			write_sections_buffered<named_task_group>(stream, capture, compression, &header);
+		}
+		else if (compression != CAPTURE_COMPRESSION_NONE)
+		{
+			write_sections_buffered<ExecuteImmediatelyTaskGroup>(stream, capture, compression, &header);
+		}
+		else
+		{
+			write_sections_sequential(stream, capture, &header);
+		}
+		header.updates_offset = pad_size(stream.get_pos());
+
+		// make sure the size fits in whatever size_t is
+		assert(size_t(header.updates_offset) == header.updates_offset);
+
+		// LAST STEP after writing into the header is to write the crc
+		header.crc = crc32buf((char *)&header, sizeof(header));
+		stream.set_pos(0);
+		header.encode(stream);
+		stream.set_pos(header.updates_offset);
+		*header_out = header;
+	}
+
+	//
+	// journal writer
+	//
+	FileStream journal_stream;
+	journal_cursor journal;
+
+	void start_journal(capture *capture)
+	{
+		journal = journal_cursor();
+		journal.is_open = true;
+		journal.last_frame = capture->get_last_updated_frame();
+		journal.num_registered = capture->m_state_registry.GetNumRegistered();
+		journal.num_spawns = size_as_int(capture->m_spawns.size());
+		journal.num_events = size_as_int(capture->m_vr_events.size());
+		journal.num_keys_updates = size_as_int(capture->m_keys_updates.size());
+		journal.num_update_bits = size_as_int(capture->m_state_update_bits.size());
+	}
+
+	// write everything after the journal cursor up to and including last_frame.  doesn't modify anything
+	void encode_journal_chunk(BaseStream &e, capture *capture, time_index_t last_frame, bool write_keys, uint64_t *structure_size)
+	{
+		int has_keys = write_keys ? 1 : 0;
+		e.write_to_stream(&has_keys, sizeof(has_keys));
+		if (has_keys)
+		{
+			capture->m_keys.encode(e);
+		}
+
+		int num_spawns = size_as_int(capture->m_spawns.size()) - journal.num_spawns;
+		e.write_to_stream(&num_spawns, sizeof(num_spawns));
+		for (int i = journal.num_spawns; i < size_as_int(capture->m_spawns.size()); i++)
+		{
+			capture->m_spawns.container[i].encode(e);
+		}
+
+		// the reader needs the ids of the spawned nodes to decode the update bits
+		int num_registered = capture->m_state_registry.GetNumRegistered();
+		int num_registry_entries = num_registered - journal.num_registered;
+		e.write_to_stream(&num_registry_entries, sizeof(num_registry_entries));
+		for (int i = journal.num_registered; i < num_registered; i++)
+		{
+			serialization_id id = size_as_serialization_id(i);
+			e.write_to_stream(&id, sizeof(id));
+			capture->m_state_registry.registered[i]->get_serialization_url().encode(e);		// inline: the names from the root
+		}
+		*structure_size = e.get_pos();
+
+		int events_end = journal.num_events;
+		int keys_updates_end = journal.num_keys_updates;
+		int update_bits_end = journal.num_update_bits;
+		for (time_index_t frame = journal.last_frame + 1; frame <= last_frame; frame++)
+		{
+			time_stamp_t time_stamp = capture->m_time_stamps[frame];
+			e.write_to_stream(&time_stamp, sizeof(time_stamp));
+
+			int keys_updates_begin = keys_updates_end;
+			keys_updates_end = end_of_frame_entries(capture->m_keys_updates, keys_updates_begin, frame);
+			int num_keys_updates = keys_updates_end - keys_updates_begin;
+			e.write_to_stream(&num_keys_updates, sizeof(num_keys_updates));
+			for (int i = keys_updates_begin; i < keys_updates_end; i++)
+			{
+				capture->m_keys_updates.container[i].get_value().encode(e);
+			}
+
+			int events_begin = events_end;
+			events_end = end_of_frame_entries(capture->m_vr_events, events_begin, frame);
+			int num_events = events_end - events_begin;
+			e.write_to_stream(&num_events, sizeof(num_events));
+			for (int i = events_begin; i < events_end; i++)
+			{
+				capture->m_vr_events.container[i].get_value().encode(e);
+			}
+
+			int update_bits_begin = update_bits_end;
+			update_bits_end = end_of_frame_entries(capture->m_state_update_bits, update_bits_begin, frame);
+			int num_update_bits = update_bits_end - update_bits_begin;
+			e.write_to_stream(&num_update_bits, sizeof(num_update_bits));
+			for (int i = update_bits_begin; i < update_bits_end; i++)
+			{
+				encode_frame_entries(e, capture, capture->m_state_update_bits.container[i].get_value(), frame);
+			}
+		}
+	}
+
+	// the update bits and then the entry of each node they have set.  a node that's set but has
+	// no entry at frame is left out of the bits too, so the reader isn't out of step
+	void encode_frame_entries(BaseStream &e, capture *capture, const sparse_bitset &bits, time_index_t frame)
+	{
+		const SerializableRegistry &registry = capture->m_state_registry;
+		size_t missing = sparse_bitset::npos;
+		for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+		{
+			if (!registry.registered[id]->has_entry(frame))
+			{
+				missing = id;
+				break;
+			}
+		}
+
+		if (missing == sparse_bitset::npos)
+		{
+			bits.encode(e);
+			for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+			{
+				registry.registered[id]->encode_entry(e, frame);
+			}
+			return;
+		}
+
+		log_printf("journal: %s has no entry at frame %d. left out\n",
+			registry.registered[missing]->get_serialization_url().get_full_path().c_str(), frame);
+		VRBitset present;
+		for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+		{
+			if (registry.registered[id]->has_entry(frame))
+			{
+				present.set(id);		// grows to fit
+			}
+		}
+		sparse_bitset present_bits(present);
+		present_bits.encode(e);
+		for (size_t id = present_bits.find_first(); id != sparse_bitset::npos; id = present_bits.find_next(id))
+		{
+			registry.registered[id]->encode_entry(e, frame);
+		}
+	}
+
+	void write_journal_chunk(capture *capture, time_index_t last_frame, bool write_keys)
+	{
+		journal_chunk_header_t chunk_header;
+		memset(&chunk_header, 0, sizeof(chunk_header));
+
+		VectorStream payload;
+		encode_journal_chunk(payload, capture, last_frame, write_keys, &chunk_header.structure_size);
+
+		chunk_header.magic = JOURNAL_CHUNK_MAGIC;
+		chunk_header.crc = crc32buf(payload.data(), size_t(payload.size()));
+		chunk_header.first_frame = journal.last_frame + 1;
+		chunk_header.num_frames = last_frame - journal.last_frame;
+		chunk_header.payload_size = payload.size();
+		chunk_header.encode(journal_stream);
+		journal_stream.write_to_stream(payload.data(), size_t(payload.size()));
+		journal_stream.flush();
+
+		start_journal(capture);
+	}
+
+	void append_journal(capture *capture)
+	{
+		time_index_t last_frame = capture->get_last_updated_frame();
+		if (last_frame == journal.last_frame)
+		{
+			return;
+		}
+
+		// the keys are only copied when the structure may have changed
+		bool write_keys = size_as_int(capture->m_spawns.size()) != journal.num_spawns ||
+							size_as_int(capture->m_keys_updates.size()) != journal.num_keys_updates;
+		write_journal_chunk(capture, last_frame, write_keys);
+		capture->m_save_summary.last_encoded_frame = last_frame;
+	}
+
+	//
+	// journal reader
+	//
+
+	// read a chunk payload and check it's crc
+	bool read_journal_payload(BaseStream &stream, const journal_chunk &chunk, std::vector<char> *payload)
+	{
+		payload->resize(size_t(chunk.header.payload_size));
+		stream.set_pos(chunk.payload_offset);
+		stream.read_from_stream(payload->data(), payload->size());
+		return crc32buf(payload->data(), payload->size()) == chunk.header.crc;
+	}
+
+	// find the chunks that can be replayed.  stops at the first one that is torn, corrupt or out of sequence
+	void scan_journal(BaseStream &stream, uint64_t file_size, uint64_t offset, time_index_t last_frame, std::vector<journal_chunk> *chunks)
+	{
+		std::vector<char> payload;
+		while (offset + sizeof(journal_chunk_header_t) <= file_size)
+		{
+			journal_chunk chunk;
+			stream.set_pos(offset);
+			chunk.header.decode(stream);
+			chunk.payload_offset = offset + sizeof(journal_chunk_header_t);
+
+			if (chunk.header.magic != JOURNAL_CHUNK_MAGIC ||
+				chunk.header.first_frame != last_frame + 1 ||
+				chunk.header.num_frames < 0 ||
+				chunk.header.structure_size > chunk.header.payload_size ||
+				chunk.payload_offset + chunk.header.payload_size > file_size ||
+				!read_journal_payload(stream, chunk, &payload))
+			{
+				break;
+			}
+			chunks->push_back(chunk);
+			last_frame += chunk.header.num_frames;
+			offset = chunk.payload_offset + chunk.header.payload_size;
+		}
+	}
+
+	void decode_journal_structure(BaseStream &e, capture *capture, const vr_keys &initial_keys, bool *has_keys, vr_keys *keys,
+						capture_spawn_visitor *spawner, capture_id_fixer *fixer)
+	{
+		int keys_present;
+		e.read_from_stream(&keys_present, sizeof(keys_present));
+		if (keys_present)
+		{
+			// only the last copy is kept.  the indexers expect to be decoded once after Init
+			vr_keys tmp(initial_keys);
+			tmp.decode(e);
+			*keys = tmp;
+			*has_keys = true;
+		}
+
+		int num_spawns;
+		e.read_from_stream(&num_spawns, sizeof(num_spawns));
+		for (int i = 0; i < num_spawns; i++)
+		{
+			time_indexed<VRSpawnRecord> spawn;
+			spawn.decode(e);
+			spawner->add_spawn(spawn.get_value());
+			capture->m_spawns.push_back(spawn);
+		}
+
+		int num_registry_entries;
+		e.read_from_stream(&num_registry_entries, sizeof(num_registry_entries));
+		for (int i = 0; i < num_registry_entries; i++)
+		{
+			serialization_id id;
+			e.read_from_stream(&id, sizeof(id));
+			base::URL url;
+			url.decode(e);
+			fixer->path2id.insert({ url.get_path_id(), id });
+		}
+	}
+
+	void decode_journal_frames(BaseStream &e, capture *capture, const journal_chunk_header_t &chunk_header)
+	{
+		for (int i = 0; i < chunk_header.num_frames; i++)
+		{
+			time_index_t frame = chunk_header.first_frame + i;
+
+			time_stamp_t time_stamp;
+			e.read_from_stream(&time_stamp, sizeof(time_stamp));
+			capture->m_time_stamps.push_back(time_stamp);
+
+			int num_keys_updates;
+			e.read_from_stream(&num_keys_updates, sizeof(num_keys_updates));
+			for (int j = 0; j < num_keys_updates; j++)
+			{
+				VRKeysUpdate update;
+				update.decode(e);
+				capture->m_keys_updates.emplace_back(frame, update);
+			}
+
+			int num_events;
+			e.read_from_stream(&num_events, sizeof(num_events));
+			for (int j = 0; j < num_events; j++)
+			{
+				VREncodableEvent event;
+				event.decode(e);
+				capture->m_vr_events.emplace_back(frame, event);
+			}
+
+			int num_update_bits;
+			e.read_from_stream(&num_update_bits, sizeof(num_update_bits));
+			for (int j = 0; j < num_update_bits; j++)
+			{
+				sparse_bitset bits;
+				bits.decode(e);
+				for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+				{
+					capture->m_state_registry.registered[id]->decode_entry(e);
+				}
+				capture->m_state_update_bits.emplace_back(frame, std::move(bits));
+			}
+		}
+	}
+
+	// restores the registry ids and applies any journal chunks that follow the saved sections.
+	// registry_stream is the saved registry table and tables what it refers to.  initial_keys are the keys before anything
+	// was decoded into them.  returns the last frame in the capture
+	time_index_t replay_journal(BaseStream &stream, uint64_t file_size, const header_t &header, BaseStream &registry_stream,
+							capture_tables *tables, capture *capture, const vr_keys &initial_keys)
+	{
+		capture_id_fixer fixer;
+		read_registry_table(registry_stream, tables, &fixer);
+
+		std::vector<journal_chunk> chunks;
+		time_index_t last_frame = capture->m_save_summary.last_encoded_frame;
+		scan_journal(stream, file_size, header.updates_offset, last_frame, &chunks);
+
+		// pass 1: re-create the structure.  the spawned nodes are registered with throw away ids
+		// and then the fixer gives every node the id it had when it was captured
+		std::vector<char> payload;
+		bool has_keys = false;
+		vr_keys keys;
+		SerializableRegistry spawn_registry;
+		capture_spawn_visitor spawner;
+		spawner.registry = &spawn_registry;
+		for (const journal_chunk &chunk : chunks)
+		{
+			read_journal_payload(stream, chunk, &payload);
+			MemoryStream payload_stream(payload.data(), payload.size(), false);
+			decode_journal_structure(payload_stream, capture, initial_keys, &has_keys, &keys, &spawner, &fixer);
+		}
+		if (has_keys)
+		{
+			capture->m_keys = keys;
+		}
+		if (!spawner.pending_spawns.empty())
+		{
+			traverse_history_graph<ExecuteImmediatelyTaskGroup>(&spawner, capture, &null_wrappers);
+			assert(spawner.pending_spawns.empty());
+		}
+		fixup_registry_ids(capture, &fixer);
+
+		// pass 2: append the entries
+		for (const journal_chunk &chunk : chunks)
+		{
+			read_journal_payload(stream, chunk, &payload);
+			MemoryStream payload_stream(payload.data(), payload.size(), false);
+			payload_stream.set_pos(chunk.header.structure_size);
+			decode_journal_frames(payload_stream, capture, chunk.header);
+			last_frame += chunk.header.num_frames;
+		}
+		return last_frame;
+	}
+
+	// a section that has been read into memory (or is mapped) so it can be decoded independently
+	struct section_view
+	{
+		section_view()
+			: data(nullptr), size(0)
+		{}
+		const char *data;
+		uint64_t size;
+		std::vector<char> storage;		// when the stream can't hand out the data in place
+		std::vector<char> uncompressed;	// when the section is compressed
+	};
+
+	// every section after the summary
+	struct capture_sections
+	{
+		section_view registry;
+		section_view keys;
+		section_view state;
+		section_view events;
+		section_view time_stamps;
+		section_view keys_updates;
+		section_view state_update_bits;
+		section_view strings;
+		section_view paths;
+	};
+
+	bool read_section(BaseStream &stream, uint64_t file_size, uint64_t offset, uint64_t size, section_view *view)
+	{
+		if (offset > file_size || size > file_size - offset)
+		{
+			return false;
+		}
+		stream.set_pos(offset);
+		view->size = size;
+		view->data = stream.read_in_place(size_t(size));
+		if (!view->data)
+		{
+			view->storage.resize(size_t(size));
+			stream.read_from_stream(view->storage.data(), view->storage.size());
+			view->data = view->storage.data();
+		}
+		return true;
+	}
+
+	bool read_sections(BaseStream &stream, uint64_t file_size, const header_t &header, capture_sections *sections)
+	{
+		return read_section(stream, file_size, header.registry_offset, header.registry_size, &sections->registry) &&
+			read_section(stream, file_size, header.keys_offset, header.keys_size, &sections->keys) &&
+			read_section(stream, file_size, header.state_offset, header.state_size, &sections->state) &&
+			read_section(stream, file_size, header.events_offset, header.events_size, &sections->events) &&
+			read_section(stream, file_size, header.time_stamps_offset, header.time_stamps_size, &sections->time_stamps) &&
+			read_section(stream, file_size, header.keys_updates_offset, header.keys_updates_size, &sections->keys_updates) &&
+			read_section(stream, file_size, header.state_update_bits_offset, header.state_update_bits_size, &sections->state_update_bits) &&
+			read_section(stream, file_size, header.strings_offset, header.strings_size, &sections->strings) &&
+			read_section(stream, file_size, header.paths_offset, header.paths_size, &sections->paths);
+	}
+
+	// checks the block table and starts a task on g for each block.  once g is done
+	// the view refers to the uncompressed section
+	template <typename TaskGroup>
+	bool decompress_section(TaskGroup &g, const section_info_t &info, section_view *view, std::atomic<int> *num_bad_blocks)
+	{
+		int num_blocks = 0;
+		if (view->size < sizeof(num_blocks))
+		{
+			return false;
+		}
+		memcpy(&num_blocks, view->data, sizeof(num_blocks));
+		if (num_blocks < 0 || sizeof(compressed_block_t) * uint64_t(num_blocks) > view->size - sizeof(num_blocks))
+		{
+			return false;
+		}
+		std::vector<compressed_block_t> blocks(num_blocks);
+		memcpy(blocks.data(), view->data + sizeof(num_blocks), sizeof(compressed_block_t) * blocks.size());
+		if (crc32buf(reinterpret_cast<const char *>(blocks.data()), sizeof(compressed_block_t) * blocks.size()) != info.block_table_crc)
+		{
+			return false;
+		}
+
+		// check every block fits before any are started
+		uint64_t src_offset = sizeof(num_blocks) + sizeof(compressed_block_t) * blocks.size();
+		uint64_t dest_offset = 0;
+		for (const compressed_block_t &block : blocks)
+		{
+			if (block.stored_size > view->size - src_offset || block.uncompressed_size > info.uncompressed_size - dest_offset)
+			{
+				return false;
+			}
+			src_offset += block.stored_size;
+			dest_offset += block.uncompressed_size;
+		}
+		if (dest_offset != info.uncompressed_size)
+		{
+			return false;
+		}
+
+		view->uncompressed.resize(size_t(info.uncompressed_size));
+		src_offset = sizeof(num_blocks) + sizeof(compressed_block_t) * blocks.size();
+		dest_offset = 0;
+		for (const compressed_block_t &block : blocks)
+		{
+			const char *src = view->data + src_offset;
+			char *dest = view->uncompressed.data() + dest_offset;
+			g.run("decompress_block", [src, dest, block, num_bad_blocks] {
+				if (!decompress_block(src, dest, block))
+				{
+					(*num_bad_blocks)++;
+				}
+			});
+			src_offset += block.stored_size;
+			dest_offset += block.uncompressed_size;
+		}
+		view->data = view->uncompressed.data();
+		view->size = info.uncompressed_size;
+		return true;
+	}
+
+	// the blocks of all the sections are decompressed together
+	template <typename TaskGroup>
+	bool decompress_sections(const header_t &header, capture_sections *sections)
+	{
+		std::atomic<int> num_bad_blocks(0);
+		TaskGroup g;
+		bool rc = decompress_section(g, header.registry_info, &sections->registry, &num_bad_blocks) &&
+			decompress_section(g, header.keys_info, &sections->keys, &num_bad_blocks) &&
+			decompress_section(g, header.state_info, &sections->state, &num_bad_blocks) &&
+			decompress_section(g, header.events_info, &sections->events, &num_bad_blocks) &&
+			decompress_section(g, header.time_stamps_info, &sections->time_stamps, &num_bad_blocks) &&
+			decompress_section(g, header.keys_updates_info, &sections->keys_updates, &num_bad_blocks) &&
+			decompress_section(g, header.state_update_bits_info, &sections->state_update_bits, &num_bad_blocks) &&
+			decompress_section(g, header.strings_info, &sections->strings, &num_bad_blocks) &&
+			decompress_section(g, header.paths_info, &sections->paths, &num_bad_blocks);
+		g.wait();	// even on failure, the blocks that were started refer to the views
+		if (num_bad_blocks > 0)
+		{
+			log_printf("capture has %d corrupt blocks\n", int(num_bad_blocks));
+		}
+		return rc && num_bad_blocks == 0;
+	}
+
+	// reads the state table and sets up a view for each top level node
+	bool split_state_section(const section_view &state, section_view *nodes)
+	{
+		MemoryStream table(const_cast<char *>(state.data), state.size, false);
+		int num_nodes = 0;
+		if (state.size >= sizeof(num_nodes))
+		{
+			table.read_from_stream(&num_nodes, sizeof(num_nodes));
+		}
+		if (num_nodes != NUM_TOP_LEVEL_NODES || state.size < sizeof(num_nodes) + sizeof(uint64_t) * NUM_TOP_LEVEL_NODES)
+		{
+			return false;
+		}
+		uint64_t node_sizes[NUM_TOP_LEVEL_NODES];
+		table.read_from_stream(node_sizes, sizeof(node_sizes));
+		uint64_t node_offset = table.get_pos();
+		for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+		{
+			if (node_sizes[node] > state.size - node_offset)
+			{
+				return false;
+			}
+			nodes[node].data = state.data + node_offset;
+			nodes[node].size = node_sizes[node];
+			node_offset += node_sizes[node];
+		}
+		return true;
+	}
+
+	// the strings and paths go before the sections that refer to them.  those only look ids up
+	bool decode_tables(const capture_sections &sections, capture_tables *tables)
+	{
+		MemoryStream strings(const_cast<char *>(sections.strings.data), sections.strings.size, false);
+		MemoryStream paths(const_cast<char *>(sections.paths.data), sections.paths.size, false);
+		return tables->strings.decode(strings) && strings.get_pos() == sections.strings.size &&
+			tables->paths.decode(paths) && paths.get_pos() == sections.paths.size;
+	}
+
+	// everything after the keys.  the state nodes and the remaining sections are independent of each
+	// other so the TaskGroup decides if they are decoded concurrently
+	template <typename TaskGroup>
+	bool decode_sections(const capture_sections &sections, capture_tables *tables, capture *capture)
+	{
+		section_view state_nodes[NUM_TOP_LEVEL_NODES];
+		if (!split_state_section(sections.state, state_nodes))
+		{
+			return false;
+		}
+
+		TaskGroup g;
+		for (int node = 0; node < NUM_TOP_LEVEL_NODES; node++)
+		{
+			const section_view *v = &state_nodes[node];
+			g.run(top_level_node_names[node], [this, capture, v, node, tables] {
+				MemoryStream s(const_cast<char *>(v->data), v->size, false);
+				decode_state_node(node, capture, s, tables);
+			});
+		}
+		const section_view *e = &sections.events;
+		g.run("decode_events", [capture, e] {
+			MemoryStream s(const_cast<char *>(e->data), e->size, false);
+			capture->m_vr_events.decode(s);
+		});
+		const section_view *t = &sections.time_stamps;
+		g.run("decode_time_stamps", [capture, t] {
+			MemoryStream s(const_cast<char *>(t->data), t->size, false);
+			s.forward_container_from_stream(capture->m_time_stamps);
+		});
+		const section_view *k = &sections.keys_updates;
+		g.run("decode_keys_updates", [capture, k] {
+			MemoryStream s(const_cast<char *>(k->data), k->size, false);
+			capture->m_keys_updates.decode(s);
+		});
+		const section_view *u = &sections.state_update_bits;
+		g.run("decode_state_update_bits", [capture, u] {
+			MemoryStream s(const_cast<char *>(u->data), u->size, false);
+			capture->m_state_update_bits.decode(s);
+		});
+		g.wait();
+		return true;
+	}
+
+	bool read_capture(BaseStream &stream, uint64_t file_size, capture *capture, bool parallel)
+	{
+		slab::scope scope(&capture->m_slab);
+		header_t header;
+		if (file_size < sizeof(header))
+		{
+			return false;
+		}
+		stream.set_pos(0);
+		header.decode(stream);
+		if (!header.verify()) // checks the magic value and the CRC
+		{
+			return false; // header is invalid
+		}
+		capture->m_resource_cache.clear();	// the loaded resources and images may not be what was last seen
+		capture->m_overlay_images.clear();
+		{
+			stream.set_pos(header.summary_offset);
+			capture->m_save_summary.decode(stream);
+		}
+
+		capture_sections sections;
+		if (!read_sections(stream, file_size, header, &sections))
+		{
+			return false;
+		}
+		if (header.compression != CAPTURE_COMPRESSION_NONE)
+		{
+			bool decompressed;
+			if (parallel)
+			{
+				decompressed = decompress_sections<named_task_group>(header, &sections);
+			}
+			else
+			{
+				decompressed = decompress_sections<ExecuteImmediatelyTaskGroup>(header, &sections);
+			}
+			if (!decompressed)
+			{
+				return false;
+			}
+		}
+
+		capture_tables tables;
+		if (!decode_tables(sections, &tables))
+		{
+			return false;
+		}
+
+		vr_keys initial_keys(capture->m_keys);
+		{
+			// the state traversal looks things up in the keys so they go first
+			MemoryStream s(const_cast<char *>(sections.keys.data), sections.keys.size, false);
+			capture->m_keys.decode(s);
+		}
+		bool rc;
+		if (parallel)
+		{
+			rc = decode_sections<named_task_group>(sections, &tables, capture);
+		}
+		else
+		{
+			rc = decode_sections<ExecuteImmediatelyTaskGroup>(sections, &tables, capture);
+		}
+		if (!rc)
+		{
+			return false;
+		}
+
+		// fixup the registry and apply chunks
+		MemoryStream registry_stream(const_cast<char *>(sections.registry.data), sections.registry.size, false);
+		capture->m_save_summary.last_encoded_frame = replay_journal(stream, file_size, header, registry_stream, &tables, capture, initial_keys);
 
 		// write derived values
 		capture->m_last_updated_frame_number = capture->m_save_summary.last_encoded_frame;
-		rc = true;
+		return true;
+	}
+};
+
+capture_traverser::capture_traverser()
+{
+	m_pimpl = new capture_traverser::impl;
+}
+
+capture_traverser::~capture_traverser()
+{
+	delete m_pimpl;
+}
+
+void capture_traverser::update_capture(capture *capture,
+	openvr_broker::open_vr_interfaces *interfaces,
+	time_stamp_t update_time,
+	bool parallel)
+{
+	slab::scope scope(&capture->m_slab);
+	time_index_t last_updated = capture->get_last_updated_frame();
+	capture_update_visitor &update_visitor = m_pimpl->update_visitor;
+	update_visitor.reset(last_updated + 1);								// setup the visitor with the new frame number
+	update_visitor.registry = &capture->m_state_registry;				// setup the visitor so he can register any new state objects
+
+	// which subtrees are due this frame
+	time_stamp_t last_update_time = capture->m_time_stamps.empty() ? update_time : capture->m_time_stamps.back();
+	poll_frame poll(&capture->m_poll_schedule, update_visitor.get_frame_number(), last_update_time, update_time);
+	update_visitor.m_poll = &poll;
+
+	ConfigObserver &config_observer = m_pimpl->config_observer;
+	config_observer.config_events.clear();
+	capture->m_keys.RegisterObserver(&config_observer);
+
+	WrapperSet &wrappers = m_pimpl->update_wrappers;
+	wrappers.assign(interfaces, &capture->m_resource_cache, &capture->m_overlay_images);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (parallel)
+	{
+		traverse_history_graph<named_task_group>(&update_visitor, capture, &wrappers);
+	}
+	else
+	{
+		traverse_history_graph<ExecuteImmediatelyTaskGroup>(&update_visitor, capture, &wrappers);
+	}
+	
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	bool quiet = true;
+	if (!quiet)
+	{
+		log_printf("parallel update took %lld us.\n",
+			std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+	}
+
+	//
+	// after updating the frame, finalize any per frame stats and then advance the frame number
+	//
+
+	// after update, log any new keys discovered:
+	capture->m_keys.UnRegisterObserver(&config_observer);
+	for (VRKeysUpdate& e : config_observer.config_events)
+	{
+		capture->m_keys_updates.emplace_back(update_visitor.get_frame_number(), e);
+	}
+
+	// after update, log spawned children.  the journal uses these to re-create the structure
+	for (auto &spawn : update_visitor.spawn)
+	{
+		const base::URL &parent_url = capture->m_state_registry.registered[spawn.first]->get_serialization_url();
+		capture->m_spawns.emplace_back(update_visitor.get_frame_number(), parent_url.get_full_path(), spawn.second);
+	}
+
+	// after update, log updated nodes
+	VRBitset &updated_node_bits = m_pimpl->updated_node_bits;
+	update_visitor.collect_updated_node_bits(&updated_node_bits);
+	if (!updated_node_bits.none())
+	{
+		// any items that updated
+		capture->m_state_update_bits.emplace_back(update_visitor.get_frame_number(), updated_node_bits);
+	}
+	
+	// after update, log the frame_time
+	capture->m_time_stamps.push_back(update_time);
+
+	// after update, finally update m_last_updated_frame_number
+	capture->increment_last_updated_frame();
+}
+
+
+bool capture_traverser::save_capture_to_binary_file(capture *capture, const char *filename, bool parallel)
+{
+	bool rc = true;
+	FileStream f;
+	
+	if (f.open_file_for_write_plus(filename))
+	{
+		header_t header;
+		m_pimpl->write_capture(f, capture, parallel, &header);
+	}
+	else
+	{
+		rc = false;
 	}
 	return rc;
 }
 
+void capture_traverser::compress_cold_segments(capture *capture)
+{
+	cold_segment_cache &cache = capture->m_cold_segments;
+	cache.begin_pass();
+	if (cache.get_age_frames() <= 0)
+	{
+		return;
+	}
+	capture_compress_visitor visitor(capture->get_last_updated_frame() + 1 - cache.get_age_frames(), &cache);
+	traverse_history_graph<ExecuteImmediatelyTaskGroup>(&visitor, capture, &m_pimpl->null_wrappers);
+	cache.end_pass();
+}
+
+void capture_traverser::set_save_compression(capture_compression compression)
+{
+	m_pimpl->compression = compression;
+}
+
+void capture_traverser::set_save_float_epsilon(float epsilon)
+{
+	m_pimpl->float_epsilon = epsilon;
+}
+
+bool capture_traverser::load_capture_from_binary_file(capture *capture, const char *filename, bool parallel)
+{
+	FileStream stream;
+	if (!stream.open_file_for_read(filename))
+	{
+		return false;
+	}
+	return m_pimpl->read_capture(stream, stream.get_file_size(), capture, parallel);
+}
+
+bool capture_traverser::load_capture_from_mapped_file(capture *capture, const char *filename, bool parallel)
+{
+	MappedFileStream stream;
+	if (!stream.open_file_for_read(filename))
+	{
+		return false;
+	}
+	return m_pimpl->read_capture(stream, stream.get_file_size(), capture, parallel);
+}
+
+bool capture_traverser::open_capture_journal(capture *capture, const char *filename)
+{
+	if (!m_pimpl->journal_stream.open_file_for_write_plus(filename))
+	{
+		return false;
+	}
+
+	// the snapshot, chunks are appended after it
+	header_t header;
+	m_pimpl->write_capture(m_pimpl->journal_stream, capture, true, &header);
+	m_pimpl->journal_stream.set_pos(header.updates_offset);
+	m_pimpl->journal_stream.flush();
+	m_pimpl->start_journal(capture);
+	return true;
+}
+
+bool capture_traverser::append_capture_journal(capture *capture)
+{
+	if (!m_pimpl->journal.is_open)
+	{
+		return false;
+	}
+	m_pimpl->append_journal(capture);
+	return true;
+}
+
+void capture_traverser::close_capture_journal(capture *capture)
+{
+	if (m_pimpl->journal.is_open)
+	{
+		m_pimpl->append_journal(capture);
+		m_pimpl->write_journal_chunk(capture, capture->get_last_updated_frame(), true);	// keys can change without a spawn
+		m_pimpl->journal_stream.close();
+		m_pimpl->journal.is_open = false;
+	}
+}
+
 // if every timestamp had also a list of objects that were updated
 // serialization could use this to efficently stream updates
 
@@ -11,11 +11,21 @@
 #include "openvr_broker.h"
 struct capture;
 
+// how sections are stored by a save.  loads work out the compression from the file
+enum capture_compression
+{
+	CAPTURE_COMPRESSION_NONE,
+	CAPTURE_COMPRESSION_LZ4,		// fast
+	CAPTURE_COMPRESSION_LZ4HC,		// slower to save, smaller.  for archiving
+};
+
 struct capture_traverser
 {
 	capture_traverser();
 	~capture_traverser();
 
+	// the traverser keeps it's wrappers and visitor between updates so they don't allocate, so
+	// only one update at a time per traverser
 	void update_capture(capture *capture, openvr_broker::open_vr_interfaces *interfaces, time_stamp_t update_time, bool parallel);
 
 	void update_capture_parallel(capture *capture, openvr_broker::open_vr_interfaces *interfaces, time_stamp_t update_time)
@@ -28,8 +38,30 @@ struct capture_traverser
 	}
 
 
-	bool save_capture_to_binary_file(capture *capture, const char *filename);
-	bool load_capture_from_binary_file(capture *capture, const char *filename);
+	// parallel encodes/decodes the sections (and the top level state nodes) concurrently.
+	// the file is the same either way
+	bool save_capture_to_binary_file(capture *capture, const char *filename, bool parallel = true);
+	bool load_capture_from_binary_file(capture *capture, const char *filename, bool parallel = true);
+	// same file format, read through a memory mapping instead of fread
+	bool load_capture_from_mapped_file(capture *capture, const char *filename, bool parallel = true);
+	// applies to saves and journal snapshots.  default is none
+	void set_save_compression(capture_compression compression);
+	// pose and matrix histories are saved within epsilon of their values instead of exactly. 0 is lossless (default)
+	void set_save_float_epsilon(float epsilon);
+
+	// maintenance pass: compresses the history segments that are older than the capture's cold
+	// segment age, frees what the last pass retired and spills cold segments past the resident
+	// ceiling to the scratch file (see cold_segments.h).  does at most
+	// CaptureConfig::cold_segment_pass_bytes of each; the next pass carries on.  not concurrent
+	// with updates, but readers can be
+	void compress_cold_segments(capture *capture);
+
+	// journal: writes a snapshot of the capture and then appends whatever changed each time
+	// append_capture_journal is called.  the file is loaded with load_capture_from_binary_file
+	// and a journal that was cut short (eg. crash) loads up to the last complete append.
+	bool open_capture_journal(capture *capture, const char *filename);
+	bool append_capture_journal(capture *capture);
+	void close_capture_journal(capture *capture);
 
 private:
 	struct impl;
@@ -6,6 +6,9 @@
 
 #include "time_containers.h"
 #include "vr_types.h"
+#include "poll_schedule.h"
+#include "tbb/enumerable_thread_specific.h"
+#include <algorithm>
 
 // CONCURRENCY: needs to be multi writer safe since jobs are sharing the same visitor
 struct capture_update_visitor 
@@ -18,14 +21,31 @@ public:
 																// log any new spawned objects during this update
 																 // first: the parent serialization_id
 																 // second: the name of the child
-	tbb::spin_mutex updated_node_lock;
-	VRBitset updated_node_bits;
+	// each thread marks the nodes it changed in it's own bitset, so visit_node doesn't share
+	// a lock.  collect_updated_node_bits ORs them together once the traversal is done
+	tbb::enumerable_thread_specific<VRBitset> updated_node_bits;
+
+	const poll_frame *m_poll;			// which subtrees to query this frame.  null queries everything
 public:
 
 	capture_update_visitor(time_index_t t)
-		:	m_frame_number(t)
+		:	m_frame_number(t),
+			m_poll(nullptr)
 	{}
 
+	// ready for another update.  keeps the memory of the last one so updates once the graph is
+	// discovered don't allocate
+	void reset(time_index_t t)
+	{
+		m_frame_number = t;
+		m_poll = nullptr;
+		spawn.clear();
+		for (VRBitset &thread_bits : updated_node_bits)
+		{
+			thread_bits.reset();
+		}
+	}
+
 	time_index_t get_frame_number() const { return m_frame_number;  }
 
 	//
@@ -35,6 +55,7 @@ public:
 	static const bool spawn_children() { return true; }
 	static const bool reload_render_models() { return false; }
 	static const bool recheck_distortion() { return false; }
+	bool poll(poll_subtree s, int item) const { return !m_poll || m_poll->poll(s, item); }
 
 	inline void start_group_node(const base::URL &url_name, int group_id_index) {}
 	inline void end_group_node(const base::URL &group_id_name, int group_id_index) {}
@@ -56,9 +77,27 @@ public:
 		{
 			history.emplace_back(m_frame_number, latest_result);
 			serialization_id history_id = history.get_serialization_index();
-			updated_node_lock.lock();
-			updated_node_bits.set(history_id);
-			updated_node_lock.unlock();
+			updated_node_bits.local().set(history_id);
+		}
+	}
+
+	// the nodes that changed this frame.  none() if nothing changed.  not safe during the traversal
+	void collect_updated_node_bits(VRBitset *bits)
+	{
+		VRBitset::size_type num_bits = 0;
+		for (const VRBitset &thread_bits : updated_node_bits)
+		{
+			num_bits = std::max(num_bits, thread_bits.size());
+		}
+		bits->clear();
+		bits->resize(num_bits);
+		for (VRBitset &thread_bits : updated_node_bits)
+		{
+			if (thread_bits.size() < num_bits)
+			{
+				thread_bits.resize(num_bits);
+			}
+			*bits |= thread_bits;
 		}
 	}
 
@@ -0,0 +1,371 @@
+#include "cold_segments.h"
+#include "log.h"
+#include "platform.h"
+#include "lz4.h"
+#include <string.h>
+#include <algorithm>
+
+// the last lookup made by this thread.  it's good while the cache's generation hasn't moved,
+// since nothing cached has been retired since.  generations are unique across caches, so a
+// cache at the address of a destroyed one doesn't match
+namespace
+{
+	struct last_lookup
+	{
+		const cold_segment_cache *cache;
+		const cold_segment *segment;
+		const void *data;
+		uint64_t generation;
+	};
+	thread_local last_lookup t_last_lookup = { nullptr, nullptr, nullptr, 0 };
+	std::atomic<uint64_t> s_next_generation(1);
+
+	// scratch file chunks.  a multiple of the windows mapping granularity
+	const uint64_t SPILL_CHUNK_BYTES = 64 * 1024 * 1024;
+	const uint64_t SPILL_PAGE_BYTES = 64 * 1024;
+	const uint64_t SPILL_ALIGNMENT = 16;
+}
+
+cold_segment_cache::cold_segment_cache()
+	:	m_age_frames(0),
+		m_capacity(0),
+		m_resident_ceiling(0),
+		m_pass_limit(0),
+		m_pass_compressed(0),
+		m_pass_limited(false),
+		m_cached_bytes(0),
+		m_generation(s_next_generation.fetch_add(uint64_t(1) << 32)),
+		m_spill_file(nullptr),
+		m_spill_file_size(0),
+		m_spill_chunk_used(0),
+		m_spill_chunk_discarded(0),
+		m_num_hits(0),
+		m_num_misses(0),
+		m_num_compressed(0),
+		m_num_stored(0),
+		m_compressed_bytes(0),
+		m_uncompressed_bytes(0),
+		m_resident_bytes(0),
+		m_spilled_bytes(0)
+{
+}
+
+cold_segment_cache::~cold_segment_cache()
+{
+	for (cached_segment &cached : m_lru)
+	{
+		delete[] cached.data;
+	}
+	for (char *data : m_retired)
+	{
+		delete[] data;
+	}
+	for (char *data : m_retired_last)
+	{
+		delete[] data;
+	}
+	for (spill_chunk &chunk : m_spill_chunks)
+	{
+		plat::unmap_scratch_file(chunk.view, chunk.size);
+	}
+	if (m_spill_file)
+	{
+		plat::close_scratch_file(m_spill_file);
+	}
+}
+
+void cold_segment_cache::Init(const CaptureConfig &c)
+{
+	m_age_frames = c.cold_segment_age_frames;
+	m_capacity = c.cold_segment_cache_bytes;
+	m_resident_ceiling = c.cold_segment_resident_bytes;
+	m_pass_limit = c.cold_segment_pass_bytes;
+}
+
+cold_segment *cold_segment_cache::compress(const void *data, uint32_t size)
+{
+	m_pass_compressed += size;
+	if (!pass_has_room())
+	{
+		m_pass_limited = true;		// the lists may have more
+	}
+	m_compress_buffer.resize(LZ4_compressBound(size_as_int(size)));
+	int compressed_size = LZ4_compress_default(static_cast<const char *>(data), m_compress_buffer.data(),
+		size_as_int(size), size_as_int(m_compress_buffer.size()));
+	bool compressed = compressed_size > 0 && uint32_t(compressed_size) <= size - size / 4;
+	if (!compressed && m_resident_ceiling == 0)
+	{
+		return nullptr;		// it wouldn't save anything, and it can't be spilled
+	}
+
+	cold_segment *segment = new cold_segment;
+	segment->stored_size = compressed ? uint32_t(compressed_size) : size;
+	segment->size = size;
+	segment->compressed = compressed;
+	segment->spilled = false;
+	char *bytes = new char[segment->stored_size];
+	memcpy(bytes, compressed ? m_compress_buffer.data() : data, segment->stored_size);
+	segment->bytes = bytes;
+	segment->resident_entry = m_resident.insert(m_resident.end(), segment);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	if (compressed)
+	{
+		m_num_compressed++;
+		m_compressed_bytes += compressed_size;
+		m_uncompressed_bytes += size;
+	}
+	else
+	{
+		m_num_stored++;
+	}
+	m_resident_bytes += segment->stored_size;
+	return segment;
+}
+
+const void *cold_segment_cache::lookup(const cold_segment *segment)
+{
+	uint64_t generation = m_generation.load(std::memory_order_acquire);
+	last_lookup &last = t_last_lookup;
+	if (last.cache == this && last.segment == segment && last.generation == generation)
+	{
+		return last.data;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	const void *data;
+	if (!segment->compressed)
+	{
+		data = segment->bytes;		// read in place
+	}
+	else
+	{
+		auto iter = m_index.find(segment);
+		if (iter != m_index.end())
+		{
+			m_num_hits++;
+			m_lru.splice(m_lru.begin(), m_lru, iter->second);
+			data = iter->second->data;
+		}
+		else
+		{
+			m_num_misses++;
+			char *decompressed = new char[segment->size];
+			if (LZ4_decompress_safe(segment->bytes, decompressed,
+					size_as_int(segment->stored_size), size_as_int(segment->size)) != int(segment->size))
+			{
+				ABORT("cold segment failed to decompress");
+			}
+			m_lru.push_front({ segment, decompressed });
+			m_index[segment] = m_lru.begin();
+			m_cached_bytes += segment->size;
+
+			// the one just decompressed stays, whatever the capacity
+			while (m_cached_bytes > m_capacity && m_lru.size() > 1)
+			{
+				cached_segment &oldest = m_lru.back();
+				m_index.erase(oldest.segment);
+				m_cached_bytes -= oldest.segment->size;
+				retire(oldest.data);
+				m_lru.pop_back();
+			}
+			data = decompressed;
+		}
+	}
+	last = { this, segment, data, m_generation.load(std::memory_order_relaxed) };
+	return data;
+}
+
+// m_lock is held
+void cold_segment_cache::retire(char *data)
+{
+	m_retired.push_back(data);
+	m_generation.fetch_add(1, std::memory_order_release);
+}
+
+void cold_segment_cache::release(cold_segment *segment)
+{
+	if (!segment->spilled)
+	{
+		m_resident.erase(segment->resident_entry);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		auto iter = m_index.find(segment);
+		if (iter != m_index.end())
+		{
+			m_cached_bytes -= segment->size;
+			retire(iter->second->data);
+			m_lru.erase(iter->second);
+			m_index.erase(iter);
+		}
+		else
+		{
+			m_generation.fetch_add(1, std::memory_order_release);	// the address may be reused
+		}
+		if (segment->compressed)
+		{
+			m_num_compressed--;
+			m_compressed_bytes -= segment->stored_size;
+			m_uncompressed_bytes -= segment->size;
+		}
+		else
+		{
+			m_num_stored--;
+		}
+		if (segment->spilled)
+		{
+			m_spilled_bytes -= segment->stored_size;	// the file doesn't shrink
+		}
+		else
+		{
+			m_resident_bytes -= segment->stored_size;
+			delete[] segment->bytes;
+		}
+	}
+	delete segment;
+}
+
+void cold_segment_cache::begin_pass()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	for (char *data : m_retired_last)
+	{
+		delete[] data;
+	}
+	m_retired_last.clear();
+	m_retired_last.swap(m_retired);
+	m_pass_compressed = 0;
+	m_pass_limited = false;
+}
+
+void cold_segment_cache::end_pass()
+{
+	if (m_resident_ceiling == 0)
+	{
+		return;
+	}
+	uint64_t resident_bytes = get_resident_bytes();
+	uint64_t pass_spilled = 0;
+	while (resident_bytes > m_resident_ceiling && !m_resident.empty())
+	{
+		if (m_pass_limit != 0 && pass_spilled >= m_pass_limit)
+		{
+			m_pass_limited = true;
+			return;
+		}
+		cold_segment *segment = m_resident.front();
+		const char *spilled = spill(segment->bytes, segment->stored_size);
+		if (!spilled)
+		{
+			log_printf("cold segments: can't spill to the scratch file. keeping them in memory\n");
+			m_resident_ceiling = 0;
+			return;
+		}
+		m_resident.pop_front();
+		resident_bytes -= segment->stored_size;
+		pass_spilled += segment->stored_size;
+
+		// a reader may be decompressing or reading the old copy
+		std::lock_guard<std::mutex> lock(m_lock);
+		retire(const_cast<char *>(segment->bytes));
+		segment->bytes = spilled;
+		segment->spilled = true;
+		m_resident_bytes -= segment->stored_size;
+		m_spilled_bytes += segment->stored_size;
+	}
+}
+
+// copies size bytes to the end of the scratch file.  the pages that are written out are dropped
+// from the working set
+const char *cold_segment_cache::spill(const char *data, uint32_t size)
+{
+	if (!m_spill_file)
+	{
+		m_spill_file = plat::create_scratch_file();
+		if (!m_spill_file)
+		{
+			return nullptr;
+		}
+	}
+
+	uint64_t offset = (m_spill_chunk_used + SPILL_ALIGNMENT - 1) & ~(SPILL_ALIGNMENT - 1);
+	if (m_spill_chunks.empty() || offset + size > m_spill_chunks.back().size)
+	{
+		if (!m_spill_chunks.empty())
+		{
+			spill_chunk &full = m_spill_chunks.back();
+			plat::discard_mapped_pages(full.view + m_spill_chunk_discarded, full.size - m_spill_chunk_discarded);
+		}
+		uint64_t chunk_size = std::max(SPILL_CHUNK_BYTES, (size + SPILL_PAGE_BYTES - 1) & ~(SPILL_PAGE_BYTES - 1));
+		char *view = plat::map_scratch_file(m_spill_file, m_spill_file_size, chunk_size);
+		if (!view)
+		{
+			return nullptr;
+		}
+		m_spill_chunks.push_back({ view, chunk_size });
+		m_spill_file_size += chunk_size;
+		m_spill_chunk_discarded = 0;
+		offset = 0;
+	}
+
+	spill_chunk &chunk = m_spill_chunks.back();
+	memcpy(chunk.view + offset, data, size);
+	m_spill_chunk_used = offset + size;
+
+	uint64_t written_pages = m_spill_chunk_used & ~(SPILL_PAGE_BYTES - 1);
+	if (written_pages > m_spill_chunk_discarded)
+	{
+		plat::discard_mapped_pages(chunk.view + m_spill_chunk_discarded, written_pages - m_spill_chunk_discarded);
+		m_spill_chunk_discarded = written_pages;
+	}
+	return chunk.view + offset;
+}
+
+uint64_t cold_segment_cache::get_num_hits() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_num_hits;
+}
+
+uint64_t cold_segment_cache::get_num_misses() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_num_misses;
+}
+
+uint64_t cold_segment_cache::get_num_compressed() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_num_compressed;
+}
+
+uint64_t cold_segment_cache::get_num_stored() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_num_stored;
+}
+
+uint64_t cold_segment_cache::get_bytes_saved() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_uncompressed_bytes - m_compressed_bytes;
+}
+
+uint64_t cold_segment_cache::get_cached_bytes() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_cached_bytes;
+}
+
+uint64_t cold_segment_cache::get_resident_bytes() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_resident_bytes;
+}
+
+uint64_t cold_segment_cache::get_spilled_bytes() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_spilled_bytes;
+}
@@ -0,0 +1,142 @@
+#pragma once
+// cold segments
+//
+//  * long recordings keep every full segment of every history resident, though readers mostly
+//    touch recent frames or one scrub position.  a maintenance pass
+//    (capture_traverser::compress_cold_segments) LZ4 compresses the full segments that only
+//    hold samples older than CaptureConfig::cold_segment_age_frames and frees them.
+//  * a compressed segment's slot in it's list's segment directory is set to null.  reading it
+//    goes through the cache, which decompresses it and keeps the most recently used ones up to
+//    CaptureConfig::cold_segment_cache_bytes.  so what's resident grows with what compresses
+//    badly and what's being looked at, rather than with the length of the session.
+//  * only full SegmentSize segments are compressed.  the writer only appends past them, so they
+//    don't change.  they are read only: a write through a reference into one is lost.
+//  * freed memory (segments that were just compressed, decompressed copies that were evicted)
+//    is retired and only released by a later pass, at least a whole maintenance period after,
+//    so a reader in the middle of reading one isn't left with freed memory.  readers mustn't
+//    hold references across passes.
+//  * segments that don't compress to under 3/4 of their size are left alone, unless spilling
+//    is on.  then they're stored as they are, and read in place.
+//  * spilling: at the end of a pass, while the cold segments in memory add up to more than
+//    CaptureConfig::cold_segment_resident_bytes, the oldest are copied to a scratch file that's
+//    mapped in 64mb chunks, and their pages are dropped from the working set.  readers fault
+//    them back in from the file.  the chunks stay mapped until the cache goes, so pointers into
+//    them stay good.
+//  * each thread remembers the last segment it looked up, so reading along a cold segment only
+//    takes the lock when it gets to the next one.  the hit and miss counts are of these
+//    lookups, not of item reads.
+//  * one per capture (capture::m_cold_segments).  passes aren't concurrent with updates
+//    (capture_controller runs them under it's update lock); readers can be.
+//  * so a pass does at most CaptureConfig::cold_segment_pass_bytes of compressing and then of
+//    spilling.  lists stop compressing when the pass is out of room (pass_has_room()) and pick
+//    up where they left off in the next one.
+//
+#include "capture_config.h"
+#include "platform.h"
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// one compressed segment, or one stored as is so it can be spilled.  it's list owns it, and
+// releases it through the cache
+struct cold_segment
+{
+	const char *bytes;		// in memory, or in the scratch file once it's spilled
+	uint32_t stored_size;
+	uint32_t size;			// uncompressed bytes
+	bool compressed;
+	bool spilled;
+	std::list<cold_segment *>::iterator resident_entry;	// while it's in memory
+};
+
+struct cold_segment_cache
+{
+	cold_segment_cache();
+	~cold_segment_cache();
+
+	void Init(const CaptureConfig &c);
+
+	int get_age_frames() const { return m_age_frames; }
+
+	// compressed (or stored) copy of size bytes, or nullptr when it isn't worth it.  counts
+	// against the pass either way
+	cold_segment *compress(const void *data, uint32_t size);
+
+	// false once this pass has compressed it's cold_segment_pass_bytes
+	bool pass_has_room() const { return m_pass_limit == 0 || m_pass_compressed < m_pass_limit; }
+	// the last pass used up it's cold_segment_pass_bytes, so there may be more to do
+	bool pass_was_limited() const { return m_pass_limited; }
+
+	// the decompressed bytes of segment.  readers call this
+	const void *lookup(const cold_segment *segment);
+
+	// segment's list was cleared or destroyed
+	void release(cold_segment *segment);
+
+	// at the start of each maintenance pass: frees what was retired before the last pass
+	void begin_pass();
+	// at the end of it: spills down to the resident ceiling
+	void end_pass();
+
+	uint64_t get_num_hits() const;
+	uint64_t get_num_misses() const;
+	uint64_t get_num_compressed() const;		// segments currently compressed
+	uint64_t get_num_stored() const;			// segments stored as they are
+	uint64_t get_bytes_saved() const;			// by the segments currently compressed
+	uint64_t get_cached_bytes() const;			// decompressed copies
+	uint64_t get_resident_bytes() const;		// cold segments in memory
+	uint64_t get_spilled_bytes() const;			// cold segments in the scratch file
+
+private:
+	struct cached_segment
+	{
+		const cold_segment *segment;
+		char *data;
+	};
+	typedef std::list<cached_segment> lru_list;
+
+	struct spill_chunk
+	{
+		char *view;
+		uint64_t size;
+	};
+
+	void retire(char *data);
+	const char *spill(const char *data, uint32_t size);
+
+	int m_age_frames;
+	uint64_t m_capacity;
+	uint64_t m_resident_ceiling;
+	uint64_t m_pass_limit;
+	uint64_t m_pass_compressed;				// this pass.  input bytes
+	bool m_pass_limited;
+
+	mutable std::mutex m_lock;
+	lru_list m_lru;				// most recently used first
+	std::unordered_map<const cold_segment *, lru_list::iterator> m_index;
+	uint64_t m_cached_bytes;
+	std::vector<char *> m_retired;			// since the last pass
+	std::vector<char *> m_retired_last;		// before it: freed by the next pass
+	std::atomic<uint64_t> m_generation;	// bumped when memory a reader may have is retired.  see lookup()
+
+	// the writer's: the pass, and lists being cleared
+	std::vector<char> m_compress_buffer;
+	std::list<cold_segment *> m_resident;	// in memory, oldest first
+	plat::scratch_file *m_spill_file;
+	std::vector<spill_chunk> m_spill_chunks;
+	uint64_t m_spill_file_size;
+	uint64_t m_spill_chunk_used;			// of the last chunk
+	uint64_t m_spill_chunk_discarded;
+
+	uint64_t m_num_hits;
+	uint64_t m_num_misses;
+	uint64_t m_num_compressed;
+	uint64_t m_num_stored;
+	uint64_t m_compressed_bytes;			// of the compressed segments
+	uint64_t m_uncompressed_bytes;			// ""
+	uint64_t m_resident_bytes;
+	uint64_t m_spilled_bytes;
+};
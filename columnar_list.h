@@ -0,0 +1,291 @@
+#pragma once
+//
+// columnar_list: a segmented_list of time_indexed<> values that also keeps the time indexes in a
+//                separate, parallel segmented_list.
+//
+//  * time_indexed_vector searches (cursor seeks, get_range, find_entry) only touch the dense
+//    time index column instead of pulling whole values (poses, controller states) into cache.
+//  * the key segments are found through a segment_directory, and a skip table holds the first
+//    key of each segment.  key segments follow the value list's segment_layout, so they are
+//    allocated lazily and start small too.  a search is a binary search of the (small) skip table and then of one
+//    key segment.
+//  * searches with a hint (cursors) check the neighbourhood of the hint before searching.
+//  * iterators are the value list's iterators, so everything else works as with segmented_list.
+//  * the value is appended before it's time index so a reader that finds a time index can
+//    always read the value.
+//
+#include "segmented_list.h"
+#include "segment_directory.h"
+#include "time_containers.h"
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+template <typename T, SegmentSizeType SegmentSize, typename A = std::allocator<T>> struct columnar_list;
+
+template <typename T, typename A = std::allocator<T>>
+using columnar_list_1024 = columnar_list<T, 1024, A>;
+
+template <typename T, SegmentSizeType SegmentSize, typename A>
+struct columnar_list
+{
+public:
+	typedef T					value_type;
+	typedef T&					reference;
+	typedef const value_type &	const_reference;
+	typedef std::ptrdiff_t		difference_type;
+	typedef SegmentSizeType		size_type;
+
+	typedef segmented_list<T, SegmentSize, A> value_list_type;
+	typedef segment_layout<SegmentSize> layout;
+	typedef typename std::allocator_traits<A>::template rebind_alloc<time_index_t> key_allocator_type;
+
+	typedef typename value_list_type::iterator			iterator;
+	typedef typename value_list_type::const_iterator	const_iterator;
+
+	explicit columnar_list(A alloc = A())
+		:	m_values(alloc),
+			m_key_allocator(alloc),
+			m_size(0)
+	{}
+
+	columnar_list(const columnar_list &rhs)
+		:	m_values(rhs.m_values),
+			m_key_allocator(m_values.get_allocator()),		// the one the copy's values chose
+			m_size(0)
+	{
+		copy_keys(rhs);
+	}
+
+	columnar_list(columnar_list &&rhs)
+		:	m_values(std::move(rhs.m_values)),
+			m_key_allocator(rhs.m_key_allocator),
+			m_size(0)
+	{
+		m_key_segments.swap(rhs.m_key_segments);
+		m_first_keys.swap(rhs.m_first_keys);
+		m_size.store(rhs.m_size.load());
+		rhs.m_size = 0;
+	}
+
+	~columnar_list()
+	{
+		for (size_type i = 0; i < m_key_segments.size(); i++)
+		{
+			m_key_allocator.deallocate(m_key_segments[i], layout::capacity(i));
+		}
+	}
+
+	columnar_list& operator=(const columnar_list& rhs)
+	{
+		if (this != &rhs)
+		{
+			m_values = rhs.m_values;
+			m_size = 0;
+			m_first_keys.clear();
+			copy_keys(rhs);
+		}
+		return *this;
+	}
+
+	columnar_list& operator=(columnar_list&& rhs)
+	{
+		if (this != &rhs)
+		{
+			swap(rhs);
+		}
+		return *this;
+	}
+
+	void swap(columnar_list& rhs)
+	{
+		m_values.swap(rhs.m_values);
+		m_key_segments.swap(rhs.m_key_segments);
+		m_first_keys.swap(rhs.m_first_keys);
+		std::swap(m_key_allocator, rhs.m_key_allocator);
+		size_type tmp = m_size;
+		m_size.store(rhs.m_size);
+		rhs.m_size.store(tmp);
+	}
+
+	// the keys are derived from the values
+	bool operator == (const columnar_list &rhs) const
+	{
+		return m_values == rhs.m_values;
+	}
+
+	bool operator != (const columnar_list &rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	T& front() { return m_values.front(); }
+	const T& front() const { return m_values.front(); }
+	T& back() { return m_values.back(); }
+	const T& back() const { return m_values.back(); }
+
+	iterator begin() { return m_values.begin(); }
+	const_iterator begin() const { return m_values.begin(); }
+	iterator end() { return m_values.end(); }
+	const_iterator end() const { return m_values.end(); }
+	const_iterator cbegin() const { return m_values.cbegin(); }
+	const_iterator cend() const { return m_values.cend(); }
+
+	T& operator[] (size_type i) { return m_values[i]; }
+	const T& operator[] (size_type i) const { return m_values[i]; }
+
+	bool empty() const { return size() == 0; }
+
+	// readers go by the keys since they are written last
+	size_type size() const { return m_size; }
+
+	A get_allocator() const { return m_values.get_allocator(); }
+
+	// keeps the key segments around for reuse
+	void clear()
+	{
+		m_size = 0;
+		m_first_keys.clear();
+		m_values.clear();
+	}
+
+	void reserve(size_type new_cap)
+	{
+		m_values.reserve(new_cap);
+	}
+
+	// only the values are compressed: searches only read the keys, so they never decompress
+	template <typename IsCold>
+	void compress_segments(cold_segment_cache *cache, IsCold is_cold)
+	{
+		m_values.compress_segments(cache, is_cold);
+	}
+
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		m_values.emplace_back(std::forward<Args>(args)...);
+		push_key(m_values.back().get_time_index());
+	}
+
+	void push_back(const T& value)
+	{
+		m_values.push_back(value);
+		push_key(value.get_time_index());
+	}
+
+	time_index_t key_at(size_type i) const
+	{
+		size_type segment, offset;
+		layout::locate(i, &segment, &offset);
+		return m_key_segments[segment][offset];
+	}
+
+	// index of the first item with a time index greater than t (size() if there isn't one).
+	// the skip table of first keys picks the segment, then the search stays inside one key segment
+	size_type upper_bound_index(time_index_t t) const
+	{
+		size_type n = size();
+		if (n == 0)
+			return 0;
+		size_type num_segments = layout::num_segments(n);
+		const std::atomic<time_index_t> *first_keys = m_first_keys.data();
+		size_type segment = size_type(std::upper_bound(first_keys, first_keys + num_segments, t) - first_keys);
+		if (segment == 0)
+			return 0;
+		segment--;
+		size_type first = size_type(layout::first_index(segment));
+		size_type count = std::min<size_type>(layout::capacity(segment), n - first);
+		const time_index_t *keys = m_key_segments[segment];
+		return first + size_type(std::upper_bound(keys, keys + count, t) - keys);
+	}
+
+	// same but checks around near first.  cursors that didn't move past a change, or moved
+	// one sample forwards or backwards, don't need a search
+	size_type upper_bound_index(time_index_t t, size_type near) const
+	{
+		size_type n = size();
+		if (near < n)
+		{
+			if (key_at(near) <= t)
+			{
+				if (near + 1 == n || key_at(near + 1) > t)
+					return near + 1;
+				if (near + 2 == n || key_at(near + 2) > t)
+					return near + 2;
+			}
+			else if (near == 0 || key_at(near - 1) <= t)
+			{
+				return near;
+			}
+		}
+		return upper_bound_index(t);
+	}
+
+private:
+	void push_key(time_index_t key)
+	{
+		size_type n = m_size;
+		size_type segment, offset;
+		layout::locate(n, &segment, &offset);
+		if (segment == m_key_segments.size())
+		{
+			time_index_t *keys = m_key_allocator.allocate(layout::capacity(segment));
+			if (!keys)
+			{
+				ABORT("alloc failed");
+			}
+			m_key_segments.push_back(keys);
+		}
+		if (offset == 0)
+		{
+			m_first_keys.push_back(key);
+		}
+		m_key_segments[segment][offset] = key;
+		m_size.store(n + 1, std::memory_order_release);
+	}
+
+	void copy_keys(const columnar_list &rhs)
+	{
+		size_type n = rhs.size();
+		for (size_type i = 0; i < n; i++)
+		{
+			push_key(rhs.key_at(i));
+		}
+	}
+
+	value_list_type						m_values;
+	segment_directory<time_index_t*>	m_key_segments;		// the key column
+	segment_directory<time_index_t>		m_first_keys;		// skip table: first key of each key segment
+	key_allocator_type					m_key_allocator;
+	std::atomic<size_type>				m_size;
+};
+
+template <typename T, SegmentSizeType SegmentSize, typename A>
+void swap(columnar_list<T, SegmentSize, A> &a, columnar_list<T, SegmentSize, A> &b)
+{
+	a.swap(b);
+}
+
+// time_indexed_vector search hooks (see time_containers.h)
+template <typename T, SegmentSizeType SegmentSize, typename A>
+struct container_has_time_keys<columnar_list<T, SegmentSize, A>> : std::true_type {};
+
+template <typename T, SegmentSizeType SegmentSize, typename A>
+typename columnar_list<T, SegmentSize, A>::iterator container_upper_bound_time(columnar_list<T, SegmentSize, A> &container, time_index_t t)
+{
+	return container.begin() + container.upper_bound_index(t);
+}
+
+template <typename T, SegmentSizeType SegmentSize, typename A>
+typename columnar_list<T, SegmentSize, A>::const_iterator container_upper_bound_time(const columnar_list<T, SegmentSize, A> &container, time_index_t t)
+{
+	return container.begin() + container.upper_bound_index(t);
+}
+
+template <typename T, SegmentSizeType SegmentSize, typename A>
+typename columnar_list<T, SegmentSize, A>::iterator container_upper_bound_time(columnar_list<T, SegmentSize, A> &container, time_index_t t,
+	const typename columnar_list<T, SegmentSize, A>::iterator &near)
+{
+	return container.begin() + container.upper_bound_index(t, typename columnar_list<T, SegmentSize, A>::size_type(near - container.begin()));
+}
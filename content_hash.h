@@ -0,0 +1,42 @@
+#pragma once
+// content_hash
+//
+//  * 64 bit hash of a blob (resources, overlay images) used to tell if it changed without
+//    keeping a copy to compare against.  not cryptographic.
+//  * 32 bytes a step in four independent lanes so the multiplies overlap (and vectorize where the
+//    compiler can), then the lanes and the tail are folded together.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+inline uint64_t hash_content(const uint8_t *data, size_t size)
+{
+	static const uint64_t PRIME1 = 0x9e3779b185ebca87ull;
+	static const uint64_t PRIME2 = 0xc2b2ae3d27d4eb4full;
+	uint64_t lanes[4] = { PRIME1, PRIME2, ~PRIME1, ~PRIME2 };
+
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		uint64_t words[4];
+		memcpy(words, data + i, sizeof(words));
+		for (int l = 0; l < 4; l++)
+		{
+			lanes[l] = (lanes[l] ^ words[l]) * PRIME1;
+			lanes[l] ^= lanes[l] >> 31;
+		}
+	}
+
+	uint64_t hash = uint64_t(size) * PRIME2;
+	for (int l = 0; l < 4; l++)
+	{
+		hash = (hash ^ lanes[l]) * PRIME1;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ data[i]) * PRIME2;
+	}
+	return hash ^ (hash >> 32);
+}
@@ -0,0 +1,348 @@
+// history_codec.h
+//
+// * specialised encoding for histories of float structures (poses, matrices, controller states).
+//   consecutive samples are usually almost the same, so each sample is XORed against the previous
+//   one word by word and only the bytes of each word that changed are written (FPC/Gorilla style).
+// * optionally lossy: float words are allowed to move by up to BaseStream::float_epsilon, which
+//   turns small changes into no change and drops the low mantissa bits of the rest.
+//
+// time_indexed_vector uses the codec for any Result<T, ReturnCode> where float_history_traits<T>
+// is enabled.  single entries (the journal) are always written raw.
+//
+#pragma once
+#include "BaseStream.h"
+#include "result.h"
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+// specialised next to the type (eg. vr_types.h) to turn the codec on for histories of T
+template <typename T>
+struct float_history_traits
+{
+	static const bool enabled = false;
+	static bool is_float_word(int word) { return false; }
+};
+
+namespace history_codec_detail
+{
+	inline void write_varint(BaseStream &e, uint32_t v)
+	{
+		uint8_t buf[5];
+		int n = 0;
+		while (v >= 0x80)
+		{
+			buf[n++] = uint8_t(v | 0x80);
+			v >>= 7;
+		}
+		buf[n++] = uint8_t(v);
+		e.write_to_stream(buf, n);
+	}
+
+	inline uint32_t read_varint(BaseStream &e)
+	{
+		uint32_t v = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			uint8_t b;
+			e.read_from_stream(&b, sizeof(b));
+			v |= uint32_t(b & 0x7f) << shift;
+			if (!(b & 0x80))
+				break;
+		}
+		return v;
+	}
+
+	// whether the next bytes are in memory.  streams that aren't backed by memory can't say
+	inline bool stream_holds(BaseStream &e, uint64_t bytes)
+	{
+		uint64_t pos = e.get_pos();
+		bool holds = e.read_in_place(size_t(bytes)) != nullptr;
+		e.set_pos(pos);
+		return holds;
+	}
+
+	inline int leading_zero_bytes(uint32_t x)
+	{
+		int n = 0;
+		while (n < 4 && (x & 0xff000000) == 0)
+		{
+			x <<= 8;
+			n++;
+		}
+		return n;
+	}
+
+	inline int trailing_zero_bytes(uint32_t x)
+	{
+		int n = 0;
+		while (n < 4 && (x & 0xff) == 0)
+		{
+			x >>= 8;
+			n++;
+		}
+		return n;
+	}
+
+	// the value the decoder will see for a float word in lossy mode.  stays within epsilon of cur
+	inline uint32_t quantize_float_word(uint32_t cur, uint32_t prev, float epsilon)
+	{
+		float cur_f, prev_f;
+		memcpy(&cur_f, &cur, sizeof(cur_f));
+		memcpy(&prev_f, &prev, sizeof(prev_f));
+		if (std::fabs(cur_f - prev_f) <= epsilon)
+		{
+			return prev;
+		}
+
+		// truncating k mantissa bits moves the value by less than 2^k ulps
+		int exponent = int((cur >> 23) & 0xff);
+		if (exponent == 0xff)
+		{
+			return cur;	// inf/nan
+		}
+		int ulp_exponent = (exponent == 0 ? 1 : exponent) - 127 - 23;
+		int k = std::ilogb(epsilon) - ulp_exponent;
+		if (k <= 0)
+		{
+			return cur;
+		}
+		if (k > 23)
+		{
+			k = 23;
+		}
+		return cur & ~((uint32_t(1) << k) - 1);
+	}
+
+	// return codes are written only when they change
+	template <typename ResultType>
+	bool return_code_changed(const ResultType &a, const ResultType &b,
+		typename std::enable_if<ResultType::has_return_code, int>::type* = 0)
+	{
+		return memcmp(&a.return_code, &b.return_code, sizeof(a.return_code)) != 0;
+	}
+
+	template <typename ResultType>
+	bool return_code_changed(const ResultType &a, const ResultType &b,
+		typename std::enable_if<!ResultType::has_return_code, int>::type* = 0)
+	{
+		return false;
+	}
+
+	template <typename ResultType>
+	void encode_return_code(const ResultType &r, BaseStream &e,
+		typename std::enable_if<ResultType::has_return_code, int>::type* = 0)
+	{
+		e.write_to_stream(&r.return_code, sizeof(r.return_code));
+	}
+
+	template <typename ResultType>
+	void encode_return_code(const ResultType &r, BaseStream &e,
+		typename std::enable_if<!ResultType::has_return_code, int>::type* = 0)
+	{
+	}
+
+	template <typename ResultType>
+	void decode_return_code(ResultType &r, BaseStream &e,
+		typename std::enable_if<ResultType::has_return_code, int>::type* = 0)
+	{
+		e.read_from_stream(&r.return_code, sizeof(r.return_code));
+	}
+
+	template <typename ResultType>
+	void decode_return_code(ResultType &r, BaseStream &e,
+		typename std::enable_if<!ResultType::has_return_code, int>::type* = 0)
+	{
+	}
+
+	template <typename ResultType>
+	void copy_return_code(ResultType &a, const ResultType &b,
+		typename std::enable_if<ResultType::has_return_code, int>::type* = 0)
+	{
+		a.return_code = b.return_code;
+	}
+
+	template <typename ResultType>
+	void copy_return_code(ResultType &a, const ResultType &b,
+		typename std::enable_if<!ResultType::has_return_code, int>::type* = 0)
+	{
+	}
+}
+
+//
+// each sample is:
+//
+//	varint time index delta, uint8_t flags, [return code if it changed],
+//	[if present: changed word mask, for each changed word: uint8_t (leading zero bytes | trailing zero bytes << 4), middle bytes]
+//
+// decode() returns false, and leaves the container empty, if the stream doesn't hold that
+//
+template <typename T>
+struct history_codec
+{
+	static const bool enabled = false;
+};
+
+template <typename ElementType, typename ReturnCode>
+struct history_codec<Result<ElementType, ReturnCode>>
+{
+	using result_type = Result<ElementType, ReturnCode>;
+	using traits = float_history_traits<ElementType>;
+	static const bool enabled = traits::enabled;
+
+	static_assert(!enabled || sizeof(ElementType) % sizeof(uint32_t) == 0, "history codec works on 32 bit words");
+	static const int num_words = int(sizeof(ElementType) / sizeof(uint32_t));
+	static const int mask_bytes = (num_words + 7) / 8;
+
+	enum { RETURN_CODE_CHANGED = 1 };
+	enum { MIN_SAMPLE_BYTES = 2 };		// a time delta byte and the flags
+
+	// container holds time_indexed<result_type>
+	template <typename Container>
+	static void encode(const Container &container, BaseStream &e)
+	{
+		using namespace history_codec_detail;
+		int size = size_as_int(container.size());
+		e.write_to_stream(&size, sizeof(size));
+
+		const float epsilon = e.float_epsilon;
+		time_index_t prev_time = 0;
+		result_type prev_result;
+		uint32_t prev[num_words];		// what the decoder has for the last present value
+		memset(&prev_result, 0, sizeof(prev_result));
+		memset(prev, 0, sizeof(prev));
+
+		for (const auto &timeval : container)
+		{
+			write_varint(e, uint32_t(timeval.get_time_index() - prev_time));
+			prev_time = timeval.get_time_index();
+
+			const result_type &r = timeval.get_value();
+			uint8_t flags = return_code_changed(r, prev_result) ? RETURN_CODE_CHANGED : 0;
+			e.write_to_stream(&flags, sizeof(flags));
+			if (flags & RETURN_CODE_CHANGED)
+			{
+				encode_return_code(r, e);
+				copy_return_code(prev_result, r);
+			}
+			if (!r.is_present())
+			{
+				continue;
+			}
+
+			uint32_t cur[num_words];
+			memcpy(cur, &r.val, sizeof(cur));
+			if (epsilon > 0.0f)
+			{
+				for (int i = 0; i < num_words; i++)
+				{
+					if (traits::is_float_word(i))
+					{
+						cur[i] = quantize_float_word(cur[i], prev[i], epsilon);
+					}
+				}
+			}
+
+			uint8_t mask[mask_bytes];
+			memset(mask, 0, sizeof(mask));
+			for (int i = 0; i < num_words; i++)
+			{
+				if (cur[i] != prev[i])
+				{
+					mask[i / 8] |= uint8_t(1 << (i % 8));
+				}
+			}
+			e.write_to_stream(mask, sizeof(mask));
+
+			for (int i = 0; i < num_words; i++)
+			{
+				uint32_t x = cur[i] ^ prev[i];
+				if (x == 0)
+					continue;
+				int lz = leading_zero_bytes(x);
+				int tz = trailing_zero_bytes(x);
+				uint8_t buf[5];
+				buf[0] = uint8_t(lz | (tz << 4));
+				int n = 4 - lz - tz;
+				for (int b = 0; b < n; b++)
+				{
+					buf[1 + b] = uint8_t(x >> (8 * (tz + b)));
+				}
+				e.write_to_stream(buf, 1 + n);
+			}
+			memcpy(prev, cur, sizeof(prev));
+		}
+	}
+
+	template <typename Container>
+	static bool decode(Container &container, BaseStream &e)
+	{
+		using namespace history_codec_detail;
+		container.clear();
+		int size;
+		e.read_from_stream(&size, sizeof(size));
+		if (size < 0)
+		{
+			return false;
+		}
+		// the size came from the file: only trust it as far as the stream can show the samples are there
+		if (stream_holds(e, 0))
+		{
+			if (!stream_holds(e, uint64_t(size) * MIN_SAMPLE_BYTES))
+			{
+				return false;
+			}
+			container.reserve(size);
+		}
+
+		time_index_t time = 0;
+		result_type r;
+		uint32_t prev[num_words];
+		memset(&r, 0, sizeof(r));
+		memset(prev, 0, sizeof(prev));
+
+		for (int s = 0; s < size; s++)
+		{
+			time += time_index_t(read_varint(e));
+
+			uint8_t flags;
+			e.read_from_stream(&flags, sizeof(flags));
+			if (flags & RETURN_CODE_CHANGED)
+			{
+				decode_return_code(r, e);
+			}
+			if (r.is_present())
+			{
+				uint8_t mask[mask_bytes];
+				e.read_from_stream(mask, sizeof(mask));
+				for (int i = 0; i < num_words; i++)
+				{
+					if (mask[i / 8] & (1 << (i % 8)))
+					{
+						uint8_t header;
+						e.read_from_stream(&header, sizeof(header));
+						int lz = header & 0xf;
+						int tz = header >> 4;
+						if (lz + tz > 4)
+						{
+							container.clear();
+							return false;
+						}
+						int n = 4 - lz - tz;
+						uint8_t buf[4];
+						e.read_from_stream(buf, n);
+						uint32_t x = 0;
+						for (int b = 0; b < n; b++)
+						{
+							x |= uint32_t(buf[b]) << (8 * (tz + b));
+						}
+						prev[i] ^= x;
+					}
+				}
+				memcpy(&r.val, prev, sizeof(prev));
+			}
+			container.emplace_back(time, r);
+		}
+		return true;
+	}
+};
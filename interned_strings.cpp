@@ -0,0 +1,273 @@
+#include "interned_strings.h"
+#include "log.h"
+#include <stdlib.h>
+#include <algorithm>
+
+string_table &string_table::global()
+{
+	static string_table table;
+	return table;
+}
+
+string_table::string_table()
+	: m_num_references(0)
+{
+	for (shard &s : m_shards)
+	{
+		s.block_used = BLOCK_BYTES;
+		s.num_bytes = 0;
+		s.num_interns = 0;
+	}
+	m_entries.push_back({ "", 0 });		// EMPTY_ID
+}
+
+string_table::~string_table()
+{
+	for (shard &s : m_shards)
+	{
+		for (char *block : s.blocks)
+		{
+			free(block);
+		}
+	}
+}
+
+void string_table::acquire()
+{
+	std::lock_guard<std::mutex> lock(m_references_lock);
+	m_num_references++;
+}
+
+void string_table::release()
+{
+	std::lock_guard<std::mutex> lock(m_references_lock);
+	assert(m_num_references > 0);
+	if (--m_num_references == 0)
+	{
+		clear();
+	}
+}
+
+// m_references_lock is held.  the memory goes back too, not just the strings
+void string_table::clear()
+{
+	for (shard &s : m_shards)
+	{
+		tbb::spin_mutex::scoped_lock lock(s.lock);
+		for (char *block : s.blocks)
+		{
+			free(block);
+		}
+		std::vector<char *>().swap(s.blocks);
+		std::unordered_map<key, uint32_t, key_hash>().swap(s.ids);
+		s.block_used = BLOCK_BYTES;
+		s.num_bytes = 0;
+		s.num_interns = 0;
+	}
+	tbb::concurrent_vector<entry>().swap(m_entries);
+	m_entries.push_back({ "", 0 });		// EMPTY_ID
+}
+
+// fnv-1a
+uint64_t string_table::hash(const char *data, uint32_t size)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (uint32_t i = 0; i < size; i++)
+	{
+		h ^= uint8_t(data[i]);
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+// s->lock is held.  strings bigger than a block get their own
+const char *string_table::store(shard *s, const char *data, uint32_t size)
+{
+	char *dest;
+	if (size > BLOCK_BYTES / 4)
+	{
+		dest = static_cast<char *>(malloc(size));
+		if (!dest)
+		{
+			throw std::bad_alloc();
+		}
+		s->blocks.push_back(dest);
+	}
+	else
+	{
+		if (s->block_used + size > BLOCK_BYTES)
+		{
+			char *block = static_cast<char *>(malloc(BLOCK_BYTES));
+			if (!block)
+			{
+				throw std::bad_alloc();
+			}
+			s->blocks.push_back(block);
+			s->block_used = 0;
+		}
+		dest = s->blocks.back() + s->block_used;
+		s->block_used += size;
+	}
+	memcpy(dest, data, size);
+	s->num_bytes += size;
+	return dest;
+}
+
+uint32_t string_table::intern(const char *data, uint32_t size)
+{
+	if (size == 0)
+	{
+		return EMPTY_ID;
+	}
+	uint64_t h = hash(data, size);
+	shard &s = m_shards[(h >> 32) % NUM_SHARDS];
+	tbb::spin_mutex::scoped_lock lock(s.lock);
+	s.num_interns++;
+	auto iter = s.ids.find({ data, size });
+	if (iter != s.ids.end())
+	{
+		return iter->second;
+	}
+	const char *stored = store(&s, data, size);
+	uint32_t id = uint32_t(m_entries.push_back({ stored, size }) - m_entries.begin());
+	s.ids.insert({ { stored, size }, id });
+	return id;
+}
+
+uint64_t string_table::get_num_bytes() const
+{
+	uint64_t num_bytes = 0;
+	for (const shard &s : m_shards)
+	{
+		num_bytes += s.num_bytes;
+	}
+	return num_bytes;
+}
+
+uint64_t string_table::get_num_interns() const
+{
+	uint64_t num_interns = 0;
+	for (const shard &s : m_shards)
+	{
+		num_interns += s.num_interns;
+	}
+	return num_interns;
+}
+
+void string_section::merge(const string_section &rhs)
+{
+	m_ids.insert(rhs.m_ids.begin(), rhs.m_ids.end());
+}
+
+//	int num_strings, { uint32_t id, int size, char bytes[size] } * num_strings
+void string_section::encode(BaseStream &e) const
+{
+	std::vector<uint32_t> ids(m_ids.begin(), m_ids.end());
+	std::sort(ids.begin(), ids.end());
+	int num_strings = size_as_int(ids.size());
+	e.write_to_stream(&num_strings, sizeof(num_strings));
+	for (uint32_t id : ids)
+	{
+		const string_table::entry &s = string_table::global().get(id);
+		int size = int(s.size);
+		e.write_to_stream(&id, sizeof(id));
+		e.write_to_stream(&size, sizeof(size));
+		e.write_to_stream(s.data, s.size);
+	}
+}
+
+bool string_section::decode(BaseStream &e)
+{
+	int num_strings;
+	e.read_from_stream(&num_strings, sizeof(num_strings));
+	if (num_strings < 0)
+	{
+		return false;
+	}
+	std::vector<char> buf;
+	m_saved_ids.reserve(num_strings);
+	for (int i = 0; i < num_strings; i++)
+	{
+		uint32_t saved_id;
+		int size;
+		e.read_from_stream(&saved_id, sizeof(saved_id));
+		e.read_from_stream(&size, sizeof(size));
+		if (size < 0)
+		{
+			return false;
+		}
+		const char *src = e.read_in_place(size);
+		if (!src)
+		{
+			buf.resize(size);
+			e.read_from_stream(buf.data(), size);
+			src = buf.data();
+		}
+		m_saved_ids[saved_id] = string_table::global().intern(src, uint32_t(size));
+	}
+	return true;
+}
+
+uint32_t string_section::lookup(uint32_t saved_id) const
+{
+	if (saved_id == string_table::EMPTY_ID)
+	{
+		return string_table::EMPTY_ID;
+	}
+	auto iter = m_saved_ids.find(saved_id);
+	if (iter == m_saved_ids.end())
+	{
+		log_printf("string %u isn't in the strings section\n", saved_id);
+		return string_table::EMPTY_ID;
+	}
+	return iter->second;
+}
+
+void interned_string::encode(BaseStream &e) const
+{
+	if (e.strings)
+	{
+		if (m_id != string_table::EMPTY_ID)
+		{
+			e.strings->add(m_id);
+		}
+		e.write_to_stream(&m_id, sizeof(m_id));
+	}
+	else
+	{
+		const string_table::entry &s = string_table::global().get(m_id);
+		int size = int(s.size);
+		e.write_to_stream(&size, sizeof(size));
+		e.write_to_stream(s.data, s.size);
+	}
+}
+
+void interned_string::decode(BaseStream &e)
+{
+	if (e.strings)
+	{
+		uint32_t saved_id;
+		e.read_from_stream(&saved_id, sizeof(saved_id));
+		m_id = e.strings->lookup(saved_id);
+	}
+	else
+	{
+		int size;
+		e.read_from_stream(&size, sizeof(size));
+		assert(size >= 0);
+		const char *src = e.read_in_place(size);
+		if (src)
+		{
+			m_id = string_table::global().intern(src, uint32_t(size));
+		}
+		else
+		{
+			std::vector<char> buf(size);
+			if (size > 0)
+			{
+				e.read_from_stream(buf.data(), size);
+			}
+			m_id = string_table::global().intern(buf.data(), uint32_t(size));
+		}
+	}
+}
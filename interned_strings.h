@@ -0,0 +1,215 @@
+//
+// interned strings: the values of the string histories (String<> in vr_types.h)
+//
+//  * string_table holds each distinct string once and gives it a 32 bit id.  there's one table
+//    for the process, so the captures, and copies of them, share ids and an id compares equal
+//    exactly when the strings do.
+//  * the table is kept while anything holds a string_table::reference.  each capture does, so
+//    once the last capture goes the strings are freed and the ids start over.  an id must not
+//    be used after that
+//  * traversal tasks intern concurrently.  the table is split into shards by hash, each with
+//    it's own lock.  lookups by id don't lock, and what they return never moves or goes away.
+//  * interned_string is the 4 byte value a history stores.  it reads like a const vector of
+//    char (data(), size(), at(), ...) so cursors resolve it in place, without copying.
+//  * on a stream it's written inline (size then bytes, like any vector) unless the stream has a
+//    string_section (BaseStream::strings): then it's just the id, and the section writes each
+//    string it saw once.  a saved capture has a strings section (see capture_traverser.cpp).
+//    a section belongs to one stream at a time; tasks that encode in parallel each fill their
+//    own and merge them after
+//
+#pragma once
+#include "BaseStream.h"
+#include "result.h"
+#include "tbb/concurrent_vector.h"
+#include "tbb/spin_mutex.h"
+#include <stdint.h>
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct string_table
+{
+	static const uint32_t EMPTY_ID = 0;		// the empty string
+
+	struct entry
+	{
+		const char *data;
+		uint32_t size;
+	};
+
+	static string_table &global();
+
+	// keeps the global table's strings.  copies are references too
+	struct reference
+	{
+		reference() { global().acquire(); }
+		reference(const reference &) { global().acquire(); }
+		reference &operator=(const reference &) { return *this; }
+		~reference() { global().release(); }
+	};
+
+	string_table();
+	~string_table();
+	string_table(const string_table &) = delete;
+	string_table& operator=(const string_table &) = delete;
+
+	uint32_t intern(const char *data, uint32_t size);
+
+	const entry &get(uint32_t id) const
+	{
+		assert(id < m_entries.size());
+		return m_entries[id];
+	}
+
+	uint32_t get_num_strings() const { return uint32_t(m_entries.size()); }
+	uint64_t get_num_bytes() const;			// of the strings, as stored
+	uint64_t get_num_interns() const;		// calls to intern
+
+private:
+	static const int NUM_SHARDS = 64;
+	static const size_t BLOCK_BYTES = 64 * 1024;
+
+	struct key
+	{
+		const char *data;
+		uint32_t size;
+		bool operator==(const key &rhs) const
+		{
+			return size == rhs.size && memcmp(data, rhs.data, size) == 0;
+		}
+	};
+
+	struct key_hash
+	{
+		size_t operator()(const key &k) const { return size_t(hash(k.data, k.size)); }
+	};
+
+	struct shard
+	{
+		tbb::spin_mutex lock;
+		std::unordered_map<key, uint32_t, key_hash> ids;
+		std::vector<char *> blocks;			// the strings are copied into these
+		size_t block_used;
+		uint64_t num_bytes;
+		uint64_t num_interns;
+	};
+
+	static uint64_t hash(const char *data, uint32_t size);
+	const char *store(shard *s, const char *data, uint32_t size);
+	void acquire();
+	void release();
+	void clear();
+
+	shard m_shards[NUM_SHARDS];
+	tbb::concurrent_vector<entry> m_entries;	// by id
+	std::mutex m_references_lock;
+	int m_num_references;
+};
+
+// the strings a stream's interned strings refer to.  a writer collects the ids it writes and
+// then encodes the strings.  a reader decodes them first and then maps the ids it reads to the
+// ids in the table.  neither locks: concurrent writers each collect into their own section and
+// merge() them, and readers only look ids up once it's decoded
+struct string_section
+{
+	// writing
+	void add(uint32_t id) { m_ids.insert(id); }
+	void merge(const string_section &rhs);
+	void encode(BaseStream &e) const;
+
+	// reading
+	bool decode(BaseStream &e);
+	uint32_t lookup(uint32_t saved_id) const;
+
+	size_t size() const { return m_ids.size() + m_saved_ids.size(); }
+
+private:
+	std::unordered_set<uint32_t> m_ids;
+	std::unordered_map<uint32_t, uint32_t> m_saved_ids;		// saved id to id
+};
+
+struct interned_string
+{
+	typedef char value_type;
+	typedef size_t size_type;
+	typedef const char *const_iterator;
+
+	interned_string()
+		: m_id(string_table::EMPTY_ID)
+	{}
+
+	// any contiguous char container
+	template <typename Container>
+	explicit interned_string(const Container &c)
+		: m_id(string_table::global().intern(c.data(), uint32_t(c.size())))
+	{}
+
+	uint32_t get_id() const { return m_id; }
+
+	const char *data() const { return string_table::global().get(m_id).data; }
+	size_type size() const { return string_table::global().get(m_id).size; }
+	bool empty() const { return size() == 0; }
+	const char *begin() const { return data(); }
+	const char *end() const { return data() + size(); }
+	const char &operator[](size_type i) const { return data()[i]; }
+	const char &at(size_type i) const { assert(i < size()); return data()[i]; }
+	const char &back() const { return data()[size() - 1]; }
+
+	bool operator==(const interned_string &rhs) const { return m_id == rhs.m_id; }
+	bool operator!=(const interned_string &rhs) const { return m_id != rhs.m_id; }
+
+	bool equals(const char *s, size_type n) const
+	{
+		const string_table::entry &e = string_table::global().get(m_id);
+		return e.size == n && (n == 0 || memcmp(e.data, s, n) == 0);
+	}
+
+	void encode(BaseStream &e) const;
+	void decode(BaseStream &e);
+
+private:
+	uint32_t m_id;
+};
+
+//
+// hooks for Result<interned_string, ReturnCode> (see result.h)
+//
+inline void val_encode(const interned_string &s, BaseStream &stream)
+{
+	s.encode(stream);
+}
+
+inline void val_decode(interned_string &s, BaseStream &stream)
+{
+	s.decode(stream);
+}
+
+inline bool interned_equals(const interned_string &a, const interned_string &b)
+{
+	return a == b;
+}
+
+template <typename Container>
+inline bool interned_equals(const interned_string &a, const Container &b)
+{
+	return a.equals(b.data(), b.size());
+}
+
+// interns the source's value.  another interned string is just copied
+template <typename ReturnCode, typename ResultType2>
+void assign(Result<interned_string, ReturnCode> &a, const Result<ResultType2, ReturnCode> &b)
+{
+	assign_return_code(a, b);
+	a.val = interned_string(b.val);
+}
+
+// compares the latest value of a history with what was just queried without interning it
+template <typename ReturnCode, typename ResultType2>
+bool not_equals(const Result<interned_string, ReturnCode> &a, const Result<ResultType2, ReturnCode> &b)
+{
+	if (return_code_not_equals(a, b))
+		return true;
+	return a.is_present() && !interned_equals(a.val, b.val);
+}
@@ -1,12 +1,12 @@
 #!/bin/bash
 export HEADERS="-I../tbb/include -I../gsl-lite/include -I. -I../openvr_clean/openvr/headers -I../vrstrings/headers"
 
-export BASE_SOURCES="base_serialization.cpp crc_32.cpp log.cpp slab_allocator.cpp url_named.cpp"
-export BASE_TEST_SOURCES="unit_tests/test_base_main.cpp unit_tests/test_result.cpp unit_tests/test_segmented_list.cpp unit_tests/test_slab_allocator.cpp"
+export BASE_SOURCES="base_serialization.cpp cold_segments.cpp crc_32.cpp interned_strings.cpp log.cpp platform.cpp slab_allocator.cpp url_named.cpp"
+export BASE_TEST_SOURCES="unit_tests/test_base_main.cpp unit_tests/test_result.cpp unit_tests/test_segmented_list.cpp unit_tests/test_slab_allocator.cpp unit_tests/test_tmp_vector.cpp unit_tests/test_interned_strings.cpp unit_tests/test_url_named.cpp unit_tests/test_sparse_bitset.cpp"
 
-export TIME_CONTAINER_TEST_SOURCES="unit_tests/test_time_containers.cpp unit_tests/test_schema_common.cpp unit_tests/test_time_containers_main.cpp"
+export TIME_CONTAINER_TEST_SOURCES="unit_tests/test_time_containers.cpp unit_tests/test_schema_common.cpp unit_tests/test_history_codec.cpp unit_tests/test_columnar_list.cpp unit_tests/test_time_containers_main.cpp"
 
-export VR_BASE_SOURCES="vr_tmp_vector.cpp openvr_broker.cpp tracker_config.cpp"
+export VR_BASE_SOURCES="vr_tmp_vector.cpp openvr_broker.cpp"
 
 export VR_STRINGS_SOURCES="../vrstrings/src/openvr_string_gen_enums.cpp ../vrstrings/src/openvr_string_structs.cpp"
 
@@ -16,14 +16,18 @@ export INDEXER_SOURCES="vr_applications_indexer.cpp vr_applications_properties_i
 
 export TRACKER_TEST_SOURCES="unit_tests/test_gui_usecase.cpp unit_tests/test_tracker_main.cpp unit_tests/tracker_test_context.cpp"
 
-export TRAVERSE_SOURCES="vr_tracker_traverse.cpp"
+export TRAVERSE_SOURCES="capture_traverser.cpp capture_config.cpp poll_events.cpp resource_cache.cpp overlay_image_scheduler.cpp texture_service.cpp vr_texture_indexer.cpp openvr_sim.cpp"
 
-export TRAVERSE_TEST_SOURCES="unit_tests/UPDATE.cpp unit_tests/test_traverse_main.cpp unit_tests/tracker_test_context.cpp unit_tests/test_tracker_serialization.cpp"
+export TRAVERSE_TEST_SOURCES="unit_tests/UPDATE.cpp unit_tests/test_traverse_main.cpp unit_tests/capture_test_context.cpp unit_tests/test_capture_serialization.cpp unit_tests/test_openvr_sim.cpp unit_tests/test_poll_schedule.cpp unit_tests/test_resource_cache.cpp unit_tests/test_overlay_images.cpp unit_tests/test_cold_segments.cpp"
 
-export CURSOR_SOURCES="vr_applications_cursor.cpp vr_chaperone_cursor.cpp vr_chaperone_setup_cursor.cpp vr_compositor_cursor.cpp vr_cursor_context.cpp vr_cursor.cpp vr_extended_display_cursor.cpp vr_overlay_cursor.cpp vr_render_models_cursor.cpp vr_resources_cursor.cpp vr_settings_cursor.cpp vr_system_cursor.cpp vr_tracked_camera_cursor.cpp openvr_cppstub.cpp"
+export CURSOR_SOURCES="vr_applications_cursor.cpp vr_chaperone_cursor.cpp vr_chaperone_setup_cursor.cpp vr_compositor_cursor.cpp vr_cursor_context.cpp vr_extended_display_cursor.cpp vr_overlay_cursor.cpp vr_render_models_cursor.cpp vr_resources_cursor.cpp vr_settings_cursor.cpp vr_system_cursor.cpp vr_tracked_camera_cursor.cpp openvr_cppstub.cpp"
 
 export CURSOR_TEST_SOURCES="unit_tests/test_cursors.cpp unit_tests/test_cursors_main.cpp unit_tests/tracker_test_context.cpp"
 
+export BENCHMARK_SOURCES="unit_tests/benchmark_main.cpp unit_tests/capture_test_context.cpp"
+
+export LZ4_SOURCES="-I../lz4/lib ../lz4/lib/lz4.c ../lz4/lib/lz4hc.c"
+
 export TBB_LIB="-L../tbb/build/linux_intel64_gcc_cc5.4.1_libc2.23_kernel4.4.0_debug -ltbb_debug"
 
 export OPENVR_LIB="-L../openvr_clean/openvr/lib/linux64 -lopenvr_api"
@@ -35,29 +39,32 @@ export COMMON_FLAGS="-g -fpermissive -std=c++11 -DHAVE_OPEN_VR_RAW -DOPENVR_STRI
 export CXX="g++-6 -Wno-undefined-inline -Wno-address-of-temporary"
 #export CXX="g++ -Wno-undefined-inline -Wno-address-of-temporary"
 
-export TARGETS="test_cursors test_tracker test_traverse test_vr_keys test_time_containers test_base"
+export TARGETS="test_cursors test_tracker test_traverse test_vr_keys test_time_containers test_base benchmarks"
 
 rm $TARGETS
 
 set -x #echo on
 # cursors
-$CXX $COMMON_FLAGS -o test_cursors -DTEST_CURSORS_MAIN $HEADERS $BASE_SOURCES $VR_BASE_SOURCES $CURSOR_SOURCES $CURSOR_TEST_SOURCES $INDEXER_SOURCES $TRAVERSE_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
+$CXX $COMMON_FLAGS -o test_cursors -DTEST_CURSORS_MAIN $HEADERS $BASE_SOURCES $LZ4_SOURCES $VR_BASE_SOURCES $CURSOR_SOURCES $CURSOR_TEST_SOURCES $INDEXER_SOURCES $TRAVERSE_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
 
 
 # traverse
-$CXX $COMMON_FLAGS -o test_traverse -DTEST_TRAVERSE_MAIN $HEADERS $BASE_SOURCES $VR_BASE_SOURCES $TRAVERSE_SOURCES $TRAVERSE_TEST_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
+$CXX $COMMON_FLAGS -o test_traverse -DTEST_TRAVERSE_MAIN $HEADERS $BASE_SOURCES $LZ4_SOURCES $VR_BASE_SOURCES $TRAVERSE_SOURCES $TRAVERSE_TEST_SOURCES $CURSOR_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
 
 # tracker 
-$CXX $COMMON_FLAGS -o test_tracker -DTEST_VR_TRACKER_MAIN $HEADERS $BASE_SOURCES $VR_BASE_SOURCES $TRACKER_TEST_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
+$CXX $COMMON_FLAGS -o test_tracker -DTEST_VR_TRACKER_MAIN $HEADERS $BASE_SOURCES $LZ4_SOURCES $VR_BASE_SOURCES $TRACKER_TEST_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
 
 # test_vr_keys
-$CXX $COMMON_FLAGS -o test_vr_keys -DTEST_VR_KEYS_MAIN $HEADERS $BASE_SOURCES $VR_BASE_SOURCES $VR_KEYS_TEST_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
+$CXX $COMMON_FLAGS -o test_vr_keys -DTEST_VR_KEYS_MAIN $HEADERS $BASE_SOURCES $LZ4_SOURCES $VR_BASE_SOURCES $VR_KEYS_TEST_SOURCES $INDEXER_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
 
 
 # time_containers
-$CXX $COMMON_FLAGS -o test_time_containers -DTEST_TIME_CONTAINERS_MAIN $HEADERS $BASE_SOURCES $TIME_CONTAINER_TEST_SOURCES -lpthread $TBB_LIB 
+$CXX $COMMON_FLAGS -o test_time_containers -DTEST_TIME_CONTAINERS_MAIN $HEADERS $BASE_SOURCES $LZ4_SOURCES $TIME_CONTAINER_TEST_SOURCES -lpthread $TBB_LIB 
+
+# benchmarks (writes benchmark_results.json)
+$CXX $COMMON_FLAGS -O2 -o benchmarks -DBENCHMARK_MAIN $HEADERS $BASE_SOURCES $VR_BASE_SOURCES $TRAVERSE_SOURCES $BENCHMARK_SOURCES $CURSOR_SOURCES $INDEXER_SOURCES $LZ4_SOURCES -lpthread $TBB_LIB $OPENVR_LIB $VR_STRINGS_SOURCES
 
 # base
-$CXX -g -o test_base -DTEST_BASE_MAIN -std=c++11 $HEADERS $BASE_SOURCES $BASE_TEST_SOURCES -lpthread $TBB_LIB 
+$CXX -g -o test_base -DTEST_BASE_MAIN -std=c++11 $HEADERS $BASE_SOURCES $LZ4_SOURCES $BASE_TEST_SOURCES -lpthread $TBB_LIB 
 
 
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "openvr_string_std.h"
+#include "openvr_sim.h"
 
 static char s_error_message[1024];
 
@@ -14,6 +15,8 @@ static bool acquire_null_interfaces(openvr_broker::open_vr_interfaces *interface
 	char **error_message);
 static bool acquire_stub_interfaces(openvr_broker::open_vr_interfaces *interfaces,
 	char **error_message);
+static bool acquire_sim_interfaces(openvr_broker::open_vr_interfaces *interfaces,
+	char **error_message);
 
 bool openvr_broker::acquire_interfaces(const char *interface_type,
 	openvr_broker::open_vr_interfaces *interfaces, char **error_message)
@@ -32,6 +35,10 @@ bool openvr_broker::acquire_interfaces(const char *interface_type,
 	{
 		return acquire_stub_interfaces(interfaces, error_message);
 	}
+	if (strcmp(interface_type, "sim") == 0)
+	{
+		return acquire_sim_interfaces(interfaces, error_message);
+	}
 	else
 	{
 		snprintf(s_error_message, sizeof(s_error_message), "broker error unrecognized interface type %s", interface_type);
@@ -149,3 +156,11 @@ static bool acquire_stub_interfaces(openvr_broker::open_vr_interfaces *interface
 	interfaces->drivi = nullptr;
 	return true;
 }
+
+// simulated runtime.  openvr_sim::configure() before acquiring to change the seed, device counts etc
+static bool acquire_sim_interfaces(openvr_broker::open_vr_interfaces *interfaces,
+	char **error_message)
+{
+	openvr_sim::get_interfaces(interfaces);
+	return true;
+}
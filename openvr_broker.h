@@ -11,6 +11,8 @@
 //	{
 //		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "VR_Init Failed", error, NULL);
 //	}
+//
+// types: "raw" (the openvr runtime), "null", "stub" and "sim" (a simulated runtime, see openvr_sim.h)
 
 namespace openvr_broker
 {
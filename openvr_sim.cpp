@@ -0,0 +1,1783 @@
+#include "openvr_sim.h"
+#include "openvr_cppstub.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace openvr_sim;
+
+static const float SIM_PI = 3.14159265358979f;
+
+static sim_config s_config;
+static bool s_configured = false;
+static std::atomic<uint64_t> s_frame(0);
+
+// every call into the interfaces, so benchmarks and tests can see what an update costs
+static std::atomic<uint64_t> s_num_calls(0);
+#define SIM_CALL() s_num_calls.fetch_add(1, std::memory_order_relaxed)
+
+// the events of the current frame and how many have been polled
+static std::mutex s_event_mutex;
+static uint64_t s_event_frame = UINT64_MAX;
+static std::vector<vr::VREvent_t> s_events;
+static size_t s_next_event = 0;
+
+// overlay handles are hashes of their keys.  this maps them back for GetOverlayKey/GetOverlayName
+static std::mutex s_overlay_mutex;
+static std::unordered_map<vr::VROverlayHandle_t, std::string> s_overlay_keys;
+
+void sim_config::set_default()
+{
+	seed = 1;
+	frames_per_second = 90.0f;
+
+	num_controllers = 2;
+	num_trackers = 3;
+	num_base_stations = 2;
+
+	button_period_frames = 45;
+	property_churn_period_frames = 900;
+
+	num_applications = 8;
+	num_render_models = 4;
+	render_model_vertices = 512;
+	texture_width = 256;
+	texture_height = 256;
+
+	overlay_width = 128;
+	overlay_height = 128;
+	overlay_image_period_frames = 90;
+}
+
+//
+// everything below is derived from hashes of (seed, what's being asked for, frame)
+//
+static uint64_t mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+static uint64_t sim_hash(uint64_t a, uint64_t b = 0, uint64_t c = 0, uint64_t d = 0)
+{
+	uint64_t h = mix(s_config.seed);
+	h = mix(h ^ a);
+	h = mix(h ^ b);
+	h = mix(h ^ c);
+	return mix(h ^ d);
+}
+
+static uint64_t string_hash(const char *s)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (; s && *s; s++)
+	{
+		h = (h ^ uint8_t(*s)) * 1099511628211ULL;
+	}
+	return h;
+}
+
+// [0,1)
+static float unit_float(uint64_t h)
+{
+	return float(h >> 40) * (1.0f / float(1 << 24));
+}
+
+static uint64_t period_of(uint64_t frame, int period_frames)
+{
+	return period_frames > 0 ? frame / uint64_t(period_frames) : 0;
+}
+
+// openvr string convention: returns the size including the terminator, only copies if it fits
+static uint32_t return_string(const char *s, char *buf, uint32_t buf_size)
+{
+	uint32_t required = uint32_t(strlen(s) + 1);
+	if (buf && buf_size >= required)
+	{
+		memcpy(buf, s, required);
+	}
+	else if (buf && buf_size > 0)
+	{
+		buf[0] = 0;
+	}
+	return required;
+}
+
+static void set_identity(vr::HmdMatrix34_t *m)
+{
+	memset(m, 0, sizeof(*m));
+	m->m[0][0] = 1.0f;
+	m->m[1][1] = 1.0f;
+	m->m[2][2] = 1.0f;
+}
+
+static void set_translation(vr::HmdMatrix34_t *m, float x, float y, float z)
+{
+	set_identity(m);
+	m->m[0][3] = x;
+	m->m[1][3] = y;
+	m->m[2][3] = z;
+}
+
+//
+// devices: hmd at 0, then controllers, trackers and base stations
+//
+static uint32_t num_devices()
+{
+	return 1 + s_config.num_controllers + s_config.num_trackers + s_config.num_base_stations;
+}
+
+static vr::ETrackedDeviceClass device_class(vr::TrackedDeviceIndex_t i)
+{
+	if (i == vr::k_unTrackedDeviceIndex_Hmd)
+		return vr::TrackedDeviceClass_HMD;
+	uint32_t n = i - 1;
+	if (n < uint32_t(s_config.num_controllers))
+		return vr::TrackedDeviceClass_Controller;
+	n -= s_config.num_controllers;
+	if (n < uint32_t(s_config.num_trackers))
+		return vr::TrackedDeviceClass_GenericTracker;
+	n -= s_config.num_trackers;
+	if (n < uint32_t(s_config.num_base_stations))
+		return vr::TrackedDeviceClass_TrackingReference;
+	return vr::TrackedDeviceClass_Invalid;
+}
+
+static bool device_connected(vr::TrackedDeviceIndex_t i)
+{
+	return i < vr::k_unMaxTrackedDeviceCount && device_class(i) != vr::TrackedDeviceClass_Invalid;
+}
+
+// circles around the play area at per device speeds and phases.  base stations stay put
+static void make_pose(vr::TrackedDeviceIndex_t i, uint64_t frame, vr::TrackedDevicePose_t *pose)
+{
+	memset(pose, 0, sizeof(*pose));
+	if (!device_connected(i))
+	{
+		pose->eTrackingResult = vr::TrackingResult_Uninitialized;
+		return;
+	}
+
+	float radius, height, speed;
+	switch (device_class(i))
+	{
+	case vr::TrackedDeviceClass_HMD:		radius = 0.3f; height = 1.7f; speed = 0.4f; break;
+	case vr::TrackedDeviceClass_Controller:	radius = 0.5f; height = 1.1f; speed = 1.0f; break;
+	case vr::TrackedDeviceClass_GenericTracker:	radius = 1.0f; height = 0.9f; speed = 0.7f; break;
+	default:								radius = 2.5f; height = 2.2f; speed = 0.0f; break;
+	}
+	speed *= 0.5f + unit_float(sim_hash(1, i));
+	float phase = unit_float(sim_hash(2, i)) * 2.0f * SIM_PI;
+	float t = float(frame) / s_config.frames_per_second;
+	float a = phase + speed * t;
+	float c = cosf(a);
+	float s = sinf(a);
+
+	vr::HmdMatrix34_t &m = pose->mDeviceToAbsoluteTracking;
+	m.m[0][0] = c;		m.m[0][2] = s;		m.m[0][3] = radius * c;
+	m.m[1][1] = 1.0f;						m.m[1][3] = height + 0.05f * sinf(3.0f * a);
+	m.m[2][0] = -s;		m.m[2][2] = c;		m.m[2][3] = radius * s;
+
+	pose->vVelocity.v[0] = -radius * speed * s;
+	pose->vVelocity.v[1] = 0.15f * speed * cosf(3.0f * a);
+	pose->vVelocity.v[2] = radius * speed * c;
+	pose->vAngularVelocity.v[1] = -speed;
+
+	pose->eTrackingResult = vr::TrackingResult_Running_OK;
+	pose->bPoseIsValid = true;
+	pose->bDeviceIsConnected = true;
+}
+
+// buttons hold their state for button_period_frames.  the packet number only moves when they change
+static void make_controller_state(vr::TrackedDeviceIndex_t i, uint64_t frame, vr::VRControllerState_t *state)
+{
+	static const vr::EVRButtonId buttons[] =
+	{
+		vr::k_EButton_System,
+		vr::k_EButton_ApplicationMenu,
+		vr::k_EButton_Grip,
+		vr::k_EButton_SteamVR_Touchpad,
+		vr::k_EButton_SteamVR_Trigger,
+	};
+
+	memset(state, 0, sizeof(*state));
+	uint64_t period = period_of(frame, s_config.button_period_frames);
+	state->unPacketNum = uint32_t(period);
+	for (int b = 0; b < int(sizeof(buttons) / sizeof(buttons[0])); b++)
+	{
+		uint64_t h = sim_hash(3, i, b, period);
+		if (h % 4 == 0)
+		{
+			state->ulButtonPressed |= vr::ButtonMaskFromId(buttons[b]);
+		}
+		if (h % 2 == 0)
+		{
+			state->ulButtonTouched |= vr::ButtonMaskFromId(buttons[b]);
+		}
+	}
+	if (state->ulButtonTouched & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad))
+	{
+		state->rAxis[0].x = unit_float(sim_hash(4, i, 0, period)) * 2.0f - 1.0f;
+		state->rAxis[0].y = unit_float(sim_hash(4, i, 1, period)) * 2.0f - 1.0f;
+	}
+	if (state->ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger))
+	{
+		state->rAxis[1].x = 1.0f;
+	}
+}
+
+// a quarter of the properties aren't there, like on real devices
+static bool property_present(vr::TrackedDeviceIndex_t i, vr::ETrackedDeviceProperty prop)
+{
+	return sim_hash(5, i, prop) % 4 != 0;
+}
+
+static bool property_check(vr::TrackedDeviceIndex_t i, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError)
+{
+	vr::ETrackedPropertyError err = vr::TrackedProp_Success;
+	if (!device_connected(i))
+	{
+		err = vr::TrackedProp_InvalidDevice;
+	}
+	else if (!property_present(i, prop))
+	{
+		err = vr::TrackedProp_UnknownProperty;
+	}
+	if (pError)
+	{
+		*pError = err;
+	}
+	return err == vr::TrackedProp_Success;
+}
+
+static void set_property_error(vr::ETrackedPropertyError *pError, vr::ETrackedPropertyError err)
+{
+	if (pError)
+	{
+		*pError = err;
+	}
+}
+
+static bool has_battery(vr::TrackedDeviceIndex_t i)
+{
+	vr::ETrackedDeviceClass c = device_class(i);
+	return c == vr::TrackedDeviceClass_Controller || c == vr::TrackedDeviceClass_GenericTracker;
+}
+
+// scripted events: what a runtime would send for the changes the sim makes on this frame.
+// the churning properties (battery, charging) change when a churn period starts
+static void make_frame_events(uint64_t frame, std::vector<vr::VREvent_t> *events)
+{
+	events->clear();
+	int period = s_config.property_churn_period_frames;
+	if (frame == 0 || period <= 0 || frame % uint64_t(period) != 0)
+		return;
+	for (uint32_t i = 0; i < num_devices(); i++)
+	{
+		if (has_battery(i))
+		{
+			vr::VREvent_t e;
+			memset(&e, 0, sizeof(e));
+			e.eventType = vr::VREvent_PropertyChanged;
+			e.trackedDeviceIndex = i;
+			events->push_back(e);
+		}
+	}
+}
+
+// events are polled during the frame they happen on
+static bool poll_event(vr::VREvent_t *pEvent, uint32_t uncbVREvent)
+{
+	std::lock_guard<std::mutex> lock(s_event_mutex);
+	if (s_event_frame != s_frame)
+	{
+		s_event_frame = s_frame;
+		make_frame_events(s_event_frame, &s_events);
+		s_next_event = 0;
+	}
+	if (s_next_event == s_events.size())
+		return false;
+	if (pEvent)
+	{
+		memcpy(pEvent, &s_events[s_next_event], uncbVREvent < sizeof(vr::VREvent_t) ? uncbVREvent : sizeof(vr::VREvent_t));
+	}
+	s_next_event++;
+	return true;
+}
+
+static void render_model_name(int model_index, char *buf, size_t buf_size)
+{
+	snprintf(buf, buf_size, "sim_model_%d", model_index);
+}
+
+// -1 if it's not one of ours.  component models ("sim_model_2_trigger") load as their parent
+static int render_model_index(const char *name)
+{
+	int index;
+	if (name && sscanf(name, "sim_model_%d", &index) == 1 && index >= 0 && index < s_config.num_render_models)
+	{
+		return index;
+	}
+	return -1;
+}
+
+static void fill_image(uint8_t *rgba, uint32_t width, uint32_t height, uint64_t h)
+{
+	uint8_t r = uint8_t(h);
+	uint8_t g = uint8_t(h >> 8);
+	uint8_t b = uint8_t(h >> 16);
+	uint32_t checker = 4 + uint32_t((h >> 24) % 28);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			bool on = ((x / checker) + (y / checker)) & 1;
+			uint8_t *p = rgba + 4 * (y * width + x);
+			p[0] = on ? r : uint8_t(x);
+			p[1] = on ? g : uint8_t(y);
+			p[2] = on ? b : uint8_t(x ^ y);
+			p[3] = 255;
+		}
+	}
+}
+
+//
+// interfaces.  anything not overridden falls through to the cppstub defaults
+//
+class VRSystemSim : public VRSystemCppStub
+{
+public:
+	void GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) override
+	{
+		SIM_CALL();
+		*pnWidth = 1512;
+		*pnHeight = 1680;
+	}
+
+	vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) override
+	{
+		SIM_CALL();
+		float l, r, t, b;
+		GetProjectionRaw(eEye, &l, &r, &t, &b);
+		float idx = 1.0f / (r - l);
+		float idy = 1.0f / (b - t);
+		float idz = 1.0f / (fFarZ - fNearZ);
+
+		vr::HmdMatrix44_t m;
+		memset(&m, 0, sizeof(m));
+		m.m[0][0] = 2.0f * idx;	m.m[0][2] = (r + l) * idx;
+		m.m[1][1] = 2.0f * idy;	m.m[1][2] = (b + t) * idy;
+		m.m[2][2] = -fFarZ * idz;	m.m[2][3] = -fFarZ * fNearZ * idz;
+		m.m[3][2] = -1.0f;
+		return m;
+	}
+
+	void GetProjectionRaw(vr::EVREye eEye, float *pfLeft, float *pfRight, float *pfTop, float *pfBottom) override
+	{
+		SIM_CALL();
+		float inner = 1.24f;
+		float outer = 1.39f;
+		*pfLeft = (eEye == vr::Eye_Left) ? -outer : -inner;
+		*pfRight = (eEye == vr::Eye_Left) ? inner : outer;
+		*pfTop = -1.47f;
+		*pfBottom = 1.46f;
+	}
+
+	bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) override
+	{
+		SIM_CALL();
+		float k[3] = { 0.99f, 1.0f, 1.01f };
+		float *channels[3] = { pDistortionCoordinates->rfRed, pDistortionCoordinates->rfGreen, pDistortionCoordinates->rfBlue };
+		for (int c = 0; c < 3; c++)
+		{
+			channels[c][0] = 0.5f + (fU - 0.5f) * k[c];
+			channels[c][1] = 0.5f + (fV - 0.5f) * k[c];
+		}
+		return true;
+	}
+
+	vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye) override
+	{
+		SIM_CALL();
+		vr::HmdMatrix34_t m;
+		set_translation(&m, eEye == vr::Eye_Left ? -0.032f : 0.032f, 0.0f, 0.0f);
+		return m;
+	}
+
+	bool GetTimeSinceLastVsync(float *pfSecondsSinceLastVsync, uint64_t *pulFrameCounter) override
+	{
+		SIM_CALL();
+		*pfSecondsSinceLastVsync = 0.0f;
+		*pulFrameCounter = s_frame;
+		return true;
+	}
+
+	int32_t GetD3D9AdapterIndex() override
+	{
+		SIM_CALL();
+		return 0;
+	}
+
+	void GetDXGIOutputInfo(int32_t *pnAdapterIndex) override
+	{
+		SIM_CALL();
+		*pnAdapterIndex = 0;
+	}
+
+	void GetOutputDevice(uint64_t *pnDevice, vr::ETextureType textureType, VkInstance_T *pInstance) override
+	{
+		SIM_CALL();
+		*pnDevice = 0;
+	}
+
+	bool IsDisplayOnDesktop() override
+	{
+		SIM_CALL();
+		return false;
+	}
+
+	void GetDeviceToAbsoluteTrackingPose(vr::ETrackingUniverseOrigin eOrigin, float fPredictedSecondsToPhotonsFromNow, vr::TrackedDevicePose_t *pTrackedDevicePoseArray, uint32_t unTrackedDevicePoseArrayCount) override
+	{
+		SIM_CALL();
+		uint64_t frame = s_frame;
+		for (uint32_t i = 0; i < unTrackedDevicePoseArrayCount; i++)
+		{
+			make_pose(i, frame, &pTrackedDevicePoseArray[i]);
+		}
+	}
+
+	vr::HmdMatrix34_t GetSeatedZeroPoseToStandingAbsoluteTrackingPose() override
+	{
+		SIM_CALL();
+		vr::HmdMatrix34_t m;
+		set_translation(&m, 0.0f, 1.2f, 0.0f);
+		return m;
+	}
+
+	vr::HmdMatrix34_t GetRawZeroPoseToStandingAbsoluteTrackingPose() override
+	{
+		SIM_CALL();
+		vr::HmdMatrix34_t m;
+		set_identity(&m);
+		return m;
+	}
+
+	uint32_t GetSortedTrackedDeviceIndicesOfClass(vr::ETrackedDeviceClass eTrackedDeviceClass, vr::TrackedDeviceIndex_t *punTrackedDeviceIndexArray, uint32_t unTrackedDeviceIndexArrayCount, vr::TrackedDeviceIndex_t unRelativeToTrackedDeviceIndex) override
+	{
+		SIM_CALL();
+		uint32_t count = 0;
+		for (vr::TrackedDeviceIndex_t i = 0; i < num_devices(); i++)
+		{
+			if (device_class(i) == eTrackedDeviceClass)
+			{
+				if (punTrackedDeviceIndexArray && count < unTrackedDeviceIndexArrayCount)
+				{
+					punTrackedDeviceIndexArray[count] = i;
+				}
+				count++;
+			}
+		}
+		return count;
+	}
+
+	vr::EDeviceActivityLevel GetTrackedDeviceActivityLevel(vr::TrackedDeviceIndex_t unDeviceId) override
+	{
+		SIM_CALL();
+		return device_connected(unDeviceId) ? vr::k_EDeviceActivityLevel_UserInteraction : vr::k_EDeviceActivityLevel_Unknown;
+	}
+
+	vr::TrackedDeviceIndex_t GetTrackedDeviceIndexForControllerRole(vr::ETrackedControllerRole unDeviceType) override
+	{
+		SIM_CALL();
+		if (unDeviceType == vr::TrackedControllerRole_LeftHand && s_config.num_controllers > 0)
+			return 1;
+		if (unDeviceType == vr::TrackedControllerRole_RightHand && s_config.num_controllers > 1)
+			return 2;
+		return vr::k_unTrackedDeviceIndexInvalid;
+	}
+
+	vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) override
+	{
+		SIM_CALL();
+		if (unDeviceIndex == 1 && s_config.num_controllers > 0)
+			return vr::TrackedControllerRole_LeftHand;
+		if (unDeviceIndex == 2 && s_config.num_controllers > 1)
+			return vr::TrackedControllerRole_RightHand;
+		return vr::TrackedControllerRole_Invalid;
+	}
+
+	vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) override
+	{
+		SIM_CALL();
+		return device_connected(unDeviceIndex) ? device_class(unDeviceIndex) : vr::TrackedDeviceClass_Invalid;
+	}
+
+	bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) override
+	{
+		SIM_CALL();
+		return device_connected(unDeviceIndex);
+	}
+
+	bool GetBoolTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		if (prop == vr::Prop_DeviceIsCharging_Bool && has_battery(unDeviceIndex))
+		{
+			set_property_error(pError, vr::TrackedProp_Success);
+			return (period_of(s_frame, s_config.property_churn_period_frames) / 20) % 2 == 1;
+		}
+		if (!property_check(unDeviceIndex, prop, pError))
+			return false;
+		return (sim_hash(6, unDeviceIndex, prop) & 1) != 0;
+	}
+
+	// battery levels drain one percent every churn period
+	float GetFloatTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		if (prop == vr::Prop_DeviceBatteryPercentage_Float && has_battery(unDeviceIndex))
+		{
+			set_property_error(pError, vr::TrackedProp_Success);
+			uint64_t drained = period_of(s_frame, s_config.property_churn_period_frames) + sim_hash(7, unDeviceIndex) % 50;
+			return 1.0f - float(drained % 100) / 100.0f;
+		}
+		if (!property_check(unDeviceIndex, prop, pError))
+			return 0.0f;
+		return unit_float(sim_hash(6, unDeviceIndex, prop));
+	}
+
+	int32_t GetInt32TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		if (prop == vr::Prop_DeviceClass_Int32 && device_connected(unDeviceIndex))
+		{
+			set_property_error(pError, vr::TrackedProp_Success);
+			return int32_t(device_class(unDeviceIndex));
+		}
+		if (!property_check(unDeviceIndex, prop, pError))
+			return 0;
+		return int32_t(sim_hash(6, unDeviceIndex, prop) % 1000);
+	}
+
+	uint64_t GetUint64TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		if (!property_check(unDeviceIndex, prop, pError))
+			return 0;
+		return sim_hash(6, unDeviceIndex, prop);
+	}
+
+	vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		vr::HmdMatrix34_t m;
+		set_identity(&m);
+		if (property_check(unDeviceIndex, prop, pError))
+		{
+			uint64_t h = sim_hash(6, unDeviceIndex, prop);
+			set_translation(&m, unit_float(h), unit_float(mix(h)), unit_float(mix(h + 1)));
+		}
+		return m;
+	}
+
+	uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError) override
+	{
+		SIM_CALL();
+		char value[64];
+		if (prop == vr::Prop_RenderModelName_String && device_connected(unDeviceIndex) && s_config.num_render_models > 0)
+		{
+			render_model_name(int(unDeviceIndex % s_config.num_render_models), value, sizeof(value));
+		}
+		else if (prop == vr::Prop_SerialNumber_String && device_connected(unDeviceIndex))
+		{
+			snprintf(value, sizeof(value), "SIM-%u-%08x", unDeviceIndex, uint32_t(sim_hash(8, unDeviceIndex)));
+		}
+		else if (prop == vr::Prop_TrackingSystemName_String && device_connected(unDeviceIndex))
+		{
+			snprintf(value, sizeof(value), "sim");
+		}
+		else if (property_check(unDeviceIndex, prop, pError))
+		{
+			snprintf(value, sizeof(value), "sim_%d_%08x", int(prop), uint32_t(sim_hash(6, unDeviceIndex, prop)));
+		}
+		else
+		{
+			return 0;
+		}
+
+		uint32_t required = return_string(value, pchValue, unBufferSize);
+		set_property_error(pError, required > unBufferSize ? vr::TrackedProp_BufferTooSmall : vr::TrackedProp_Success);
+		return required;
+	}
+
+	bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) override
+	{
+		SIM_CALL();
+		if (!device_connected(unControllerDeviceIndex) || device_class(unControllerDeviceIndex) != vr::TrackedDeviceClass_Controller)
+			return false;
+		vr::VRControllerState_t state;
+		make_controller_state(unControllerDeviceIndex, s_frame, &state);
+		memcpy(pControllerState, &state, unControllerStateSize < sizeof(state) ? unControllerStateSize : sizeof(state));
+		return true;
+	}
+
+	bool GetControllerStateWithPose(vr::ETrackingUniverseOrigin eOrigin, vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize, vr::TrackedDevicePose_t *pTrackedDevicePose) override
+	{
+		SIM_CALL();
+		if (!GetControllerState(unControllerDeviceIndex, pControllerState, unControllerStateSize))
+			return false;
+		if (pTrackedDevicePose)
+		{
+			make_pose(unControllerDeviceIndex, s_frame, pTrackedDevicePose);
+		}
+		return true;
+	}
+
+	bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) override
+	{
+		SIM_CALL();
+		return poll_event(pEvent, uncbVREvent);
+	}
+
+	bool PollNextEventWithPose(vr::ETrackingUniverseOrigin eOrigin, vr::VREvent_t *pEvent, uint32_t uncbVREvent, vr::TrackedDevicePose_t *pTrackedDevicePose) override
+	{
+		SIM_CALL();
+		if (!poll_event(pEvent, uncbVREvent))
+			return false;
+		if (pTrackedDevicePose && pEvent)
+		{
+			make_pose(pEvent->trackedDeviceIndex, s_frame, pTrackedDevicePose);
+		}
+		return true;
+	}
+
+	bool IsInputAvailable() override
+	{
+		SIM_CALL();
+		return true;
+	}
+};
+
+class VRExtendedDisplaySim : public VRExtendedDisplayCppStub
+{
+public:
+	void GetWindowBounds(int32_t *pnX, int32_t *pnY, uint32_t *pnWidth, uint32_t *pnHeight) override
+	{
+		SIM_CALL();
+		*pnX = 0;
+		*pnY = 0;
+		*pnWidth = 2160;
+		*pnHeight = 1200;
+	}
+
+	void GetEyeOutputViewport(vr::EVREye eEye, uint32_t *pnX, uint32_t *pnY, uint32_t *pnWidth, uint32_t *pnHeight) override
+	{
+		SIM_CALL();
+		*pnX = (eEye == vr::Eye_Left) ? 0 : 1080;
+		*pnY = 0;
+		*pnWidth = 1080;
+		*pnHeight = 1200;
+	}
+
+	void GetDXGIOutputInfo(int32_t *pnAdapterIndex, int32_t *pnAdapterOutputIndex) override
+	{
+		SIM_CALL();
+		*pnAdapterIndex = 0;
+		*pnAdapterOutputIndex = 0;
+	}
+};
+
+class VRTrackedCameraSim : public VRTrackedCameraCppStub
+{
+public:
+	vr::EVRTrackedCameraError HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) override
+	{
+		SIM_CALL();
+		*pHasCamera = false;
+		return vr::VRTrackedCameraError_None;
+	}
+
+	vr::EVRTrackedCameraError GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) override
+	{
+		SIM_CALL();
+		return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+	}
+
+	vr::EVRTrackedCameraError GetCameraIntrinsics(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::HmdVector2_t *pFocalLength, vr::HmdVector2_t *pCenter) override
+	{
+		SIM_CALL();
+		return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+	}
+
+	vr::EVRTrackedCameraError GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) override
+	{
+		SIM_CALL();
+		return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+	}
+
+	vr::EVRTrackedCameraError GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) override
+	{
+		SIM_CALL();
+		return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+	}
+};
+
+// applications are "sim.app.<n>".  the first one is running
+class VRApplicationsSim : public VRApplicationsCppStub
+{
+public:
+	bool IsApplicationInstalled(const char *pchAppKey) override
+	{
+		SIM_CALL();
+		return app_index(pchAppKey) >= 0;
+	}
+
+	uint32_t GetApplicationCount() override
+	{
+		SIM_CALL();
+		return uint32_t(s_config.num_applications);
+	}
+
+	vr::EVRApplicationError GetApplicationKeyByIndex(uint32_t unApplicationIndex, char *pchAppKeyBuffer, uint32_t unAppKeyBufferLen) override
+	{
+		SIM_CALL();
+		if (unApplicationIndex >= uint32_t(s_config.num_applications))
+		{
+			return_string("", pchAppKeyBuffer, unAppKeyBufferLen);
+			return vr::VRApplicationError_InvalidIndex;
+		}
+		char key[64];
+		snprintf(key, sizeof(key), "sim.app.%u", unApplicationIndex);
+		if (return_string(key, pchAppKeyBuffer, unAppKeyBufferLen) > unAppKeyBufferLen)
+			return vr::VRApplicationError_BufferTooSmall;
+		return vr::VRApplicationError_None;
+	}
+
+	uint32_t GetApplicationProcessId(const char *pchAppKey) override
+	{
+		SIM_CALL();
+		return app_index(pchAppKey) == 0 ? 1000 : 0;
+	}
+
+	uint32_t GetApplicationPropertyString(const char *pchAppKey, vr::EVRApplicationProperty eProperty, char *pchPropertyValueBuffer, uint32_t unPropertyValueBufferLen, vr::EVRApplicationError *peError) override
+	{
+		SIM_CALL();
+		if (app_index(pchAppKey) < 0)
+		{
+			set_error(peError, vr::VRApplicationError_UnknownApplication);
+			return 0;
+		}
+		char value[128];
+		snprintf(value, sizeof(value), "%s/%d", pchAppKey, int(eProperty));
+		uint32_t required = return_string(value, pchPropertyValueBuffer, unPropertyValueBufferLen);
+		set_error(peError, required > unPropertyValueBufferLen ? vr::VRApplicationError_BufferTooSmall : vr::VRApplicationError_None);
+		return required;
+	}
+
+	bool GetApplicationPropertyBool(const char *pchAppKey, vr::EVRApplicationProperty eProperty, vr::EVRApplicationError *peError) override
+	{
+		SIM_CALL();
+		if (app_index(pchAppKey) < 0)
+		{
+			set_error(peError, vr::VRApplicationError_UnknownApplication);
+			return false;
+		}
+		set_error(peError, vr::VRApplicationError_None);
+		return (sim_hash(9, string_hash(pchAppKey), eProperty) & 1) != 0;
+	}
+
+	uint64_t GetApplicationPropertyUint64(const char *pchAppKey, vr::EVRApplicationProperty eProperty, vr::EVRApplicationError *peError) override
+	{
+		SIM_CALL();
+		if (app_index(pchAppKey) < 0)
+		{
+			set_error(peError, vr::VRApplicationError_UnknownApplication);
+			return 0;
+		}
+		set_error(peError, vr::VRApplicationError_None);
+		return sim_hash(9, string_hash(pchAppKey), eProperty);
+	}
+
+	bool GetApplicationAutoLaunch(const char *pchAppKey) override
+	{
+		SIM_CALL();
+		return false;
+	}
+
+	bool GetDefaultApplicationForMimeType(const char *pchMimeType, char *pchAppKeyBuffer, uint32_t unAppKeyBufferLen) override
+	{
+		SIM_CALL();
+		return_string("", pchAppKeyBuffer, unAppKeyBufferLen);
+		return false;
+	}
+
+	bool GetApplicationSupportedMimeTypes(const char *pchAppKey, char *pchMimeTypesBuffer, uint32_t unMimeTypesBuffer) override
+	{
+		SIM_CALL();
+		return_string("", pchMimeTypesBuffer, unMimeTypesBuffer);
+		return false;
+	}
+
+	uint32_t GetApplicationsThatSupportMimeType(const char *pchMimeType, char *pchAppKeysThatSupportBuffer, uint32_t unAppKeysThatSupportBuffer) override
+	{
+		SIM_CALL();
+		return return_string("", pchAppKeysThatSupportBuffer, unAppKeysThatSupportBuffer);
+	}
+
+	uint32_t GetApplicationLaunchArguments(uint32_t unHandle, char *pchArgs, uint32_t unArgs) override
+	{
+		SIM_CALL();
+		return return_string("", pchArgs, unArgs);
+	}
+
+	vr::EVRApplicationError GetStartingApplication(char *pchAppKeyBuffer, uint32_t unAppKeyBufferLen) override
+	{
+		SIM_CALL();
+		return_string("", pchAppKeyBuffer, unAppKeyBufferLen);
+		return vr::VRApplicationError_NoApplication;
+	}
+
+	uint32_t GetCurrentSceneProcessId() override
+	{
+		SIM_CALL();
+		return s_config.num_applications > 0 ? 1000 : 0;
+	}
+
+private:
+	static int app_index(const char *key)
+	{
+		int index;
+		if (key && sscanf(key, "sim.app.%d", &index) == 1 && index >= 0 && index < s_config.num_applications)
+		{
+			return index;
+		}
+		return -1;
+	}
+
+	static void set_error(vr::EVRApplicationError *peError, vr::EVRApplicationError err)
+	{
+		if (peError)
+		{
+			*peError = err;
+		}
+	}
+};
+
+static void play_area_rect(vr::HmdQuad_t *rect)
+{
+	float x = 1.5f;
+	float z = 1.25f;
+	float corners[4][2] = { { -x, z }, { x, z }, { x, -z }, { -x, -z } };
+	for (int i = 0; i < 4; i++)
+	{
+		rect->vCorners[i].v[0] = corners[i][0];
+		rect->vCorners[i].v[1] = 0.0f;
+		rect->vCorners[i].v[2] = corners[i][1];
+	}
+}
+
+// four 2.4m walls around the play area
+static bool collision_bounds(vr::HmdQuad_t *pQuadsBuffer, uint32_t *punQuadsCount)
+{
+	uint32_t capacity = *punQuadsCount;
+	*punQuadsCount = 4;
+	if (!pQuadsBuffer || capacity < 4)
+		return false;
+	vr::HmdQuad_t floor;
+	play_area_rect(&floor);
+	for (int i = 0; i < 4; i++)
+	{
+		const vr::HmdVector3_t &a = floor.vCorners[i];
+		const vr::HmdVector3_t &b = floor.vCorners[(i + 1) % 4];
+		vr::HmdQuad_t &wall = pQuadsBuffer[i];
+		wall.vCorners[0] = a;
+		wall.vCorners[1] = a;
+		wall.vCorners[1].v[1] = 2.4f;
+		wall.vCorners[2] = b;
+		wall.vCorners[2].v[1] = 2.4f;
+		wall.vCorners[3] = b;
+	}
+	return true;
+}
+
+class VRChaperoneSim : public VRChaperoneCppStub
+{
+public:
+	vr::ChaperoneCalibrationState GetCalibrationState() override
+	{
+		SIM_CALL();
+		return vr::ChaperoneCalibrationState_OK;
+	}
+
+	bool GetPlayAreaSize(float *pSizeX, float *pSizeZ) override
+	{
+		SIM_CALL();
+		*pSizeX = 3.0f;
+		*pSizeZ = 2.5f;
+		return true;
+	}
+
+	bool GetPlayAreaRect(vr::HmdQuad_t *rect) override
+	{
+		SIM_CALL();
+		play_area_rect(rect);
+		return true;
+	}
+
+	void GetBoundsColor(vr::HmdColor_t *pOutputColorArray, int nNumOutputColors, float flCollisionBoundsFadeDistance, vr::HmdColor_t *pOutputCameraColor) override
+	{
+		SIM_CALL();
+		for (int i = 0; i < nNumOutputColors; i++)
+		{
+			float f = float(i) / float(nNumOutputColors);
+			pOutputColorArray[i].r = 0.0f;
+			pOutputColorArray[i].g = 1.0f - f;
+			pOutputColorArray[i].b = 1.0f;
+			pOutputColorArray[i].a = 1.0f - f;
+		}
+		if (pOutputCameraColor)
+		{
+			pOutputCameraColor->r = 1.0f;
+			pOutputCameraColor->g = 1.0f;
+			pOutputCameraColor->b = 1.0f;
+			pOutputCameraColor->a = 0.0f;
+		}
+	}
+
+	bool AreBoundsVisible() override
+	{
+		SIM_CALL();
+		return false;
+	}
+};
+
+class VRChaperoneSetupSim : public VRChaperoneSetupCppStub
+{
+public:
+	bool GetWorkingPlayAreaSize(float *pSizeX, float *pSizeZ) override
+	{
+		SIM_CALL();
+		*pSizeX = 3.0f;
+		*pSizeZ = 2.5f;
+		return true;
+	}
+
+	bool GetWorkingPlayAreaRect(vr::HmdQuad_t *rect) override
+	{
+		SIM_CALL();
+		play_area_rect(rect);
+		return true;
+	}
+
+	bool GetWorkingCollisionBoundsInfo(vr::HmdQuad_t *pQuadsBuffer, uint32_t *punQuadsCount) override
+	{
+		SIM_CALL();
+		return collision_bounds(pQuadsBuffer, punQuadsCount);
+	}
+
+	bool GetLiveCollisionBoundsInfo(vr::HmdQuad_t *pQuadsBuffer, uint32_t *punQuadsCount) override
+	{
+		SIM_CALL();
+		return collision_bounds(pQuadsBuffer, punQuadsCount);
+	}
+
+	bool GetLivePhysicalBoundsInfo(vr::HmdQuad_t *pQuadsBuffer, uint32_t *punQuadsCount) override
+	{
+		SIM_CALL();
+		return collision_bounds(pQuadsBuffer, punQuadsCount);
+	}
+
+	bool GetLiveCollisionBoundsTagsInfo(uint8_t *pTagsBuffer, uint32_t *punTagCount) override
+	{
+		SIM_CALL();
+		uint32_t capacity = *punTagCount;
+		*punTagCount = 4;
+		if (!pTagsBuffer || capacity < 4)
+			return false;
+		memset(pTagsBuffer, 0, 4);
+		return true;
+	}
+
+	bool GetWorkingSeatedZeroPoseToRawTrackingPose(vr::HmdMatrix34_t *pmatSeatedZeroPoseToRawTrackingPose) override
+	{
+		SIM_CALL();
+		set_translation(pmatSeatedZeroPoseToRawTrackingPose, 0.0f, 1.2f, 0.0f);
+		return true;
+	}
+
+	bool GetWorkingStandingZeroPoseToRawTrackingPose(vr::HmdMatrix34_t *pmatStandingZeroPoseToRawTrackingPose) override
+	{
+		SIM_CALL();
+		set_identity(pmatStandingZeroPoseToRawTrackingPose);
+		return true;
+	}
+
+	bool GetLiveSeatedZeroPoseToRawTrackingPose(vr::HmdMatrix34_t *pmatSeatedZeroPoseToRawTrackingPose) override
+	{
+		SIM_CALL();
+		set_translation(pmatSeatedZeroPoseToRawTrackingPose, 0.0f, 1.2f, 0.0f);
+		return true;
+	}
+};
+
+class VRCompositorSim : public VRCompositorCppStub
+{
+public:
+	vr::ETrackingUniverseOrigin GetTrackingSpace() override
+	{
+		SIM_CALL();
+		return vr::TrackingUniverseStanding;
+	}
+
+	vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override
+	{
+		SIM_CALL();
+		return GetLastPoses(pRenderPoseArray, unRenderPoseArrayCount, pGamePoseArray, unGamePoseArrayCount);
+	}
+
+	vr::EVRCompositorError GetLastPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override
+	{
+		SIM_CALL();
+		uint64_t frame = s_frame;
+		for (uint32_t i = 0; pRenderPoseArray && i < unRenderPoseArrayCount; i++)
+		{
+			make_pose(i, frame, &pRenderPoseArray[i]);
+		}
+		for (uint32_t i = 0; pGamePoseArray && i < unGamePoseArrayCount; i++)
+		{
+			make_pose(i, frame, &pGamePoseArray[i]);
+		}
+		return vr::VRCompositorError_None;
+	}
+
+	vr::EVRCompositorError GetLastPoseForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex, vr::TrackedDevicePose_t *pOutputPose, vr::TrackedDevicePose_t *pOutputGamePose) override
+	{
+		SIM_CALL();
+		if (unDeviceIndex >= vr::k_unMaxTrackedDeviceCount)
+			return vr::VRCompositorError_IndexOutOfRange;
+		uint64_t frame = s_frame;
+		if (pOutputPose)
+		{
+			make_pose(unDeviceIndex, frame, pOutputPose);
+		}
+		if (pOutputGamePose)
+		{
+			make_pose(unDeviceIndex, frame, pOutputGamePose);
+		}
+		return vr::VRCompositorError_None;
+	}
+
+	bool GetFrameTiming(vr::Compositor_FrameTiming *pTiming, uint32_t unFramesAgo) override
+	{
+		SIM_CALL();
+		uint64_t frame = s_frame;
+		if (unFramesAgo > frame)
+			return false;
+		make_frame_timing(frame - unFramesAgo, pTiming);
+		return true;
+	}
+
+	// oldest first
+	uint32_t GetFrameTimings(vr::Compositor_FrameTiming *pTiming, uint32_t nFrames) override
+	{
+		SIM_CALL();
+		uint64_t frame = s_frame;
+		uint32_t count = uint32_t(nFrames < frame + 1 ? nFrames : frame + 1);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			make_frame_timing(frame + 1 - count + i, &pTiming[i]);
+		}
+		return count;
+	}
+
+	float GetFrameTimeRemaining() override
+	{
+		SIM_CALL();
+		return (0.3f + 0.4f * unit_float(sim_hash(10, s_frame))) / s_config.frames_per_second;
+	}
+
+	void GetCumulativeStats(vr::Compositor_CumulativeStats *pStats, uint32_t nStatsSizeInBytes) override
+	{
+		SIM_CALL();
+		vr::Compositor_CumulativeStats stats;
+		memset(&stats, 0, sizeof(stats));
+		uint64_t frame = s_frame;
+		stats.m_nPid = 1000;
+		stats.m_nNumFramePresents = uint32_t(frame);
+		stats.m_nNumDroppedFrames = uint32_t(frame / 1000);
+		memcpy(pStats, &stats, nStatsSizeInBytes < sizeof(stats) ? nStatsSizeInBytes : sizeof(stats));
+	}
+
+	vr::HmdColor_t GetCurrentFadeColor(bool bBackground) override
+	{
+		SIM_CALL();
+		vr::HmdColor_t c = { 0.0f, 0.0f, 0.0f, 0.0f };
+		return c;
+	}
+
+	float GetCurrentGridAlpha() override
+	{
+		SIM_CALL();
+		return 0.0f;
+	}
+
+	bool IsFullscreen() override
+	{
+		SIM_CALL();
+		return true;
+	}
+
+	uint32_t GetCurrentSceneFocusProcess() override
+	{
+		SIM_CALL();
+		return 1000;
+	}
+
+	uint32_t GetLastFrameRenderer() override
+	{
+		SIM_CALL();
+		return 1000;
+	}
+
+	bool CanRenderScene() override
+	{
+		SIM_CALL();
+		return true;
+	}
+
+	uint32_t GetVulkanInstanceExtensionsRequired(char *pchValue, uint32_t unBufferSize) override
+	{
+		SIM_CALL();
+		return return_string("", pchValue, unBufferSize);
+	}
+
+private:
+	static void make_frame_timing(uint64_t frame, vr::Compositor_FrameTiming *timing)
+	{
+		memset(timing, 0, sizeof(*timing));
+		timing->m_nSize = sizeof(*timing);
+		timing->m_nFrameIndex = uint32_t(frame);
+		timing->m_nNumFramePresents = 1;
+		timing->m_flSystemTimeInSeconds = double(frame) / s_config.frames_per_second;
+		timing->m_flTotalRenderGpuMs = 4.0f + 3.0f * unit_float(sim_hash(11, frame));
+		timing->m_flCompositorRenderGpuMs = 1.0f + unit_float(sim_hash(12, frame));
+		make_pose(vr::k_unTrackedDeviceIndex_Hmd, frame, &timing->m_HmdPose);
+	}
+};
+
+// every key is an overlay.  images change every overlay_image_period_frames.  every getter the
+// traversal reads is here: the stubs leave their outputs unwritten
+class VROverlaySim : public VROverlayCppStub
+{
+public:
+	vr::EVROverlayError FindOverlay(const char *pchOverlayKey, vr::VROverlayHandle_t *pOverlayHandle) override
+	{
+		SIM_CALL();
+		vr::VROverlayHandle_t handle = string_hash(pchOverlayKey) | 1;
+		{
+			std::lock_guard<std::mutex> lock(s_overlay_mutex);
+			s_overlay_keys[handle] = pchOverlayKey;
+		}
+		*pOverlayHandle = handle;
+		return vr::VROverlayError_None;
+	}
+
+	uint32_t GetOverlayKey(vr::VROverlayHandle_t ulOverlayHandle, char *pchValue, uint32_t unBufferSize, vr::EVROverlayError *pError) override
+	{
+		SIM_CALL();
+		return return_overlay_string(ulOverlayHandle, "", pchValue, unBufferSize, pError);
+	}
+
+	uint32_t GetOverlayName(vr::VROverlayHandle_t ulOverlayHandle, char *pchValue, uint32_t unBufferSize, vr::EVROverlayError *pError) override
+	{
+		SIM_CALL();
+		return return_overlay_string(ulOverlayHandle, " (sim)", pchValue, unBufferSize, pError);
+	}
+
+	vr::EVROverlayError GetOverlayImageData(vr::VROverlayHandle_t ulOverlayHandle, void *pvBuffer, uint32_t unBufferSize, uint32_t *punWidth, uint32_t *punHeight) override
+	{
+		SIM_CALL();
+		uint32_t width = uint32_t(s_config.overlay_width);
+		uint32_t height = uint32_t(s_config.overlay_height);
+		*punWidth = width;
+		*punHeight = height;
+		if (!pvBuffer || unBufferSize < width * height * 4)
+			return vr::VROverlayError_ArrayTooSmall;
+		fill_image((uint8_t *)pvBuffer, width, height, sim_hash(13, ulOverlayHandle, period_of(s_frame, s_config.overlay_image_period_frames)));
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTextureSize(vr::VROverlayHandle_t ulOverlayHandle, uint32_t *pWidth, uint32_t *pHeight) override
+	{
+		SIM_CALL();
+		*pWidth = uint32_t(s_config.overlay_width);
+		*pHeight = uint32_t(s_config.overlay_height);
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayColor(vr::VROverlayHandle_t ulOverlayHandle, float *pfRed, float *pfGreen, float *pfBlue) override
+	{
+		SIM_CALL();
+		uint64_t h = sim_hash(14, ulOverlayHandle);
+		*pfRed = unit_float(h);
+		*pfGreen = unit_float(mix(h));
+		*pfBlue = unit_float(mix(h + 1));
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayAlpha(vr::VROverlayHandle_t ulOverlayHandle, float *pfAlpha) override
+	{
+		SIM_CALL();
+		*pfAlpha = 1.0f;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTexelAspect(vr::VROverlayHandle_t ulOverlayHandle, float *pfTexelAspect) override
+	{
+		SIM_CALL();
+		*pfTexelAspect = 1.0f;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlaySortOrder(vr::VROverlayHandle_t ulOverlayHandle, uint32_t *punSortOrder) override
+	{
+		SIM_CALL();
+		*punSortOrder = uint32_t(sim_hash(15, ulOverlayHandle) % 8);
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayWidthInMeters(vr::VROverlayHandle_t ulOverlayHandle, float *pfWidthInMeters) override
+	{
+		SIM_CALL();
+		*pfWidthInMeters = 1.5f;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayAutoCurveDistanceRangeInMeters(vr::VROverlayHandle_t ulOverlayHandle, float *pfMinDistanceInMeters, float *pfMaxDistanceInMeters) override
+	{
+		SIM_CALL();
+		*pfMinDistanceInMeters = 1.0f;
+		*pfMaxDistanceInMeters = 2.0f;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTransformType(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayTransformType *peTransformType) override
+	{
+		SIM_CALL();
+		*peTransformType = vr::VROverlayTransform_Absolute;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTransformAbsolute(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin *peTrackingOrigin, vr::HmdMatrix34_t *pmatTrackingOriginToOverlayTransform) override
+	{
+		SIM_CALL();
+		uint64_t h = sim_hash(16, ulOverlayHandle);
+		*peTrackingOrigin = vr::TrackingUniverseStanding;
+		set_translation(pmatTrackingOriginToOverlayTransform, unit_float(h) * 2.0f - 1.0f, 1.0f + unit_float(mix(h)), -1.0f - unit_float(mix(h + 1)));
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayFlags(vr::VROverlayHandle_t ulOverlayHandle, uint32_t *pFlags) override
+	{
+		SIM_CALL();
+		*pFlags = uint32_t(sim_hash(18, ulOverlayHandle) & 0xff);
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTextureColorSpace(vr::VROverlayHandle_t ulOverlayHandle, vr::EColorSpace *peTextureColorSpace) override
+	{
+		SIM_CALL();
+		*peTextureColorSpace = vr::ColorSpace_Auto;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayTextureBounds(vr::VROverlayHandle_t ulOverlayHandle, vr::VRTextureBounds_t *pOverlayTextureBounds) override
+	{
+		SIM_CALL();
+		pOverlayTextureBounds->uMin = 0.0f;
+		pOverlayTextureBounds->vMin = 0.0f;
+		pOverlayTextureBounds->uMax = 1.0f;
+		pOverlayTextureBounds->vMax = 1.0f;
+		return vr::VROverlayError_None;
+	}
+
+	// every overlay is absolute, so the relative transform is just cleared
+	vr::EVROverlayError GetOverlayTransformTrackedDeviceRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t *punTrackedDevice, vr::HmdMatrix34_t *pmatTrackedDeviceToOverlayTransform) override
+	{
+		SIM_CALL();
+		*punTrackedDevice = vr::k_unTrackedDeviceIndexInvalid;
+		memset(pmatTrackedDeviceToOverlayTransform, 0, sizeof(*pmatTrackedDeviceToOverlayTransform));
+		return vr::VROverlayError_WrongTransformType;
+	}
+
+	vr::EVROverlayError GetOverlayTransformTrackedDeviceComponent(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t *punDeviceIndex, char *pchComponentName, uint32_t unComponentNameSize) override
+	{
+		SIM_CALL();
+		*punDeviceIndex = vr::k_unTrackedDeviceIndexInvalid;
+		return_string("", pchComponentName, unComponentNameSize);
+		return vr::VROverlayError_WrongTransformType;
+	}
+
+	vr::EVROverlayError GetOverlayInputMethod(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayInputMethod *peInputMethod) override
+	{
+		SIM_CALL();
+		*peInputMethod = vr::VROverlayInputMethod_None;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetOverlayMouseScale(vr::VROverlayHandle_t ulOverlayHandle, vr::HmdVector2_t *pvecMouseScale) override
+	{
+		SIM_CALL();
+		pvecMouseScale->v[0] = 1.0f;
+		pvecMouseScale->v[1] = 1.0f;
+		return vr::VROverlayError_None;
+	}
+
+	vr::EVROverlayError GetDashboardOverlaySceneProcess(vr::VROverlayHandle_t ulOverlayHandle, uint32_t *punProcessId) override
+	{
+		SIM_CALL();
+		*punProcessId = 0;
+		return vr::VROverlayError_None;
+	}
+
+	bool IsOverlayVisible(vr::VROverlayHandle_t ulOverlayHandle) override
+	{
+		SIM_CALL();
+		return (sim_hash(17, ulOverlayHandle, period_of(s_frame, s_config.overlay_image_period_frames)) & 1) != 0;
+	}
+
+private:
+	static uint32_t return_overlay_string(vr::VROverlayHandle_t handle, const char *suffix, char *pchValue, uint32_t unBufferSize, vr::EVROverlayError *pError)
+	{
+		// formatted straight into the caller's buffer: a steady state update shouldn't see the
+		// sim allocate
+		std::lock_guard<std::mutex> lock(s_overlay_mutex);
+		auto iter = s_overlay_keys.find(handle);
+		if (iter == s_overlay_keys.end())
+		{
+			if (pError)
+			{
+				*pError = vr::VROverlayError_InvalidHandle;
+			}
+			return_string("", pchValue, unBufferSize);
+			return 0;
+		}
+		uint32_t required = uint32_t(iter->second.size() + strlen(suffix) + 1);
+		if (pchValue && unBufferSize >= required)
+		{
+			snprintf(pchValue, unBufferSize, "%s%s", iter->second.c_str(), suffix);
+		}
+		else if (pchValue && unBufferSize > 0)
+		{
+			pchValue[0] = 0;
+		}
+		if (pError)
+		{
+			*pError = required > unBufferSize ? vr::VROverlayError_ArrayTooSmall : vr::VROverlayError_None;
+		}
+		return required;
+	}
+};
+
+// "sim_model_<n>", each a cylinder with render_model_vertices vertices and texture <n>
+class VRRenderModelsSim : public VRRenderModelsCppStub
+{
+public:
+	vr::EVRRenderModelError LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) override
+	{
+		SIM_CALL();
+		int index = render_model_index(pchRenderModelName);
+		if (index < 0)
+		{
+			*ppRenderModel = nullptr;
+			return vr::VRRenderModelError_InvalidModel;
+		}
+
+		uint64_t h = sim_hash(18, string_hash(pchRenderModelName));
+		uint32_t columns = uint32_t(s_config.render_model_vertices / 2);
+		if (columns < 3)
+			columns = 3;
+		float radius = 0.02f + 0.03f * unit_float(h);
+		float length = 0.1f + 0.1f * unit_float(mix(h));
+
+		vr::RenderModel_Vertex_t *vertices = new vr::RenderModel_Vertex_t[columns * 2];
+		uint16_t *indexes = new uint16_t[columns * 6];
+		for (uint32_t c = 0; c < columns; c++)
+		{
+			float a = 2.0f * SIM_PI * float(c) / float(columns);
+			for (uint32_t end = 0; end < 2; end++)
+			{
+				vr::RenderModel_Vertex_t &v = vertices[c * 2 + end];
+				v.vPosition.v[0] = radius * cosf(a);
+				v.vPosition.v[1] = radius * sinf(a);
+				v.vPosition.v[2] = end ? -length : 0.0f;
+				v.vNormal.v[0] = cosf(a);
+				v.vNormal.v[1] = sinf(a);
+				v.vNormal.v[2] = 0.0f;
+				v.rfTextureCoord[0] = float(c) / float(columns);
+				v.rfTextureCoord[1] = float(end);
+			}
+			uint16_t a0 = uint16_t(c * 2);
+			uint16_t a1 = uint16_t(c * 2 + 1);
+			uint16_t b0 = uint16_t(((c + 1) % columns) * 2);
+			uint16_t b1 = uint16_t(((c + 1) % columns) * 2 + 1);
+			uint16_t quad[6] = { a0, b0, a1, a1, b0, b1 };
+			memcpy(&indexes[c * 6], quad, sizeof(quad));
+		}
+
+		vr::RenderModel_t *model = new vr::RenderModel_t;
+		model->rVertexData = vertices;
+		model->unVertexCount = columns * 2;
+		model->rIndexData = indexes;
+		model->unTriangleCount = columns * 2;
+		model->diffuseTextureId = vr::TextureID_t(index);
+		*ppRenderModel = model;
+		return vr::VRRenderModelError_None;
+	}
+
+	void FreeRenderModel(vr::RenderModel_t *pRenderModel) override
+	{
+		SIM_CALL();
+		if (pRenderModel)
+		{
+			delete[] pRenderModel->rVertexData;
+			delete[] pRenderModel->rIndexData;
+			delete pRenderModel;
+		}
+	}
+
+	vr::EVRRenderModelError LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) override
+	{
+		SIM_CALL();
+		if (textureId < 0 || textureId >= s_config.num_render_models)
+		{
+			*ppTexture = nullptr;
+			return vr::VRRenderModelError_InvalidTexture;
+		}
+		uint32_t width = uint32_t(s_config.texture_width);
+		uint32_t height = uint32_t(s_config.texture_height);
+		uint8_t *data = new uint8_t[width * height * 4];
+		fill_image(data, width, height, sim_hash(19, textureId));
+
+		vr::RenderModel_TextureMap_t *texture = new vr::RenderModel_TextureMap_t;
+		texture->unWidth = uint16_t(width);
+		texture->unHeight = uint16_t(height);
+		texture->rubTextureMapData = data;
+		*ppTexture = texture;
+		return vr::VRRenderModelError_None;
+	}
+
+	void FreeTexture(vr::RenderModel_TextureMap_t *pTexture) override
+	{
+		SIM_CALL();
+		if (pTexture)
+		{
+			delete[] pTexture->rubTextureMapData;
+			delete pTexture;
+		}
+	}
+
+	uint32_t GetRenderModelName(uint32_t unRenderModelIndex, char *pchRenderModelName, uint32_t unRenderModelNameLen) override
+	{
+		SIM_CALL();
+		if (unRenderModelIndex >= uint32_t(s_config.num_render_models))
+			return 0;
+		char name[64];
+		render_model_name(int(unRenderModelIndex), name, sizeof(name));
+		return return_string(name, pchRenderModelName, unRenderModelNameLen);
+	}
+
+	uint32_t GetRenderModelCount() override
+	{
+		SIM_CALL();
+		return uint32_t(s_config.num_render_models);
+	}
+
+	uint32_t GetComponentCount(const char *pchRenderModelName) override
+	{
+		SIM_CALL();
+		return render_model_index(pchRenderModelName) >= 0 ? uint32_t(NUM_COMPONENTS) : 0;
+	}
+
+	uint32_t GetComponentName(const char *pchRenderModelName, uint32_t unComponentIndex, char *pchComponentName, uint32_t unComponentNameLen) override
+	{
+		SIM_CALL();
+		if (render_model_index(pchRenderModelName) < 0 || unComponentIndex >= uint32_t(NUM_COMPONENTS))
+			return 0;
+		return return_string(component_names()[unComponentIndex], pchComponentName, unComponentNameLen);
+	}
+
+	uint64_t GetComponentButtonMask(const char *pchRenderModelName, const char *pchComponentName) override
+	{
+		SIM_CALL();
+		switch (component_index(pchComponentName))
+		{
+		case 1: return vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger);
+		case 2: return vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad);
+		default: return 0;
+		}
+	}
+
+	uint32_t GetComponentRenderModelName(const char *pchRenderModelName, const char *pchComponentName, char *pchComponentRenderModelName, uint32_t unComponentRenderModelNameLen) override
+	{
+		SIM_CALL();
+		if (render_model_index(pchRenderModelName) < 0 || component_index(pchComponentName) < 0)
+			return 0;
+		char name[128];
+		snprintf(name, sizeof(name), "%s_%s", pchRenderModelName, pchComponentName);
+		return return_string(name, pchComponentRenderModelName, unComponentRenderModelNameLen);
+	}
+
+	// pressed components sink a little
+	bool GetComponentState(const char *pchRenderModelName, const char *pchComponentName, const vr::VRControllerState_t *pControllerState, const vr::RenderModel_ControllerMode_State_t *pState, vr::RenderModel_ComponentState_t *pComponentState) override
+	{
+		SIM_CALL();
+		if (render_model_index(pchRenderModelName) < 0 || component_index(pchComponentName) < 0)
+			return false;
+		uint64_t mask = GetComponentButtonMask(pchRenderModelName, pchComponentName);
+		bool pressed = pControllerState && (pControllerState->ulButtonPressed & mask);
+		bool touched = pControllerState && (pControllerState->ulButtonTouched & mask);
+		set_translation(&pComponentState->mTrackingToComponentRenderModel, 0.0f, pressed ? -0.005f : 0.0f, 0.0f);
+		set_translation(&pComponentState->mTrackingToComponentLocal, 0.0f, pressed ? -0.005f : 0.0f, 0.0f);
+		pComponentState->uProperties = vr::VRComponentProperty_IsVisible;
+		if (pressed)
+			pComponentState->uProperties |= vr::VRComponentProperty_IsPressed;
+		if (touched)
+			pComponentState->uProperties |= vr::VRComponentProperty_IsTouched;
+		return true;
+	}
+
+	bool RenderModelHasComponent(const char *pchRenderModelName, const char *pchComponentName) override
+	{
+		SIM_CALL();
+		return render_model_index(pchRenderModelName) >= 0 && component_index(pchComponentName) >= 0;
+	}
+
+	uint32_t GetRenderModelThumbnailURL(const char *pchRenderModelName, char *pchThumbnailURL, uint32_t unThumbnailURLLen, vr::EVRRenderModelError *peError) override
+	{
+		SIM_CALL();
+		return return_model_path("file:///sim/rendermodels/%s.png", pchRenderModelName, pchThumbnailURL, unThumbnailURLLen, peError);
+	}
+
+	uint32_t GetRenderModelOriginalPath(const char *pchRenderModelName, char *pchOriginalPath, uint32_t unOriginalPathLen, vr::EVRRenderModelError *peError) override
+	{
+		SIM_CALL();
+		return return_model_path("sim/rendermodels/%s.obj", pchRenderModelName, pchOriginalPath, unOriginalPathLen, peError);
+	}
+
+private:
+	enum { NUM_COMPONENTS = 3 };
+
+	static const char **component_names()
+	{
+		static const char *names[NUM_COMPONENTS] = { "base", "trigger", "trackpad" };
+		return names;
+	}
+
+	static int component_index(const char *name)
+	{
+		for (int i = 0; name && i < NUM_COMPONENTS; i++)
+		{
+			if (strcmp(name, component_names()[i]) == 0)
+				return i;
+		}
+		return -1;
+	}
+
+	static uint32_t return_model_path(const char *format, const char *name, char *buf, uint32_t buf_size, vr::EVRRenderModelError *peError)
+	{
+		if (render_model_index(name) < 0)
+		{
+			if (peError)
+			{
+				*peError = vr::VRRenderModelError_InvalidModel;
+			}
+			return_string("", buf, buf_size);
+			return 0;
+		}
+		char path[128];
+		snprintf(path, sizeof(path), format, name);
+		uint32_t required = return_string(path, buf, buf_size);
+		if (peError)
+		{
+			*peError = required > buf_size ? vr::VRRenderModelError_BufferTooSmall : vr::VRRenderModelError_None;
+		}
+		return required;
+	}
+};
+
+// every setting exists.  values come from the section and key names
+class VRSettingsSim : public VRSettingsCppStub
+{
+public:
+	bool GetBool(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override
+	{
+		SIM_CALL();
+		return (setting_hash(pchSection, pchSettingsKey, peError) & 1) != 0;
+	}
+
+	int32_t GetInt32(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override
+	{
+		SIM_CALL();
+		return int32_t(setting_hash(pchSection, pchSettingsKey, peError) % 1000);
+	}
+
+	float GetFloat(const char *pchSection, const char *pchSettingsKey, vr::EVRSettingsError *peError) override
+	{
+		SIM_CALL();
+		return unit_float(setting_hash(pchSection, pchSettingsKey, peError));
+	}
+
+	void GetString(const char *pchSection, const char *pchSettingsKey, char *pchValue, uint32_t unValueLen, vr::EVRSettingsError *peError) override
+	{
+		SIM_CALL();
+		uint32_t h = uint32_t(setting_hash(pchSection, pchSettingsKey, peError));
+		if (pchValue && unValueLen > 0)
+		{
+			snprintf(pchValue, unValueLen, "sim_%08x", h);
+		}
+	}
+
+private:
+	static uint64_t setting_hash(const char *section, const char *key, vr::EVRSettingsError *peError)
+	{
+		if (peError)
+		{
+			*peError = vr::VRSettingsError_None;
+		}
+		return sim_hash(20, string_hash(section), string_hash(key));
+	}
+};
+
+class VRResourcesSim : public VRResourcesCppStub
+{
+public:
+	uint32_t LoadSharedResource(const char *pchResourceName, char *pchBuffer, uint32_t unBufferLen) override
+	{
+		SIM_CALL();
+		uint64_t h = sim_hash(21, string_hash(pchResourceName));
+		uint32_t size = 256 + uint32_t(h % 4096);
+		if (pchBuffer && unBufferLen >= size)
+		{
+			for (uint32_t i = 0; i < size; i++)
+			{
+				pchBuffer[i] = char(mix(h + i / 8) >> (8 * (i % 8)));
+			}
+		}
+		return size;
+	}
+
+	uint32_t GetResourceFullPath(const char *pchResourceName, const char *pchResourceTypeDirectory, char *pchPathBuffer, uint32_t unBufferLen) override
+	{
+		SIM_CALL();
+		std::string path = std::string("sim/") + (pchResourceTypeDirectory ? pchResourceTypeDirectory : "") + "/" + (pchResourceName ? pchResourceName : "");
+		return return_string(path.c_str(), pchPathBuffer, unBufferLen);
+	}
+};
+
+class VRDriverManagerSim : public VRDriverManagerCppStub
+{
+public:
+	uint32_t GetDriverCount() const override
+	{
+		SIM_CALL();
+		return 2;
+	}
+
+	uint32_t GetDriverName(vr::DriverId_t nDriver, char *pchValue, uint32_t unBufferSize) override
+	{
+		SIM_CALL();
+		static const char *names[] = { "sim", "sim_lighthouse" };
+		if (nDriver >= 2)
+			return 0;
+		return return_string(names[nDriver], pchValue, unBufferSize);
+	}
+};
+
+static VRSystemSim VRSystemSimInstance;
+static VRExtendedDisplaySim VRExtendedDisplaySimInstance;
+static VRTrackedCameraSim VRTrackedCameraSimInstance;
+static VRApplicationsSim VRApplicationsSimInstance;
+static VRChaperoneSim VRChaperoneSimInstance;
+static VRChaperoneSetupSim VRChaperoneSetupSimInstance;
+static VRCompositorSim VRCompositorSimInstance;
+static VROverlaySim VROverlaySimInstance;
+static VRRenderModelsSim VRRenderModelsSimInstance;
+static VRSettingsSim VRSettingsSimInstance;
+static VRScreenshotsCppStub VRScreenshotsSimInstance;
+static VRResourcesSim VRResourcesSimInstance;
+static VRDriverManagerSim VRDriverManagerSimInstance;
+
+void openvr_sim::configure(const sim_config &config)
+{
+	s_config = config;
+	uint32_t max_devices = vr::k_unMaxTrackedDeviceCount;
+	if (num_devices() > max_devices)
+	{
+		// keep the hmd and controllers, drop trackers and base stations
+		int spare = int(max_devices) - 1 - s_config.num_controllers;
+		s_config.num_trackers = spare > 0 ? (s_config.num_trackers < spare ? s_config.num_trackers : spare) : 0;
+		spare -= s_config.num_trackers;
+		s_config.num_base_stations = spare > 0 ? (s_config.num_base_stations < spare ? s_config.num_base_stations : spare) : 0;
+	}
+	s_configured = true;
+	s_frame = 0;
+	{
+		std::lock_guard<std::mutex> event_lock(s_event_mutex);
+		s_event_frame = UINT64_MAX;
+	}
+
+	std::lock_guard<std::mutex> lock(s_overlay_mutex);
+	s_overlay_keys.clear();
+}
+
+const sim_config &openvr_sim::get_config()
+{
+	return s_config;
+}
+
+void openvr_sim::advance_frame(int num_frames)
+{
+	s_frame += uint64_t(num_frames);
+}
+
+uint64_t openvr_sim::get_frame()
+{
+	return s_frame;
+}
+
+uint64_t openvr_sim::get_num_calls()
+{
+	return s_num_calls;
+}
+
+void openvr_sim::get_interfaces(openvr_broker::open_vr_interfaces *interfaces)
+{
+	if (!s_configured)
+	{
+		sim_config config;
+		config.set_default();
+		configure(config);
+	}
+	interfaces->sysi = &VRSystemSimInstance;
+	interfaces->appi = &VRApplicationsSimInstance;
+	interfaces->seti = &VRSettingsSimInstance;
+	interfaces->chapi = &VRChaperoneSimInstance;
+	interfaces->chapsi = &VRChaperoneSetupSimInstance;
+	interfaces->compi = &VRCompositorSimInstance;
+	interfaces->ovi = &VROverlaySimInstance;
+	interfaces->remi = &VRRenderModelsSimInstance;
+	interfaces->exdi = &VRExtendedDisplaySimInstance;
+	interfaces->taci = &VRTrackedCameraSimInstance;
+	interfaces->screeni = &VRScreenshotsSimInstance;
+	interfaces->noti = nullptr;  // like raw: not implemented in openvr
+	interfaces->resi = &VRResourcesSimInstance;
+	interfaces->drivi = &VRDriverManagerSimInstance;
+}
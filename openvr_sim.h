@@ -0,0 +1,59 @@
+#pragma once
+//
+// openvr_sim: a simulated openvr runtime for benchmarking and testing without hardware.
+//
+//  * an hmd, N controllers, N trackers and base stations following scripted trajectories.
+//  * controller buttons, property churn (battery levels etc), overlays with changing images,
+//    render models with textures, settings, applications, chaperone, compositor timings.
+//  * every answer is a function of (seed, frame, the query) - nothing depends on wall clock time or
+//    call order - so the same seed and frame sequence always produce the same capture, even when
+//    the updater queries in parallel.
+//  * time only moves when advance_frame() is called.  a benchmark at 90hz calls it once per update.
+//  * PollNextEvent returns scripted events for the frame's changes (VREvent_PropertyChanged when the
+//    churning properties change), and every interface call is counted (get_num_calls).
+//
+// openvr_broker::acquire_interfaces("sim", ...) hands out the simulation with the default config.
+//
+#include <openvr_broker.h>
+#include <stdint.h>
+
+namespace openvr_sim
+{
+	struct sim_config
+	{
+		uint64_t seed;
+		float frames_per_second;			// GetTimeSinceLastVsync, frame timings and pose speeds
+
+		int num_controllers;				// the first two get the left and right hand roles
+		int num_trackers;
+		int num_base_stations;
+
+		int button_period_frames;			// how often a button can change state
+		int property_churn_period_frames;	// how often the churning properties (battery etc) change
+
+		int num_applications;
+		int num_render_models;
+		int render_model_vertices;
+		int texture_width;					// render model textures
+		int texture_height;
+
+		int overlay_width;					// every overlay key is found
+		int overlay_height;
+		int overlay_image_period_frames;	// how often the overlay images change
+
+		void set_default();
+	};
+
+	// replaces the simulation.  the frame goes back to 0
+	void configure(const sim_config &config);
+	const sim_config &get_config();
+
+	void advance_frame(int num_frames = 1);
+	uint64_t get_frame();
+
+	// calls into the simulated interfaces since startup
+	uint64_t get_num_calls();
+
+	// the simulated interfaces.  notifications are null like the raw runtime's
+	void get_interfaces(openvr_broker::open_vr_interfaces *interfaces);
+};
@@ -0,0 +1,20 @@
+#include "overlay_image_scheduler.h"
+#include "content_hash.h"
+
+bool overlay_image_scheduler::image_changed(int overlay_index, uint32_t width, uint32_t height, int error, const uint8_t *data, uint32_t size)
+{
+	if (overlay_index >= int(m_last.size()))
+	{
+		m_last.resize(overlay_index + 1, last_image{ false, 0, 0, 0, 0, 0 });
+	}
+	last_image &last = m_last[overlay_index];
+	uint64_t hash = hash_content(data, size);
+	if (last.seen && last.width == width && last.height == height && last.error == error &&
+		last.size == size && last.hash == hash)
+	{
+		return false;
+	}
+	last = { true, width, height, error, size, hash };
+	m_num_changes++;
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+// overlay_image_scheduler
+//
+//  * GetOverlayImageData can't be called from more than one thread (vrclient.dll crashes), and
+//    each call copies out a whole RGBA image.  so updates fetch the images from one task, the
+//    overlays taking turns: each update carries on from the overlay after the last one fetched
+//    until the byte budget (CaptureConfig::overlay_image_bytes_per_frame) is spent.  at least
+//    one is fetched per update, so the budget can be overshot by one image.
+//  * each fetched image is hashed (content_hash.h) and only visited when it, it's size or the
+//    error changed.
+//  * images are fetched into one buffer that is reused, instead of a malloc per call.
+//  * the turn order only depends on the overlay count, so it's deterministic.
+//  * one per capture (capture::m_overlay_images).  not locked: only the image task uses it.
+//
+#include "capture_config.h"
+#include <stdint.h>
+#include <vector>
+
+struct overlay_image_scheduler
+{
+	static const uint32_t DEFAULT_BYTES_PER_FRAME = 4 * 1024 * 1024;
+
+	overlay_image_scheduler()
+		:	m_bytes_per_frame(DEFAULT_BYTES_PER_FRAME),
+			m_next_overlay(0),
+			m_num_fetches(0),
+			m_num_changes(0)
+	{}
+
+	void Init(const CaptureConfig &c)
+	{
+		m_bytes_per_frame = c.overlay_image_bytes_per_frame;
+	}
+
+	// forget the images seen, so the next fetch of each is visited
+	void clear()
+	{
+		m_last.clear();
+		m_next_overlay = 0;
+	}
+
+	// calls fetch(overlay_index) for this update's overlays.  fetch returns the bytes it fetched
+	template <typename F>
+	void run_frame(int num_overlays, F fetch)
+	{
+		uint64_t spent = 0;
+		for (int n = 0; n < num_overlays && (n == 0 || spent < m_bytes_per_frame); n++)
+		{
+			int i = m_next_overlay % num_overlays;
+			m_next_overlay = (i + 1) % num_overlays;
+			spent += fetch(i);
+			m_num_fetches++;
+		}
+	}
+
+	// true if the image isn't what was last seen for the overlay
+	bool image_changed(int overlay_index, uint32_t width, uint32_t height, int error, const uint8_t *data, uint32_t size);
+
+	std::vector<uint8_t> &get_buffer() { return m_buffer; }
+
+	uint64_t get_num_fetches() const { return m_num_fetches; }
+	uint64_t get_num_changes() const { return m_num_changes; }
+
+private:
+	struct last_image
+	{
+		bool seen;
+		uint32_t width;
+		uint32_t height;
+		int error;
+		uint32_t size;
+		uint64_t hash;
+	};
+
+	uint32_t m_bytes_per_frame;
+	int m_next_overlay;
+	std::vector<last_image> m_last;
+	std::vector<uint8_t> m_buffer;
+	uint64_t m_num_fetches;
+	uint64_t m_num_changes;
+};
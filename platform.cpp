@@ -1,5 +1,17 @@
 #include "platform.h"
 #include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#endif
 
 void plat::sleep_ms(unsigned long ms)
 {
@@ -19,3 +31,205 @@ std::string plat::make_temporary_filename()
 {
 	return(std::tmpnam(nullptr));
 }
+
+const char *plat::map_file_for_read(const char *filename, uint64_t *size, void **handle)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);	// the mapping keeps the file open
+	if (!mapping)
+		return nullptr;
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(mapping);
+		return nullptr;
+	}
+	*size = file_size.QuadPart;
+	*handle = mapping;
+	return static_cast<const char *>(view);
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+	void *view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);			// the mapping keeps the file open
+	if (view == MAP_FAILED)
+		return nullptr;
+	madvise(view, st.st_size, MADV_SEQUENTIAL);
+	*size = st.st_size;
+	*handle = nullptr;
+	return static_cast<const char *>(view);
+#endif
+}
+
+void plat::unmap_file(const char *view, uint64_t size, void *handle)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+	CloseHandle(static_cast<HANDLE>(handle));
+#else
+	munmap(const_cast<char *>(view), size);
+#endif
+}
+
+struct plat::scratch_file
+{
+#ifdef _WIN32
+	HANDLE file;
+#else
+	int fd;
+#endif
+};
+
+plat::scratch_file *plat::create_scratch_file()
+{
+#ifdef _WIN32
+	char dir[MAX_PATH + 1];
+	DWORD dir_length = GetTempPathA(sizeof(dir), dir);
+	if (dir_length == 0 || dir_length > sizeof(dir))
+		return nullptr;
+	// a non zero unique value makes GetTempFileName only build the name.  CREATE_NEW fails rather
+	// than open a file someone else put there, so try the next one
+	UINT unique = UINT(GetTickCount());
+	for (int attempt = 0; attempt < 100; attempt++)
+	{
+		char filename[MAX_PATH];
+		if (GetTempFileNameA(dir, "vrc", (unique + attempt) | 1, filename) == 0)
+			return nullptr;
+		HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+			FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		if (file != INVALID_HANDLE_VALUE)
+			return new scratch_file{ file };
+		if (GetLastError() != ERROR_FILE_EXISTS)
+			return nullptr;
+	}
+	return nullptr;
+#else
+	const char *dir = getenv("TMPDIR");
+	std::string filename = std::string(dir && *dir ? dir : "/tmp") + "/vrcapture_XXXXXX";
+	int fd = mkstemp(&filename[0]);		// creates it exclusively, 0600
+	if (fd < 0)
+		return nullptr;
+	unlink(filename.c_str());	// it goes when it's closed
+	return new scratch_file{ fd };
+#endif
+}
+
+char *plat::map_scratch_file(scratch_file *file, uint64_t offset, uint64_t size)
+{
+	uint64_t end = offset + size;
+#ifdef _WIN32
+	HANDLE mapping = CreateFileMappingA(file->file, nullptr, PAGE_READWRITE, DWORD(end >> 32), DWORD(end), nullptr);
+	if (!mapping)
+		return nullptr;
+	void *view = MapViewOfFile(mapping, FILE_MAP_WRITE, DWORD(offset >> 32), DWORD(offset), size_t(size));
+	CloseHandle(mapping);	// the view keeps it open
+	return static_cast<char *>(view);
+#else
+	struct stat st;
+	if (fstat(file->fd, &st) != 0)
+		return nullptr;
+	if (uint64_t(st.st_size) < end && ftruncate(file->fd, end) != 0)
+		return nullptr;
+	void *view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, offset);
+	if (view == MAP_FAILED)
+		return nullptr;
+	return static_cast<char *>(view);
+#endif
+}
+
+void plat::unmap_scratch_file(char *view, uint64_t size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+#else
+	munmap(view, size);
+#endif
+}
+
+void plat::discard_mapped_pages(char *view, uint64_t size)
+{
+#ifdef _WIN32
+	VirtualUnlock(view, size_t(size));	// on pages that aren't locked, this takes them out of the working set
+#else
+	madvise(view, size, MADV_DONTNEED);	// shared file pages: the contents stay in the file
+#endif
+}
+
+void plat::close_scratch_file(scratch_file *file)
+{
+#ifdef _WIN32
+	CloseHandle(file->file);
+#else
+	close(file->fd);
+#endif
+	delete file;
+}
+
+bool plat::get_file_info(const char *filename, uint64_t *size, uint64_t *write_time)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &data))
+		return false;
+	*size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	*write_time = ((uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime) * 100;
+	return true;
+#else
+	struct stat st;
+	if (stat(filename, &st) != 0)
+		return false;
+	*size = st.st_size;
+	*write_time = uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	return true;
+#endif
+}
+
+uint64_t plat::get_resident_bytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.WorkingSetSize;
+#else
+	long pages = 0;
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f)
+	{
+		long total;
+		if (fscanf(f, "%ld %ld", &total, &pages) != 2)
+			pages = 0;
+		fclose(f);
+	}
+	return uint64_t(pages) * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+uint64_t plat::get_peak_resident_bytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+}
@@ -13,14 +13,36 @@ namespace plat
 	void sleep_ms(unsigned long ms);
 	std::string make_temporary_filename(const std::string &key);
 	std::string make_temporary_filename();
-	
+
+	// read only view of a whole file. returns nullptr on failure
+	const char *map_file_for_read(const char *filename, uint64_t *size, void **handle);
+	void unmap_file(const char *view, uint64_t size, void *handle);
+
+	// read/write scratch file in the temp directory that's deleted when it's closed.  it's a new
+	// file with a unique name, never one that was already there.  returns nullptr on failure
+	struct scratch_file;
+	scratch_file *create_scratch_file();
+	// read/write view of size bytes at offset (a multiple of 64kb), growing the file to cover it.
+	// views stay valid until they're unmapped.  returns nullptr on failure
+	char *map_scratch_file(scratch_file *file, uint64_t offset, uint64_t size);
+	void unmap_scratch_file(char *view, uint64_t size);
+	// drops pages of a view from the working set.  they're read back from the file when touched
+	void discard_mapped_pages(char *view, uint64_t size);
+	void close_scratch_file(scratch_file *file);
+
+	// size and last write time (ns, only comparable with itself) of a file. false if it can't be stat'ed
+	bool get_file_info(const char *filename, uint64_t *size, uint64_t *write_time);
+
+	// process memory use, for benchmarks
+	uint64_t get_resident_bytes();
+	uint64_t get_peak_resident_bytes();
 };
 
 using time_point_t = std::chrono::steady_clock::time_point;
 
 typedef uint64_t time_stamp_t;
 typedef int time_index_t;
-using serialization_id = uint16_t;
+using serialization_id = uint32_t;		// one per history node.  a big graph has hundreds of thousands
 
 template <typename T>
 constexpr int size_as_int(const T &size_in) {
@@ -28,7 +50,7 @@ constexpr int size_as_int(const T &size_in) {
 }
 
 template <typename T>
-constexpr int size_as_uint32(const T &size_in) {
+constexpr uint32_t size_as_uint32(const T &size_in) {
 	return static_cast<uint32_t>(size_in);
 }
 
@@ -37,7 +59,7 @@ constexpr int ptrdiff_as_int(const ptrdiff_t &size_in) {
 }
 
 template <typename T>
-constexpr int size_as_serialization_id(const T &size_in) {
+constexpr serialization_id size_as_serialization_id(const T &size_in) {
 	return static_cast<serialization_id>(size_in);
 }
 
@@ -0,0 +1,98 @@
+#include "poll_events.h"
+#include "poll_schedule.h"
+#include "vr_keys.h"
+#include <string.h>
+
+static void invalidate_section(const char *section_name, vr_keys *keys, poll_schedule *schedule)
+{
+	SettingsIndexer &indexer = keys->GetSettingsIndexer();
+	for (int i = 0; i < indexer.GetNumSections(); i++)
+	{
+		if (strcmp(indexer.GetSectionName(i), section_name) == 0)
+		{
+			schedule->invalidate(POLL_SETTINGS, i);
+			return;
+		}
+	}
+	schedule->request_poll(POLL_SETTINGS);	// not one the indexer knows about yet
+}
+
+static void invalidate_device(vr::TrackedDeviceIndex_t device_index, poll_schedule *schedule)
+{
+	if (device_index < vr::k_unMaxTrackedDeviceCount)
+	{
+		schedule->invalidate(POLL_DEVICE_PROPERTIES, int(device_index));
+	}
+	else
+	{
+		schedule->request_poll(POLL_DEVICE_PROPERTIES);
+	}
+}
+
+bool invalidate_for_event(const vr::VREvent_t &event, vr_keys *keys, poll_schedule *schedule)
+{
+	switch (event.eventType)
+	{
+	// devices
+	case vr::VREvent_TrackedDeviceActivated:
+	case vr::VREvent_TrackedDeviceDeactivated:
+		invalidate_device(event.trackedDeviceIndex, schedule);
+		schedule->invalidate(POLL_RENDER_MODELS, -1);		// may have brought a new render model
+		break;
+	case vr::VREvent_TrackedDeviceUpdated:
+	case vr::VREvent_TrackedDeviceRoleChanged:
+	case vr::VREvent_PropertyChanged:
+		invalidate_device(event.trackedDeviceIndex, schedule);
+		break;
+
+	// applications
+	case vr::VREvent_SceneApplicationChanged:
+	case vr::VREvent_SceneFocusChanged:
+	case vr::VREvent_ApplicationTransitionStarted:
+	case vr::VREvent_ApplicationTransitionAborted:
+	case vr::VREvent_ApplicationTransitionNewAppStarted:
+	case vr::VREvent_ProcessConnected:
+	case vr::VREvent_ProcessDisconnected:
+		schedule->invalidate(POLL_APPLICATIONS, -1);		// the list and the scene state
+		break;
+	case vr::VREvent_ApplicationListUpdated:
+		schedule->request_poll(POLL_APPLICATIONS);
+		schedule->request_poll(POLL_MIME_TYPES);
+		break;
+	case vr::VREvent_ApplicationMimeTypeLoad:
+		schedule->request_poll(POLL_MIME_TYPES);
+		break;
+
+	// chaperone
+	case vr::VREvent_ChaperoneDataHasChanged:
+	case vr::VREvent_ChaperoneUniverseHasChanged:
+	case vr::VREvent_ChaperoneTempDataHasChanged:
+	case vr::VREvent_SeatedZeroPoseReset:
+		schedule->request_poll(POLL_CHAPERONE);
+		schedule->request_poll(POLL_CHAPERONE_SETUP);
+		break;
+	case vr::VREvent_ChaperoneSettingsHaveChanged:
+		schedule->request_poll(POLL_CHAPERONE);
+		schedule->request_poll(POLL_CHAPERONE_SETUP);
+		invalidate_section(vr::k_pch_CollisionBounds_Section, keys, schedule);
+		break;
+
+	// settings
+	case vr::VREvent_BackgroundSettingHasChanged:
+	case vr::VREvent_ReprojectionSettingHasChanged:
+	case vr::VREvent_ModelSkinSettingsHaveChanged:
+	case vr::VREvent_EnvironmentSettingsHaveChanged:
+		invalidate_section(vr::k_pch_SteamVR_Section, keys, schedule);
+		break;
+	case vr::VREvent_CameraSettingsHaveChanged:
+		invalidate_section(vr::k_pch_Camera_Section, keys, schedule);
+		break;
+	case vr::VREvent_PowerSettingsHaveChanged:
+		invalidate_section(vr::k_pch_Power_Section, keys, schedule);
+		break;
+
+	default:
+		return false;
+	}
+	return true;
+}
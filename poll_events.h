@@ -0,0 +1,17 @@
+#pragma once
+// poll_events
+//
+//  * maps openvr events to the subtrees they make stale, so subtrees that are polled on demand
+//    (see poll_schedule.h, CaptureConfig::set_poll_on_events) are only queried when something
+//    changed.
+//  * device events invalidate that device, settings events their section, chaperone and
+//    application events their whole subtree.  events that aren't mapped change nothing; the
+//    safety sweep picks up anything they missed.
+//
+#include <openvr.h>
+
+struct vr_keys;
+struct poll_schedule;
+
+// returns false if the event isn't one that invalidates anything
+bool invalidate_for_event(const vr::VREvent_t &event, vr_keys *keys, poll_schedule *schedule);
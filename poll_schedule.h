@@ -0,0 +1,194 @@
+#pragma once
+// poll_schedule
+//
+//  * decides which subtrees an update queries.  poses and controller state are needed every frame,
+//    but device strings, applications, mime types, resources and settings hardly ever change and
+//    cost dozens of cross process calls each.
+//  * each subtree has a rate (CaptureConfig::poll_rates): every frame, every N frames, every N ms
+//    or on demand.
+//  * a slow subtree's items (devices, applications, sections...) each get their own phase, so the
+//    work is spread across frames instead of all landing on one.
+//  * on demand subtrees are only polled when something asks: request_poll for the whole subtree,
+//    invalidate for one item (see poll_events.h for the openvr events that do this).  their
+//    period is a safety sweep in ms in case an event is missed (0 for none).
+//  * the first update polls everything.
+//
+#include "capture_config.h"
+#include "platform.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+struct poll_schedule
+{
+	poll_schedule()
+		:	m_first_update(true),
+			m_requests(0)
+	{
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			m_rates[i] = { POLL_EVERY_FRAME, 1 };
+		}
+	}
+
+	// copies the rates.  requests stay with the original
+	poll_schedule(const poll_schedule &rhs)
+		:	m_first_update(rhs.m_first_update),
+			m_requests(0)
+	{
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			m_rates[i] = rhs.m_rates[i];
+		}
+	}
+
+	poll_schedule &operator = (const poll_schedule &rhs)
+	{
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			m_rates[i] = rhs.m_rates[i];
+		}
+		m_first_update = rhs.m_first_update;
+		return *this;
+	}
+
+	void Init(const CaptureConfig &c)
+	{
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			set_rate(poll_subtree(i), c.poll_rates[i]);
+		}
+	}
+
+	void set_rate(poll_subtree s, poll_rate rate)
+	{
+		if (rate.type == POLL_ON_DEMAND)
+		{
+			rate.period = std::max(rate.period, 0);
+		}
+		else if (rate.period < 1)
+		{
+			rate.period = 1;
+		}
+		m_rates[s] = rate;
+	}
+
+	const poll_rate &get_rate(poll_subtree s) const { return m_rates[s]; }
+
+	// poll all of s on the next update whatever it's rate.  safe to call during an update
+	void request_poll(poll_subtree s)
+	{
+		m_requests.fetch_or(1u << s);
+	}
+
+	// poll one item of s on the next update.  -1 is the subtree's own state (lists, scalars)
+	void invalidate(poll_subtree s, int item)
+	{
+		std::lock_guard<std::mutex> lock(m_invalid_lock);
+		m_invalid[s].push_back(item);
+	}
+
+	// hands the requests to an update.  later requests go to the next one, in the lists the
+	// update before handed back
+	void take_requests(bool *first_update, uint32_t *requests, std::vector<int> *invalid)
+	{
+		*first_update = m_first_update;
+		m_first_update = false;
+		*requests = m_requests.exchange(0);
+		std::lock_guard<std::mutex> lock(m_invalid_lock);
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			invalid[i].swap(m_invalid[i]);
+			m_invalid[i].swap(m_spare_invalid[i]);
+		}
+	}
+
+	// the update is done with the lists.  they're kept, emptied, so invalidating doesn't allocate
+	// once they've grown
+	void return_requests(std::vector<int> *invalid)
+	{
+		std::lock_guard<std::mutex> lock(m_invalid_lock);
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			invalid[i].clear();
+			m_spare_invalid[i].swap(invalid[i]);
+		}
+	}
+
+private:
+	poll_rate m_rates[NUM_POLL_SUBTREES];
+	bool m_first_update;
+	std::atomic<uint32_t> m_requests;
+
+	std::mutex m_invalid_lock;
+	std::vector<int> m_invalid[NUM_POLL_SUBTREES];
+	std::vector<int> m_spare_invalid[NUM_POLL_SUBTREES];	// the lists the last update handed back
+};
+
+// what one update polls.  made from the schedule at the start of the update
+struct poll_frame
+{
+	poll_frame(poll_schedule *schedule, time_index_t frame, time_stamp_t last_update_time, time_stamp_t update_time)
+		:	m_schedule(schedule),
+			m_frame(frame),
+			m_last_update_time(last_update_time),
+			m_update_time(update_time)
+	{
+		schedule->take_requests(&m_first_update, &m_requests, m_invalid);
+		for (int i = 0; i < NUM_POLL_SUBTREES; i++)
+		{
+			std::sort(m_invalid[i].begin(), m_invalid[i].end());
+		}
+	}
+
+	~poll_frame()
+	{
+		m_schedule->return_requests(m_invalid);
+	}
+
+	poll_frame(const poll_frame &) = delete;
+	poll_frame &operator=(const poll_frame &) = delete;
+
+	// item -1 is the subtree itself (lists, scalars), 0.. are it's children
+	bool poll(poll_subtree s, int item) const
+	{
+		if (m_first_update || (m_requests & (1u << s)))
+			return true;
+
+		const poll_rate &rate = m_schedule->get_rate(s);
+		uint64_t phase = uint64_t(item + 1) + uint64_t(s) * 7;
+		switch (rate.type)
+		{
+		case POLL_EVERY_FRAME:
+			return true;
+		case POLL_EVERY_N_FRAMES:
+			return (uint64_t(m_frame) + phase) % rate.period == 0;
+		case POLL_EVERY_N_MS:
+			return due(rate.period, phase);
+		case POLL_ON_DEMAND:
+		default:
+			return std::binary_search(m_invalid[s].begin(), m_invalid[s].end(), item) ||
+				(rate.period > 0 && due(rate.period, phase));
+		}
+	}
+
+private:
+	static const int POLL_MS_SLOTS = 64;
+
+	// the period is split into slots and each item is due when the update times cross it's slot
+	bool due(int period_ms, uint64_t phase) const
+	{
+		uint64_t period_us = uint64_t(period_ms) * 1000;
+		uint64_t offset = (phase % POLL_MS_SLOTS) * (period_us / POLL_MS_SLOTS);
+		return (m_update_time + offset) / period_us != (m_last_update_time + offset) / period_us;
+	}
+
+	poll_schedule *m_schedule;
+	time_index_t m_frame;
+	time_stamp_t m_last_update_time;
+	time_stamp_t m_update_time;
+	bool m_first_update;
+	uint32_t m_requests;
+	std::vector<int> m_invalid[NUM_POLL_SUBTREES];
+};
@@ -0,0 +1,55 @@
+#include "resource_cache.h"
+#include "platform.h"
+#include "content_hash.h"
+#include <string.h>
+
+// the key string is reused so lookups of known paths don't allocate
+resource_cache::entry &resource_cache::lookup(const char *full_path)
+{
+	m_key.assign(full_path);
+	auto iter = m_entries.find(m_key);
+	if (iter != m_entries.end())
+	{
+		return iter->second;
+	}
+	return m_entries[m_key];
+}
+
+bool resource_cache::needs_load(const char *full_path)
+{
+	entry &e = lookup(full_path);
+	uint64_t file_size;
+	uint64_t write_time;
+	if (!plat::get_file_info(full_path, &file_size, &write_time))
+	{
+		// not a file on disk (or gone).  the content hash still stops unchanged data being visited
+		e.have_file_info = false;
+		m_num_loads++;
+		return true;
+	}
+
+	if (e.have_content && e.have_file_info && e.file_size == file_size && e.write_time == write_time)
+	{
+		return false;
+	}
+	e.file_size = file_size;
+	e.write_time = write_time;
+	e.have_file_info = true;
+	m_num_loads++;
+	return true;
+}
+
+bool resource_cache::content_changed(const char *full_path, const uint8_t *data, uint32_t size)
+{
+	entry &e = lookup(full_path);
+	uint64_t hash = hash_content(data, size);
+	if (e.have_content && e.content_size == size && e.content_hash == hash)
+	{
+		return false;
+	}
+	e.have_content = true;
+	e.content_size = size;
+	e.content_hash = hash;
+	m_num_changes++;
+	return true;
+}
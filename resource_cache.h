@@ -0,0 +1,65 @@
+#pragma once
+// resource_cache
+//
+//  * resources are whole files (images mostly) loaded through IVRResources::LoadSharedResource.
+//    loading and comparing every one on every poll is megabytes of I/O and memcmp, and they
+//    almost never change.
+//  * the cache remembers each full path's size and write time and the hash of it's content
+//    (content_hash.h).  a resource is only reloaded when the metadata changed (or can't be
+//    read), and only visited when the reloaded content hashes differently.
+//  * one per capture (capture::m_resource_cache).  only the resources node uses it and it's
+//    visited by one task, so there is no locking.
+//
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct resource_cache
+{
+	resource_cache()
+		:	m_num_loads(0),
+			m_num_changes(0)
+	{}
+
+	// false if full_path's size and write time are what they were when it was last loaded
+	bool needs_load(const char *full_path);
+
+	// after a load: true if the content isn't what was last seen for full_path
+	bool content_changed(const char *full_path, const uint8_t *data, uint32_t size);
+
+	void clear() { m_entries.clear(); }
+
+	// resources are loaded into this, so loads don't allocate once it's grown
+	std::vector<uint8_t> &get_buffer() { return m_buffer; }
+
+	uint64_t get_num_loads() const { return m_num_loads; }
+	uint64_t get_num_changes() const { return m_num_changes; }
+
+private:
+	struct entry
+	{
+		entry()
+			:	file_size(0),
+				write_time(0),
+				have_file_info(false),
+				have_content(false),
+				content_size(0),
+				content_hash(0)
+		{}
+		uint64_t file_size;
+		uint64_t write_time;
+		bool have_file_info;		// false when the path can't be stat'ed, so every poll loads
+		bool have_content;
+		uint32_t content_size;
+		uint64_t content_hash;
+	};
+
+	entry &lookup(const char *full_path);
+
+	std::unordered_map<std::string, entry> m_entries;
+	std::string m_key;
+	std::vector<uint8_t> m_buffer;
+	uint64_t m_num_loads;
+	uint64_t m_num_changes;
+};
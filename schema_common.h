@@ -119,6 +119,28 @@ struct time_node<ResultType, ContainerType, false, Allocator> :
 		time_indexed_vector<ResultType, ContainerType, Allocator>::decode(e);
 	}
 
+	virtual bool has_entry(time_index_t t) const override final
+	{
+		return time_indexed_vector<ResultType, ContainerType, Allocator>::find_entry(t) != nullptr;
+	}
+
+	virtual void encode_entry(BaseStream &e, time_index_t t) const override final
+	{
+		auto entry = time_indexed_vector<ResultType, ContainerType, Allocator>::find_entry(t);
+		assert(entry);
+		if (entry)
+		{
+			entry->encode(e);
+		}
+	}
+
+	virtual void decode_entry(BaseStream &e) override final
+	{
+		typename time_indexed_vector<ResultType, ContainerType, Allocator>::time_indexed_type entry;
+		entry.decode(e);
+		time_indexed_vector<ResultType, ContainerType, Allocator>::push_back(entry);
+	}
+
 
 	base::URL make_url_for_child(const std::string &child) { return base::URL(); }
 };
@@ -155,6 +177,22 @@ struct named_vector :	public std::vector<T, Allocator>,
 		assert(0);	// todo - split the serialization into some hierarchy thing
 	}
 
+	// vectors have no per frame entries, only their children do
+	virtual bool has_entry(time_index_t t) const override final
+	{
+		return false;
+	}
+
+	virtual void encode_entry(BaseStream &e, time_index_t t) const override final
+	{
+		assert(0);
+	}
+
+	virtual void decode_entry(BaseStream &e) override final
+	{
+		assert(0);
+	}
+
 	// what is weird below is that only the vector identity
 	// and the vector size is put on the stream.
 	//
@@ -0,0 +1,137 @@
+#pragma once
+//
+// segment_directory: an append only array of segment pointers (or of small per segment
+//                    summaries) that readers can index without locking while a single writer
+//                    appends.
+//
+//  * the table doubles when it's full.  the new table is filled in before it's published and the
+//    old one is kept until the directory is destroyed, since a reader may still be looking at it.
+//  * the count is published after the pointer is written, so a reader never sees an unset slot.
+//  * the slots are atomics so the writer can also replace a published slot (set(), for segments
+//    that were compressed, see cold_segments.h).  for pointers and time indexes the loads are
+//    plain loads.
+//
+#include <atomic>
+#include <vector>
+#include <assert.h>
+#include <algorithm>
+#include <cstdint>
+
+template <typename T>
+struct segment_directory
+{
+	typedef uint32_t size_type;
+	typedef std::atomic<T> slot_type;
+
+	segment_directory()
+		:	m_table(nullptr),
+			m_count(0),
+			m_capacity(0)
+	{}
+
+	segment_directory(const segment_directory &) = delete;
+	segment_directory& operator=(const segment_directory &) = delete;
+
+	~segment_directory()
+	{
+		delete[] m_table.load();
+		for (const retired_table &retired : m_retired)
+		{
+			delete[] retired.table;
+		}
+	}
+
+	size_type size() const
+	{
+		return m_count.load(std::memory_order_acquire);
+	}
+
+	T operator[] (size_type i) const
+	{
+		assert(i < size());
+		return m_table.load(std::memory_order_acquire)[i].load(std::memory_order_acquire);
+	}
+
+	T back() const
+	{
+		return (*this)[size() - 1];
+	}
+
+	// the current table.  valid for the indexes below a size() read before calling this
+	const slot_type* data() const
+	{
+		return m_table.load(std::memory_order_acquire);
+	}
+
+	// writer only
+	void push_back(const T& entry)
+	{
+		size_type count = m_count.load(std::memory_order_relaxed);
+		if (count == m_capacity)
+		{
+			size_type new_capacity = m_capacity ? m_capacity * 2 : 16;
+			slot_type* new_table = new slot_type[new_capacity];
+			slot_type* old_table = m_table.load(std::memory_order_relaxed);
+			if (old_table)
+			{
+				for (size_type i = 0; i < count; i++)
+				{
+					new_table[i].store(old_table[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+				m_retired.push_back({ old_table, count });
+			}
+			m_table.store(new_table, std::memory_order_release);
+			m_capacity = new_capacity;
+		}
+		m_table.load(std::memory_order_relaxed)[count].store(entry, std::memory_order_relaxed);
+		m_count.store(count + 1, std::memory_order_release);
+	}
+
+	// writer only.  replaces slot i.  the retired tables that have it get it too, since a reader
+	// may still be indexing one of them
+	void set(size_type i, const T& entry)
+	{
+		assert(i < size());
+		for (const retired_table &retired : m_retired)
+		{
+			if (i < retired.count)
+			{
+				retired.table[i].store(entry, std::memory_order_release);
+			}
+		}
+		m_table.load(std::memory_order_relaxed)[i].store(entry, std::memory_order_release);
+	}
+
+	// writer only.  the caller owns the segments and frees them first
+	void clear()
+	{
+		m_count.store(0, std::memory_order_release);
+	}
+
+	// not safe with concurrent readers
+	void swap(segment_directory &rhs)
+	{
+		slot_type* table = m_table.load();
+		m_table.store(rhs.m_table.load());
+		rhs.m_table.store(table);
+
+		size_type count = m_count.load();
+		m_count.store(rhs.m_count.load());
+		rhs.m_count.store(count);
+
+		std::swap(m_capacity, rhs.m_capacity);
+		m_retired.swap(rhs.m_retired);
+	}
+
+private:
+	struct retired_table
+	{
+		slot_type*	table;
+		size_type	count;		// slots that were in use when it was retired
+	};
+
+	std::atomic<slot_type*>		m_table;
+	std::atomic<size_type>		m_count;
+	size_type					m_capacity;
+	std::vector<retired_table>	m_retired;
+};
@@ -1,5 +1,5 @@
 #pragma once 
-#include <list>
+#include <limits>
 #include <algorithm>
 #include <atomic>
 #include <thread>
@@ -7,17 +7,90 @@
 #include <cstring>
 #include "log.h"
 #include "platform.h"
+#include "segment_directory.h"
+#include "cold_segments.h"
 
 
 typedef uint32_t SegmentSizeType;
 
 template <typename T, SegmentSizeType SegmentSize, typename A = std::allocator<T>> struct segmented_list;
 
+// segment_layout: which segment a list wide index is in.
+//
+//  * most histories only ever hold a sample or two, so segments are allocated when the first item
+//    lands in them, and the first ones are small: 4, 16, 64, ... growing by 4x until they reach
+//    SegmentSize.  every segment after that is SegmentSize.
+//  * the layout only depends on the index, so lists with the same SegmentSize line up segment
+//    for segment (copies and compares work a segment at a time).
+//
+template <SegmentSizeType SegmentSize>
+struct segment_layout
+{
+	static const SegmentSizeType FIRST_SEGMENT_SIZE = 4;
+
+	static constexpr SegmentSizeType count_small_segments(SegmentSizeType capacity)
+	{
+		return capacity >= SegmentSize ? 0 : 1 + count_small_segments(capacity * 4);
+	}
+
+	static constexpr SegmentSizeType count_small_items(SegmentSizeType capacity)
+	{
+		return capacity >= SegmentSize ? 0 : capacity + count_small_items(capacity * 4);
+	}
+
+	static const SegmentSizeType NUM_SMALL_SEGMENTS = count_small_segments(FIRST_SEGMENT_SIZE);
+	static const SegmentSizeType NUM_SMALL_ITEMS = count_small_items(FIRST_SEGMENT_SIZE);
+
+	static SegmentSizeType capacity(SegmentSizeType segment)
+	{
+		if (segment < NUM_SMALL_SEGMENTS)
+			return FIRST_SEGMENT_SIZE << (2 * segment);
+		return SegmentSize;
+	}
+
+	// list wide index of the first item in segment
+	static size_t first_index(SegmentSizeType segment)
+	{
+		if (segment < NUM_SMALL_SEGMENTS)
+			return FIRST_SEGMENT_SIZE * ((size_t(1) << (2 * segment)) - 1) / 3;
+		return NUM_SMALL_ITEMS + size_t(segment - NUM_SMALL_SEGMENTS) * SegmentSize;
+	}
+
+	// long histories are past the small segments, so that's checked first
+	static void locate(size_t i, SegmentSizeType *segment, SegmentSizeType *offset)
+	{
+		if (i >= NUM_SMALL_ITEMS)
+		{
+			size_t j = i - NUM_SMALL_ITEMS;
+			*segment = SegmentSizeType(NUM_SMALL_SEGMENTS + j / SegmentSize);
+			*offset = SegmentSizeType(j % SegmentSize);
+			return;
+		}
+		SegmentSizeType s = 0;
+		while (first_index(s + 1) <= i)
+		{
+			s++;
+		}
+		*segment = s;
+		*offset = SegmentSizeType(i - first_index(s));
+	}
+
+	// number of segments holding count items
+	static SegmentSizeType num_segments(size_t count)
+	{
+		if (count == 0)
+			return 0;
+		SegmentSizeType segment, offset;
+		locate(count - 1, &segment, &offset);
+		return segment + 1;
+	}
+};
+
 template <typename T, typename A = std::allocator<T>>
 using segmented_list_1024 = segmented_list<T, 1024, A>;
 
 
-template <typename T, typename SegmentContainerIterator, uint32_t SegmentSize, typename A = std::allocator<T>>
+template <typename T, typename ListPointer, uint32_t SegmentSize, typename A = std::allocator<T>>
 struct segmented_list_iterator;
 
 template <typename T, SegmentSizeType SegmentSize, typename A>
@@ -33,9 +106,13 @@ public:
 	typedef SegmentSizeType		size_type;
 
 	// internal:
-	typedef std::list<T*, A>	segment_container_type;
-	typedef std::list<const T*, A> const_segment_container_type;
-	typedef typename segment_container_type::const_iterator segment_iterator_type;
+	// segments are found through a directory so indexing, back() and end() don't walk anything.
+	// readers can index it while the writer appends (see segment_directory.h).  segments are
+	// allocated lazily and grow from small to SegmentSize (see segment_layout).  full segments
+	// can be compressed (compress_segments), which nulls their slot in the directory
+	typedef segment_directory<T*>	segment_container_type;
+	typedef segment_layout<SegmentSize> layout;
+	typedef const segmented_list *segment_iterator_type;
 	
 	typedef segmented_list_iterator<T, segment_iterator_type, SegmentSize, A> iterator;
 	typedef segmented_list_iterator<const T, segment_iterator_type, SegmentSize, A> const_iterator;
@@ -49,16 +126,16 @@ public:
 		rc = m_size == rhs.m_size;
 		if (rc)
 		{
-			auto iter_l = m_segment_container.begin();
-			auto iter_r = rhs.m_segment_container.begin();
+			size_type segment = 0;
 			size_type items_left_to_compare = m_size;
 			while (items_left_to_compare && rc)
 			{
-				size_type items_to_compare_in_this_container = std::min<size_type>(items_left_to_compare, SegmentSize);
+				size_type items_to_compare_in_this_container = std::min<size_type>(items_left_to_compare, layout::capacity(segment));
 				items_left_to_compare -= items_to_compare_in_this_container;
-				rc = std::equal(*iter_l, *iter_l + items_to_compare_in_this_container, *iter_r);
-				++iter_l;
-				++iter_r;
+				const T *lhs_segment = segment_data(segment);
+				const T *rhs_segment = rhs.segment_data(segment);
+				rc = std::equal(lhs_segment, lhs_segment + items_to_compare_in_this_container, rhs_segment);
+				++segment;
 			}
 		}
 		
@@ -82,129 +159,121 @@ public:
 
 	const T&back() const
 	{
-		return begin()[m_size - 1];		// TODO: faster way by looking at end
+		return (*this)[m_size - 1];
 	}
 
 	T&back()
 	{
-		return begin()[m_size - 1];		// TODO: faster way by looking at end
+		return (*this)[m_size - 1];
 	}
 
 	iterator begin() 
 	{
-		return{ m_segment_container.begin(), 0, 0 };
+		return{ this, 0 };
 	}
 
 	const_iterator begin() const
 	{
-		return{ m_segment_container.begin(), 0, 0 };
+		return{ this, 0 };
 	}
 
-	const_iterator cbegin() const { return{ m_segment_container.begin(), 0, 0 }; }
+	const_iterator cbegin() const { return{ this, 0 }; }
 	const_iterator cend()	const { return end(); }
 
 	T& operator[] (size_type i) 
 	{
-		return begin()[i];
+		return *address(i);
 	}
 
 	const T& operator[] (size_type i) const
 	{
-		return begin()[i];
-	}
-
-	template <typename iterator_type>
-	iterator_type find_end(iterator_type begin) const
-	{
-		// figuring out the end without locking the writer isn't that easy
-		// if i can grab the end use it. otherwise fall back to linear search
-		std::atomic<size_type> size_before;
-		size_before.store(m_size);
-		auto the_end = m_segment_container.end();
-		
-		if (size_before == m_size) // <-- if this is true, then the_end I got is a good one
-		{
-			the_end--;
-			iterator_type it2{ the_end, size_before / SegmentSize, size_before };
-			return it2;
-		}
-		else
-		{
-			iterator_type it(begin);
-			it.change_index(m_size);
-			return it;
-		}
+		return *address(i);
 	}
 
+	// the writer publishes a segment before the size that reaches into it, so the end
+	// is just the size.  the end isn't dereferenceable: it's segment may not be allocated yet
 	const_iterator end() const
 	{
-		return find_end<const_iterator>(begin());
+		return{ this, m_size };
 	}
 
 	iterator end() 
 	{
-		return find_end<iterator>(begin());
+		return{ this, m_size };
 	}
 
+	// nothing is allocated until the first item is added
 	explicit segmented_list(A alloc = A())
-		:	m_segment_container(alloc),
-			m_size(0)
+		:	m_allocator(alloc),
+			m_size(0),
+			m_cold(nullptr)
 	{
-		add_segment();
 	}
   
 	explicit segmented_list(size_type count, const A& alloc = A())
-		: m_segment_container(alloc)
+		:	m_allocator(alloc),
+			m_size(0),
+			m_cold(nullptr)
 	{
-		size_type num_required_segments = count / SegmentSize + 1;
-		for (size_t i = m_segment_container.size(); i < num_required_segments; i++)
-		{
-			add_segment();
-		}
+		reserve(count);
 		m_size = count;
 	}
 
 	segmented_list(const segmented_list &rhs)			// "select on container copy construction" is to choose the correct allocator to use
-		: m_segment_container(std::allocator_traits<A>::select_on_container_copy_construction(rhs.get_allocator()))
+		:	m_allocator(std::allocator_traits<A>::select_on_container_copy_construction(rhs.get_allocator())),
+			m_size(0),
+			m_cold(nullptr)
 	{
-		m_segment_container.clear();
 		copy_segments(*this, rhs); // copy_segments updates m_size
 	}
 
 	explicit segmented_list(const segmented_list &rhs, const A& alloc)
-		: m_segment_container(alloc)
+		:	m_allocator(alloc),
+			m_size(0),
+			m_cold(nullptr)
 	{
-		m_segment_container.clear();
 		copy_segments(*this, rhs); // copy_segments updates m_size
 	}
 
 	// If alloc is not provided, allocator is obtained by move - construction from the allocator belonging to other.
 	segmented_list(segmented_list &&rhs)			// "select on container copy construction" is to choose the correct allocator to use
-		: m_segment_container(std::move(rhs.m_segment_container))
+		:	m_allocator(std::move(rhs.m_allocator)),
+			m_cold(nullptr)
 	{
 		size_type tmp = rhs.m_size;
 		m_size = tmp;
-		rhs.m_segment_container.clear();
+		m_segment_container.swap(rhs.m_segment_container);
+		m_cold.store(rhs.m_cold.exchange(nullptr));
 		rhs.m_size = 0;
 	}
 
+	// the segments can only be taken over if they came from an equal allocator
 	segmented_list(segmented_list &&rhs, const A& alloc)
-		:
-		m_segment_container(std::move(rhs.m_segment_container), alloc)  
+		:	m_allocator(alloc),
+			m_size(0),
+			m_cold(nullptr)
 	{
 		log_printf("the one i wanted to test");
-		size_type tmp = rhs.m_size;
-		m_size = tmp;
-		rhs.m_segment_container.clear();
-		rhs.m_size = 0;
+		if (m_allocator == rhs.m_allocator)
+		{
+			size_type tmp = rhs.m_size;
+			m_size = tmp;
+			m_segment_container.swap(rhs.m_segment_container);
+			m_cold.store(rhs.m_cold.exchange(nullptr));
+			rhs.m_size = 0;
+		}
+		else
+		{
+			copy_segments(*this, rhs);
+		}
 	}
 
 	template< class InputIt >
 	segmented_list(InputIt first, InputIt last, const A& alloc = A())
-		: m_segment_container(alloc),
-			m_size(0)
+		:	m_allocator(alloc),
+			m_size(0),
+			m_cold(nullptr)
 	{
-		add_segment();
 		while (first != last)
 		{
 			emplace_back(*first);
@@ -218,47 +287,57 @@ public:
 
 	~segmented_list()
 	{
-		for (auto iter = m_segment_container.begin();
-			iter != m_segment_container.end();
-			iter++)
+		release_cold();
+		for (size_type i = 0; i < m_segment_container.size(); i++)
 		{
-			get_allocator().deallocate(*iter, SegmentSize);
+			T *segment = m_segment_container[i];
+			if (segment)
+			{
+				m_allocator.deallocate(segment, layout::capacity(i));
+			}
 		}
 	}
 
 	void clear()
 	{
-		// erase everything but one
-		auto erase_start = m_segment_container.begin();
-		erase_start++;
-		for (auto iter = erase_start; iter != m_segment_container.end(); iter++)
+		// erase everything but the first (small) segment
+		m_size = 0;
+		release_cold();
+		size_type num_segments = m_segment_container.size();
+		if (num_segments <= 1)
 		{
-			get_allocator().deallocate(*iter, SegmentSize);
+			return;
 		}
-		m_segment_container.erase(erase_start, m_segment_container.end());
-		m_size = 0;
+		T *first = m_segment_container[0];
+		for (size_type i = 1; i < num_segments; i++)
+		{
+			T *segment = m_segment_container[i];
+			if (segment)
+			{
+				m_allocator.deallocate(segment, layout::capacity(i));
+			}
+		}
+		m_segment_container.clear();
+		m_segment_container.push_back(first);
 	}
 
+	// only the segments holding items are copied, so a copy doesn't carry over reserved space
 	void copy_segments(segmented_list& lhs, const segmented_list& rhs)
 	{
-		lhs.m_size.store(rhs.m_size);
-		auto lhs_iter = lhs.m_segment_container.begin();
-		for (auto segment = rhs.m_segment_container.begin(); segment != rhs.m_segment_container.end(); segment++)
+		size_type rhs_size = rhs.m_size;
+		size_type rhs_segments = layout::num_segments(rhs_size);
+		for (size_type i = 0; i < rhs_segments; i++)
 		{
-			const value_type *dest = *segment;
-			T *buf;
-			if (lhs_iter != lhs.m_segment_container.end())
-			{
-				buf = *lhs_iter;
-				++lhs_iter;
-			}
-			else
+			const value_type *src = rhs.segment_data(i);
+			if (i == lhs.m_segment_container.size())
 			{
-				buf = get_allocator().allocate(SegmentSize);
-				lhs.m_segment_container.push_back(buf);
+				lhs.add_segment();
 			}
-			memcpy(buf, dest, SegmentSize * sizeof(value_type));	// copy data from rhs segment to lhs buf
+			T *buf = lhs.m_segment_container[i];
+			size_type count = std::min<size_type>(layout::capacity(i), size_type(rhs_size - layout::first_index(i)));
+			memcpy(buf, src, count * sizeof(value_type));	// copy data from rhs segment to lhs buf
 		}
+		lhs.m_size.store(rhs_size);
 	}
 
 	segmented_list& operator=(const segmented_list& rhs) 
@@ -284,6 +363,8 @@ public:
 		m_size.store(rhs.m_size);
 		rhs.m_size.store(tmp);
 		m_segment_container.swap(rhs.m_segment_container);
+		m_cold.store(rhs.m_cold.exchange(m_cold.load()));
+		std::swap(m_allocator, rhs.m_allocator);
 	}
 
 	bool empty() const
@@ -298,118 +379,225 @@ public:
 
 	size_type max_size() const
 	{
-		return std::min(
-			std::numeric_limits<size_type>::max() / sizeof(value_type),	// memory size
-			m_segment_container.max_size() * SegmentSize); // max number of segments limited by segment container
+		return std::numeric_limits<size_type>::max() / sizeof(value_type);	// memory size
 	}
 
 	A get_allocator() const
 	{
-		return m_segment_container.get_allocator();
+		return m_allocator;
 	}
 
-	void add_segment()
+	// items that fit without allocating
+	size_type capacity() const
 	{
-		T* segment = get_allocator().allocate(SegmentSize);
-		if (!segment)
-		{
-			ABORT("alloc failed");
-		}
-		m_segment_container.emplace_back(segment);
+		return size_type(layout::first_index(m_segment_container.size()));
 	}
 
-	void grow_if_necessary()
+	// allocates the segments up to new_cap now, so appends below it don't allocate
+	void reserve(size_type new_cap)
 	{
-		if ((m_size + 1) % SegmentSize == 0)
+		size_type num_required_segments = layout::num_segments(new_cap);
+		while (m_segment_container.size() < num_required_segments)
 		{
 			add_segment();
 		}
 	}
 
-	void reserve(size_type new_cap)
-	{
-		// todo: support reserve.  can't do it because
-		// some code (like emplace back and pushback below)
-		// assume indices into the last container
-	}
-
+	// the segment is published (see segment_directory.h) before the size that reaches into it
 	template<typename... Args> 
 	void emplace_back(Args&&... args)
 	{
-		T* buf = &m_segment_container.back()[m_size % SegmentSize];
+		T* buf = append_address();
 		new(buf) T(std::forward<Args>(args)...);
-		grow_if_necessary();
-		m_size++;
+		m_size.store(m_size + 1, std::memory_order_release);
 	}
 
 	void push_back(const T& value)
 	{
-		T* buf = &m_segment_container.back()[m_size % SegmentSize];
+		T* buf = append_address();
 		new(buf) T(value);
-		grow_if_necessary();
-		m_size++;
+		m_size.store(m_size + 1, std::memory_order_release);
+	}
+
+	// compresses the full segments, oldest first, while is_cold(the segment's last item) and the
+	// cache's pass has room (see cold_segments.h).  segments that were compressed by the last call
+	// are freed first.  not concurrent with appends
+	template <typename IsCold>
+	void compress_segments(cold_segment_cache *cache, IsCold is_cold)
+	{
+		cold_state *cold = m_cold.load(std::memory_order_relaxed);
+		if (cold)
+		{
+			for (T *segment : cold->retired)
+			{
+				m_allocator.deallocate(segment, SegmentSize);
+			}
+			cold->retired.clear();
+		}
+
+		size_type size = m_size;
+		size_type segment = cold ? cold->next_segment : layout::NUM_SMALL_SEGMENTS;
+		for (; layout::first_index(segment) + SegmentSize <= size; segment++)
+		{
+			T *data = m_segment_container[segment];
+			if (!is_cold(data[SegmentSize - 1]) || !cache->pass_has_room())
+			{
+				break;
+			}
+			if (!cold)
+			{
+				cold = new cold_state(cache);
+				m_cold.store(cold, std::memory_order_release);
+			}
+			while (cold->segments.size() < segment)
+			{
+				cold->segments.push_back(nullptr);
+			}
+			cold_segment *compressed = cache->compress(data, uint32_t(SegmentSize * sizeof(T)));
+			cold->segments.push_back(compressed);
+			if (compressed)
+			{
+				// readers that see the null slot find the compressed segment
+				m_segment_container.set(segment, nullptr);
+				cold->retired.push_back(data);
+			}
+		}
+		if (cold)
+		{
+			cold->next_segment = segment;
+		}
+	}
+
+	// internal: the items of a segment, decompressed if it's cold.  iterators use this
+	T *segment_data(size_type segment) const
+	{
+		T *data = m_segment_container[segment];
+		if (!data)
+		{
+			const cold_state *cold = m_cold.load(std::memory_order_acquire);
+			data = static_cast<T *>(const_cast<void *>(cold->cache->lookup(cold->segments[segment])));
+		}
+		return data;
+	}
+
+	T *address(size_type i) const
+	{
+		size_type segment, offset;
+		layout::locate(i, &segment, &offset);
+		return segment_data(segment) + offset;
 	}
 
 private:
+	// compressed segments.  only lists that have had full segments looked at have one
+	struct cold_state
+	{
+		explicit cold_state(cold_segment_cache *c)
+			:	cache(c),
+				next_segment(layout::NUM_SMALL_SEGMENTS)
+		{}
+		cold_segment_cache *cache;
+		segment_directory<cold_segment *> segments;	// by segment index.  null while it's hot
+		size_type next_segment;						// the first one compress_segments hasn't compressed
+		std::vector<T *> retired;					// compressed by the last compress_segments
+	};
+
+	void release_cold()
+	{
+		cold_state *cold = m_cold.load();
+		if (!cold)
+		{
+			return;
+		}
+		for (size_type i = 0; i < cold->segments.size(); i++)
+		{
+			cold_segment *segment = cold->segments[i];
+			if (segment)
+			{
+				cold->cache->release(segment);
+			}
+		}
+		for (T *segment : cold->retired)
+		{
+			m_allocator.deallocate(segment, SegmentSize);
+		}
+		delete cold;
+		m_cold.store(nullptr);
+	}
+
+	void add_segment()
+	{
+		T* segment = m_allocator.allocate(layout::capacity(m_segment_container.size()));
+		if (!segment)
+		{
+			ABORT("alloc failed");
+		}
+		m_segment_container.push_back(segment);
+	}
+
+	// where the next item goes, allocating it's segment if it's the first item in it
+	T *append_address()
+	{
+		size_type segment, offset;
+		layout::locate(m_size, &segment, &offset);
+		if (segment == m_segment_container.size())
+		{
+			add_segment();
+		}
+		return m_segment_container[segment] + offset;
+	}
+
+	A							m_allocator;
 	segment_container_type		m_segment_container;
 	std::atomic<size_type>		m_size;
+	std::atomic<cold_state *>	m_cold;
 };
 
 // difference type - a type that can hold the distance between two iterators
-template <typename T, typename SegmentContainerIterator, uint32_t SegmentSize, typename A>
+template <typename T, typename ListPointer, uint32_t SegmentSize, typename A>
 struct segmented_list_iterator : std::iterator<std::random_access_iterator_tag, T, std::ptrdiff_t>
 {
 	typedef size_t			size_type;
 	typedef std::ptrdiff_t		difference_type;
 	typedef T&				reference;
 
-	SegmentContainerIterator _segment;			// pointer to current segment
-	size_type				 _segment_index;		// 0..n-1 segment index
-	size_type				 _listwide_index;				// index into the entire list
+	ListPointer				_list;
+	size_type				_listwide_index;	// index into the entire list
 
 	segmented_list_iterator()
 	{}
 
-	segmented_list_iterator(const SegmentContainerIterator &segment, size_type segment_index, size_type listwide_index)
-		: _segment(segment), _segment_index(segment_index), _listwide_index(listwide_index)
+	segmented_list_iterator(const ListPointer &list, size_type listwide_index)
+		: _list(list), _listwide_index(listwide_index)
 	{}
 
 	segmented_list_iterator(const segmented_list_iterator &rhs)
-		: _segment(rhs._segment), _segment_index(rhs._segment_index), _listwide_index(rhs._listwide_index)
+		: _list(rhs._list), _listwide_index(rhs._listwide_index)
 	{
 	}
 
 	segmented_list_iterator& operator=(const segmented_list_iterator &rhs)
 	{
-		_segment = rhs._segment;
-		_segment_index = rhs._segment_index;
+		_list = rhs._list;
 		_listwide_index = rhs._listwide_index;
 		return *this;
 	}
 
 	segmented_list_iterator& operator=(segmented_list_iterator &&rhs)
 	{
-		_segment = rhs._segment;
-		_segment_index = rhs._segment_index;
+		_list = rhs._list;
 		_listwide_index = rhs._listwide_index;
 		return *this;
 	}
 
-	// adjust segment for the current index value
+	// the segment is looked up when the iterator is dereferenced, so moving is just arithmetic
 	void change_index(size_type listwide_index)
 	{
 		_listwide_index = listwide_index;
-		size_type correct_segment = listwide_index / SegmentSize;
-		while (_segment_index < correct_segment)
-		{
-			_segment++;
-			_segment_index++;
-		}
-		while (_segment_index > correct_segment)
-		{
-			_segment--;
-			_segment_index--;
-		}
+	}
+
+	T *get_address() const
+	{
+		return _list->address(SegmentSizeType(_listwide_index));
 	}
 	
 
@@ -481,26 +669,22 @@ struct segmented_list_iterator : std::iterator<std::random_access_iterator_tag,
 
 	T * operator->()
 	{
-		T* base_addr = *_segment;
-		return base_addr + _listwide_index % SegmentSize;
+		return get_address();
 	}
 
 	const T * operator->() const
 	{
-		T* base_addr = *_segment;
-		return base_addr + _listwide_index % SegmentSize;
+		return get_address();
 	}
 
 	T & operator *()
 	{
-		T* base_addr = *_segment;
-		return *(base_addr + _listwide_index % SegmentSize);
+		return *get_address();
 	}
 
 	const T & operator *() const
 	{
-		const T* base_addr = *_segment;
-		return *(base_addr + _listwide_index % SegmentSize);
+		return *get_address();
 	}
 
 	bool operator != (segmented_list_iterator &rhs) const
@@ -536,16 +720,16 @@ struct segmented_list_iterator : std::iterator<std::random_access_iterator_tag,
 
 
 
-template <typename T, typename SegmentContainerIterator, uint32_t SegmentSize, typename A = std::allocator<T>>
-inline bool operator==(const segmented_list_iterator<T, SegmentContainerIterator,SegmentSize,A>& a,
-	const  segmented_list_iterator<T, SegmentContainerIterator, SegmentSize, A>& b)
+template <typename T, typename ListPointer, uint32_t SegmentSize, typename A = std::allocator<T>>
+inline bool operator==(const segmented_list_iterator<T, ListPointer, SegmentSize, A>& a,
+	const  segmented_list_iterator<T, ListPointer, SegmentSize, A>& b)
 {
 	return a._listwide_index == b._listwide_index;
 }
 
-template <typename T, typename SegmentContainerIterator, uint32_t SegmentSize, typename A = std::allocator<T>>
-inline bool operator!=(const segmented_list_iterator<T, SegmentContainerIterator, SegmentSize, A>& a,
-	const  segmented_list_iterator<T, SegmentContainerIterator, SegmentSize, A>& b)
+template <typename T, typename ListPointer, uint32_t SegmentSize, typename A = std::allocator<T>>
+inline bool operator!=(const segmented_list_iterator<T, ListPointer, SegmentSize, A>& a,
+	const  segmented_list_iterator<T, ListPointer, SegmentSize, A>& b)
 {
 	return a._listwide_index != b._listwide_index;
 }
@@ -1,11 +1,203 @@
 #include "slab_allocator.h"
+#include <atomic>
 
 int slab_allocator_base::slab_allocators_constructed;
 int slab_allocator_base::slab_allocators_destroyed;
-int slab_allocator_base::slab_allocators_leaks;
 slab* slab_allocator_base::m_temp_slab;
 
-int slab::slab_num_slabs;
-int slab::slab_total_slab_page_allocs;
-int slab::slab_total_slab_page_frees;
+std::atomic<int> slab::slab_num_slabs;
+std::atomic<int> slab::slab_total_slab_page_allocs;
+std::atomic<int> slab::slab_total_slab_page_frees;
 
+thread_local slab *slab::t_current;
+
+// the slab this thread last used, and it's heap in it
+namespace
+{
+	struct thread_heap_cache
+	{
+		uint64_t slab_id;
+		void *heap;
+	};
+	thread_local thread_heap_cache t_heap_cache = { 0, nullptr };
+	std::atomic<uint64_t> s_next_slab_id(1);
+}
+
+slab::slab(int page_size_in)
+	:	page_size(page_size_in),
+		m_id(s_next_slab_id++),
+		m_large(nullptr),
+		m_num_large(0)
+{
+	assert(size_t(page_size) >= MAX_CLASS_BYTES);
+	slab_num_slabs++;
+}
+
+slab::~slab()
+{
+	for (thread_heap *heap : m_heaps)
+	{
+		for (page_header *page = heap->pages; page;)
+		{
+			page_header *next = page->next;
+			free(page);
+			slab_total_slab_page_frees += 1;
+			page = next;
+		}
+		delete heap;
+	}
+	for (large_header *block = m_large; block;)
+	{
+		large_header *next = block->next;
+		free(block);
+		block = next;
+	}
+	slab_num_slabs--;
+}
+
+slab::thread_heap *slab::get_thread_heap()
+{
+	thread_heap_cache &cache = t_heap_cache;
+	if (cache.slab_id == m_id)
+	{
+		return static_cast<thread_heap *>(cache.heap);
+	}
+	thread_heap *heap = find_thread_heap();
+	cache.slab_id = m_id;
+	cache.heap = heap;
+	return heap;
+}
+
+// the first time this thread uses the slab, or since it last used another one
+slab::thread_heap *slab::find_thread_heap()
+{
+	std::thread::id thread = std::this_thread::get_id();
+	tbb::spin_mutex::scoped_lock lock(m_lock);
+	for (thread_heap *heap : m_heaps)
+	{
+		if (heap->thread == thread)
+		{
+			return heap;
+		}
+	}
+	thread_heap *heap = new thread_heap;
+	heap->thread = thread;
+	heap->pos = nullptr;
+	heap->end = nullptr;
+	heap->pages = nullptr;
+	heap->num_pages = 0;
+	memset(heap->free_lists, 0, sizeof(heap->free_lists));
+	heap->num_alloc_calls = 0;
+	heap->num_dealloc_calls = 0;
+	heap->num_reused = 0;
+	m_heaps.push_back(heap);
+	return heap;
+}
+
+// what's left of the last page is given up.  the header goes in front, so page_size is all
+// for blocks
+void slab::new_page(thread_heap *heap)
+{
+	page_header *page = static_cast<page_header *>(malloc(sizeof(page_header) + page_size));
+	if (!page)
+	{
+		throw std::bad_alloc();
+	}
+	slab_total_slab_page_allocs += 1;
+	page->next = heap->pages;
+	heap->pages = page;
+	heap->num_pages++;
+	heap->pos = reinterpret_cast<char *>(page + 1);
+	heap->end = heap->pos + page_size;
+}
+
+void *slab::large_alloc(size_t size)
+{
+	large_header *block = static_cast<large_header *>(malloc(sizeof(large_header) + size));
+	if (!block)
+	{
+		throw std::bad_alloc();
+	}
+	tbb::spin_mutex::scoped_lock lock(m_lock);
+	block->prev = nullptr;
+	block->next = m_large;
+	if (m_large)
+	{
+		m_large->prev = block;
+	}
+	m_large = block;
+	m_num_large++;
+	return block + 1;
+}
+
+void slab::large_dealloc(void *p)
+{
+	large_header *block = static_cast<large_header *>(p) - 1;
+	{
+		tbb::spin_mutex::scoped_lock lock(m_lock);
+		if (block->prev)
+		{
+			block->prev->next = block->next;
+		}
+		else
+		{
+			m_large = block->next;
+		}
+		if (block->next)
+		{
+			block->next->prev = block->prev;
+		}
+		m_num_large--;
+	}
+	free(block);
+}
+
+int slab::get_num_threads() const
+{
+	return int(m_heaps.size());
+}
+
+int slab::get_num_pages() const
+{
+	int num_pages = 0;
+	for (thread_heap *heap : m_heaps)
+	{
+		num_pages += heap->num_pages;
+	}
+	return num_pages;
+}
+
+uint64_t slab::get_num_alloc_calls() const
+{
+	uint64_t num = 0;
+	for (thread_heap *heap : m_heaps)
+	{
+		num += heap->num_alloc_calls;
+	}
+	return num;
+}
+
+uint64_t slab::get_num_dealloc_calls() const
+{
+	uint64_t num = 0;
+	for (thread_heap *heap : m_heaps)
+	{
+		num += heap->num_dealloc_calls;
+	}
+	return num;
+}
+
+uint64_t slab::get_num_reused() const
+{
+	uint64_t num = 0;
+	for (thread_heap *heap : m_heaps)
+	{
+		num += heap->num_reused;
+	}
+	return num;
+}
+
+uint64_t slab::get_num_large() const
+{
+	return m_num_large;
+}
@@ -1,80 +1,205 @@
-// allocates pages of memory.
-// includes an allocator
-// does not implement free
-
-// rangesplay.cpp : Defines the entry point for the console application.
+// slab: an arena for the containers of one capture (capture::m_slab)
+//
+//  * each thread bumps through it's own pages of the slab, so allocating doesn't take a lock.
+//    a thread finds it's pages through a thread local cache, and only locks the slab the first
+//    time it uses it.
+//  * freed blocks go on the freeing thread's free list for their size class, and it's next
+//    allocations of that class reuse them.  so the buffers vectors leave behind when they grow
+//    are reused rather than leaked.
+//  * blocks over the largest class come from the heap (under a lock) and go back to it.
+//  * the pages and the large blocks are chained through a header in front of them, so growing a
+//    slab mallocs what it hands out and nothing else.
+//  * everything is released in bulk when the slab is destroyed.  the capture declares it first so
+//    it goes last.
+//  * slab_allocator takes the slab that's current on the thread when it's made (slab::scope,
+//    see capture and named_task_group), or else slab_allocator_base::m_temp_slab, or else the
+//    heap.  container copies take the current one too (select_on_container_copy_construction),
+//    so a copy of a capture doesn't point into the source's slab.
 //
 
 #pragma once
 #include <assert.h>
-#include <forward_list>
+#include <stdint.h>
 #include <cstring>
 #include <cstdlib>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
 #include "tbb/spin_mutex.h"
 
 struct slab
 {
-	static int slab_num_slabs;
-	static int slab_total_slab_page_allocs;
-	static int slab_total_slab_page_frees;
-	int slab_num_alloc_calls = 0;
-	int slab_num_dealloc_calls = 0;
-
-	std::forward_list<char *> pages;
-	int		page_size;
-	int64_t current_page_pos;
-	tbb::spin_mutex mutex;
-
-	slab(int page_size_in = 1024 * 1024)
-		: page_size(page_size_in)
-	{
-		slab_num_slabs++;
-		current_page_pos = 0;
-		slab_alloc(0);	// allocate the initial page
-	}
+	// updated by whichever threads make slabs and pages
+	static std::atomic<int> slab_num_slabs;
+	static std::atomic<int> slab_total_slab_page_allocs;
+	static std::atomic<int> slab_total_slab_page_frees;
 
+	// size classes: 16 byte steps up to 128, then powers of two up to MAX_CLASS_BYTES
+	static const size_t ALIGNMENT = 16;
+	static const int NUM_STEP_CLASSES = 8;
+	static const int NUM_CLASSES = NUM_STEP_CLASSES + 9;
+	static const size_t MAX_CLASS_BYTES = 64 * 1024;
 
-	~slab()
+	// makes s the slab new allocators on this thread take, until it's ended or goes
+	struct scope
 	{
-		for (auto iter = pages.begin(); iter != pages.end(); iter++)
+		explicit scope(slab *s)
+			:	m_previous(t_current),
+				m_ended(false)
 		{
-			char *mem = *iter;
-			free(mem);
-			slab_total_slab_page_frees += 1;
+			t_current = s;
 		}
-		pages.clear();
-		slab_num_slabs--;
-	}
+		~scope()
+		{
+			end();
+		}
+		void end()
+		{
+			if (!m_ended)
+			{
+				t_current = m_previous;
+				m_ended = true;
+			}
+		}
+		scope(const scope &) = delete;
+		scope& operator=(const scope &) = delete;
+
+	private:
+		slab *m_previous;
+		bool m_ended;
+	};
+
+	static slab *current() { return t_current; }
+
+	// page_size is the bump chunk each thread takes at a time
+	slab(int page_size_in = 1024 * 1024);
+	~slab();
+
+	slab(const slab &) = delete;
+	slab& operator=(const slab &) = delete;
 
 	void *slab_alloc(size_t size)
 	{
-		assert((int)size <= page_size);
-		size = (size + 3) & ~0x3;
-		slab_num_alloc_calls += 1;
+		if (size > MAX_CLASS_BYTES)
+		{
+			return large_alloc(size);
+		}
+		thread_heap *heap = get_thread_heap();
+		heap->num_alloc_calls++;
+		int size_class = get_size_class(size);
+		free_block *block = heap->free_lists[size_class];
+		if (block)
+		{
+			heap->free_lists[size_class] = block->next;
+			heap->num_reused++;
+			return block;
+		}
+		size_t bytes = get_class_bytes(size_class);
+		if (heap->pos + bytes > heap->end)
+		{
+			new_page(heap);
+		}
+		char *ret = heap->pos;
+		heap->pos += bytes;
+		return ret;
+	}
 
-		// critical start
-		mutex.lock();
-		if (pages.empty() || (int)size + current_page_pos > page_size)
+	// size is what was asked for
+	void slab_dealloc(void *p, size_t size)
+	{
+		if (size > MAX_CLASS_BYTES)
 		{
-			current_page_pos = 0;
-			slab_total_slab_page_allocs += 1;
-			char *page = (char *)malloc(page_size);
-			assert(page);
-			pages.push_front(page);
+			large_dealloc(p);
+			return;
 		}
+		thread_heap *heap = get_thread_heap();
+		heap->num_dealloc_calls++;
+		int size_class = get_size_class(size);
+		free_block *block = static_cast<free_block *>(p);
+		block->next = heap->free_lists[size_class];
+		heap->free_lists[size_class] = block;
+	}
 
-		char *ret = pages.front();
-		ret += current_page_pos;
-		current_page_pos += size;
-		// critical end
-		mutex.unlock();
-		return ret;
+	static int get_size_class(size_t size)
+	{
+		if (size <= ALIGNMENT * NUM_STEP_CLASSES)
+		{
+			return size ? int((size - 1) / ALIGNMENT) : 0;
+		}
+		int size_class = NUM_STEP_CLASSES;
+		size_t bytes = 2 * ALIGNMENT * NUM_STEP_CLASSES;
+		while (bytes < size)
+		{
+			bytes *= 2;
+			size_class++;
+		}
+		return size_class;
 	}
 
-	void slab_dealloc()
+	static size_t get_class_bytes(int size_class)
 	{
-		slab_num_dealloc_calls += 1;
+		if (size_class < NUM_STEP_CLASSES)
+		{
+			return (size_class + 1) * ALIGNMENT;
+		}
+		return (2 * ALIGNMENT * NUM_STEP_CLASSES) << (size_class - NUM_STEP_CLASSES);
 	}
+
+	// totals over the threads.  read them when nothing is allocating
+	int get_page_size() const { return page_size; }
+	int get_num_threads() const;
+	int get_num_pages() const;
+	uint64_t get_num_alloc_calls() const;
+	uint64_t get_num_dealloc_calls() const;
+	uint64_t get_num_reused() const;			// allocations served from a free list
+	uint64_t get_num_large() const;				// live heap blocks
+
+private:
+	struct free_block
+	{
+		free_block *next;
+	};
+
+	// in front of each page, and of each large block
+	struct alignas(ALIGNMENT) page_header
+	{
+		page_header *next;
+	};
+
+	struct alignas(ALIGNMENT) large_header
+	{
+		large_header *prev;
+		large_header *next;
+	};
+
+	struct thread_heap
+	{
+		std::thread::id thread;
+		char *pos;
+		char *end;
+		page_header *pages;				// newest first
+		int num_pages;
+		free_block *free_lists[NUM_CLASSES];
+		uint64_t num_alloc_calls;
+		uint64_t num_dealloc_calls;
+		uint64_t num_reused;
+	};
+
+	thread_heap *get_thread_heap();
+	thread_heap *find_thread_heap();
+	void new_page(thread_heap *heap);
+	void *large_alloc(size_t size);
+	void large_dealloc(void *p);
+
+	static thread_local slab *t_current;
+
+	int page_size;
+	uint64_t m_id;						// unique across slabs, for the thread local cache
+	tbb::spin_mutex m_lock;				// the thread heaps and the large blocks
+	std::vector<thread_heap *> m_heaps;
+	large_header *m_large;				// live large blocks
+	uint64_t m_num_large;
 };
 
 
@@ -82,8 +207,13 @@ struct slab_allocator_base
 {
 	static int slab_allocators_constructed;
 	static int slab_allocators_destroyed;
-	static int slab_allocators_leaks;
 	static slab* m_temp_slab;
+
+	static slab *default_slab()
+	{
+		slab *s = slab::current();
+		return s ? s : m_temp_slab;
+	}
 };
 
 template <class T=char>
@@ -93,11 +223,11 @@ public:
 	typedef T*         pointer;
 	typedef const T&   const_reference;
 
-	slab* m_slab;
+	slab* m_slab;		// null: the heap
 
 	// stl likes to make these evil ones for some reason
 	slab_allocator()
-		: m_slab(m_temp_slab)
+		: m_slab(default_slab())
 	{
 		slab_allocators_constructed++;
 	}
@@ -134,26 +264,39 @@ public:
 		slab_allocators_constructed++;
 	}
 
+	// a copy of a container allocates from the slab of where it's being copied to
+	slab_allocator select_on_container_copy_construction() const
+	{
+		return slab_allocator();
+	}
+
 	T* allocate(std::size_t n)
 	{
-		T* p = (T*)m_slab->slab_alloc(n * sizeof(T));
-		return (T*)p;
+		if (!m_slab)
+		{
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+		return static_cast<T*>(m_slab->slab_alloc(n * sizeof(T)));
 	}
 	void deallocate(void * p, std::size_t n)
 	{
-		m_slab->slab_dealloc();
-		slab_allocators_leaks++;
+		if (!m_slab)
+		{
+			::operator delete(p);
+			return;
+		}
+		m_slab->slab_dealloc(p, n * sizeof(T));
 	}
 };
 
 template <class T, class U>
-bool operator==(const slab_allocator<T>&, const slab_allocator<U>&)
+bool operator==(const slab_allocator<T>& a, const slab_allocator<U>& b)
 {
-	return true;
+	return a.m_slab == b.m_slab;
 }
 
 template <class T, class U>
-bool operator!=(const slab_allocator<T>&, const slab_allocator<U>&)
+bool operator!=(const slab_allocator<T>& a, const slab_allocator<U>& b)
 {
-	return false;
-}
\ No newline at end of file
+	return a.m_slab != b.m_slab;
+}
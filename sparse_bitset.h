@@ -0,0 +1,201 @@
+//
+// sparse_bitset: the set of nodes (serialization ids) an update changed
+//
+//  * an update usually changes a handful of nodes out of the whole graph, and their ids can be
+//    anywhere in it: a device discovered late has ids above everything before it.  a plain bitset
+//    is sized by the highest id, so a frame that moves one controller costs num_nodes / 8 bytes.
+//  * so a sparse_bitset is either the sorted ids, or, once that would be bigger, a window of bits
+//    from the block holding the first id to the block holding the last.  assign() picks the
+//    smaller.  nothing below the first id is stored either way.
+//  * it's built once per frame from a scratch bitset (anything with find_first(), find_next() and
+//    npos, eg. VRBitset) and then only read: find_first()/find_next() like the bitset.
+//  * encoded the same way: the ids as varint deltas, the window as it's blocks
+//  * the ids and the window come from the slab that's current when it's made (slab_allocator.h),
+//    so an update that records one takes it from the capture's slab, not the heap.  assign()
+//    sizes the form it picks once, so that's one allocation
+//
+#pragma once
+#include "BaseStream.h"
+#include "history_codec.h"
+#include "slab_allocator.h"
+#include "dynamic_bitset.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+struct sparse_bitset
+{
+	typedef size_t size_type;
+	static const size_type npos = static_cast<size_type>(-1);
+
+	sparse_bitset()
+		: m_offset(0)
+	{}
+
+	template <typename Bitset>
+	explicit sparse_bitset(const Bitset &bits)
+		: m_offset(0)
+	{
+		assign(bits);
+	}
+
+	template <typename Bitset>
+	void assign(const Bitset &bits)
+	{
+		m_offset = 0;
+		m_window.clear();
+		m_ids.clear();
+		size_t num_ids = 0;
+		typename Bitset::size_type first = bits.find_first();
+		typename Bitset::size_type last = first;
+		for (typename Bitset::size_type id = first; id != Bitset::npos; id = bits.find_next(id))
+		{
+			assert(id <= std::numeric_limits<uint32_t>::max());
+			num_ids++;
+			last = id;
+		}
+		if (num_ids == 0)
+		{
+			return;
+		}
+		uint32_t first_block = uint32_t(first / BLOCK_BITS);
+		uint32_t num_blocks = uint32_t(last / BLOCK_BITS) - first_block + 1;
+		if (num_ids * sizeof(uint32_t) > num_blocks * sizeof(uint64_t))
+		{
+			m_offset = first_block * BLOCK_BITS;
+			m_window.resize(num_blocks * BLOCK_BITS);
+			for (typename Bitset::size_type id = first; id != Bitset::npos; id = bits.find_next(id))
+			{
+				m_window.set(id - m_offset);
+			}
+		}
+		else
+		{
+			m_ids.reserve(num_ids);
+			for (typename Bitset::size_type id = first; id != Bitset::npos; id = bits.find_next(id))
+			{
+				m_ids.push_back(uint32_t(id));
+			}
+		}
+	}
+
+	bool none() const { return m_ids.empty() && m_window.none(); }
+	bool is_window() const { return !m_window.empty(); }
+
+	bool test(size_type id) const
+	{
+		if (is_window())
+		{
+			return id >= m_offset && id - m_offset < m_window.size() && m_window.test(id - m_offset);
+		}
+		return std::binary_search(m_ids.begin(), m_ids.end(), uint32_t(id));
+	}
+
+	size_type find_first() const
+	{
+		if (is_window())
+		{
+			return m_offset + m_window.find_first();		// the window starts at a set bit's block
+		}
+		return m_ids.empty() ? npos : m_ids.front();
+	}
+
+	size_type find_next(size_type id) const
+	{
+		if (is_window())
+		{
+			if (id < m_offset)
+			{
+				return find_first();
+			}
+			size_type next = m_window.find_next(id - m_offset);
+			return next == window_type::npos ? npos : m_offset + next;
+		}
+		if (id >= std::numeric_limits<uint32_t>::max())
+		{
+			return npos;
+		}
+		auto iter = std::upper_bound(m_ids.begin(), m_ids.end(), uint32_t(id));
+		return iter == m_ids.end() ? npos : *iter;
+	}
+
+	bool operator==(const sparse_bitset &rhs) const
+	{
+		return m_offset == rhs.m_offset && m_ids == rhs.m_ids && m_window == rhs.m_window;
+	}
+
+	bool operator!=(const sparse_bitset &rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	//	uint8_t form,
+	//	  IDS:    uint32_t num_ids, varint first id, varint delta * (num_ids - 1)
+	//	  WINDOW: uint32_t first_block, int num_blocks, uint64_t block[num_blocks]
+	void encode(BaseStream &e) const
+	{
+		uint8_t form = is_window() ? WINDOW : IDS;
+		e.write_to_stream(&form, sizeof(form));
+		if (form == WINDOW)
+		{
+			uint32_t first_block = m_offset / BLOCK_BITS;
+			e.write_to_stream(&first_block, sizeof(first_block));
+			std::vector<uint64_t> blocks;
+			blocks.reserve(m_window.num_blocks());
+			boost::to_block_range(m_window, std::back_inserter(blocks));
+			e.contiguous_container_out_to_stream(blocks);
+		}
+		else
+		{
+			uint32_t num_ids = size_as_uint32(m_ids.size());
+			e.write_to_stream(&num_ids, sizeof(num_ids));
+			uint32_t prev = 0;
+			for (uint32_t id : m_ids)
+			{
+				history_codec_detail::write_varint(e, id - prev);
+				prev = id;
+			}
+		}
+	}
+
+	void decode(BaseStream &e)
+	{
+		m_offset = 0;
+		m_window.clear();
+		m_ids.clear();
+		uint8_t form;
+		e.read_from_stream(&form, sizeof(form));
+		if (form == WINDOW)
+		{
+			uint32_t first_block;
+			e.read_from_stream(&first_block, sizeof(first_block));
+			std::vector<uint64_t> blocks;
+			e.contiguous_container_from_stream(blocks);
+			m_offset = first_block * BLOCK_BITS;
+			m_window.resize(blocks.size() * BLOCK_BITS);
+			boost::from_block_range(blocks.begin(), blocks.end(), m_window);
+		}
+		else
+		{
+			assert(form == IDS);
+			uint32_t num_ids;
+			e.read_from_stream(&num_ids, sizeof(num_ids));
+			m_ids.resize(num_ids);
+			uint32_t prev = 0;
+			for (uint32_t &id : m_ids)
+			{
+				id = prev + history_codec_detail::read_varint(e);
+				prev = id;
+			}
+		}
+	}
+
+private:
+	typedef boost::dynamic_bitset<uint64_t, slab_allocator<uint64_t>> window_type;
+	static const uint32_t BLOCK_BITS = 64;
+	enum : uint8_t { IDS = 0, WINDOW = 1 };
+
+	uint32_t m_offset;				// id of the window's first bit.  a multiple of BLOCK_BITS
+	window_type m_window;			// empty unless it's a window
+	std::vector<uint32_t, slab_allocator<uint32_t>> m_ids;	// sorted.  empty if it's a window
+};
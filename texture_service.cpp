@@ -9,14 +9,15 @@ texture_service::texture_service()
 {
 	m_num_compressed = 0;
 	m_num_textures_submitted = 0;
+	m_remi = nullptr;	// start() picks the render models
+}
 
-	openvr_broker::open_vr_interfaces interfaces;
-	char *error;
-	if (!openvr_broker::acquire_interfaces("raw", &interfaces, &error))
-	{
-		ABORT("texture service failed to acquire interfaces: %s", error);
-	}
-	m_remi = interfaces.remi;
+texture_service::texture_service(vr::IVRRenderModels *remi)
+	: m_started(false), m_stop_requested(false)
+{
+	m_num_compressed = 0;
+	m_num_textures_submitted = 0;
+	m_remi = remi;
 }
 
 texture_service::~texture_service()
@@ -43,10 +44,25 @@ texture_service &texture_service::operator = (const texture_service &rhs)
 }
 
 
-void texture_service::start()
+void texture_service::start(vr::IVRRenderModels *remi)
 {
 	if (!m_started)
 	{
+		if (remi)
+		{
+			m_remi = remi;
+		}
+		if (!m_remi)
+		{
+			openvr_broker::open_vr_interfaces interfaces;
+			char *error;
+			if (!openvr_broker::acquire_interfaces("raw", &interfaces, &error))
+			{
+				ABORT("texture service failed to acquire interfaces: %s", error);
+			}
+			m_remi = interfaces.remi;
+		}
+
 		m_workers.push_back(std::thread([this]()
 		{
 			load_task();
@@ -209,6 +225,10 @@ void texture_service::compression_task()
 			// done modifying texture
 			tex->unlock();
 
+			// process_all_pending checks the count under the queue lock, so take it before notifying
+			// or the wakeup can land between its check and its wait
+			m_compression_queue_mutex.lock();
+			m_compression_queue_mutex.unlock();
 			m_compression_cv.notify_all(); // do a notify in case there is a wait on compression counts (process_all_pending)
 		}
 		else
@@ -125,12 +125,15 @@ private:
 struct texture_service
 {
 	texture_service();
+	explicit texture_service(vr::IVRRenderModels *remi);	// load from these render models instead of the raw runtime's
 	~texture_service();
 
 	texture_service(const texture_service &rhs);
 	texture_service &operator = (const texture_service &rhs);
 
-	void start();
+	// the workers load from remi if it's given, otherwise from the render models the service was
+	// constructed with, otherwise from the raw runtime's
+	void start(vr::IVRRenderModels *remi = nullptr);
 	void stop();
 	void process_texture(std::shared_ptr<texture> t);
 	void process_all_pending();
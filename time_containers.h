@@ -4,6 +4,13 @@
 #include "range.h"
 #include "range_algorithm.h"
 #include "base_serialization.h"
+#include "history_codec.h"
+#include "log.h"
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+struct cold_segment_cache;	// cold_segments.h
 
 template <typename T>
 struct time_indexed
@@ -55,6 +62,27 @@ private:
 
 
 
+// search hooks for time_indexed_vector.  containers that keep their time indexes in a separate
+// column (columnar_list.h) specialize/overload these so searches don't touch the values
+template <typename Container>
+struct container_has_time_keys : std::false_type {};
+
+// first item with a time index greater than t
+template <typename Container>
+auto container_upper_bound_time(Container &container, time_index_t t) -> decltype(container.begin())
+{
+	typedef typename Container::value_type time_indexed_type;
+	return std::upper_bound(container.begin(), container.end(), time_indexed_type(t),
+		[](const time_indexed_type &a, const time_indexed_type &b) { return a.get_time_index() < b.get_time_index(); });
+}
+
+// same but near is a hint of where the result is (eg. a cursor's last position)
+template <typename Container>
+auto container_upper_bound_time(Container &container, time_index_t t, const decltype(container.begin()) &near) -> decltype(container.begin())
+{
+	return container_upper_bound_time(container, t);
+}
+
 // time_indexed_vector:  a container of items wrapped in time_indexed<T>
 //                       a pretty thin layer
 template <typename T,
@@ -95,6 +123,17 @@ template <typename T,
 	// [start and end)  (half open range)
 	std::range<iterator> get_range(time_index_t a, time_index_t b)
 	{
+		if (container_has_time_keys<container_type_t>::value)
+		{
+			// same result as range_intersect but searches the time index column
+			iterator end_iter = container.end();
+			if (container.empty() || a >= b)
+				return std::range<iterator>(end_iter, end_iter);
+			iterator first = (a == std::numeric_limits<time_index_t>::min()) ? container.begin() : container_upper_bound_time(container, a - 1);
+			if (first == end_iter || first->get_time_index() >= b)
+				return std::range<iterator>(end_iter, end_iter);
+			return std::range<iterator>(first, container_upper_bound_time(container, b));
+		}
 		return range_intersect(get_range(), time_indexed_type(a), time_indexed_type(b),
 			[](const time_indexed_type &a, const time_indexed_type &b) { return a.get_time_index() < b.get_time_index(); });
 	}
@@ -111,8 +150,14 @@ template <typename T,
 
 	iterator last_item_less_than_or_equal_to_time(time_index_t a)
 	{
-		return last_item_less_than_or_equal_to(container.begin(), container.end(), time_indexed_type(a),
-			[](const time_indexed_type &a, const time_indexed_type &b) { return a.get_time_index() < b.get_time_index(); });
+		iterator it = container_upper_bound_time(container, a);
+		if (it != container.begin()) {
+			--it; // not at the start so rewind to previous item
+		}
+		else {
+			it = container.end(); // no items before this point, so return end()
+		}
+		return it;
 	}
 
 	// check the hint iterator first before searching for it
@@ -125,6 +170,16 @@ template <typename T,
 			{
 				return hint_iterator;
 			}
+			else if (container_has_time_keys<container_type_t>::value)
+			{
+				// search the time index column and only walk the values from the hint
+				iterator it = container_upper_bound_time(container, a, hint_iterator);
+				if (it != container.begin())
+					--it;
+				else
+					it = container.end();
+				return it;
+			}
 			else if (hint_index < a)
 			{
 				return last_item_less_than_or_equal_to(hint_iterator, container.end(), time_indexed_type(a),
@@ -142,6 +197,22 @@ template <typename T,
 	}
 
 
+	// entry recorded exactly at time a or nullptr.  updates append, so check the latest first
+	const time_indexed_type *find_entry(time_index_t a) const
+	{
+		if (container.empty())
+			return nullptr;
+		if (container.back().get_time_index() == a)
+			return &container.back();
+		auto iter = container_upper_bound_time(container, a);
+		if (iter == container.begin())
+			return nullptr;
+		--iter;
+		if (iter->get_time_index() != a)
+			return nullptr;
+		return &*iter;
+	}
+
 	template<typename... Args>
 	void emplace_back(time_index_t time_index, Args&&... args)
 	{
@@ -153,10 +224,29 @@ template <typename T,
 		container.push_back(val);
 	}
 
+	// compresses the full segments that only hold samples from up to time index t (see
+	// cold_segments.h).  not concurrent with appends
+	void compress_cold_segments(time_index_t t, cold_segment_cache *cache)
+	{
+		container.compress_segments(cache, [t](const time_indexed_type &v) { return v.get_time_index() <= t; });
+	}
+
 	// write just the value out to the stream
 	void encode(BaseStream &e) const 
 	{
 		base::url_named::encode(e);
+		encode_values(e, std::integral_constant<bool, history_codec<T>::enabled>());
+	}
+
+	// read the value from the stream
+	void decode(BaseStream &e) 
+	{
+		base::url_named::decode(e);
+		decode_values(e, std::integral_constant<bool, history_codec<T>::enabled>());
+	}
+
+	void encode_values(BaseStream &e, std::false_type) const
+	{
 		int size = size_as_int(container.size());
 		e.write_to_stream(&size, sizeof(size)); // write the container size
 		
@@ -166,11 +256,8 @@ template <typename T,
 		}
 	}
 
-	// read the value from the stream
-	void decode(BaseStream &e) 
+	void decode_values(BaseStream &e, std::false_type)
 	{
-		base::url_named::decode(e);
-
 		container.clear();
 		int size;
 		e.read_from_stream(&size, sizeof(size));
@@ -184,6 +271,20 @@ template <typename T,
 		}
 	}
 
+	// float histories that are delta encoded
+	void encode_values(BaseStream &e, std::true_type) const
+	{
+		history_codec<T>::encode(container, e);
+	}
+
+	void decode_values(BaseStream &e, std::true_type)
+	{
+		if (!history_codec<T>::decode(container, e))
+		{
+			log_printf("%s: corrupt history dropped\n", get_path().c_str());
+		}
+	}
+
 	bool operator==(const time_indexed_vector &rhs) const
 	{
 		if (!base::url_named::operator==(rhs))
@@ -1,104 +1,307 @@
-#pragma once 
+// tmp_vector_pool
+//	buffers for the temporaries that OpenVR queries write into
+//
+//	* three size classes: small (most strings), medium and large (FixedSizeBytes, the most any
+//	  query needs).  a tmp_vector2 starts small and is promoted when it needs more - see reserve()
+//	  and the query helpers in vr_wrappers_common.h.
+//	* each thread keeps a few free buffers of each class, so taking and returning one doesn't
+//	  take a lock.  past that they go back to the pool's lists, under the lock.
+//	* a buffer goes back to the cache of the thread that frees it.
+//	* the counters are kept per thread, and summed by the getters.  read them when nothing is
+//	  allocating.
+//
+#pragma once
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
 #include "tbb/spin_mutex.h"
 
 template <size_t FixedSizeBytes>
 struct tmp_vector_pool
 {
+	enum size_class
+	{
+		SMALL,
+		MEDIUM,
+		LARGE,
+		NUM_CLASSES
+	};
+
+	static size_t get_class_bytes(int c)
+	{
+		static const size_t bytes[NUM_CLASSES] = {
+			std::min(size_t(256), FixedSizeBytes),
+			std::min(size_t(4096), FixedSizeBytes),
+			FixedSizeBytes };
+		return bytes[c];
+	}
+
+	// the smallest class that holds bytes.  NUM_CLASSES if none do
+	static int get_size_class(size_t bytes)
+	{
+		int c = SMALL;
+		while (c < NUM_CLASSES && get_class_bytes(c) < bytes)
+		{
+			c++;
+		}
+		return c;
+	}
+
 	tmp_vector_pool()
-		: 
-		m_alloc_one_calls(0),
-		m_free_one_calls(0)
+		: m_id(s_next_pool_id++)
 	{}
 
 	~tmp_vector_pool()
 	{
-		for (auto ptr : string_pool)
+		for (thread_cache *cache : m_caches)
 		{
-			free(ptr);
+			for (int c = 0; c < NUM_CLASSES; c++)
+			{
+				for (int i = 0; i < cache->num_free[c]; i++)
+				{
+					free(cache->free[c][i]);
+				}
+			}
+			delete cache;
+		}
+		for (int c = 0; c < NUM_CLASSES; c++)
+		{
+			for (auto ptr : m_pool[c])
+			{
+				free(ptr);
+			}
 		}
 	}
 
-	char *AllocOne()
+	tmp_vector_pool(const tmp_vector_pool &) = delete;
+	tmp_vector_pool& operator=(const tmp_vector_pool &) = delete;
+
+	char *AllocOne(int c = LARGE)
 	{
-		char *ret;
-		pool_mutex.lock();
-		m_alloc_one_calls++;
+		thread_cache *cache = get_thread_cache();
+		cache->num_allocs[c]++;
+		if (cache->num_free[c] > 0)
+		{
+			cache->num_cache_hits++;
+			return cache->free[c][--cache->num_free[c]];
+		}
 
-		if (string_pool.empty())
+		char *ret = nullptr;
 		{
-			ret = (char *)malloc(FixedSizeBytes);
-			assert(ret);
+			tbb::spin_mutex::scoped_lock lock(pool_mutex);
+			if (!m_pool[c].empty())
+			{
+				ret = m_pool[c].back();
+				m_pool[c].pop_back();
+			}
 		}
-		else
+		if (!ret)
 		{
-			ret = string_pool.back();
-			string_pool.pop_back();
+			ret = (char *)malloc(get_class_bytes(c));
+			if (!ret)
+			{
+				throw std::bad_alloc();
+			}
+			cache->num_buffers++;
 		}
-		pool_mutex.unlock();
-
 		return ret;
 	}
 
-	void FreeOne(char *s)
+	void FreeOne(char *s, int c = LARGE)
 	{
-		pool_mutex.lock();
-		m_free_one_calls++;
+		thread_cache *cache = get_thread_cache();
+		cache->num_frees[c]++;
+		if (cache->num_free[c] < get_max_cached(c))
+		{
+			cache->free[c][cache->num_free[c]++] = s;
+			return;
+		}
+
+		tbb::spin_mutex::scoped_lock lock(pool_mutex);
 #ifdef _DEBUG
-		for (int i = 0; i < size_as_int(string_pool.size()); i++)
+		for (int i = 0; i < size_as_int(m_pool[c].size()); i++)
 		{
 			// make sure duplicates don't appear back in the string pool
-			assert(string_pool[i] != (char *)s);
+			assert(m_pool[c][i] != s);
 		}
 #endif
-		string_pool.push_back((char *)s);
-		pool_mutex.unlock();
+		m_pool[c].push_back(s);
 	}
 
-	int get_num_alloc_one_calls() const {
-		return m_alloc_one_calls;
+	// moves the first used_bytes of s (class from) to a buffer of class to
+	char *Promote(char *s, int from, int to, size_t used_bytes)
+	{
+		assert(to > from && used_bytes <= get_class_bytes(from));
+		char *ret = AllocOne(to);
+		memcpy(ret, s, used_bytes);
+		FreeOne(s, from);
+		get_thread_cache()->num_promotions++;
+		return ret;
 	}
-	int get_num_free_one_calls() const {
-		return m_free_one_calls;
+
+	uint64_t get_num_allocs(int c) const
+	{
+		return sum(&thread_cache::num_allocs, c);
+	}
+	uint64_t get_num_allocs() const
+	{
+		return get_num_allocs(SMALL) + get_num_allocs(MEDIUM) + get_num_allocs(LARGE);
+	}
+	uint64_t get_num_frees() const
+	{
+		return sum(&thread_cache::num_frees, SMALL) + sum(&thread_cache::num_frees, MEDIUM) + sum(&thread_cache::num_frees, LARGE);
+	}
+	uint64_t get_num_cache_hits() const			// allocations that didn't lock the pool
+	{
+		return sum(&thread_cache::num_cache_hits);
+	}
+	uint64_t get_num_promotions() const
+	{
+		return sum(&thread_cache::num_promotions);
 	}
+	uint64_t get_num_buffers() const			// allocated from the heap
+	{
+		return sum(&thread_cache::num_buffers);
+	}
+	int get_num_threads() const
+	{
+		tbb::spin_mutex::scoped_lock lock(pool_mutex);
+		return int(m_caches.size());
+	}
+
 private:
-	int m_alloc_one_calls;
-	int m_free_one_calls;
-	tbb::spin_mutex pool_mutex;
-	std::vector<char *> string_pool;
+	// the most free buffers of a class a thread keeps
+	static const int MAX_CACHED_ANY = 32;
+	static int get_max_cached(int c)
+	{
+		return c == SMALL ? MAX_CACHED_ANY : c == MEDIUM ? 16 : 4;
+	}
+
+	struct thread_cache
+	{
+		std::thread::id thread;
+		int num_free[NUM_CLASSES];
+		char *free[NUM_CLASSES][MAX_CACHED_ANY];
+		uint64_t num_allocs[NUM_CLASSES];
+		uint64_t num_frees[NUM_CLASSES];
+		uint64_t num_cache_hits;
+		uint64_t num_promotions;
+		uint64_t num_buffers;
+	};
+
+	// the pool this thread last used, and it's cache in it
+	struct thread_cache_ref
+	{
+		uint64_t pool_id;
+		thread_cache *cache;
+	};
+
+	thread_cache *get_thread_cache()
+	{
+		thread_cache_ref &ref = t_cache;
+		if (ref.pool_id != m_id)
+		{
+			ref.cache = find_thread_cache();
+			ref.pool_id = m_id;
+		}
+		return ref.cache;
+	}
+
+	// the first time this thread uses the pool, or since it last used another one
+	thread_cache *find_thread_cache()
+	{
+		std::thread::id thread = std::this_thread::get_id();
+		tbb::spin_mutex::scoped_lock lock(pool_mutex);
+		for (thread_cache *cache : m_caches)
+		{
+			if (cache->thread == thread)
+			{
+				return cache;
+			}
+		}
+		thread_cache *cache = new thread_cache();
+		cache->thread = thread;
+		m_caches.push_back(cache);
+		return cache;
+	}
+
+	template <typename Counter>
+	uint64_t sum(Counter counter, int c) const
+	{
+		tbb::spin_mutex::scoped_lock lock(pool_mutex);
+		uint64_t total = 0;
+		for (thread_cache *cache : m_caches)
+		{
+			total += (cache->*counter)[c];
+		}
+		return total;
+	}
+
+	uint64_t sum(uint64_t thread_cache::*counter) const
+	{
+		tbb::spin_mutex::scoped_lock lock(pool_mutex);
+		uint64_t total = 0;
+		for (thread_cache *cache : m_caches)
+		{
+			total += cache->*counter;
+		}
+		return total;
+	}
+
+	static std::atomic<uint64_t> s_next_pool_id;
+	static thread_local thread_cache_ref t_cache;
+
+	uint64_t m_id;						// unique across pools, for the thread local ref
+	mutable tbb::spin_mutex pool_mutex;	// the thread caches and the lists
+	std::vector<thread_cache *> m_caches;
+	std::vector<char *> m_pool[NUM_CLASSES];
 };
 
+template <size_t FixedSizeBytes>
+std::atomic<uint64_t> tmp_vector_pool<FixedSizeBytes>::s_next_pool_id(1);
+
+template <size_t FixedSizeBytes>
+thread_local typename tmp_vector_pool<FixedSizeBytes>::thread_cache_ref tmp_vector_pool<FixedSizeBytes>::t_cache = { 0, nullptr };
+
 template <typename T, size_t FixedSizeBytes>
 struct tmp_vector2
 {
 	typedef T value_type;
 	typedef size_t size_type;
+	typedef tmp_vector_pool<FixedSizeBytes> pool_type;
 private:
 	T *m_s;
-	tmp_vector_pool<FixedSizeBytes> *m_pool;
+	pool_type *m_pool;
 	size_type m_count;
+	int m_class;
 
 public:
 	tmp_vector2()
 		: m_pool(nullptr),
 		m_count(0),
-		m_s(0)
+		m_s(0),
+		m_class(pool_type::SMALL)
 	{}
 
-	explicit tmp_vector2(tmp_vector_pool<FixedSizeBytes> *pool)
+	explicit tmp_vector2(pool_type *pool)
 		:
 		m_pool(pool),
-		m_count(0)
+		m_count(0),
+		m_class(pool_type::SMALL)
 	{
-		m_s = (T*)m_pool->AllocOne();
+		m_s = (T*)m_pool->AllocOne(m_class);
 	}
 	~tmp_vector2()
 	{
 		if (m_s)
 		{
-			m_pool->FreeOne((char *)m_s);
+			m_pool->FreeOne((char *)m_s, m_class);
 		}
 	}
 
@@ -106,7 +309,8 @@ public:
 		:
 		m_s(rhs.m_s),
 		m_pool(rhs.m_pool),
-		m_count(rhs.m_count)
+		m_count(rhs.m_count),
+		m_class(rhs.m_class)
 	{
 		rhs.m_s = nullptr;
 	}
@@ -116,6 +320,7 @@ public:
 		m_s = rhs.m_s;
 		m_pool = rhs.m_pool;
 		m_count = rhs.m_count;
+		m_class = rhs.m_class;
 		rhs.m_s = nullptr;
 		return *this;
 	}
@@ -135,9 +340,35 @@ public:
 	const T * first() const { return m_s; }
 	const T * last() const { return m_s + m_count; }
 
-	size_type max_size() const { return FixedSizeBytes / sizeof(T); }
+	// what fits in the buffer it has now
+	size_type max_size() const { return pool_type::get_class_bytes(m_class) / sizeof(T); }
+	// what fits in the largest
+	size_type max_capacity() const { return FixedSizeBytes / sizeof(T); }
 	size_type size() const { return m_count; }
-	void resize(size_type count) { m_count = count; }
+
+	// promotes to a class that holds count, keeping the contents.  false if none do
+	bool reserve(size_type count)
+	{
+		if (count <= max_size())
+		{
+			return true;
+		}
+		int c = pool_type::get_size_class(count * sizeof(T));
+		if (c == pool_type::NUM_CLASSES)
+		{
+			return false;
+		}
+		m_s = (T*)m_pool->Promote((char *)m_s, m_class, c, m_count * sizeof(T));
+		m_class = c;
+		return true;
+	}
+
+	void resize(size_type count)
+	{
+		reserve(count);
+		assert(count <= max_size());
+		m_count = count;
+	}
 	void clear() { m_count = 0; }
 
 	T & operator[] (int pos) { return m_s[pos]; }
@@ -145,8 +376,7 @@ public:
 
 	void push_back(const T&ref)
 	{
+		reserve(m_count + 1);
 		m_s[m_count++] = ref;
 	}
 };
-
-
@@ -299,23 +299,28 @@ static void visit_controller_state(visitor_fn *visitor,
 			visitor->visit_node(ss->controller_state);
 		}
 	}
-	if (visitor->spawn_children())
+	// properties (and the component names that come from them) are polled at their own rate
+	bool poll_properties = visitor->poll(POLL_DEVICE_PROPERTIES, controller_index);
+	if (poll_properties)
 	{
-		spawn_check(visitor, &system_ss->structure_version, ss->string_props, indexer, PropertiesIndexer::PROP_STRING);
-		spawn_check(visitor, &system_ss->structure_version, ss->bool_props, indexer, PropertiesIndexer::PROP_BOOL);
-		spawn_check(visitor, &system_ss->structure_version, ss->float_props, indexer, PropertiesIndexer::PROP_FLOAT);
-		spawn_check(visitor, &system_ss->structure_version, ss->mat34_props, indexer, PropertiesIndexer::PROP_MAT34);
-		spawn_check(visitor, &system_ss->structure_version, ss->int32_props, indexer, PropertiesIndexer::PROP_INT32);
-		spawn_check(visitor, &system_ss->structure_version, ss->uint64_props, indexer, PropertiesIndexer::PROP_UINT64);
+		if (visitor->spawn_children())
+		{
+			spawn_check(visitor, &system_ss->structure_version, ss->string_props, indexer, PropertiesIndexer::PROP_STRING);
+			spawn_check(visitor, &system_ss->structure_version, ss->bool_props, indexer, PropertiesIndexer::PROP_BOOL);
+			spawn_check(visitor, &system_ss->structure_version, ss->float_props, indexer, PropertiesIndexer::PROP_FLOAT);
+			spawn_check(visitor, &system_ss->structure_version, ss->mat34_props, indexer, PropertiesIndexer::PROP_MAT34);
+			spawn_check(visitor, &system_ss->structure_version, ss->int32_props, indexer, PropertiesIndexer::PROP_INT32);
+			spawn_check(visitor, &system_ss->structure_version, ss->uint64_props, indexer, PropertiesIndexer::PROP_UINT64);
+		}
+
+		visit_string_vec(visitor, controller_index, ss->string_props, wrap, indexer, PropertiesIndexer::PROP_STRING, "string props");
+		visit_vec(visitor, controller_index, ss->bool_props, wrap, indexer, PropertiesIndexer::PROP_BOOL, "bool props");
+		visit_vec(visitor, controller_index, ss->float_props, wrap, indexer, PropertiesIndexer::PROP_FLOAT, "float props");
+		visit_vec(visitor, controller_index, ss->mat34_props, wrap, indexer, PropertiesIndexer::PROP_MAT34, "mat34 props");
+		visit_vec(visitor, controller_index, ss->int32_props, wrap, indexer, PropertiesIndexer::PROP_INT32, "int32 props");
+		visit_vec(visitor, controller_index, ss->uint64_props, wrap, indexer, PropertiesIndexer::PROP_UINT64, "uint64 props");
 	}
 	
-	visit_string_vec(visitor, controller_index, ss->string_props, wrap, indexer, PropertiesIndexer::PROP_STRING, "string props");
-	visit_vec(visitor, controller_index, ss->bool_props, wrap, indexer, PropertiesIndexer::PROP_BOOL, "bool props");
-	visit_vec(visitor, controller_index, ss->float_props, wrap, indexer, PropertiesIndexer::PROP_FLOAT, "float props");
-	visit_vec(visitor, controller_index, ss->mat34_props, wrap, indexer, PropertiesIndexer::PROP_MAT34, "mat34 props");
-	visit_vec(visitor, controller_index, ss->int32_props, wrap, indexer, PropertiesIndexer::PROP_INT32, "int32 props");
-	visit_vec(visitor, controller_index, ss->uint64_props, wrap, indexer, PropertiesIndexer::PROP_UINT64, "uint64 props");
-	
 	// update the component states on this controller
 	// based on: component name
 	//           render model name
@@ -324,7 +329,7 @@ static void visit_controller_state(visitor_fn *visitor,
 	// render model name comes from a property.  to avoid coupling to visit_string_properties, 
 	// just look it up again
 
-	if (visitor->spawn_children() && visitor->visit_source_interfaces())
+	if (poll_properties && visitor->spawn_children() && visitor->visit_source_interfaces())
 	{
 		TMPString<ETrackedPropertyError> render_model;
 		wrap->GetStringTrackedDeviceProperty(controller_index, vr::Prop_RenderModelName_String, 
@@ -700,7 +705,8 @@ static void visit_applications_node(visitor_fn *visitor, vr_state::applications_
 {
 	visitor->start_group_node(ss->get_url(), -1);
 
-	if (visitor->visit_source_interfaces())
+	bool poll_applications = visitor->poll(POLL_APPLICATIONS, -1);
+	if (visitor->visit_source_interfaces() && poll_applications)
 	{
 		keys->GetApplicationsIndexer().update_presence_and_size(wrap);
 	}
@@ -727,29 +733,35 @@ static void visit_applications_node(visitor_fn *visitor, vr_state::applications_
 	}
 
 	g.run("applications top level",
-		[visitor, ss, keys, wrap] 
+		[visitor, ss, keys, wrap, poll_applications] 
 	{
-
-		if (visitor->visit_source_interfaces())
-		{
-			keys->GetApplicationsIndexer().read_lock_live_indexes();
-			visitor->visit_node(ss->active_application_indexes, make_result(keys->GetApplicationsIndexer().get_live_indexes()));
-			keys->GetApplicationsIndexer().read_unlock_live_indexes();
-		}
-		else
+		if (poll_applications)
 		{
-			visitor->visit_node(ss->active_application_indexes);
-		}
+			if (visitor->visit_source_interfaces())
+			{
+				keys->GetApplicationsIndexer().read_lock_live_indexes();
+				const std::vector<int> &live_indexes = keys->GetApplicationsIndexer().get_live_indexes();
+				visitor->visit_node(ss->active_application_indexes, make_result(gsl::make_span(live_indexes.data(), live_indexes.size())));
+				keys->GetApplicationsIndexer().read_unlock_live_indexes();
+			}
+			else
+			{
+				visitor->visit_node(ss->active_application_indexes);
+			}
 
-		VISIT(starting_application, wrap->GetStartingApplication(&(TMPString<vr::EVRApplicationError>())));
-		VISIT(transition_state, wrap->GetTransitionState());
-		VISIT(is_quit_user_prompt, wrap->IsQuitUserPromptRequested());
-		VISIT(current_scene_process_id, wrap->GetCurrentSceneProcessId());
+			VISIT(starting_application, wrap->GetStartingApplication(&(TMPString<vr::EVRApplicationError>())));
+			VISIT(transition_state, wrap->GetTransitionState());
+			VISIT(is_quit_user_prompt, wrap->IsQuitUserPromptRequested());
+			VISIT(current_scene_process_id, wrap->GetCurrentSceneProcessId());
+		}
 
 		START_VECTOR(mime_types);
 		for (int i = 0; i < size_as_int(ss->mime_types.size()); i++)
 		{
-			visit_mime_type_schema(visitor, &ss->mime_types[i], wrap, i, keys);
+			if (visitor->poll(POLL_MIME_TYPES, i))
+			{
+				visit_mime_type_schema(visitor, &ss->mime_types[i], wrap, i, keys);
+			}
 		}
 		END_VECTOR(mime_types);
 	});
@@ -765,7 +777,10 @@ static void visit_applications_node(visitor_fn *visitor, vr_state::applications_
 		{
 			for (int j = i; j < i + num_iter; j++)
 			{
-				visit_application_state(visitor, ss, wrap, j, keys);
+				if (visitor->poll(POLL_APPLICATIONS, j))
+				{
+					visit_application_state(visitor, ss, wrap, j, keys);
+				}
 			}
 		});
 		i += num_iter;
@@ -922,8 +937,11 @@ static void visit_settings_node(
 			[visitor, ss, wrap, keys, index, num_iter] {
 			for (int j = index; j < index + num_iter; j++)
 			{
-				visit_section(visitor, keys->GetSettingsIndexer().GetSectionName(j), &ss->sections[j],
-					&ss->structure_version, wrap, keys);
+				if (visitor->poll(POLL_SETTINGS, j))
+				{
+					visit_section(visitor, keys->GetSettingsIndexer().GetSectionName(j), &ss->sections[j],
+						&ss->structure_version, wrap, keys);
+				}
 			}
 		});
 		index += num_iter;
@@ -1141,7 +1159,7 @@ static void visit_rendermodel(visitor_fn *visitor,
 				unVertexCount = pRenderModel->unVertexCount;
 				rIndexData = pRenderModel->rIndexData;
 				unTriangleCount = pRenderModel->unTriangleCount;
-				texture_index = config->GetTextureIndexer().add_texture(pRenderModel->diffuseTextureId, render_model_name);
+				texture_index = config->GetTextureIndexer().add_texture(pRenderModel->diffuseTextureId, render_model_name, wrap->remi);
 			}
 			visitor->visit_node(ss->vertex_data, make_result(gsl::make_span(rVertexData, unVertexCount), rc));
 			visitor->visit_node(ss->index_data, make_result(gsl::make_span(rIndexData, unTriangleCount*3), rc));
@@ -1193,49 +1211,42 @@ static void visit_rendermodel(visitor_fn *visitor,
 }
 
 
+// fetches one overlay's image into the scheduler's buffer and visits it if it changed.  only
+// called from the image task (see visit_overlay_state).  returns the bytes fetched
 template <typename visitor_fn>
-static void visit_per_overlay_image(
+static uint32_t visit_per_overlay_image(
 	visitor_fn *visitor,
 	vr_state::overlay_schema *overlay_state,
 	OverlayWrapper *wrap,
-	uint32_t overlay_index,
+	int overlay_index,
 	vr_keys *config
 )
 {
 	vr_state::per_overlay_state *ss = &overlay_state->overlays[overlay_index];
-	if (visitor->visit_source_interfaces())
+	overlay_image_scheduler *images = wrap->images;
+	const char *key = config->GetOverlayIndexer().get_overlay_key_for_index(overlay_index);
+	OverlayHandle<EVROverlayError> handle_result = wrap->GetOverlayHandle(key);
+
+	Uint32<EVROverlayError> width = make_result<uint32_t, EVROverlayError>(0, handle_result.return_code);
+	Uint32<EVROverlayError> height = make_result<uint32_t, EVROverlayError>(0, handle_result.return_code);
+	EVROverlayError err = handle_result.return_code;
+	std::vector<uint8_t> &buffer = images->get_buffer();
+	buffer.clear();
+	if (handle_result.is_present())
 	{
-		const char *key = config->GetOverlayIndexer().get_overlay_key_for_index(overlay_index);
-		OverlayHandle<EVROverlayError> handle_result = wrap->GetOverlayHandle(key);
-		
-		if (handle_result.is_present())
-		{
-			Uint32<EVROverlayError> width;
-			Uint32<EVROverlayError> height;
-			uint8_t *ptr;
-			uint32_t size;
-			EVROverlayError err = wrap->GetImageData(handle_result.val, &width, &height, &ptr, &size);
-			visitor->visit_node(ss->overlay_image_width, width);
-			visitor->visit_node(ss->overlay_image_height, height);
-			auto result(make_result(gsl::make_span(ptr, size), err));
-			visitor->visit_node(ss->overlay_image_data, result);
-			wrap->FreeImageData(ptr);
-		}
-		else
-		{
-			visitor->visit_node(ss->overlay_image_width, make_result(0, handle_result.return_code));
-			visitor->visit_node(ss->overlay_image_height, make_result(0, handle_result.return_code));
-			uint8_t *ptr = nullptr;
-			auto result(make_result(gsl::make_span(ptr, 0), handle_result.return_code));
-			visitor->visit_node(ss->overlay_image_data, result);
-		}
+		err = wrap->GetImageData(handle_result.val, &width, &height, &buffer);
 	}
-	else
+
+	uint32_t size = size_as_uint32(buffer.size());
+	if (images->image_changed(overlay_index, width.val, height.val, err, buffer.data(), size))
 	{
-		visitor->visit_node(ss->overlay_image_width);
-		visitor->visit_node(ss->overlay_image_height);
-		visitor->visit_node(ss->overlay_image_data);
+		visitor->visit_node(ss->overlay_image_width, width);
+		visitor->visit_node(ss->overlay_image_height, height);
+		uint8_t *ptr = buffer.data();
+		auto result(make_result(gsl::make_span(ptr, size), err));
+		visitor->visit_node(ss->overlay_image_data, result);
 	}
+	return size;
 }
 
 template <typename visitor_fn>
@@ -1263,28 +1274,7 @@ static void visit_per_overlay(
 		visitor->visit_node(ss->overlay_handle, handle_result);
 		visitor->visit_node(ss->overlay_name, name);
 
-// 3/15/2017: disable image data since it's not thread safe - I think its directx
-			if ( 0 &&handle_result.is_present())
-			{
-				Uint32<EVROverlayError> width;
-				Uint32<EVROverlayError> height;
-				uint8_t *ptr;
-				uint32_t size;
-				EVROverlayError err = wrap->GetImageData(handle_result.val, &width, &height, &ptr, &size);
-				visitor->visit_node(ss->overlay_image_width, width);
-				visitor->visit_node(ss->overlay_image_height, height);
-				auto result(make_result(gsl::make_span(ptr, size), err));
-				visitor->visit_node(ss->overlay_image_data, result);
-				wrap->FreeImageData(ptr);
-			}
-			else
-			{
-				visitor->visit_node(ss->overlay_image_width, make_result(0, handle_result.return_code));
-				visitor->visit_node(ss->overlay_image_height, make_result(0, handle_result.return_code));
-				uint8_t *ptr = nullptr;
-				auto result(make_result(gsl::make_span(ptr, 0), handle_result.return_code));
-				visitor->visit_node(ss->overlay_image_data, result);
-			}
+		// the image nodes are visited by the image task (visit_per_overlay_image)
 	}
 	else
 	{
@@ -1357,46 +1347,56 @@ static void visit_overlay_state(visitor_fn *visitor, vr_state::overlay_schema *s
 
 	visitor->start_group_node(ss->get_url(), -1);
 
-	if (visitor->visit_source_interfaces())
+	bool poll_overlays = visitor->poll(POLL_OVERLAYS, -1);
+	if (poll_overlays)
 	{
-		keys->GetOverlayIndexer().update_presence(wrap);
-	}
+		if (visitor->visit_source_interfaces())
+		{
+			keys->GetOverlayIndexer().update_presence(wrap);
+		}
 
-	VISIT(gamepad_focus_overlay, wrap->GetGamepadFocusOverlay());
-	VISIT(primary_dashboard_device, wrap->GetPrimaryDashboardDevice());
-	VISIT(is_dashboard_visible, wrap->IsDashboardVisible());
-	VISIT(keyboard_text, wrap->GetKeyboardText(&(TMPString<>())));
+		VISIT(gamepad_focus_overlay, wrap->GetGamepadFocusOverlay());
+		VISIT(primary_dashboard_device, wrap->GetPrimaryDashboardDevice());
+		VISIT(is_dashboard_visible, wrap->IsDashboardVisible());
+		VISIT(keyboard_text, wrap->GetKeyboardText(&(TMPString<>())));
 
-	if (visitor->visit_source_interfaces())
-	{
-		keys->GetOverlayIndexer().read_lock_live_indexes();
-		visitor->visit_node(ss->active_overlay_indexes, make_result(keys->GetOverlayIndexer().get_live_indexes()));
-		keys->GetOverlayIndexer().read_unlock_live_indexes();
-	}
-	else
-	{
-		visitor->visit_node(ss->active_overlay_indexes);
+		if (visitor->visit_source_interfaces())
+		{
+			keys->GetOverlayIndexer().read_lock_live_indexes();
+			const std::vector<int> &live_indexes = keys->GetOverlayIndexer().get_live_indexes();
+			visitor->visit_node(ss->active_overlay_indexes, make_result(gsl::make_span(live_indexes.data(), live_indexes.size())));
+			keys->GetOverlayIndexer().read_unlock_live_indexes();
+		}
+		else
+		{
+			visitor->visit_node(ss->active_overlay_indexes);
+		}
 	}
-
 	
 	START_VECTOR(overlays);
 	for (int i = 0; i < size_as_int(ss->overlays.size()); i++)
 	{
-		g.run("single overlay", [visitor, ss, wrap, i, keys]
+		if (visitor->poll(POLL_OVERLAYS, i))
 		{
-			visit_per_overlay(visitor, ss, wrap, i, keys);
-		});
+			g.run("single overlay", [visitor, ss, wrap, i, keys]
+			{
+				visit_per_overlay(visitor, ss, wrap, i, keys);
+			});
+		}
 	}
 
 	// // 3/15/2017 - calling GetOverlayImage simultaneously causes vrclient.dll to 
-	// crash - so to avoid this, we call it in a single thread - and only once. TODO: walk through all of them
+	// crash - so to avoid this, we call it in a single thread.  the overlays take turns within a
+	// byte budget (overlay_image_scheduler.h).  other visitors get the image nodes from visit_per_overlay
 	// (do not use RAND! you will screw up the determinism between counting and encoding in the serialization system)
-	if (ss->overlays.size() > 0)
+	if (visitor->visit_source_interfaces() && wrap->images && ss->overlays.size() > 0 && poll_overlays)
 	{
-		int index = 0;
-		g.run("image update", [visitor, ss, wrap, keys, index]
+		g.run("image update", [visitor, ss, wrap, keys]
 		{
-			visit_per_overlay_image(visitor, ss, wrap, index, keys);
+			wrap->images->run_frame(size_as_int(ss->overlays.size()), [visitor, ss, wrap, keys](int index)
+			{
+				return visit_per_overlay_image(visitor, ss, wrap, index, keys);
+			});
 		});
 	}
 
@@ -1410,7 +1410,7 @@ static void visit_rendermodel_state(visitor_fn *visitor, vr_state::render_models
 	RenderModelsWrapper *wrap, vr_keys *config, TaskGroup &g)
 {
 	
-	if (visitor->spawn_children() && visitor->visit_source_interfaces())
+	if (visitor->spawn_children() && visitor->visit_source_interfaces() && visitor->poll(POLL_RENDER_MODELS, -1))
 	{
 		Uint32<> current_rendermodels = wrap->GetRenderModelCount();
 		int num_render_models = current_rendermodels.val;
@@ -1434,7 +1434,10 @@ static void visit_rendermodel_state(visitor_fn *visitor, vr_state::render_models
 		{
 			for (int j = i; j < i + num_iter; j++)
 			{
-				visit_rendermodel(visitor, &ss->models[j], &ss->structure_version, wrap, j, config);
+				if (visitor->poll(POLL_RENDER_MODELS, j))
+				{
+					visit_rendermodel(visitor, &ss->models[j], &ss->structure_version, wrap, j, config);
+				}
 			}
 		});
 		i += num_iter;
@@ -1572,10 +1575,24 @@ static void visit_per_resource(visitor_fn *visitor,
 
 		visitor->visit_node(ss->resources[i].resource_full_path, full_path);
 
-		uint8_t *data;
-		uint32_t size = wrap->GetImageData(full_path.val.data(), &data);
-		visitor->visit_node(ss->resources[i].resource_data, make_result(gsl::make_span(data, size)));
-		wrap->FreeImageData(data);
+		// unchanged resources (see resource_cache.h) aren't visited, so their history stays as is
+		if (!wrap->cache)
+		{
+			uint8_t *data;
+			uint32_t size = wrap->GetImageData(full_path.val.data(), &data);
+			visitor->visit_node(ss->resources[i].resource_data, make_result(gsl::make_span(data, size)));
+			wrap->FreeImageData(data);
+		}
+		else if (wrap->cache->needs_load(full_path.val.data()))
+		{
+			std::vector<uint8_t> &buffer = wrap->cache->get_buffer();
+			uint32_t size = wrap->GetImageData(full_path.val.data(), &buffer);
+			uint8_t *data = buffer.data();
+			if (wrap->cache->content_changed(full_path.val.data(), data, size))
+			{
+				visitor->visit_node(ss->resources[i].resource_data, make_result(gsl::make_span(data, size)));
+			}
+		}
 	}
 	else
 	{
@@ -1612,7 +1629,10 @@ static void visit_resources_state(visitor_fn *visitor,
 	START_VECTOR(resources);
 	for (int i = 0; i < size_as_int(ss->resources.size()); i++)
 	{
-		visit_per_resource(visitor, ss, wrap, i, keys);
+		if (visitor->poll(POLL_RESOURCES, i))
+		{
+			visit_per_resource(visitor, ss, wrap, i, keys);
+		}
 	}
 	END_VECTOR(resources);
 
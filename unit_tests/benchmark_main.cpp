@@ -0,0 +1,958 @@
+//
+// benchmarks: capture update, the update visitor, a 250k node graph, save/load and compression,
+//   cursor seeks, the time containers and the texture service
+//
+//  * updates run against the simulated runtime (openvr_sim.h) so the numbers don't depend
+//    on what hardware is plugged in and runs can be compared.  the long save/load runs use
+//    synthetic captures for the same reason
+//  * results are logged and written as json (benchmark_report.h) to the file named on the
+//    command line, or benchmark_results.json
+//  * the executable counts operator new calls, and fails (exit code 2) if an update allocates
+//    once the capture has been discovered, while the sim keeps moving
+//  * it also counts the bytes operator new hands out, so what a freshly discovered capture costs
+//    can be reported next to the resident set
+//
+#include "benchmark_report.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "capture_updater.h"
+#include "openvr_sim.h"
+#include "poll_events.h"
+#include "texture_service.h"
+#include "vr_cursor_context.h"
+#include "vr_system_cursor.h"
+#include "segmented_list.h"
+#include "columnar_list.h"
+#include "time_containers.h"
+#include "result.h"
+#include "FileStream.h"
+#include "VectorStream.h"
+#include "log.h"
+#include "tbb/task_arena.h"
+#include "tbb/task_group.h"
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <new>
+#include <stdlib.h>
+
+static const int BENCHMARK_UPDATE_FRAMES = 900;			// 10 seconds at 90hz
+static const int BENCHMARK_SEEKS = 100000;
+static const int BENCHMARK_CONTAINER_ITEMS = 1000000;
+static const int BENCHMARK_TEXTURES = 64;
+static const int BENCHMARK_TEXTURE_SIZE = 512;
+static const int BENCHMARK_WARMUP_FRAMES = 200;			// past a few button, overlay image and event changes
+static const int BENCHMARK_STEADY_EVENT_PERIOD = 30;	// frames between the sim's property change events
+static const int BENCHMARK_STEADY_FRAMES = 200;
+static const int BENCHMARK_DISCOVERY_DEVICES = 16;
+static const int BENCHMARK_SYNTHETIC_FRAMES = 1000000;
+static const int VISITOR_BENCHMARK_DEVICES = 64;			// controllers, trackers...
+static const int VISITOR_BENCHMARK_PROPERTIES = 256;		// properties per device
+static const int VISITOR_BENCHMARK_FRAMES = 200;
+static const int STRESS_BENCHMARK_DEVICES = 1000;
+static const int STRESS_BENCHMARK_PROPERTIES = 250;			// 250k nodes, well past 16 bit ids
+static const int STRESS_BENCHMARK_FRAMES = 900;
+
+// allocation counting hook.  only the benchmark executable replaces operator new; linked into
+// anything else nothing is counted.  malloc (and tbb's own allocator) isn't counted
+#ifdef BENCHMARK_MAIN
+static std::atomic<uint64_t> s_num_allocations(0);
+static std::atomic<uint64_t> s_allocated_bytes(0);		// handed out, not net of frees
+
+void *operator new(size_t size)
+{
+	s_num_allocations.fetch_add(1, std::memory_order_relaxed);
+	s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	void *p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+static bool counting_allocations() { return true; }
+static uint64_t get_num_allocations() { return s_num_allocations.load(); }
+static uint64_t get_allocated_bytes() { return s_allocated_bytes.load(); }
+#else
+static bool counting_allocations() { return false; }
+static uint64_t get_num_allocations() { return 0; }
+static uint64_t get_allocated_bytes() { return 0; }
+#endif
+
+static int64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double per_second(double count, int64_t ns)
+{
+	return ns > 0 ? count / (ns / 1e9) : 0.0;
+}
+
+// update the capture from the sim once per frame and time each update.  with events, the sim's
+// events are drained into the poll schedule first (poll_events.h)
+static void benchmark_update(benchmark_report &report, const char *mode, capture_test_context *context, bool parallel, bool events = false)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	openvr_sim::configure(config);
+
+	capture &c = context->get_capture();
+	openvr_broker::open_vr_interfaces &vri = context->sim_vr_interfaces();
+	capture_traverser traverser;
+	std::vector<double> frame_us(BENCHMARK_UPDATE_FRAMES);
+	uint64_t start_calls = openvr_sim::get_num_calls();
+	for (int i = 0; i < BENCHMARK_UPDATE_FRAMES; i++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (events)
+		{
+			vr::VREvent_t event;
+			while (vri.sysi->PollNextEvent(&event, sizeof(event)))
+			{
+				invalidate_for_event(event, &c.m_keys, &c.m_poll_schedule);
+			}
+		}
+		traverser.update_capture(&c, &vri, time_stamp_t(i) * 11111, parallel);
+		frame_us[i] = elapsed_ns(start) / 1000.0;
+		openvr_sim::advance_frame();
+	}
+	double calls_per_frame = double(openvr_sim::get_num_calls() - start_calls) / BENCHMARK_UPDATE_FRAMES;
+
+	double total_us = 0;
+	for (double us : frame_us)
+	{
+		total_us += us;
+	}
+	double p50 = benchmark_report::percentile(&frame_us, 50);
+	double p99 = benchmark_report::percentile(&frame_us, 99);
+	log_printf("%s update: p50 %.1f us, p99 %.1f us, mean %.1f us, %.1f openvr calls\n", mode, p50, p99, total_us / BENCHMARK_UPDATE_FRAMES, calls_per_frame);
+	report.add("update", (std::string(mode) + "_p50_us").c_str(), p50);
+	report.add("update", (std::string(mode) + "_p99_us").c_str(), p99);
+	report.add("update", (std::string(mode) + "_mean_us").c_str(), total_us / BENCHMARK_UPDATE_FRAMES);
+	report.add("update", (std::string(mode) + "_calls_per_frame").c_str(), calls_per_frame);
+}
+
+static void benchmark_save_load(benchmark_report &report, capture_test_context *context)
+{
+	std::string fname(plat::make_temporary_filename("benchmark_capture.bin"));
+	capture_traverser traverser;
+
+	std::chrono::steady_clock::time_point save_start = std::chrono::steady_clock::now();
+	assert(traverser.save_capture_to_binary_file(&context->get_capture(), fname.c_str()));
+	int64_t save_ns = elapsed_ns(save_start);
+
+	capture_test_context loaded;
+	std::chrono::steady_clock::time_point load_start = std::chrono::steady_clock::now();
+	assert(traverser.load_capture_from_mapped_file(&loaded.get_capture(), fname.c_str()));
+	int64_t load_ns = elapsed_ns(load_start);
+	assert(loaded.get_capture() == context->get_capture());
+
+	FileStream f;
+	assert(f.open_file_for_read(fname.c_str()));
+	double mb = f.get_file_size() / (1024.0 * 1024.0);
+	log_printf("save/load: %.2f mb. save %.1f mb/s, load %.1f mb/s\n", mb, per_second(mb, save_ns), per_second(mb, load_ns));
+	report.add("save_load", "file_mb", mb);
+	report.add("save_load", "save_mb_per_s", per_second(mb, save_ns));
+	report.add("save_load", "load_mb_per_s", per_second(mb, load_ns));
+}
+
+// what capture_update_visitor used to do: one lock around one shared bitset
+struct locked_update_visitor : capture_update_visitor
+{
+	tbb::spin_mutex updated_node_lock;
+	VRBitset shared_bits;
+
+	locked_update_visitor(time_index_t t)
+		: capture_update_visitor(t)
+	{}
+
+	template <typename HistoryVectorType, typename ResultType>
+	void visit_node(HistoryVectorType &history, const ResultType &latest_result)
+	{
+		if (history.empty() || not_equals(history.latest().get_value(), latest_result))
+		{
+			history.emplace_back(m_frame_number, latest_result);
+			serialization_id history_id = history.get_serialization_index();
+			updated_node_lock.lock();
+			shared_bits.set(history_id);
+			updated_node_lock.unlock();
+		}
+	}
+
+	void collect_updated_node_bits(VRBitset *bits)
+	{
+		*bits = shared_bits;
+	}
+};
+
+using benchmark_node = time_node<vr_result::Float<bool>, columnar_list_1024, false, std::allocator>;
+
+// every device is a task and every property changes every frame, which is the worst case for
+// the changed node tracking
+template <typename Visitor>
+static int64_t time_visits(std::vector<benchmark_node> &nodes, int num_threads)
+{
+	tbb::task_arena arena(num_threads);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < VISITOR_BENCHMARK_FRAMES; frame++)
+	{
+		Visitor visitor(frame);
+		arena.execute([&]()
+		{
+			tbb::task_group g;
+			for (int device = 0; device < VISITOR_BENCHMARK_DEVICES; device++)
+			{
+				g.run([&, device]()
+				{
+					for (int i = 0; i < VISITOR_BENCHMARK_PROPERTIES; i++)
+					{
+						int node = device * VISITOR_BENCHMARK_PROPERTIES + i;
+						visitor.visit_node(nodes[node], vr_result::Float<bool>(float(frame + node), true));
+					}
+				});
+			}
+			g.wait();
+		});
+		VRBitset bits;
+		visitor.collect_updated_node_bits(&bits);
+		assert(bits.size() == nodes.size());
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			assert(bits[i]);
+		}
+	}
+	return elapsed_ns(start);
+}
+
+static std::vector<benchmark_node> make_benchmark_nodes(SerializableRegistry *registry)
+{
+	std::vector<benchmark_node> nodes;
+	nodes.reserve(VISITOR_BENCHMARK_DEVICES * VISITOR_BENCHMARK_PROPERTIES);
+	for (int i = 0; i < VISITOR_BENCHMARK_DEVICES * VISITOR_BENCHMARK_PROPERTIES; i++)
+	{
+		nodes.emplace_back(base::URL("node", "/node").make_child(std::to_string(i)), registry);
+	}
+	return nodes;
+}
+
+// thread scaling of changed node tracking: the old shared lock vs the per thread bitsets
+static void benchmark_update_visitor(benchmark_report &report)
+{
+	log_printf("update visitor: %d devices x %d properties, %d frames\n",
+		VISITOR_BENCHMARK_DEVICES, VISITOR_BENCHMARK_PROPERTIES, VISITOR_BENCHMARK_FRAMES);
+	for (int num_threads = 1; num_threads <= int(std::thread::hardware_concurrency()); num_threads *= 2)
+	{
+		SerializableRegistry locked_registry;
+		std::vector<benchmark_node> locked_nodes(make_benchmark_nodes(&locked_registry));
+		double locked_us = time_visits<locked_update_visitor>(locked_nodes, num_threads) / 1000.0 / VISITOR_BENCHMARK_FRAMES;
+
+		SerializableRegistry registry;
+		std::vector<benchmark_node> nodes(make_benchmark_nodes(&registry));
+		double per_thread_us = time_visits<capture_update_visitor>(nodes, num_threads) / 1000.0 / VISITOR_BENCHMARK_FRAMES;
+
+		log_printf("%d threads: shared lock %.1f us/frame, per thread bitsets %.1f us/frame\n", num_threads, locked_us, per_thread_us);
+		std::string prefix = std::to_string(num_threads) + "_threads_";
+		report.add("update_visitor", (prefix + "shared_lock_us_per_frame").c_str(), locked_us);
+		report.add("update_visitor", (prefix + "per_thread_bitsets_us_per_frame").c_str(), per_thread_us);
+	}
+}
+
+// a graph much bigger than a real one: discovery registers every node from the device tasks at once,
+// then, like a late controller, only the last device changes, so the update bits only hold high ids.
+// times registration, encoding (registry table, nodes, update bits and paths) and loading, which
+// decodes everything and restores the ids the way a capture load does (capture_id_fixer.h)
+static void benchmark_stress(benchmark_report &report)
+{
+	const int num_nodes = STRESS_BENCHMARK_DEVICES * STRESS_BENCHMARK_PROPERTIES;
+	log_printf("stress: %d devices x %d properties, %d frames\n",
+		STRESS_BENCHMARK_DEVICES, STRESS_BENCHMARK_PROPERTIES, STRESS_BENCHMARK_FRAMES);
+
+	std::vector<std::string> property_names;
+	for (int i = 0; i < STRESS_BENCHMARK_PROPERTIES; i++)
+	{
+		property_names.push_back("prop_" + std::to_string(i));
+	}
+
+	SerializableRegistry registry;
+	std::vector<std::unique_ptr<benchmark_node>> nodes(num_nodes);
+	base::URL root("stress", "/stress");
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	{
+		tbb::task_group g;
+		for (int device = 0; device < STRESS_BENCHMARK_DEVICES; device++)
+		{
+			g.run([&, device]()
+			{
+				base::URL device_url = root.make_child(std::to_string(device));
+				for (int i = 0; i < STRESS_BENCHMARK_PROPERTIES; i++)
+				{
+					nodes[device * STRESS_BENCHMARK_PROPERTIES + i].reset(
+						new benchmark_node(device_url.make_child(property_names[i]), &registry));
+				}
+			});
+		}
+		g.wait();
+	}
+	int64_t register_us = elapsed_ns(start) / 1000;
+	assert(registry.GetNumRegistered() == serialization_id(num_nodes));
+
+	// the first frame changes everything, the rest only the nodes with the highest ids.  the device
+	// tasks registered in any order, so they're picked by id
+	VRUpdateVector update_bits;
+	VRBitset scratch;
+	uint64_t bitset_bytes = 0;
+	for (int frame = 0; frame < STRESS_BENCHMARK_FRAMES; frame++)
+	{
+		capture_update_visitor visitor(frame);
+		int first_id = frame == 0 ? 0 : num_nodes - STRESS_BENCHMARK_PROPERTIES;
+		for (int id = first_id; id < num_nodes; id++)
+		{
+			benchmark_node *node = static_cast<benchmark_node *>(registry.registered[id]);
+			visitor.visit_node(*node, vr_result::Float<bool>(float(frame + id), true));
+		}
+		visitor.collect_updated_node_bits(&scratch);
+		update_bits.emplace_back(frame, scratch);
+		bitset_bytes += sizeof(uint32_t) + sizeof(int) + scratch.num_blocks() * sizeof(uint64_t);	// as a VRBitset
+	}
+
+	VectorStream registry_stream;
+	VectorStream state_stream;
+	VectorStream update_bits_stream;
+	VectorStream paths_stream;
+	start = std::chrono::steady_clock::now();
+	{
+		base::path_section saved_paths;
+		registry_stream.paths = &saved_paths;
+		state_stream.paths = &saved_paths;
+		int num_entries = registry.GetNumRegistered();
+		registry_stream.write_to_stream(&num_entries, sizeof(num_entries));
+		for (int i = 0; i < num_entries; i++)
+		{
+			registry.registered[i]->get_serialization_url().encode(registry_stream);
+		}
+		for (const std::unique_ptr<benchmark_node> &node : nodes)
+		{
+			node->encode(state_stream);
+		}
+		update_bits.encode(update_bits_stream);
+		saved_paths.encode(paths_stream);
+	}
+	int64_t encode_us = elapsed_ns(start) / 1000;
+
+	SerializableRegistry loaded_registry;
+	std::vector<benchmark_node> loaded(num_nodes);
+	VRUpdateVector loaded_update_bits;
+	start = std::chrono::steady_clock::now();
+	{
+		base::path_section loaded_paths;
+		paths_stream.reset_buf_pos();
+		bool rc = loaded_paths.decode(paths_stream);
+		assert(rc);
+
+		registry_stream.reset_buf_pos();
+		registry_stream.paths = &loaded_paths;
+		int num_entries;
+		registry_stream.read_from_stream(&num_entries, sizeof(num_entries));
+		std::unordered_map<uint32_t, serialization_id> path2id;
+		path2id.reserve(num_entries);
+		for (int i = 0; i < num_entries; i++)
+		{
+			base::URL url;
+			url.decode(registry_stream);
+			path2id.insert({ url.get_path_id(), size_as_serialization_id(i) });
+		}
+
+		state_stream.reset_buf_pos();
+		state_stream.paths = &loaded_paths;
+		loaded_registry.reserve(size_as_serialization_id(num_entries));
+		for (benchmark_node &node : loaded)
+		{
+			node.decode(state_stream);
+			serialization_id id = path2id.at(node.get_serialization_url().get_path_id());
+			node.set_serialization_index(id);
+			loaded_registry.Register(&node, id);
+		}
+
+		update_bits_stream.reset_buf_pos();
+		loaded_update_bits.decode(update_bits_stream);
+	}
+	int64_t load_us = elapsed_ns(start) / 1000;
+
+	for (int i = 0; i < num_nodes; i++)
+	{
+		assert(loaded[i] == *nodes[i]);
+	}
+	assert(loaded_update_bits == update_bits);
+
+	log_printf("%d nodes: register %lld ms, encode %lld ms, load %lld ms\n", num_nodes,
+		register_us / 1000, encode_us / 1000, load_us / 1000);
+	log_printf("state %llu KB, registry %llu KB, paths %llu KB, update bits %llu KB (%llu KB as bitsets)\n",
+		state_stream.size() / 1024, registry_stream.size() / 1024,
+		paths_stream.size() / 1024, update_bits_stream.size() / 1024,
+		bitset_bytes / 1024);
+	report.add("stress", "nodes", num_nodes);
+	report.add("stress", "register_ms", register_us / 1000.0);
+	report.add("stress", "encode_ms", encode_us / 1000.0);
+	report.add("stress", "load_ms", load_us / 1000.0);
+	report.add("stress", "state_kb", state_stream.size() / 1024.0);
+	report.add("stress", "registry_kb", registry_stream.size() / 1024.0);
+	report.add("stress", "paths_kb", paths_stream.size() / 1024.0);
+	report.add("stress", "update_bits_kb", update_bits_stream.size() / 1024.0);
+	report.add("stress", "update_bits_as_bitsets_kb", bitset_bytes / 1024.0);
+}
+
+
+// fill a capture with pod histories that change every frame, without talking to openvr
+static void make_synthetic_capture(capture *c, int num_frames)
+{
+	auto &system_node = c->m_state.system_node;
+	vr::HmdMatrix34_t m;
+	memset(&m, 0, sizeof(m));
+	for (int i = 0; i < num_frames; i++)
+	{
+		c->m_time_stamps.push_back(time_stamp_t(i) * 11111);
+		system_node.seconds_since_last_vsync.emplace_back(i, vr_result::Float<bool>(i * 0.011f, true));
+		system_node.frame_counter_since_last_vsync.emplace_back(i, vr_result::Uint64<bool>(uint64_t(i), true));
+		m.m[0][3] = float(i);
+		system_node.seated2standing.emplace_back(i, vr_result::HmdMatrix34<>(m));
+		c->increment_last_updated_frame();
+	}
+}
+
+static double file_mb(const std::string &fname)
+{
+	FileStream f;
+	bool rc = f.open_file_for_read(fname.c_str());
+	assert(rc);
+	return f.get_file_size() / (1024.0 * 1024.0);
+}
+
+static void time_synthetic_load(benchmark_report &report, const char *name, capture_test_context *context, const std::string &fname, bool mapped, bool parallel)
+{
+	capture_traverser traverser;
+	uint64_t resident_before = plat::get_resident_bytes();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool rc;
+	if (mapped)
+	{
+		rc = traverser.load_capture_from_mapped_file(&context->get_capture(), fname.c_str(), parallel);
+	}
+	else
+	{
+		rc = traverser.load_capture_from_binary_file(&context->get_capture(), fname.c_str(), parallel);
+	}
+	int64_t ns = elapsed_ns(start);
+	assert(rc);
+	assert(context->get_capture().get_last_updated_frame() == BENCHMARK_SYNTHETIC_FRAMES - 1);
+
+	double mb = file_mb(fname);
+	double resident_mb = double(plat::get_resident_bytes() - resident_before) / (1024.0 * 1024.0);
+	double peak_mb = double(plat::get_peak_resident_bytes()) / (1024.0 * 1024.0);
+	const char *mode = parallel ? "parallel" : "sequential";
+	log_printf("%s %s load: %.1f mb/s. resident +%.1f mb, process peak %.1f mb\n", name, mode, per_second(mb, ns), resident_mb, peak_mb);
+	std::string prefix = std::string(name) + "_" + mode + "_load_";
+	report.add("synthetic_save_load", (prefix + "mb_per_s").c_str(), per_second(mb, ns));
+	report.add("synthetic_save_load", (prefix + "resident_mb").c_str(), resident_mb);
+}
+
+static void time_synthetic_save(benchmark_report &report, capture *c, const std::string &fname, bool parallel)
+{
+	capture_traverser traverser;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool rc = traverser.save_capture_to_binary_file(c, fname.c_str(), parallel);
+	int64_t ns = elapsed_ns(start);
+	assert(rc);
+
+	double mb = file_mb(fname);
+	const char *mode = parallel ? "parallel" : "sequential";
+	log_printf("%s save of %d frames (%.1f mb): %.1f mb/s\n", mode, BENCHMARK_SYNTHETIC_FRAMES, mb, per_second(mb, ns));
+	report.add("synthetic_save_load", "file_mb", mb);
+	report.add("synthetic_save_load", (std::string(mode) + "_save_mb_per_s").c_str(), per_second(mb, ns));
+}
+
+// a capture far longer than the sim runs: the sequential and parallel saves, and the FileStream
+// loader against the memory mapped one.  the parallel save goes last so it's file is the one
+// that's loaded, and the mapped loader goes first so the FileStream loader's peak doesn't hide it
+static void benchmark_synthetic_save_load(benchmark_report &report)
+{
+	std::string fname(plat::make_temporary_filename("benchmark_synthetic_capture.bin"));
+	{
+		capture_test_context context;
+		make_synthetic_capture(&context.get_capture(), BENCHMARK_SYNTHETIC_FRAMES);
+		time_synthetic_save(report, &context.get_capture(), fname, false);
+		time_synthetic_save(report, &context.get_capture(), fname, true);
+	}
+
+	capture_test_context mapped_context;
+	time_synthetic_load(report, "mapped", &mapped_context, fname, true, false);
+	capture_test_context mapped_parallel_context;
+	time_synthetic_load(report, "mapped", &mapped_parallel_context, fname, true, true);
+	assert(mapped_context.get_capture() == mapped_parallel_context.get_capture());
+	capture_test_context file_context;
+	time_synthetic_load(report, "filestream", &file_context, fname, false, true);
+	assert(mapped_context.get_capture() == file_context.get_capture());
+}
+
+// compression ratio and save/load throughput for each compression mode.  throughput is in terms
+// of the uncompressed capture so the modes can be compared
+static void benchmark_compression(benchmark_report &report)
+{
+	static const struct { capture_compression compression; const char *name; } modes[] =
+	{
+		{ CAPTURE_COMPRESSION_NONE, "none" },
+		{ CAPTURE_COMPRESSION_LZ4, "lz4" },
+		{ CAPTURE_COMPRESSION_LZ4HC, "lz4hc" },
+	};
+
+	capture_test_context context;
+	make_synthetic_capture(&context.get_capture(), BENCHMARK_SYNTHETIC_FRAMES);
+
+	double uncompressed_mb = 0;
+	for (auto &mode : modes)
+	{
+		std::string fname(plat::make_temporary_filename(std::string("benchmark_compression_") + mode.name + ".bin"));
+		capture_traverser traverser;
+		traverser.set_save_compression(mode.compression);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		bool rc = traverser.save_capture_to_binary_file(&context.get_capture(), fname.c_str());
+		int64_t save_ns = elapsed_ns(start);
+		assert(rc);
+
+		capture_test_context loaded;
+		start = std::chrono::steady_clock::now();
+		rc = traverser.load_capture_from_mapped_file(&loaded.get_capture(), fname.c_str());
+		int64_t load_ns = elapsed_ns(start);
+		assert(rc);
+		assert(loaded.get_capture() == context.get_capture());
+
+		double mb = file_mb(fname);
+		if (mode.compression == CAPTURE_COMPRESSION_NONE)
+		{
+			uncompressed_mb = mb;
+		}
+		double ratio = mb > 0 ? uncompressed_mb / mb : 0.0;
+		log_printf("%s: %.1f mb, ratio %.2f. save %.1f mb/s, load %.1f mb/s\n", mode.name, mb, ratio,
+			per_second(uncompressed_mb, save_ns), per_second(uncompressed_mb, load_ns));
+		report.add("compression", (std::string(mode.name) + "_mb").c_str(), mb);
+		report.add("compression", (std::string(mode.name) + "_ratio").c_str(), ratio);
+		report.add("compression", (std::string(mode.name) + "_save_mb_per_s").c_str(), per_second(uncompressed_mb, save_ns));
+		report.add("compression", (std::string(mode.name) + "_load_mb_per_s").c_str(), per_second(uncompressed_mb, load_ns));
+	}
+}
+
+static void time_seeks(benchmark_report &report, const char *name, capture *c, const std::vector<time_index_t> &frames)
+{
+	CursorContext cursor_context(c);
+	VRSystemCursor system(&cursor_context);
+	vr::TrackedDeviceIndex_t left = 1;	// the hmd is 0 and the first controller is the left hand
+
+	float accum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (time_index_t frame : frames)
+	{
+		cursor_context.ChangeFrame(frame);
+		float seconds;
+		system.GetTimeSinceLastVsync(&seconds, nullptr);
+		vr::VRControllerState_t state;
+		vr::TrackedDevicePose_t pose;
+		system.GetControllerStateWithPose(vr::TrackingUniverseStanding, left, &state, sizeof(state), &pose);
+		accum += seconds + pose.mDeviceToAbsoluteTracking.m[0][3];
+	}
+	int64_t ns = elapsed_ns(start);
+	log_printf("%s seeks: %.0f per second (%f)\n", name, per_second(double(frames.size()), ns), accum);
+	report.add("cursor", (std::string(name) + "_seeks_per_s").c_str(), per_second(double(frames.size()), ns));
+}
+
+// random seeks and forward/backward scrubs across the updated capture
+static void benchmark_cursor(benchmark_report &report, capture_test_context *context)
+{
+	time_index_t num_frames = time_index_t(context->get_capture().m_time_stamps.size());
+	std::vector<time_index_t> random_frames(BENCHMARK_SEEKS);
+	std::vector<time_index_t> forward_frames(BENCHMARK_SEEKS);
+	std::vector<time_index_t> backward_frames(BENCHMARK_SEEKS);
+	std::mt19937 rng(1);
+	for (int i = 0; i < BENCHMARK_SEEKS; i++)
+	{
+		random_frames[i] = time_index_t(rng() % num_frames);
+		forward_frames[i] = time_index_t(i % num_frames);
+		backward_frames[i] = num_frames - 1 - time_index_t(i % num_frames);
+	}
+	time_seeks(report, "random", &context->get_capture(), random_frames);
+	time_seeks(report, "scrub_forward", &context->get_capture(), forward_frames);
+	time_seeks(report, "scrub_backward", &context->get_capture(), backward_frames);
+}
+
+template <template <typename, typename> class Container>
+static void benchmark_history_search(benchmark_report &report, const char *name, const std::vector<time_index_t> &frames)
+{
+	time_indexed_vector<Result<float, bool>, Container, std::allocator> history;
+	time_index_t frame = 0;
+	for (int i = 0; i < BENCHMARK_CONTAINER_ITEMS; i++)
+	{
+		history.emplace_back(frame, Result<float, bool>(float(i), true));
+		frame += 1 + i % 3;		// gaps, like a device that only updates when it changes
+	}
+
+	float accum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (time_index_t t : frames)
+	{
+		accum += history.last_item_less_than_or_equal_to_time(t % frame)->get_value().val;
+	}
+	int64_t search_ns = elapsed_ns(start);
+
+	auto hint = history.end();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCHMARK_CONTAINER_ITEMS; i++)
+	{
+		accum += history.last_item_less_than_or_equal_to_time(time_index_t(i), hint)->get_value().val;
+	}
+	int64_t hinted_ns = elapsed_ns(start);
+
+	log_printf("%s: search %.1f ns, hinted search %.1f ns (%f)\n", name,
+		double(search_ns) / frames.size(), double(hinted_ns) / BENCHMARK_CONTAINER_ITEMS, accum);
+	report.add("containers", (std::string(name) + "_search_ns").c_str(), double(search_ns) / frames.size());
+	report.add("containers", (std::string(name) + "_hinted_search_ns").c_str(), double(hinted_ns) / BENCHMARK_CONTAINER_ITEMS);
+}
+
+// about the size of vr::TrackedDevicePose_t, where columnar_list keeps the time indexes apart
+// from the values
+struct benchmark_pose
+{
+	float m[3][4];
+	float velocity[3];
+	float angular_velocity[3];
+	int32_t tracking_result;
+	int32_t flags;
+};
+
+inline bool operator == (const benchmark_pose &lhs, const benchmark_pose &rhs)
+{
+	return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+}
+
+inline bool operator != (const benchmark_pose &lhs, const benchmark_pose &rhs)
+{
+	return !(lhs == rhs);
+}
+
+// random seeks (scrubbing) and hinted seeks (playback, like vr_cursor_common.h's update_iter)
+template <template <typename, typename> class Container>
+static void benchmark_pose_seeks(benchmark_report &report, const char *name)
+{
+	time_indexed_vector<Result<benchmark_pose, bool>, Container, std::allocator> history;
+	std::mt19937 rng(7);
+	benchmark_pose p;
+	memset(&p, 0, sizeof(p));
+	time_index_t frame = 5;
+	for (int i = 0; i < BENCHMARK_CONTAINER_ITEMS; i++)
+	{
+		p.m[0][3] = float(i);
+		history.emplace_back(frame, Result<benchmark_pose, bool>(p, true));
+		frame += 1 + int(rng() % 3);
+	}
+	time_index_t first = history.earliest().get_time_index();
+	time_index_t last = history.latest().get_time_index();
+
+	std::vector<time_index_t> frames(BENCHMARK_CONTAINER_ITEMS);
+	for (auto &f : frames)
+	{
+		f = first + time_index_t(rng() % (last - first + 1));
+	}
+
+	uint64_t checksum = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (time_index_t f : frames)
+	{
+		checksum += history.last_item_less_than_or_equal_to_time(f)->get_time_index();
+	}
+	int64_t random_ns = elapsed_ns(start);
+
+	auto hint = history.end();
+	start = std::chrono::steady_clock::now();
+	for (time_index_t f = first; f <= last; f++)
+	{
+		hint = history.last_item_less_than_or_equal_to_time(f, hint);
+		checksum += hint->get_time_index();
+	}
+	int64_t playback_ns = elapsed_ns(start);
+
+	log_printf("%s poses: random seek %.1f ns, playback seek %.1f ns (%llu)\n", name,
+		double(random_ns) / frames.size(), double(playback_ns) / (last - first + 1), (unsigned long long)checksum);
+	report.add("containers", (std::string(name) + "_pose_seek_ns").c_str(), double(random_ns) / frames.size());
+	report.add("containers", (std::string(name) + "_pose_playback_seek_ns").c_str(), double(playback_ns) / (last - first + 1));
+}
+
+static void benchmark_containers(benchmark_report &report)
+{
+	segmented_list_1024<uint64_t> list;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCHMARK_CONTAINER_ITEMS; i++)
+	{
+		list.push_back(uint64_t(i));
+	}
+	int64_t append_ns = elapsed_ns(start);
+
+	std::vector<time_index_t> random_indexes(BENCHMARK_CONTAINER_ITEMS);
+	std::mt19937 rng(2);
+	for (int i = 0; i < BENCHMARK_CONTAINER_ITEMS; i++)
+	{
+		random_indexes[i] = time_index_t(rng() % BENCHMARK_CONTAINER_ITEMS);
+	}
+	uint64_t accum = 0;
+	start = std::chrono::steady_clock::now();
+	for (time_index_t i : random_indexes)
+	{
+		accum += list[i];
+	}
+	int64_t index_ns = elapsed_ns(start);
+
+	log_printf("segmented_list: append %.1f ns, index %.1f ns (%llu)\n",
+		double(append_ns) / BENCHMARK_CONTAINER_ITEMS, double(index_ns) / BENCHMARK_CONTAINER_ITEMS, (unsigned long long)accum);
+	report.add("containers", "segmented_list_append_ns", double(append_ns) / BENCHMARK_CONTAINER_ITEMS);
+	report.add("containers", "segmented_list_index_ns", double(index_ns) / BENCHMARK_CONTAINER_ITEMS);
+
+	benchmark_history_search<segmented_list_1024>(report, "segmented_list", random_indexes);
+	benchmark_history_search<columnar_list_1024>(report, "columnar_list", random_indexes);
+	benchmark_pose_seeks<segmented_list_1024>(report, "segmented_list");
+	benchmark_pose_seeks<columnar_list_1024>(report, "columnar_list");
+}
+
+// load and compress the sim's render model textures
+static void benchmark_texture_service(benchmark_report &report, capture_test_context *context)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	config.num_render_models = BENCHMARK_TEXTURES;
+	config.texture_width = BENCHMARK_TEXTURE_SIZE;
+	config.texture_height = BENCHMARK_TEXTURE_SIZE;
+	openvr_sim::configure(config);
+
+	std::vector<std::shared_ptr<texture>> textures;
+	texture_service service(context->sim_vr_interfaces().remi);
+	service.start();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCHMARK_TEXTURES; i++)
+	{
+		textures.push_back(std::make_shared<texture>(i));
+		service.process_texture(textures.back());
+	}
+	service.process_all_pending();
+	int64_t ns = elapsed_ns(start);
+	service.stop();
+
+	for (auto &tex : textures)
+	{
+		assert(tex->get_state() == texture::COMPRESSED);
+	}
+	double mb = BENCHMARK_TEXTURES * double(BENCHMARK_TEXTURE_SIZE) * BENCHMARK_TEXTURE_SIZE * 4 / (1024.0 * 1024.0);
+	log_printf("texture_service: %.1f textures per second, %.1f mb/s\n", per_second(BENCHMARK_TEXTURES, ns), per_second(mb, ns));
+	report.add("texture_service", "textures_per_s", per_second(BENCHMARK_TEXTURES, ns));
+	report.add("texture_service", "mb_per_s", per_second(mb, ns));
+
+	config.set_default();
+	openvr_sim::configure(config);
+}
+
+// what one update costs a new capture of a 16 device setup (hmd, 2 base stations, 2 controllers
+// and trackers).  nearly every history holds a single sample at this point, so this is mostly
+// what the time containers allocate up front (segmented_list.h's segment_layout)
+static void benchmark_discovery_memory(benchmark_report &report)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	config.num_trackers = BENCHMARK_DISCOVERY_DEVICES - 1 - config.num_controllers - config.num_base_stations;
+	openvr_sim::configure(config);
+
+	uint64_t resident_before = plat::get_resident_bytes();
+	uint64_t bytes_before = get_allocated_bytes();
+	uint64_t allocations_before = get_num_allocations();
+	{
+		capture_test_context context;
+		capture_traverser traverser;
+		traverser.update_capture(&context.get_capture(), &context.sim_vr_interfaces(), 0, false);
+
+		double resident_mb = double(plat::get_resident_bytes() - resident_before) / (1024.0 * 1024.0);
+		double allocated_mb = double(get_allocated_bytes() - bytes_before) / (1024.0 * 1024.0);
+		double allocations = double(get_num_allocations() - allocations_before);
+		log_printf("discovery of %d devices: resident +%.1f mb, allocated %.1f mb in %.0f allocations%s\n",
+			BENCHMARK_DISCOVERY_DEVICES, resident_mb, allocated_mb, allocations,
+			counting_allocations() ? "" : " (allocations not counted in this build)");
+		report.add("memory", "discovery_devices", BENCHMARK_DISCOVERY_DEVICES);
+		report.add("memory", "discovery_resident_mb", resident_mb);
+		report.add("memory", "discovery_allocated_mb", allocated_mb);
+		report.add("memory", "discovery_allocations", allocations);
+	}
+}
+
+// read the sim's events for the frame into the poll schedule, the way a recorder does before
+// each update (poll_events.h)
+static void drain_events(capture *c, openvr_broker::open_vr_interfaces *vri)
+{
+	vr::VREvent_t event;
+	while (vri->sysi->PollNextEvent(&event, sizeof(event)))
+	{
+		invalidate_for_event(event, &c->m_keys, &c->m_poll_schedule);
+	}
+}
+
+// once the capture is discovered, updates of a moving setup: the sim advances every frame, so
+// poses and frame timings change every update, buttons and overlay images every so often, and
+// the churning properties send events.  two kinds of allocation are counted:
+//  * the heap (operator new).  an update shouldn't make any
+//  * the capture's slab.  what an update records is kept there: the frame's update bits, and a new
+//    segment whenever a history or the time stamp list fills one (4, 16, 64 ... entries, see
+//    segment_layout).  that's expected.  a slab block freed during the update is one the update
+//    didn't keep, ie. scratch it should have reused
+// the warmup runs through a few of each kind of change first, so the buffers updates reuse have
+// grown.  returns false if an update allocated
+static bool benchmark_steady_state_allocations(benchmark_report &report, bool parallel)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	config.property_churn_period_frames = BENCHMARK_STEADY_EVENT_PERIOD;
+	openvr_sim::configure(config);
+
+	capture_test_context context;
+	capture &c = context.get_capture();
+	openvr_broker::open_vr_interfaces &vri = context.sim_vr_interfaces();
+	capture_traverser traverser;
+	int frame = 0;
+	for (; frame < BENCHMARK_WARMUP_FRAMES; frame++)
+	{
+		drain_events(&c, &vri);
+		traverser.update_capture(&c, &vri, time_stamp_t(frame) * 11111, parallel);
+		openvr_sim::advance_frame();
+	}
+
+	// the textures discovery found are compressed in the background.  the workers' allocations
+	// aren't the updates'
+	c.m_keys.GetTextureIndexer().process_all_pending();
+
+	int heap_frames = 0;
+	uint64_t heap_allocations = 0;
+	int time_stamp_segments = 0;
+	int changed_frames = 0;
+	uint64_t slab_allocations = 0;
+	int slab_freeing_frames = 0;
+	for (; frame < BENCHMARK_WARMUP_FRAMES + BENCHMARK_STEADY_FRAMES; frame++)
+	{
+		SegmentSizeType segment, offset;
+		VRTimestampVector::layout::locate(c.m_time_stamps.size(), &segment, &offset);
+		if (offset == 0)
+		{
+			time_stamp_segments++;
+		}
+		size_t num_update_bits = c.m_state_update_bits.size();
+
+		uint64_t heap_start = get_num_allocations();
+		uint64_t slab_start = c.m_slab.get_num_alloc_calls();
+		uint64_t slab_free_start = c.m_slab.get_num_dealloc_calls();
+		drain_events(&c, &vri);
+		traverser.update_capture(&c, &vri, time_stamp_t(frame) * 11111, parallel);
+		uint64_t frame_heap = get_num_allocations() - heap_start;
+		slab_allocations += c.m_slab.get_num_alloc_calls() - slab_start;
+		uint64_t frame_slab_frees = c.m_slab.get_num_dealloc_calls() - slab_free_start;
+		openvr_sim::advance_frame();
+
+		if (frame_heap > 0)
+		{
+			heap_frames++;
+			heap_allocations += frame_heap;
+		}
+		if (frame_slab_frees > 0)
+		{
+			slab_freeing_frames++;
+		}
+		if (c.m_state_update_bits.size() != num_update_bits)
+		{
+			changed_frames++;
+		}
+	}
+
+	const char *mode = parallel ? "parallel" : "sequential";
+	log_printf("%s steady state, %d updates (%d changed something): heap %llu allocations in %d updates%s. slab %llu allocations, %d new time stamp segments, %d updates freed scratch\n",
+		mode, BENCHMARK_STEADY_FRAMES, changed_frames, (unsigned long long)heap_allocations, heap_frames,
+		counting_allocations() ? "" : " (not counted in this build)", (unsigned long long)slab_allocations,
+		time_stamp_segments, slab_freeing_frames);
+	std::string prefix = std::string(mode) + "_steady_state_";
+	report.add("allocations", (prefix + "changed_frames").c_str(), changed_frames);
+	report.add("allocations", (prefix + "heap_allocating_frames").c_str(), heap_frames);
+	report.add("allocations", (prefix + "heap_allocations").c_str(), double(heap_allocations));
+	report.add("allocations", (prefix + "slab_allocations").c_str(), double(slab_allocations));
+	report.add("allocations", (prefix + "time_stamp_segments").c_str(), time_stamp_segments);
+	report.add("allocations", (prefix + "slab_freeing_frames").c_str(), slab_freeing_frames);
+	return heap_frames == 0 && slab_freeing_frames == 0;
+}
+
+// false if a check failed
+bool run_benchmarks(benchmark_report &report)
+{
+	report.add("config", "update_frames", BENCHMARK_UPDATE_FRAMES);
+	report.add("config", "hardware_concurrency", std::thread::hardware_concurrency());
+
+	// first, while the heap is still small
+	benchmark_discovery_memory(report);
+
+	capture_test_context sequential;
+	capture_test_context parallel;
+	benchmark_update(report, "sequential", &sequential, false);
+	benchmark_update(report, "parallel", &parallel, true);
+
+	// what the poll schedule saves (CaptureConfig::poll_rates)
+	capture_test_context every_frame;
+	every_frame.get_config().set_poll_every_frame();
+	benchmark_update(report, "parallel_poll_every_frame", &every_frame, true);
+
+	// and what re-polling only on openvr events saves on top
+	capture_test_context event_driven;
+	event_driven.get_config().set_poll_on_events(10000);
+	benchmark_update(report, "parallel_poll_on_events", &event_driven, true, true);
+	report.add("config", "sim_seed", double(openvr_sim::get_config().seed));
+	assert(capture_test_context::captured_the_same(sequential.get_capture(), parallel.get_capture()));
+
+	benchmark_update_visitor(report);
+	benchmark_stress(report);
+	benchmark_save_load(report, &parallel);
+	benchmark_synthetic_save_load(report);
+	benchmark_compression(report);
+	benchmark_cursor(report, &parallel);
+	benchmark_containers(report);
+	benchmark_texture_service(report, &parallel);
+
+	bool rc = benchmark_steady_state_allocations(report, false);
+	rc &= benchmark_steady_state_allocations(report, true);
+	return rc;
+}
+
+#ifdef BENCHMARK_MAIN
+int hack_vr_init_called = 0;
+
+int main(int argc, char **argv)
+{
+	const char *fname = argc > 1 ? argv[1] : "benchmark_results.json";
+	benchmark_report report;
+	bool checks_passed = run_benchmarks(report);
+	if (!report.write_json(fname))
+	{
+		log_printf("failed to write %s\n", fname);
+		return 1;
+	}
+	log_printf("benchmark results written to %s\n", fname);
+	if (!checks_passed)
+	{
+		log_printf("steady state updates allocated\n");
+		return 2;
+	}
+	return 0;
+}
+#endif
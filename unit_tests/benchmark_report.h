@@ -0,0 +1,78 @@
+#pragma once
+//
+// benchmark_report: numbers from the benchmark executable, written out as json so runs can be
+//                   compared by scripts.
+//
+//  * values are grouped ({"update": {"sequential_p50_us": 120, ...}, "save_load": {...}}) and
+//    written in the order they were added, each group where it was first added.
+//
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+struct benchmark_report
+{
+	void add(const char *group, const char *name, double value)
+	{
+		m_entries.push_back({ group, name, value });
+	}
+
+	bool write_json(const char *filename) const
+	{
+		FILE *f = fopen(filename, "w");
+		if (!f)
+			return false;
+		write_json(f);
+		return fclose(f) == 0;
+	}
+
+	// a group added to again later is still written once, where it was first added
+	void write_json(FILE *f) const
+	{
+		fprintf(f, "{");
+		std::vector<std::string> groups;
+		for (const entry &e : m_entries)
+		{
+			if (std::find(groups.begin(), groups.end(), e.group) == groups.end())
+			{
+				groups.push_back(e.group);
+			}
+		}
+		for (size_t g = 0; g < groups.size(); g++)
+		{
+			fprintf(f, "%s\n\t\"%s\": {", g ? "," : "", groups[g].c_str());
+			const char *separator = "";
+			for (const entry &e : m_entries)
+			{
+				if (e.group == groups[g])
+				{
+					fprintf(f, "%s\n\t\t\"%s\": %.9g", separator, e.name.c_str(), e.value);
+					separator = ",";
+				}
+			}
+			fprintf(f, "\n\t}");
+		}
+		fprintf(f, "\n}\n");
+	}
+
+	// value at percentile p (0..100) of samples.  sorts samples
+	static double percentile(std::vector<double> *samples, double p)
+	{
+		if (samples->empty())
+			return 0.0;
+		std::sort(samples->begin(), samples->end());
+		size_t i = size_t(p / 100.0 * (samples->size() - 1) + 0.5);
+		return (*samples)[std::min(i, samples->size() - 1)];
+	}
+
+private:
+	struct entry
+	{
+		std::string group;
+		std::string name;
+		double value;
+	};
+	std::vector<entry> m_entries;
+};
@@ -4,6 +4,10 @@
 #include "vr_tmp_vector.h"
 #include "capture.h"
 #include "capture_test_context.h"
+#include "log.h"
+#include <string>
+#include <unordered_map>
+#include <set>
 
 tmp_vector_pool<VRTMPSize> g_tmp_pool;
 
@@ -17,12 +21,9 @@ capture_test_context::capture_test_context()
 	: 
 	m_config(nullptr),
 	m_capture(nullptr),
-	m_interfaces(nullptr)
+	m_interfaces(nullptr),
+	m_sim_interfaces(nullptr)
 {
-	if (!slab_allocator_base::m_temp_slab)
-	{
-		slab_allocator_base::m_temp_slab = new slab(1024 * 1024 * 32);
-	}
 	if (!vr_tmp_vector_base::m_global_pool)
 	{
 		vr_tmp_vector_base::m_global_pool = &g_tmp_pool;
@@ -46,6 +47,7 @@ capture_test_context::~capture_test_context()
 	delete m_config;
 	delete m_capture;
 	delete m_interfaces;
+	delete m_sim_interfaces;
 }
 
 CaptureConfig &capture_test_context::get_config()
@@ -64,6 +66,9 @@ capture& capture_test_context::get_capture()
 	{
 		m_capture = new capture;
 		m_capture->m_keys.Init(get_config());
+		m_capture->m_poll_schedule.Init(get_config());
+		m_capture->m_overlay_images.Init(get_config());
+		m_capture->m_cold_segments.Init(get_config());
 	}
 	return *m_capture;
 }
@@ -84,3 +89,83 @@ openvr_broker::open_vr_interfaces &capture_test_context::raw_vr_interfaces()
 	return *m_interfaces;
 }
 
+openvr_broker::open_vr_interfaces &capture_test_context::sim_vr_interfaces()
+{
+	if (!m_sim_interfaces)
+	{
+		char *error;
+		m_sim_interfaces = new openvr_broker::open_vr_interfaces;
+		bool acquired = openvr_broker::acquire_interfaces("sim", m_sim_interfaces, &error);
+		if (!acquired)
+		{
+			log_printf("error! %s", error);
+			exit(1);
+		}
+	}
+	return *m_sim_interfaces;
+}
+
+static std::set<std::string> updated_paths(const capture &c, time_index_t t)
+{
+	std::set<std::string> paths;
+	auto entry = c.m_state_update_bits.find_entry(t);
+	if (entry)
+	{
+		const sparse_bitset &bits = entry->get_value();
+		for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+		{
+			paths.insert(c.m_state_registry.registered[id]->get_serialization_url().get_full_path());
+		}
+	}
+	return paths;
+}
+
+bool capture_test_context::captured_the_same(const capture &a, const capture &b)
+{
+	if (a.m_save_summary != b.m_save_summary ||
+		a.get_last_updated_frame() != b.get_last_updated_frame() ||
+		a.m_keys != b.m_keys ||
+		a.m_time_stamps != b.m_time_stamps ||
+		a.m_keys_updates != b.m_keys_updates ||
+		a.m_state_registry.registered.size() != b.m_state_registry.registered.size())
+	{
+		return false;
+	}
+
+	std::unordered_map<std::string, const RegisteredSerializable *> b_nodes;
+	for (const RegisteredSerializable *node : b.m_state_registry.registered)
+	{
+		b_nodes.insert({ node->get_serialization_url().get_full_path(), node });
+	}
+
+	// every node of a has to be in b, with entries at the same frames
+	for (const RegisteredSerializable *node : a.m_state_registry.registered)
+	{
+		std::string path = node->get_serialization_url().get_full_path();
+		auto iter = b_nodes.find(path);
+		if (iter == b_nodes.end())
+		{
+			log_printf("captured_the_same: %s is missing\n", path.c_str());
+			return false;
+		}
+		for (time_index_t t = 0; t <= a.get_last_updated_frame(); t++)
+		{
+			if (node->has_entry(t) != iter->second->has_entry(t))
+			{
+				log_printf("captured_the_same: %s differs at frame %d\n", path.c_str(), t);
+				return false;
+			}
+		}
+	}
+
+	// and the same nodes have to be marked updated
+	for (time_index_t t = 0; t <= a.get_last_updated_frame(); t++)
+	{
+		if (updated_paths(a, t) != updated_paths(b, t))
+		{
+			log_printf("captured_the_same: the updates differ at frame %d\n", t);
+			return false;
+		}
+	}
+	return true;
+}
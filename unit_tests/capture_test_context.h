@@ -23,9 +23,36 @@ public:
 	CaptureConfig &get_config();
 	capture& get_capture();
 	openvr_broker::open_vr_interfaces &raw_vr_interfaces();
+	openvr_broker::open_vr_interfaces &sim_vr_interfaces();	// see openvr_sim.h
+
+	// true if a and b have the same nodes, updated on the same frames.  unlike capture ==, the
+	// serialization ids don't have to match: a parallel update registers new nodes in whichever
+	// order its tasks get to them.  like it, the values aren't compared; same_history does that
+	static bool captured_the_same(const capture &a, const capture &b);
 
 private:
 	CaptureConfig *m_config;
 	capture *m_capture;
 	openvr_broker::open_vr_interfaces *m_interfaces;
+	openvr_broker::open_vr_interfaces *m_sim_interfaces;
 };
+
+// the histories match.  time_node == also compares the serialization ids
+template <typename T, template <typename, typename> class Container, template <typename> class A>
+inline bool same_history(const time_indexed_vector<T, Container, A> &a, const time_indexed_vector<T, Container, A> &b)
+{
+	return a == b;
+}
+
+template <typename VectorOfNodes>
+inline bool same_histories(const VectorOfNodes &a, const VectorOfNodes &b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (!same_history(a[i], b[i]))
+			return false;
+	}
+	return true;
+}
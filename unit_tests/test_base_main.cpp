@@ -5,12 +5,20 @@ extern void test_base_stream();
 extern void TEST_SEGMENTED_LIST();
 extern void TEST_RESULT();
 extern void TEST_SLAB_ALLOCATOR();
+extern void TEST_TMP_VECTOR();
+extern void TEST_INTERNED_STRINGS();
+extern void TEST_URL_NAMED();
+extern void TEST_SPARSE_BITSET();
 
 void test_base()
 {
 	test_base_stream();
 	TEST_RESULT();
 	TEST_SLAB_ALLOCATOR();
+	TEST_TMP_VECTOR();
+	TEST_INTERNED_STRINGS();
+	TEST_URL_NAMED();
+	TEST_SPARSE_BITSET();
 	TEST_SEGMENTED_LIST();
 }
 
@@ -3,6 +3,7 @@
 
 #include "capture_test_context.h"
 #include "capture_traverser.h"
+#include "FileStream.h"
 
 using namespace vr;
 
@@ -94,6 +95,74 @@ void test_capture_serialization()
 		capture_test_context contextb;
 		traverser.load_capture_from_binary_file(&contextb.get_capture(), fname.c_str());
 		assert(contexta.get_capture() == contextb.get_capture());
+
+		// sequential and parallel save/load use the same format
+		std::string sequential_fname(plat::make_temporary_filename("tracker10_sequential.bin"));
+		assert(traverser.save_capture_to_binary_file(&contexta.get_capture(), sequential_fname.c_str(), false));
+		capture_test_context contextc;
+		assert(traverser.load_capture_from_mapped_file(&contextc.get_capture(), sequential_fname.c_str(), true));
+		assert(contexta.get_capture() == contextc.get_capture());
+		capture_test_context contextd;
+		assert(traverser.load_capture_from_binary_file(&contextd.get_capture(), fname.c_str(), false));
+		assert(contexta.get_capture() == contextd.get_capture());
+
+		// compressed, and the file has to be smaller
+		std::string lz4_fname(plat::make_temporary_filename("tracker10_lz4.bin"));
+		capture_traverser lz4_traverser;
+		lz4_traverser.set_save_compression(CAPTURE_COMPRESSION_LZ4);
+		assert(lz4_traverser.save_capture_to_binary_file(&contexta.get_capture(), lz4_fname.c_str()));
+		capture_test_context contexte;
+		assert(traverser.load_capture_from_binary_file(&contexte.get_capture(), lz4_fname.c_str()));
+		assert(contexta.get_capture() == contexte.get_capture());
+		capture_test_context contextf;
+		assert(traverser.load_capture_from_mapped_file(&contextf.get_capture(), lz4_fname.c_str(), false));
+		assert(contexta.get_capture() == contextf.get_capture());
+		FileStream raw_file, lz4_file;
+		assert(raw_file.open_file_for_read(fname.c_str()) && lz4_file.open_file_for_read(lz4_fname.c_str()));
+		assert(lz4_file.get_file_size() < raw_file.get_file_size());
+	}
+	capture_test_context::reset_globals();
+	{
+		std::string fname(plat::make_temporary_filename("tracker_journal.bin"));
+		log_printf("journaling 10 updates to %s\n", fname.c_str());
+		capture_test_context contexta;
+		traverser.update_capture_parallel(&contexta.get_capture(), &contexta.raw_vr_interfaces(), 0);
+		assert(traverser.open_capture_journal(&contexta.get_capture(), fname.c_str()));
+		for (int i = 1; i < 10; i++)
+		{
+			traverser.update_capture_parallel(&contexta.get_capture(), &contexta.raw_vr_interfaces(), i);
+			assert(traverser.append_capture_journal(&contexta.get_capture()));
+		}
+
+		// a journal that was never closed (eg. the process died) loads everything appended so far
+		{
+			capture_test_context contextb;
+			assert(traverser.load_capture_from_binary_file(&contextb.get_capture(), fname.c_str()));
+			assert(contexta.get_capture() == contextb.get_capture());
+		}
+
+		// an incomplete last chunk is ignored
+		{
+			FileStream in;
+			assert(in.open_file_for_read(fname.c_str()));
+			std::vector<char> bytes(size_t(in.get_file_size()));
+			in.read_from_stream(bytes.data(), bytes.size());
+
+			std::string torn_fname(plat::make_temporary_filename("tracker_journal_torn.bin"));
+			FileStream out;
+			assert(out.open_file_for_write_plus(torn_fname.c_str()));
+			out.write_to_stream(bytes.data(), bytes.size() - 3);
+			out.close();
+
+			capture_test_context contextb;
+			assert(traverser.load_capture_from_binary_file(&contextb.get_capture(), torn_fname.c_str()));
+			assert(contextb.get_capture().get_last_updated_frame() == contexta.get_capture().get_last_updated_frame() - 1);
+		}
+
+		traverser.close_capture_journal(&contexta.get_capture());
+		capture_test_context contextb;
+		assert(traverser.load_capture_from_binary_file(&contextb.get_capture(), fname.c_str()));
+		assert(contexta.get_capture() == contextb.get_capture());
 	}
 	capture_test_context::reset_globals();
 	log_printf("done test_capture_serialization\n");
@@ -0,0 +1,363 @@
+//
+// cold segments: compressed history segments read back the same, through iterators, searches,
+// copies and saves, and readers can read while they're compressed
+//
+#include "cold_segments.h"
+#include "segmented_list.h"
+#include "columnar_list.h"
+#include "time_containers.h"
+#include "result.h"
+#include "platform.h"
+#include "openvr_sim.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "log.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+// a four byte return code, so the samples have no padding to compress
+enum cold_test_error { cold_test_success, cold_test_failed };
+
+template <>
+struct ValidReturnCode<cold_test_error>
+{
+	static const cold_test_error return_code = cold_test_success;
+};
+
+typedef segmented_list<int, 1024> cold_test_list;
+typedef time_indexed_vector<Result<int, cold_test_error>, columnar_list_1024, std::allocator> cold_test_history;
+
+static void configure_cache(cold_segment_cache *cache, uint64_t capacity, uint64_t resident_bytes = 0)
+{
+	CaptureConfig config;
+	config.set_default();
+	config.cold_segment_cache_bytes = capacity;
+	config.cold_segment_resident_bytes = resident_bytes;
+	cache->Init(config);
+}
+
+static int test_value(int i)
+{
+	return i / 7;
+}
+
+static bool all_cold(int) { return true; }
+
+// 340 items in the small segments, then 1024 a segment
+static void test_compress_segments()
+{
+	cold_segment_cache cache;
+	configure_cache(&cache, 2 * 1024 * sizeof(int));
+	cold_test_list list;
+	for (int i = 0; i < 5000; i++)
+	{
+		list.emplace_back(test_value(i));
+	}
+	list.compress_segments(&cache, all_cold);
+	assert(cache.get_num_compressed() == 4);
+	assert(cache.get_bytes_saved() > 0);
+
+	// read twice over: the cache holds two segments, so every segment is decompressed twice
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 0; i < 5000; i++)
+		{
+			assert(list[i] == test_value(i));
+		}
+		int i = 0;
+		for (int value : list)
+		{
+			assert(value == test_value(i++));
+		}
+	}
+	assert(cache.get_num_misses() >= 8);
+	assert(cache.get_cached_bytes() <= 2 * 1024 * sizeof(int));
+
+	// copies are hot, and equal
+	cold_test_list copy(list);
+	assert(copy == list);
+	assert(list == copy);
+
+	// later passes only look at the new segments
+	for (int i = 5000; i < 7000; i++)
+	{
+		list.emplace_back(test_value(i));
+	}
+	cache.begin_pass();
+	list.compress_segments(&cache, all_cold);
+	assert(cache.get_num_compressed() == 6);
+	assert(list.back() == test_value(6999));
+
+	list.clear();
+	assert(cache.get_num_compressed() == 0 && cache.get_cached_bytes() == 0);
+	list.emplace_back(3);
+	assert(list[0] == 3);
+}
+
+// random segments don't shrink enough to be worth it, and stay as they are.  when they can be
+// spilled they're stored as they are, and read in place
+static void test_incompressible()
+{
+	std::mt19937 rng(5);
+	std::vector<int> ref;
+	for (int i = 0; i < 3000; i++)
+	{
+		ref.push_back(int(rng()));
+	}
+	for (uint64_t resident_bytes : { uint64_t(0), uint64_t(1024 * 1024) })
+	{
+		cold_segment_cache cache;
+		configure_cache(&cache, 1024 * 1024, resident_bytes);
+		cold_test_list list;
+		for (int value : ref)
+		{
+			list.emplace_back(value);
+		}
+		list.compress_segments(&cache, all_cold);
+		assert(cache.get_num_compressed() == 0);
+		assert(cache.get_num_stored() == (resident_bytes ? 2 : 0));
+		assert(std::equal(ref.begin(), ref.end(), list.begin()));
+		assert(cache.get_num_misses() == 0);
+	}
+}
+
+// past the resident ceiling the oldest cold segments go to the scratch file, and read back the
+// same from there
+static void test_spill()
+{
+	static const int NUM_VALUES = 30000;
+	cold_segment_cache cache;
+	configure_cache(&cache, 2 * 1024 * sizeof(int), 8 * 1024);
+	std::mt19937 rng(7);
+	std::vector<int> ref;
+	cold_test_list list;
+	for (int i = 0; i < NUM_VALUES; i++)
+	{
+		// every third segment is noise, and is stored rather than compressed
+		ref.push_back(i >= 340 && (i - 340) / 1024 % 3 == 2 ? int(rng()) : test_value(i));
+		list.emplace_back(ref.back());
+		if (i % 5000 == 4999)
+		{
+			cache.begin_pass();
+			list.compress_segments(&cache, all_cold);
+			cache.end_pass();
+			assert(cache.get_resident_bytes() <= 8 * 1024);
+		}
+	}
+	assert(cache.get_num_stored() > 0 && cache.get_num_compressed() > 0);
+	assert(cache.get_spilled_bytes() > 0);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		assert(std::equal(ref.begin(), ref.end(), list.begin()));
+		for (int i = NUM_VALUES - 1; i >= 0; i -= 97)
+		{
+			assert(list[i] == ref[i]);
+		}
+	}
+	cold_test_list copy(list);
+	assert(copy == list);
+
+	list.clear();
+	assert(cache.get_spilled_bytes() == 0 && cache.get_resident_bytes() == 0);
+}
+
+// passes stop at cold_segment_pass_bytes, and the next ones carry on where they stopped
+static void test_pass_limit()
+{
+	CaptureConfig config;
+	config.set_default();
+	config.cold_segment_pass_bytes = 2 * 1024 * sizeof(int);	// two segments a pass
+	cold_segment_cache cache;
+	cache.Init(config);
+	cold_test_list a;
+	cold_test_list b;
+	for (int i = 0; i < 5000; i++)
+	{
+		a.emplace_back(test_value(i));
+		b.emplace_back(test_value(i));
+	}
+
+	uint64_t expected[] = { 2, 4, 6, 8 };
+	for (uint64_t num_compressed : expected)
+	{
+		cache.begin_pass();
+		a.compress_segments(&cache, all_cold);
+		b.compress_segments(&cache, all_cold);
+		cache.end_pass();
+		assert(cache.get_num_compressed() == num_compressed);
+		assert(cache.pass_was_limited());
+	}
+	cache.begin_pass();
+	a.compress_segments(&cache, all_cold);
+	b.compress_segments(&cache, all_cold);
+	cache.end_pass();
+	assert(cache.get_num_compressed() == 8 && !cache.pass_was_limited());
+	for (int i = 0; i < 5000; i++)
+	{
+		assert(a[i] == test_value(i) && b[i] == test_value(i));
+	}
+}
+
+// a sample every other frame.  searches only read the keys, values come from the cache
+static void test_cold_history()
+{
+	cold_segment_cache cache;
+	configure_cache(&cache, 1024 * 1024);
+	cold_test_history history;
+	for (int i = 0; i < 5000; i++)
+	{
+		history.emplace_back(2 * i, Result<int, cold_test_error>(test_value(i), cold_test_success));
+	}
+	cold_test_history hot(history);
+
+	// the segments ending at items 1363 and 2387 are older than frame 6000. the next one isn't
+	history.compress_cold_segments(6000, &cache);
+	assert(cache.get_num_compressed() == 2);
+	assert(history == hot);
+
+	auto hint = history.end();
+	for (time_index_t t = 0; t < 10005; t += 3)
+	{
+		auto it = history.last_item_less_than_or_equal_to_time(t);
+		auto hot_it = hot.last_item_less_than_or_equal_to_time(t);
+		assert(it->get_time_index() == hot_it->get_time_index() && it->get_value() == hot_it->get_value());
+		hint = history.last_item_less_than_or_equal_to_time(t, hint);
+		assert(hint->get_value() == hot_it->get_value());
+
+		auto range = history.get_range(t, t + 40);
+		auto hot_range = hot.get_range(t, t + 40);
+		assert(range.end() - range.begin() == hot_range.end() - hot_range.begin());
+		assert(std::equal(range.begin(), range.end(), hot_range.begin()));
+	}
+}
+
+// the writer appends and compresses while readers read all over the list.  a pass only starts
+// once every reader has finished a read that began after the last one, standing in for the
+// maintenance period readers rely on (see cold_segments.h).  a fixed sleep isn't enough: a
+// reader can be descheduled for longer than that between finding a segment and reading it
+static void test_concurrent_readers()
+{
+	static const int NUM_WRITES = 40000;
+	static const int NUM_READERS = 3;
+	cold_segment_cache cache;
+	configure_cache(&cache, 3 * 1024 * sizeof(int));
+	cold_test_list list;
+	std::atomic<bool> done(false);
+	std::atomic<int> pass(0);
+	std::atomic<int> reader_pass[NUM_READERS];		// the pass each reader's last finished read began in
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < NUM_READERS; r++)
+	{
+		reader_pass[r] = -1;
+		readers.emplace_back([&list, &done, &pass, &reader_pass, r]()
+		{
+			std::mt19937 rng(r);
+			while (!done)
+			{
+				int started_in = pass;
+				int size = size_as_int(list.size());
+				if (size == 0)
+					continue;
+				int i = int(rng() % size);
+				assert(list[i] == test_value(i));
+				assert(*(list.begin() + i) == test_value(i));
+				assert(list.back() >= test_value(size - 1));
+				reader_pass[r] = started_in;
+			}
+		});
+	}
+	for (int i = 0; i < NUM_WRITES; i++)
+	{
+		list.emplace_back(test_value(i));
+		if (i % 1500 == 0)
+		{
+			for (int r = 0; r < NUM_READERS; r++)
+			{
+				while (reader_pass[r] < pass)
+				{
+					std::this_thread::yield();
+				}
+			}
+			cache.begin_pass();
+			list.compress_segments(&cache, all_cold);
+			pass++;
+		}
+	}
+	done = true;
+	for (auto &reader : readers)
+	{
+		reader.join();
+	}
+	assert(cache.get_num_compressed() > 30);
+	for (int i = 0; i < NUM_WRITES; i++)
+	{
+		assert(list[i] == test_value(i));
+	}
+}
+
+// a sim capture compressed and spilled by the maintenance pass is the same capture, and saves
+// the same
+static void test_sim_capture()
+{
+	openvr_sim::sim_config sim;
+	sim.set_default();
+	openvr_sim::configure(sim);
+
+	capture_test_context context;
+	context.get_config().cold_segment_age_frames = 100;
+	context.get_config().cold_segment_cache_bytes = 256 * 1024;
+	context.get_config().cold_segment_resident_bytes = 16 * 1024;
+	capture &c = context.get_capture();
+	capture_traverser traverser;
+	for (int i = 0; i < 2000; i++)
+	{
+		traverser.update_capture(&c, &context.sim_vr_interfaces(), i * 11111, false);
+		openvr_sim::advance_frame();
+	}
+	capture hot(c);
+
+	traverser.compress_cold_segments(&c);
+	assert(c.m_cold_segments.get_num_compressed() > 0);
+	assert(c.m_cold_segments.get_spilled_bytes() > 0);
+	auto &controllers = c.m_state.system_node.controllers;
+	for (int i = 0; i < size_as_int(controllers.size()); i++)
+	{
+		assert(controllers[i].raw_tracking_pose == hot.m_state.system_node.controllers[i].raw_tracking_pose);
+	}
+
+	std::string fname = plat::make_temporary_filename("cold_segments_test.bin");
+	assert(traverser.save_capture_to_binary_file(&c, fname.c_str()));
+	capture_test_context loaded;
+	assert(traverser.load_capture_from_binary_file(&loaded.get_capture(), fname.c_str()));
+	assert(loaded.get_capture() == c);		// saving stamped c's summary
+	auto &loaded_controllers = loaded.get_capture().m_state.system_node.controllers;
+	for (int i = 0; i < size_as_int(controllers.size()); i++)
+	{
+		assert(loaded_controllers[i].raw_tracking_pose == hot.m_state.system_node.controllers[i].raw_tracking_pose);
+	}
+	remove(fname.c_str());
+
+	log_printf("cold segments: %llu compressed, %llu stored, %llu kb saved, %llu kb spilled, %llu hits %llu misses\n",
+		(unsigned long long)c.m_cold_segments.get_num_compressed(),
+		(unsigned long long)c.m_cold_segments.get_num_stored(),
+		(unsigned long long)c.m_cold_segments.get_bytes_saved() / 1024,
+		(unsigned long long)c.m_cold_segments.get_spilled_bytes() / 1024,
+		(unsigned long long)c.m_cold_segments.get_num_hits(),
+		(unsigned long long)c.m_cold_segments.get_num_misses());
+}
+
+void test_cold_segments()
+{
+	test_compress_segments();
+	test_incompressible();
+	test_spill();
+	test_pass_limit();
+	test_cold_history();
+	test_concurrent_readers();
+	test_sim_capture();
+	log_printf("test_cold_segments done\n");
+}
@@ -0,0 +1,152 @@
+// columnar_list: time_indexed_vector searches must give the same answers as on segmented_list.
+// the seek timings are in benchmark_main.cpp
+//
+#include "time_containers.h"
+#include "segmented_list.h"
+#include "columnar_list.h"
+#include "result.h"
+#include "log.h"
+#include <random>
+
+// about the size of vr::TrackedDevicePose_t
+struct seek_pose
+{
+	float m[3][4];
+	float velocity[3];
+	float angular_velocity[3];
+	int32_t tracking_result;
+	int32_t flags;
+};
+
+inline bool operator == (const seek_pose &lhs, const seek_pose &rhs)
+{
+	return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+}
+
+inline bool operator != (const seek_pose &lhs, const seek_pose &rhs)
+{
+	return !(lhs == rhs);
+}
+
+template <template <typename, typename> class Container>
+using seek_history = time_indexed_vector<Result<seek_pose, bool>, Container, std::allocator>;
+
+// frames with gaps, like a device that only updates when it changes
+template <template <typename, typename> class Container>
+static void make_seek_history(seek_history<Container> *h, int num_samples)
+{
+	std::mt19937 rng(7);
+	seek_pose p;
+	memset(&p, 0, sizeof(p));
+	time_index_t frame = 5;
+	for (int i = 0; i < num_samples; i++)
+	{
+		p.m[0][3] = float(i);
+		h->emplace_back(frame, Result<seek_pose, bool>(p, true));
+		frame += 1 + int(rng() % 3);
+	}
+}
+
+template <typename A, typename B>
+static bool same_position(A &va, const typename A::iterator &a, B &vb, const typename B::iterator &b)
+{
+	bool a_end = (a == va.end());
+	bool b_end = (b == vb.end());
+	if (a_end || b_end)
+		return a_end == b_end;
+	return a->get_time_index() == b->get_time_index() && a->get_value() == b->get_value();
+}
+
+static void test_columnar_matches_segmented()
+{
+	seek_history<segmented_list_1024> seg;
+	seek_history<columnar_list_1024> col;
+
+	// empty
+	assert(col.last_item_less_than_or_equal_to_time(10) == col.end());
+	assert(col.get_range(0, 10).begin() == col.end());
+	assert(col.find_entry(10) == nullptr);
+
+	make_seek_history(&seg, 5000);
+	make_seek_history(&col, 5000);
+	assert(seg.size() == col.size());
+	time_index_t last = col.latest().get_time_index();
+
+	std::mt19937 rng(11);
+	auto col_hint = col.end();
+	for (int i = 0; i < 20000; i++)
+	{
+		time_index_t t = time_index_t(rng() % (last + 10));
+		if (i < 4)
+		{
+			time_index_t edges[] = { 0, 5, last, last + 1 };
+			t = edges[i];
+		}
+
+		assert(same_position(seg, seg.last_item_less_than_or_equal_to_time(t), col, col.last_item_less_than_or_equal_to_time(t)));
+
+		// hinted seeks must match the unhinted ones
+		col_hint = col.last_item_less_than_or_equal_to_time(t, col_hint);
+		assert(same_position(col, col_hint, col, col.last_item_less_than_or_equal_to_time(t)));
+
+		time_index_t b = t + time_index_t(rng() % 50);
+		auto seg_range = seg.get_range(t, b);
+		auto col_range = col.get_range(t, b);
+		assert(seg_range.end() - seg_range.begin() == col_range.end() - col_range.begin());
+		assert(same_position(seg, seg_range.begin(), col, col_range.begin()));
+
+		auto seg_entry = seg.find_entry(t);
+		auto col_entry = col.find_entry(t);
+		assert((seg_entry == nullptr) == (col_entry == nullptr));
+		assert(!seg_entry || seg_entry->get_time_index() == col_entry->get_time_index());
+	}
+
+	// scrubbing forwards and backwards one frame at a time with a hint
+	col_hint = col.end();
+	for (time_index_t t = 0; t <= last + 1; t++)
+	{
+		col_hint = col.last_item_less_than_or_equal_to_time(t, col_hint);
+		assert(same_position(col, col_hint, seg, seg.last_item_less_than_or_equal_to_time(t)));
+	}
+	for (time_index_t t = last + 1; t >= 0; t--)
+	{
+		col_hint = col.last_item_less_than_or_equal_to_time(t, col_hint);
+		assert(same_position(col, col_hint, seg, seg.last_item_less_than_or_equal_to_time(t)));
+	}
+
+	// copies and moves keep the time index column in step
+	seek_history<columnar_list_1024> copy(col);
+	assert(copy == col);
+	assert(copy.last_item_less_than_or_equal_to_time(last)->get_time_index() == last);
+	seek_history<columnar_list_1024> moved(std::move(copy));
+	assert(moved.last_item_less_than_or_equal_to_time(last)->get_time_index() == last);
+
+	// clear starts a new skip table
+	moved.container.clear();
+	assert(moved.last_item_less_than_or_equal_to_time(last) == moved.end());
+	make_seek_history(&moved, 3000);
+	assert(moved.last_item_less_than_or_equal_to_time(7)->get_time_index() == col.last_item_less_than_or_equal_to_time(7)->get_time_index());
+}
+
+// histories that end inside and on the edges of the small first segments
+static void test_short_histories()
+{
+	for (int n = 1; n <= 90; n++)
+	{
+		seek_history<segmented_list_1024> seg;
+		seek_history<columnar_list_1024> col;
+		make_seek_history(&seg, n);
+		make_seek_history(&col, n);
+		time_index_t last = col.latest().get_time_index();
+		for (time_index_t t = 0; t <= last + 1; t++)
+		{
+			assert(same_position(seg, seg.last_item_less_than_or_equal_to_time(t), col, col.last_item_less_than_or_equal_to_time(t)));
+		}
+	}
+}
+
+void TEST_COLUMNAR_LIST()
+{
+	test_columnar_matches_segmented();
+	test_short_histories();
+}
@@ -4,6 +4,7 @@
 #include "vr_cursor_context.h"
 #include "capture_traverser.h"
 #include <set>
+#include <cmath>
 
 static void do_read(capture_test_context *test_context, int unique_reads)
 {
@@ -144,9 +145,90 @@ static void test_seek_time(capture_test_context *test_context)
 	//the best cache for 500,500 case is where cache return if its an exact match or lower bound
 }
 
+// an hour at 90hz.  vsync timing changes every frame, the seated pose every few seconds
+static const int SEEK_BENCHMARK_FRAMES = 90 * 60 * 60;
+
+static void make_long_capture(capture *c, int num_frames)
+{
+	auto &system_node = c->m_state.system_node;
+	vr::HmdMatrix34_t m;
+	memset(&m, 0, sizeof(m));
+	for (int i = 0; i < num_frames; i++)
+	{
+		c->m_time_stamps.push_back(time_stamp_t(i) * 11111);
+		system_node.seconds_since_last_vsync.emplace_back(i, vr_result::Float<bool>(i * 0.011f, true));
+		system_node.frame_counter_since_last_vsync.emplace_back(i, vr_result::Uint64<bool>(uint64_t(i), true));
+		if (i % 300 == 0)
+		{
+			m.m[0][3] = float(i);
+			system_node.seated2standing.emplace_back(i, vr_result::HmdMatrix34<>(m));
+		}
+		c->increment_last_updated_frame();
+	}
+}
+
+// read a dense and a sparse history at each frame
+static float read_at_frames(CursorContext &cursor_context, VRSystemCursor *system, const std::vector<time_index_t> &frames)
+{
+	float accum = 0;
+	for (time_index_t frame : frames)
+	{
+		cursor_context.ChangeFrame(frame);
+		float seconds;
+		system->GetTimeSinceLastVsync(&seconds, nullptr);
+		accum += seconds + system->GetSeatedZeroPoseToStandingAbsoluteTrackingPose().m[0][3];
+	}
+	return accum;
+}
+
+static void time_frames(const char *name, CursorContext &cursor_context, VRSystemCursor *system, const std::vector<time_index_t> &frames)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	float accum = read_at_frames(cursor_context, system, frames);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	log_printf("%s: %d seeks took %lld us, %lld ns per seek (%f)\n", name, size_as_int(frames.size()),
+		ns / 1000, ns / int64_t(frames.size()), accum);
+}
+
+// random, forward scrub and backward scrub seeks across an hour long capture
+static void test_seek_benchmark()
+{
+	capture_test_context test_context;
+	make_long_capture(&test_context.get_capture(), SEEK_BENCHMARK_FRAMES);
+	CursorContext cursor_context(&test_context.get_capture());
+	VRSystemCursor system(&cursor_context);
+
+	std::vector<time_index_t> random_frames(SEEK_BENCHMARK_FRAMES);
+	std::vector<time_index_t> forward_frames(SEEK_BENCHMARK_FRAMES);
+	std::vector<time_index_t> backward_frames(SEEK_BENCHMARK_FRAMES);
+	srand(1);
+	for (int i = 0; i < SEEK_BENCHMARK_FRAMES; i++)
+	{
+		random_frames[i] = time_index_t((uint64_t(rand()) * (RAND_MAX + 1ull) + rand()) % SEEK_BENCHMARK_FRAMES);
+		forward_frames[i] = i;
+		backward_frames[i] = SEEK_BENCHMARK_FRAMES - 1 - i;
+	}
+
+	// random and scrubbed seeks have to see the same values
+	std::vector<time_index_t> check_frames(random_frames.begin(), random_frames.begin() + 1000);
+	float expected = 0;
+	for (time_index_t frame : check_frames)
+	{
+		expected += frame * 0.011f + float(frame - frame % 300);
+	}
+	assert(std::fabs(read_at_frames(cursor_context, &system, check_frames) - expected) <= std::fabs(expected) * 1e-4f);
+
+	log_printf("seek benchmark: %d frames\n", SEEK_BENCHMARK_FRAMES);
+	time_frames("random", cursor_context, &system, random_frames);
+	time_frames("forward scrub", cursor_context, &system, forward_frames);
+	time_frames("backward scrub", cursor_context, &system, backward_frames);
+}
 
 void TEST_SYSTEM_CURSOR()
 {
+	test_seek_benchmark();
+
 	capture_test_context test_context;
 	test_context.ForceInitAll(); // make sure it's setup before splitting into separate threads
 
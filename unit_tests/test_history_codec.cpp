@@ -0,0 +1,210 @@
+// history codec: pose like histories must round trip exactly when lossless and
+// within the epsilon when lossy, and be a lot smaller than the raw encoding
+//
+#include "MemoryStream.h"
+#include "VectorStream.h"
+#include "time_containers.h"
+#include "segmented_list.h"
+#include "result.h"
+#include "log.h"
+#include <cmath>
+#include <random>
+
+// same shape as vr::TrackedDevicePose_t, without needing openvr
+struct test_pose
+{
+	float m[3][4];
+	float velocity[3];
+	float angular_velocity[3];
+	int32_t tracking_result;
+	bool valid;
+	bool connected;
+};
+
+inline bool operator == (const test_pose &lhs, const test_pose &rhs)
+{
+	return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+}
+
+inline bool operator != (const test_pose &lhs, const test_pose &rhs)
+{
+	return !(lhs == rhs);
+}
+
+template <>
+struct float_history_traits<test_pose>
+{
+	static const bool enabled = true;
+	static bool is_float_word(int word) { return word < int(offsetof(test_pose, tracking_result) / sizeof(uint32_t)); }
+};
+
+using test_pose_history = time_indexed_vector<Result<test_pose, bool>, segmented_list_1024, std::allocator>;
+
+// a device moving slowly with some sensor noise.  every few frames the device is invalid
+static void make_history(test_pose_history *h, int num_samples)
+{
+	std::mt19937 rng(42);
+	std::normal_distribution<float> noise(0.0f, 0.0005f);
+	test_pose p;
+	memset(&p, 0, sizeof(p));
+	p.m[0][0] = p.m[1][1] = p.m[2][2] = 1.0f;
+	p.tracking_result = 200;
+	p.valid = true;
+	p.connected = true;
+	for (int i = 0; i < num_samples; i++)
+	{
+		float t = i * 0.011f;
+		p.m[0][3] = 0.5f * std::sin(t) + noise(rng);
+		p.m[1][3] = 1.7f + noise(rng);
+		p.m[2][3] = -0.25f * std::cos(t) + noise(rng);
+		p.m[0][1] = 0.01f * std::sin(t * 0.5f);
+		p.velocity[0] = 0.5f * std::cos(t);
+		p.velocity[2] = 0.25f * std::sin(t);
+		p.angular_velocity[1] = noise(rng);
+		bool return_code = (i % 500) != 499;	// 'not present' now and then
+		h->emplace_back(i * 2, p, return_code);
+	}
+}
+
+static uint64_t raw_size(const test_pose_history &h)
+{
+	uint64_t size = 0;
+	for (const auto &timeval : h.container)
+	{
+		MemoryStream count(nullptr, 0, true);
+		timeval.encode(count);
+		size += count.get_pos();
+	}
+	return size;
+}
+
+static void round_trip(const test_pose_history &a, test_pose_history *b, float epsilon, uint64_t *encoded_size)
+{
+	VectorStream stream;
+	stream.float_epsilon = epsilon;
+	a.encode(stream);
+	*encoded_size = stream.size();
+	stream.reset_buf_pos();
+	b->decode(stream);
+	assert(stream.get_pos() == stream.size());
+}
+
+static void test_lossless()
+{
+	test_pose_history a;
+	make_history(&a, 20000);
+	test_pose_history b;
+	uint64_t encoded_size;
+	round_trip(a, &b, 0.0f, &encoded_size);
+	assert(a == b);
+	// bitwise, not just operator ==
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		assert(a.container[i].get_time_index() == b.container[i].get_time_index());
+		assert(a.container[i].get_value().return_code == b.container[i].get_value().return_code);
+		if (a.container[i].get_value().is_present())
+		{
+			assert(memcmp(&a.container[i].get_value().val, &b.container[i].get_value().val, sizeof(test_pose)) == 0);
+		}
+	}
+	log_printf("history codec lossless: raw %llu encoded %llu (%.1fx)\n", raw_size(a), encoded_size, double(raw_size(a)) / encoded_size);
+	assert(encoded_size < raw_size(a));
+}
+
+static void test_lossy(float epsilon)
+{
+	test_pose_history a;
+	make_history(&a, 20000);
+	test_pose_history b;
+	uint64_t encoded_size;
+	round_trip(a, &b, epsilon, &encoded_size);
+	assert(a.size() == b.size());
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		const Result<test_pose, bool> &ra = a.container[i].get_value();
+		const Result<test_pose, bool> &rb = b.container[i].get_value();
+		assert(a.container[i].get_time_index() == b.container[i].get_time_index());
+		assert(ra.return_code == rb.return_code);
+		if (!ra.is_present())
+			continue;
+		const float *fa = &ra.val.m[0][0];
+		const float *fb = &rb.val.m[0][0];
+		for (int w = 0; w < 18; w++)
+		{
+			assert(std::fabs(fa[w] - fb[w]) <= epsilon);
+		}
+		// words that aren't floats are exact
+		assert(ra.val.tracking_result == rb.val.tracking_result);
+		assert(ra.val.valid == rb.val.valid);
+		assert(ra.val.connected == rb.val.connected);
+	}
+	log_printf("history codec lossy %g: raw %llu encoded %llu (%.1fx)\n", epsilon, raw_size(a), encoded_size, double(raw_size(a)) / encoded_size);
+	assert(encoded_size * 3 < raw_size(a));
+}
+
+static void test_empty_and_reencode()
+{
+	test_pose_history a;
+	test_pose_history b;
+	uint64_t encoded_size;
+	round_trip(a, &b, 0.0f, &encoded_size);
+	assert(b.empty());
+
+	// what a lossy encode decodes to goes through the lossless encode exactly
+	make_history(&a, 1000);
+	round_trip(a, &b, 0.001f, &encoded_size);
+	test_pose_history c;
+	round_trip(b, &c, 0.0f, &encoded_size);
+	assert(b == c);
+}
+
+// one present sample, with the header of it's first changed word given
+static void write_one_sample(VectorStream *stream, int size, uint8_t word_header)
+{
+	using codec = history_codec<Result<test_pose, bool>>;
+	stream->write_to_stream(&size, sizeof(size));
+	uint8_t time_delta = 0;
+	uint8_t flags = codec::RETURN_CODE_CHANGED;
+	bool return_code = true;
+	stream->write_to_stream(&time_delta, sizeof(time_delta));
+	stream->write_to_stream(&flags, sizeof(flags));
+	stream->write_to_stream(&return_code, sizeof(return_code));
+	uint8_t mask[codec::mask_bytes] = { 1 };
+	stream->write_to_stream(mask, sizeof(mask));
+	stream->write_to_stream(&word_header, sizeof(word_header));
+	uint32_t middle = 0xffffffff;
+	int middle_bytes = 4 - (word_header & 0xf) - (word_header >> 4);
+	stream->write_to_stream(&middle, middle_bytes > 0 ? middle_bytes : 0);
+}
+
+static bool decode_one_sample(int size, uint8_t word_header, test_pose_history *h)
+{
+	VectorStream stream;
+	write_one_sample(&stream, size, word_header);
+	stream.reset_buf_pos();
+	return history_codec<Result<test_pose, bool>>::decode(h->container, stream);
+}
+
+// sizes and byte counts come from the file, so bad ones fail the decode rather than overrun
+static void test_corrupt()
+{
+	test_pose_history h;
+	assert(decode_one_sample(1, 0x11, &h));
+	assert(h.size() == 1);
+
+	assert(!decode_one_sample(1, 0x33, &h));		// 3 leading and 3 trailing zero bytes of a 4 byte word
+	assert(h.empty());
+	assert(!decode_one_sample(1, 0xf0, &h));
+	assert(!decode_one_sample(-1, 0x11, &h));
+	assert(!decode_one_sample(100000000, 0x11, &h));	// more samples than the stream has bytes
+	assert(h.empty());
+}
+
+void TEST_HISTORY_CODEC()
+{
+	test_lossless();
+	test_lossy(0.0001f);
+	test_lossy(0.001f);
+	test_empty_and_reencode();
+	test_corrupt();
+}
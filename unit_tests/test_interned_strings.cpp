@@ -0,0 +1,185 @@
+// test_interned_strings
+// * unit test for the string table: concurrent interning, the Result hooks, the two encodings
+//   and freeing the strings with the last reference
+//
+
+#include "interned_strings.h"
+#include "VectorStream.h"
+#include "log.h"
+#include <assert.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef Result<interned_string, bool> string_result;
+typedef Result<std::vector<char>, bool> vector_result;
+
+static std::vector<char> make_chars(const std::string &s)
+{
+	return std::vector<char>(s.c_str(), s.c_str() + s.size() + 1);	// with the null, like the queries
+}
+
+// threads interning the same strings at once get the same ids
+static void test_concurrent_intern()
+{
+	static const int NUM_THREADS = 8;
+	static const int NUM_STRINGS = 2000;
+	std::vector<std::vector<uint32_t>> ids(NUM_THREADS);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUM_THREADS; t++)
+	{
+		std::vector<uint32_t> *mine = &ids[t];
+		threads.emplace_back([mine, t]()
+		{
+			for (int i = 0; i < NUM_STRINGS; i++)
+			{
+				int n = (i + t * 37) % NUM_STRINGS;		// each thread in a different order
+				std::string s = "/devices/" + std::to_string(n) + "/prop_string";
+				mine->push_back(string_table::global().intern(s.data(), uint32_t(s.size())));
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	for (int t = 1; t < NUM_THREADS; t++)
+	{
+		for (int i = 0; i < NUM_STRINGS; i++)
+		{
+			assert(ids[t][i] == ids[0][(i + t * 37) % NUM_STRINGS]);
+		}
+	}
+	for (int i = 0; i < NUM_STRINGS; i++)
+	{
+		std::string s = "/devices/" + std::to_string(i) + "/prop_string";
+		const string_table::entry &e = string_table::global().get(ids[0][i]);
+		assert(std::string(e.data, e.size) == s);
+	}
+	assert(string_table::global().intern("", 0) == string_table::EMPTY_ID);
+}
+
+static void test_result_hooks()
+{
+	vector_result queried(make_chars("LIGHTHOUSE"), true);
+	string_result a;
+	a.return_code = false;
+	assert(not_equals(a, queried));
+
+	a = queried;
+	assert(a.is_present());
+	assert(!not_equals(a, queried));
+	assert(strcmp(a.val.data(), "LIGHTHOUSE") == 0);
+	assert(a.val.size() == 11 && a.val.at(10) == 0);
+
+	// same contents, same id
+	string_result b(queried);
+	assert(b.val.get_id() == a.val.get_id());
+	assert(!not_equals(a, b));
+
+	vector_result other(make_chars("lighthouse"), true);
+	assert(not_equals(a, other));
+	b = other;
+	assert(not_equals(a, b));
+
+	// a missing value isn't compared
+	string_result missing;
+	missing.return_code = false;
+	vector_result also_missing(make_chars("whatever"), false);
+	assert(!not_equals(missing, also_missing));
+}
+
+static void test_encodings()
+{
+	std::vector<string_result> values;
+	for (const char *s : { "a", "render_model", "a", "", "render_model" })
+	{
+		values.push_back(string_result(vector_result(make_chars(s), true)));
+	}
+	values.push_back(string_result(vector_result(make_chars("not present"), false)));
+
+	// inline: the layout of a vector of char
+	{
+		VectorStream stream;
+		values[1].encode(stream);
+		assert(stream.size() == sizeof(bool) + sizeof(int) + strlen("render_model") + 1);
+	}
+
+	// ids, and the strings once
+	VectorStream state;
+	string_section saved;
+	state.strings = &saved;
+	for (const string_result &v : values)
+	{
+		v.encode(state);
+	}
+	assert(saved.size() == 3);		// "a", "" and "render_model" with their nulls
+	VectorStream strings;
+	saved.encode(strings);
+
+	string_section loaded;
+	strings.reset_buf_pos();
+	assert(loaded.decode(strings));
+	state.reset_buf_pos();
+	state.strings = &loaded;
+	for (const string_result &v : values)
+	{
+		string_result decoded;
+		decoded.decode(state);
+		assert(decoded.return_code == v.return_code);
+		if (v.is_present())
+		{
+			assert(decoded.val == v.val);
+		}
+	}
+	assert(state.get_pos() == state.size());
+
+	// sections filled by separate tasks and merged write each string once
+	VectorStream task_a, task_b;
+	string_section section_a, section_b;
+	task_a.strings = &section_a;
+	task_b.strings = &section_b;
+	values[0].encode(task_a);
+	values[1].encode(task_a);
+	values[2].encode(task_b);
+	values[4].encode(task_b);
+	section_a.merge(section_b);
+	assert(section_a.size() == 2);
+	VectorStream merged;
+	section_a.encode(merged);
+	assert(merged.size() == strings.size() - (sizeof(uint32_t) + sizeof(int) + 1));	// less ""
+}
+
+// the strings go with the last reference, and the ids start over
+static void test_references()
+{
+	{
+		string_table::reference capture_a;
+		interned_string kept(make_chars("kept"));
+		{
+			string_table::reference capture_b(capture_a);
+			interned_string s(make_chars("interned while both are held"));
+		}
+		assert(strcmp(kept.data(), "kept") == 0);
+		assert(string_table::global().get_num_strings() > 1);
+	}
+	assert(string_table::global().get_num_strings() == 1);		// the empty string
+	assert(string_table::global().get_num_bytes() == 0);
+
+	string_table::reference capture_c;
+	interned_string again(make_chars("kept"));
+	assert(again.get_id() == 1);
+	assert(strcmp(again.data(), "kept") == 0);
+}
+
+void TEST_INTERNED_STRINGS()
+{
+	test_concurrent_intern();
+	test_result_hooks();
+	test_encodings();
+	log_printf("string table: %u strings, %llu bytes, %llu interns\n",
+		string_table::global().get_num_strings(),
+		(unsigned long long)string_table::global().get_num_bytes(),
+		(unsigned long long)string_table::global().get_num_interns());
+	test_references();
+}
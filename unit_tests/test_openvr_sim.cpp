@@ -0,0 +1,124 @@
+//
+// openvr_sim: the simulated runtime has to give the same answers for the same seed and frame,
+// and captures updated from it have to match, sequential or parallel
+//
+#include "openvr_sim.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "log.h"
+#include <string.h>
+
+static const int SIM_TEST_FRAMES = 200;
+
+static void read_frame(openvr_broker::open_vr_interfaces &vri, vr::VRControllerState_t *state, vr::TrackedDevicePose_t *pose, float *battery)
+{
+	vr::TrackedDeviceIndex_t left = vri.sysi->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand);
+	memset(state, 0, sizeof(*state));
+	memset(pose, 0, sizeof(*pose));
+	bool rc = vri.sysi->GetControllerStateWithPose(vr::TrackingUniverseStanding, left, state, sizeof(*state), pose);
+	assert(rc);
+	vr::ETrackedPropertyError err;
+	*battery = vri.sysi->GetFloatTrackedDeviceProperty(left, vr::Prop_DeviceBatteryPercentage_Float, &err);
+	assert(err == vr::TrackedProp_Success);
+}
+
+static void test_sim_is_deterministic()
+{
+	capture_test_context context;
+	openvr_broker::open_vr_interfaces &vri = context.sim_vr_interfaces();
+
+	openvr_sim::sim_config config;
+	config.set_default();
+	config.property_churn_period_frames = 10;
+
+	std::vector<vr::VRControllerState_t> states(SIM_TEST_FRAMES);
+	std::vector<vr::TrackedDevicePose_t> poses(SIM_TEST_FRAMES);
+	std::vector<float> batteries(SIM_TEST_FRAMES);
+
+	openvr_sim::configure(config);
+	for (int i = 0; i < SIM_TEST_FRAMES; i++)
+	{
+		read_frame(vri, &states[i], &poses[i], &batteries[i]);
+		openvr_sim::advance_frame();
+	}
+	assert(openvr_sim::get_frame() == uint64_t(SIM_TEST_FRAMES));
+
+	// same seed, same answers
+	openvr_sim::configure(config);
+	int num_moves = 0;
+	int num_battery_changes = 0;
+	for (int i = 0; i < SIM_TEST_FRAMES; i++)
+	{
+		vr::VRControllerState_t state;
+		vr::TrackedDevicePose_t pose;
+		float battery;
+		read_frame(vri, &state, &pose, &battery);
+		assert(memcmp(&state, &states[i], sizeof(state)) == 0);
+		assert(memcmp(&pose, &poses[i], sizeof(pose)) == 0);
+		assert(battery == batteries[i]);
+		if (i > 0 && memcmp(&poses[i], &poses[i - 1], sizeof(pose)) != 0)
+			num_moves++;
+		if (i > 0 && batteries[i] != batteries[i - 1])
+			num_battery_changes++;
+
+		// nothing moves until the frame does
+		read_frame(vri, &state, &pose, &battery);
+		assert(memcmp(&pose, &poses[i], sizeof(pose)) == 0);
+		openvr_sim::advance_frame();
+	}
+	assert(num_moves == SIM_TEST_FRAMES - 1);
+	assert(num_battery_changes > 0 && num_battery_changes < SIM_TEST_FRAMES / 2);
+
+	// another seed, another trajectory
+	config.seed++;
+	openvr_sim::configure(config);
+	vr::VRControllerState_t state;
+	vr::TrackedDevicePose_t pose;
+	float battery;
+	read_frame(vri, &state, &pose, &battery);
+	assert(memcmp(&pose, &poses[0], sizeof(pose)) != 0);
+
+	config.set_default();
+	openvr_sim::configure(config);
+}
+
+static void update_from_sim(capture_test_context *context, bool parallel)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	openvr_sim::configure(config);
+
+	capture_traverser traverser;
+	for (int i = 0; i < 20; i++)
+	{
+		traverser.update_capture(&context->get_capture(), &context->sim_vr_interfaces(), i, parallel);
+		openvr_sim::advance_frame();
+	}
+}
+
+static void test_sim_captures_match()
+{
+	capture_test_context sequential;
+	capture_test_context parallel;
+	update_from_sim(&sequential, false);
+	update_from_sim(&parallel, true);
+	assert(capture_test_context::captured_the_same(sequential.get_capture(), parallel.get_capture()));
+
+	auto &sequential_system = sequential.get_capture().m_state.system_node;
+	auto &parallel_system = parallel.get_capture().m_state.system_node;
+	assert(sequential_system.controllers.size() == parallel_system.controllers.size());
+	for (size_t i = 0; i < sequential_system.controllers.size(); i++)
+	{
+		assert(same_history(sequential_system.controllers[i].standing_tracking_pose, parallel_system.controllers[i].standing_tracking_pose));
+		assert(same_history(sequential_system.controllers[i].controller_state, parallel_system.controllers[i].controller_state));
+		assert(same_histories(sequential_system.controllers[i].float_props, parallel_system.controllers[i].float_props));
+		assert(same_histories(sequential_system.controllers[i].string_props, parallel_system.controllers[i].string_props));
+	}
+}
+
+void test_openvr_sim()
+{
+	test_sim_is_deterministic();
+	test_sim_captures_match();
+	log_printf("test_openvr_sim done\n");
+}
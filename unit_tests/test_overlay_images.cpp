@@ -0,0 +1,100 @@
+//
+// overlay_image_scheduler: the overlays take turns within the byte budget, so every image is
+// captured, and unchanged images aren't stored again
+//
+#include "overlay_image_scheduler.h"
+#include "platform.h"
+#include "openvr_sim.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "log.h"
+#include <vector>
+
+static void test_round_robin()
+{
+	CaptureConfig config;
+	config.set_default();
+	config.overlay_image_bytes_per_frame = 1000;
+	overlay_image_scheduler images;
+	images.Init(config);
+
+	// 400 bytes each: 3 a frame (the third goes over), carrying on where the last frame stopped
+	std::vector<int> fetched;
+	for (int frame = 0; frame < 4; frame++)
+	{
+		images.run_frame(5, [&fetched](int i) { fetched.push_back(i); return 400u; });
+	}
+	static const int expected[] = { 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1 };
+	assert(fetched.size() == TBL_SIZE(expected));
+	for (int i = 0; i < size_as_int(fetched.size()); i++)
+	{
+		assert(fetched[i] == expected[i]);
+	}
+
+	// at least one a frame, whatever the size
+	fetched.clear();
+	images.run_frame(5, [&fetched](int i) { fetched.push_back(i); return 1000000u; });
+	assert(fetched.size() == 1 && fetched[0] == 2);
+
+	// never more than once a frame
+	fetched.clear();
+	images.run_frame(2, [&fetched](int i) { fetched.push_back(i); return 0u; });
+	assert(fetched.size() == 2);
+	images.run_frame(0, [&fetched](int i) { fetched.push_back(i); return 0u; });
+	assert(fetched.size() == 2);
+}
+
+static void test_image_changed()
+{
+	overlay_image_scheduler images;
+	std::vector<uint8_t> a(64 * 64 * 4, 3);
+	assert(images.image_changed(4, 64, 64, 0, a.data(), uint32_t(a.size())));
+	assert(!images.image_changed(4, 64, 64, 0, a.data(), uint32_t(a.size())));
+	assert(images.image_changed(3, 64, 64, 0, a.data(), uint32_t(a.size())));
+	assert(images.image_changed(4, 32, 128, 0, a.data(), uint32_t(a.size())));
+	assert(images.image_changed(4, 32, 128, 1, a.data(), uint32_t(a.size())));
+	a[100] = 4;
+	assert(images.image_changed(4, 32, 128, 1, a.data(), uint32_t(a.size())));
+
+	images.clear();
+	assert(images.image_changed(4, 32, 128, 1, a.data(), uint32_t(a.size())));
+}
+
+// one image a frame from the sim: after two rounds every overlay has it's image, stored once
+static void test_sim_overlay_images()
+{
+	openvr_sim::sim_config sim;
+	sim.set_default();
+	sim.overlay_image_period_frames = 100000;
+	openvr_sim::configure(sim);
+
+	capture_test_context context;
+	context.get_config().set_poll_every_frame();
+	context.get_config().overlay_image_bytes_per_frame = sim.overlay_width * sim.overlay_height * 4;
+	int num_overlays = context.get_config().num_overlays;
+	capture_traverser traverser;
+	for (int i = 0; i < 2 * num_overlays; i++)
+	{
+		traverser.update_capture(&context.get_capture(), &context.sim_vr_interfaces(), i * 11111, true);
+		openvr_sim::advance_frame();
+	}
+
+	capture &c = context.get_capture();
+	assert(c.m_overlay_images.get_num_fetches() == uint64_t(2 * num_overlays));
+	assert(c.m_overlay_images.get_num_changes() == uint64_t(num_overlays));
+	auto &overlays = c.m_state.overlay_node.overlays;
+	assert(size_as_int(overlays.size()) == num_overlays);
+	for (int i = 0; i < num_overlays; i++)
+	{
+		assert(overlays[i].overlay_image_data.size() == 1);
+		assert(overlays[i].overlay_image_width.latest().get_value().val == uint32_t(sim.overlay_width));
+	}
+}
+
+void test_overlay_images()
+{
+	test_round_robin();
+	test_image_changed();
+	test_sim_overlay_images();
+	log_printf("test_overlay_images done\n");
+}
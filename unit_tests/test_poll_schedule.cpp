@@ -0,0 +1,256 @@
+//
+// poll_schedule: slow subtrees are polled at their rate with the items spread across frames,
+// and a sim capture keeps every pose while skipping most of the slow queries.  with openvr events
+// driving the on demand subtrees, property changes are still all captured for fewer calls.
+//
+#include "poll_schedule.h"
+#include "poll_events.h"
+#include "openvr_sim.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "log.h"
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+static const int POLL_TEST_ITEMS = 20;
+static const time_stamp_t POLL_TEST_FRAME_US = 11111;	// 90hz
+
+// polls[frame][item] for num_frames updates
+static std::vector<std::vector<bool>> run_schedule(poll_schedule *schedule, poll_subtree s, int num_frames)
+{
+	std::vector<std::vector<bool>> polls(num_frames, std::vector<bool>(POLL_TEST_ITEMS));
+	for (int frame = 0; frame < num_frames; frame++)
+	{
+		time_stamp_t last = frame == 0 ? 0 : (frame - 1) * POLL_TEST_FRAME_US;
+		poll_frame poll(schedule, frame, last, frame * POLL_TEST_FRAME_US);
+		for (int item = 0; item < POLL_TEST_ITEMS; item++)
+		{
+			polls[frame][item] = poll.poll(s, item);
+		}
+	}
+	return polls;
+}
+
+static void test_every_n_frames()
+{
+	poll_schedule schedule;
+	schedule.set_rate(POLL_DEVICE_PROPERTIES, { POLL_EVERY_N_FRAMES, 10 });
+	auto polls = run_schedule(&schedule, POLL_DEVICE_PROPERTIES, 1001);
+
+	// the first frame gets everything
+	assert(std::count(polls[0].begin(), polls[0].end(), true) == POLL_TEST_ITEMS);
+
+	// then each item once per 10 frames, 2 items a frame
+	std::vector<int> item_polls(POLL_TEST_ITEMS);
+	for (int frame = 1; frame < 1001; frame++)
+	{
+		assert(std::count(polls[frame].begin(), polls[frame].end(), true) == POLL_TEST_ITEMS / 10);
+		for (int item = 0; item < POLL_TEST_ITEMS; item++)
+		{
+			item_polls[item] += polls[frame][item];
+		}
+	}
+	for (int item = 0; item < POLL_TEST_ITEMS; item++)
+	{
+		assert(item_polls[item] == 100);
+	}
+
+	// other subtrees are still every frame
+	auto system_polls = run_schedule(&schedule, POLL_SYSTEM, 10);
+	for (auto &frame : system_polls)
+	{
+		assert(std::count(frame.begin(), frame.end(), true) == POLL_TEST_ITEMS);
+	}
+}
+
+static void test_every_n_ms()
+{
+	poll_schedule schedule;
+	schedule.set_rate(POLL_SETTINGS, { POLL_EVERY_N_MS, 1000 });
+	auto polls = run_schedule(&schedule, POLL_SETTINGS, 901);	// 10 seconds
+
+	std::vector<int> item_polls(POLL_TEST_ITEMS);
+	int busiest_frame = 0;
+	for (int frame = 1; frame < 901; frame++)
+	{
+		busiest_frame = std::max(busiest_frame, int(std::count(polls[frame].begin(), polls[frame].end(), true)));
+		for (int item = 0; item < POLL_TEST_ITEMS; item++)
+		{
+			item_polls[item] += polls[frame][item];
+		}
+	}
+	for (int item = 0; item < POLL_TEST_ITEMS; item++)
+	{
+		assert(item_polls[item] >= 9 && item_polls[item] <= 10);
+	}
+	assert(busiest_frame <= 2);
+}
+
+static void test_on_demand()
+{
+	poll_schedule schedule;
+	schedule.set_rate(POLL_RESOURCES, { POLL_ON_DEMAND, 0 });
+	{
+		poll_frame first(&schedule, 0, 0, 0);
+		assert(first.poll(POLL_RESOURCES, 3));
+	}
+	{
+		poll_frame next(&schedule, 1, 0, POLL_TEST_FRAME_US);
+		assert(!next.poll(POLL_RESOURCES, 3));
+	}
+
+	schedule.request_poll(POLL_RESOURCES);
+	{
+		poll_frame requested(&schedule, 2, POLL_TEST_FRAME_US, 2 * POLL_TEST_FRAME_US);
+		assert(requested.poll(POLL_RESOURCES, 3));
+		assert(requested.poll(POLL_RESOURCES, -1));
+
+		// a request made during an update is for the next one
+		schedule.request_poll(POLL_RESOURCES);
+	}
+	{
+		poll_frame later(&schedule, 3, 2 * POLL_TEST_FRAME_US, 3 * POLL_TEST_FRAME_US);
+		assert(later.poll(POLL_RESOURCES, 3));
+	}
+	{
+		poll_frame after(&schedule, 4, 3 * POLL_TEST_FRAME_US, 4 * POLL_TEST_FRAME_US);
+		assert(!after.poll(POLL_RESOURCES, 3));
+	}
+
+	// an invalidation is for the next update only, however the lists are passed back and forth
+	for (int frame = 5; frame < 10; frame++)
+	{
+		schedule.invalidate(POLL_RESOURCES, frame);
+		poll_frame invalidated(&schedule, frame, (frame - 1) * POLL_TEST_FRAME_US, frame * POLL_TEST_FRAME_US);
+		assert(invalidated.poll(POLL_RESOURCES, frame));
+		assert(!invalidated.poll(POLL_RESOURCES, frame - 1));
+	}
+}
+
+static void update_from_sim(capture_test_context *context, int num_frames)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	openvr_sim::configure(config);
+
+	capture_traverser traverser;
+	for (int i = 0; i < num_frames; i++)
+	{
+		traverser.update_capture(&context->get_capture(), &context->sim_vr_interfaces(), i * POLL_TEST_FRAME_US, true);
+		openvr_sim::advance_frame();
+	}
+}
+
+// the default rates keep every pose change
+static void test_tiered_capture_keeps_poses()
+{
+	capture_test_context tiered;
+	capture_test_context every_frame;
+	every_frame.get_config().set_poll_every_frame();
+	update_from_sim(&tiered, 200);
+	update_from_sim(&every_frame, 200);
+
+	auto &tiered_system = tiered.get_capture().m_state.system_node;
+	auto &every_frame_system = every_frame.get_capture().m_state.system_node;
+	for (int i = 0; i < 1 + openvr_sim::get_config().num_controllers; i++)
+	{
+		assert(same_history(tiered_system.controllers[i].standing_tracking_pose, every_frame_system.controllers[i].standing_tracking_pose));
+		assert(same_history(tiered_system.controllers[i].controller_state, every_frame_system.controllers[i].controller_state));
+	}
+	assert(tiered.get_capture().m_time_stamps.size() == every_frame.get_capture().m_time_stamps.size());
+}
+
+// an event invalidates just the device it names
+static void test_event_invalidates_device()
+{
+	capture_test_context context;
+	poll_schedule &schedule = context.get_capture().m_poll_schedule;
+	schedule.set_rate(POLL_DEVICE_PROPERTIES, { POLL_ON_DEMAND, 0 });
+	{
+		poll_frame first(&schedule, 0, 0, 0);
+	}
+
+	vr::VREvent_t event;
+	memset(&event, 0, sizeof(event));
+	event.eventType = vr::VREvent_PropertyChanged;
+	event.trackedDeviceIndex = 3;
+	bool rc = invalidate_for_event(event, &context.get_capture().m_keys, &schedule);
+	assert(rc);
+
+	poll_frame next(&schedule, 1, 0, POLL_TEST_FRAME_US);
+	for (int i = 0; i < POLL_TEST_ITEMS; i++)
+	{
+		assert(next.poll(POLL_DEVICE_PROPERTIES, i) == (i == 3));
+	}
+	assert(!next.poll(POLL_DEVICE_PROPERTIES, -1));
+}
+
+// runs num_frames updates and returns the openvr calls per frame.  with events, the sim's events
+// are drained into the schedule before each update
+static double calls_per_frame_from_sim(capture_test_context *context, int num_frames, bool events)
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	config.property_churn_period_frames = 90;
+	openvr_sim::configure(config);
+
+	capture &capture = context->get_capture();
+	openvr_broker::open_vr_interfaces &vri = context->sim_vr_interfaces();
+	capture_traverser traverser;
+	uint64_t start_calls = openvr_sim::get_num_calls();
+	for (int i = 0; i < num_frames; i++)
+	{
+		if (events)
+		{
+			vr::VREvent_t event;
+			while (vri.sysi->PollNextEvent(&event, sizeof(event)))
+			{
+				invalidate_for_event(event, &capture.m_keys, &capture.m_poll_schedule);
+			}
+		}
+		traverser.update_capture(&capture, &vri, i * POLL_TEST_FRAME_US, true);
+		openvr_sim::advance_frame();
+	}
+	return double(openvr_sim::get_num_calls() - start_calls) / num_frames;
+}
+
+// property changes land in the event driven capture on the same frame as the every frame one
+static void test_event_driven_capture()
+{
+	static const int num_frames = 450;
+	capture_test_context every_frame;
+	capture_test_context tiered;
+	capture_test_context event_driven;
+	every_frame.get_config().set_poll_every_frame();
+	event_driven.get_config().set_poll_on_events(10000);
+
+	double every_frame_calls = calls_per_frame_from_sim(&every_frame, num_frames, false);
+	double tiered_calls = calls_per_frame_from_sim(&tiered, num_frames, false);
+	double event_calls = calls_per_frame_from_sim(&event_driven, num_frames, true);
+
+	auto &every_frame_system = every_frame.get_capture().m_state.system_node;
+	auto &event_system = event_driven.get_capture().m_state.system_node;
+	for (int i = 0; i < int(every_frame_system.controllers.size()); i++)
+	{
+		assert(same_histories(event_system.controllers[i].float_props, every_frame_system.controllers[i].float_props));
+		assert(same_histories(event_system.controllers[i].bool_props, every_frame_system.controllers[i].bool_props));
+		assert(same_history(event_system.controllers[i].standing_tracking_pose, every_frame_system.controllers[i].standing_tracking_pose));
+	}
+
+	log_printf("openvr calls per frame: every frame %.1f tiered %.1f event driven %.1f\n",
+		every_frame_calls, tiered_calls, event_calls);
+	assert(event_calls <= tiered_calls);
+	assert(tiered_calls < every_frame_calls);
+}
+
+void test_poll_schedule()
+{
+	test_every_n_frames();
+	test_every_n_ms();
+	test_on_demand();
+	test_tiered_capture_keeps_poses();
+	test_event_invalidates_device();
+	test_event_driven_capture();
+	log_printf("test_poll_schedule done\n");
+}
@@ -0,0 +1,116 @@
+//
+// resource_cache: resources are only reloaded when their file changes and only visited when the
+// content does
+//
+#include "resource_cache.h"
+#include "content_hash.h"
+#include "platform.h"
+#include "openvr_sim.h"
+#include "capture_test_context.h"
+#include "capture_traverser.h"
+#include "log.h"
+#include <stdio.h>
+#include <vector>
+
+static void write_file(const std::string &filename, const std::vector<uint8_t> &contents)
+{
+	FILE *f = fopen(filename.c_str(), "wb");
+	assert(f);
+	fwrite(contents.data(), 1, contents.size(), f);
+	fclose(f);
+}
+
+static void test_file_metadata()
+{
+	std::string filename = plat::make_temporary_filename("resource_cache_test.bin");
+	std::vector<uint8_t> a(1000, 1);
+	std::vector<uint8_t> b(1200, 2);
+	write_file(filename, a);
+
+	resource_cache cache;
+	assert(cache.needs_load(filename.c_str()));
+	assert(cache.content_changed(filename.c_str(), a.data(), uint32_t(a.size())));
+
+	// untouched, so no load
+	assert(!cache.needs_load(filename.c_str()));
+	assert(!cache.needs_load(filename.c_str()));
+	assert(cache.get_num_loads() == 1);
+
+	write_file(filename, b);
+	assert(cache.needs_load(filename.c_str()));
+	assert(cache.content_changed(filename.c_str(), b.data(), uint32_t(b.size())));
+
+	// rewritten with the same bytes: may be loaded again but isn't a change
+	write_file(filename, b);
+	if (cache.needs_load(filename.c_str()))
+	{
+		assert(!cache.content_changed(filename.c_str(), b.data(), uint32_t(b.size())));
+	}
+	assert(cache.get_num_changes() == 2);
+	remove(filename.c_str());
+}
+
+// paths that aren't files are always loaded, but only changed content is a change
+static void test_content_hash()
+{
+	resource_cache cache;
+	std::vector<uint8_t> a(333, 7);
+	std::vector<uint8_t> b = a;
+	b[200] = 8;
+	assert(cache.needs_load("not/a/file"));
+	assert(cache.content_changed("not/a/file", a.data(), uint32_t(a.size())));
+	assert(cache.needs_load("not/a/file"));
+	assert(!cache.content_changed("not/a/file", a.data(), uint32_t(a.size())));
+	assert(cache.content_changed("not/a/file", b.data(), uint32_t(b.size())));
+	assert(cache.content_changed("not/a/file", a.data(), uint32_t(a.size() - 1)));
+	assert(cache.content_changed("another/path", a.data(), uint32_t(a.size())));
+
+	// every byte counts, wherever it is
+	for (size_t i = 0; i < a.size(); i += 37)
+	{
+		b = a;
+		b[i]++;
+		assert(hash_content(a.data(), a.size()) != hash_content(b.data(), b.size()));
+	}
+	assert(hash_content(a.data(), 0) != hash_content(a.data(), 1));
+}
+
+// updating every frame, each sim resource is visited once
+static void test_sim_resources_visited_once()
+{
+	openvr_sim::sim_config config;
+	config.set_default();
+	openvr_sim::configure(config);
+
+	// the default config has no resources to intercept
+	static const char *filenames[] = { "sim_icon.png", "sim_sound.wav", "sim_layout.json" };
+	static const char *directories[] = { "icons", "sounds", "" };
+
+	capture_test_context context;
+	context.get_config().set_poll_every_frame();
+	context.get_config().num_resources = TBL_SIZE(filenames);
+	context.get_config().resource_filenames = filenames;
+	context.get_config().resource_directories = directories;
+	capture_traverser traverser;
+	for (int i = 0; i < 10; i++)
+	{
+		traverser.update_capture(&context.get_capture(), &context.sim_vr_interfaces(), i * 11111, true);
+		openvr_sim::advance_frame();
+	}
+
+	auto &resources = context.get_capture().m_state.resources_node.resources;
+	assert(resources.size() > 0);
+	assert(context.get_capture().m_resource_cache.get_num_changes() == resources.size());
+	for (int i = 0; i < size_as_int(resources.size()); i++)
+	{
+		assert(resources[i].resource_data.size() == 1);
+	}
+}
+
+void test_resource_cache()
+{
+	test_file_metadata();
+	test_content_hash();
+	test_sim_resources_visited_once();
+	log_printf("test_resource_cache done\n");
+}
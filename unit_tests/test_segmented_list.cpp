@@ -22,15 +22,18 @@ struct SimpleHeap
 	SimpleHeap()
 	{
 		allocations = 0;
+		bytes = 0;
 	}
 
 	size_t allocations;
+	size_t bytes;
 
 	void *allocate(size_t size)
 	{
 		void *ret = malloc(size);
 		memset(ret, 7, size);
 		allocations++;
+		bytes += size;
 		return ret;
 	}
 
@@ -658,9 +661,51 @@ void compare_against_ref()
 	}
 }
 
+// readers index and call back() while the writer appends.  with one item per segment the
+// segment directory is reallocated many times under the readers
+static void directory_growth_test()
+{
+	static const int NUM_WRITES = 100000;
+	typedef segmented_list<int, 1, SimpleAllocator<int>> list_t;
+	SimpleAllocator<int> ss;
+	list_t shared_list(ss);
+	std::atomic<bool> done(false);
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 2; i++)
+	{
+		readers.emplace_back([&shared_list, &done]()
+		{
+			while (!done)
+			{
+				int size = size_as_int(shared_list.size());
+				if (size == 0)
+					continue;
+				assert(shared_list.back() >= size - 1);
+				assert(shared_list[size - 1] == size - 1);
+				assert(shared_list[size / 2] == size / 2);
+				assert(*(shared_list.begin() + (size - 1)) == size - 1);
+			}
+		});
+	}
+	for (int i = 0; i < NUM_WRITES; i++)
+	{
+		shared_list.emplace_back(i);
+	}
+	done = true;
+	for (auto &reader : readers)
+	{
+		reader.join();
+	}
+	assert(shared_list.size() == NUM_WRITES);
+	assert(shared_list.back() == NUM_WRITES - 1);
+}
+
 // evaluates one writer, multi reader threading access to different segment sizes
 static void threading_tests()
 {
+	directory_growth_test();
+
 	read_ordering_test_int<1>();
 	read_ordering_test_int<2>();
 	read_ordering_test_int<3>();
@@ -870,12 +915,74 @@ static void move_test()
 	}
 }
 
+// segments are allocated when the first item lands in them, and grow 4, 16, 64, ... up to SegmentSize
+static void lazy_segment_test()
+{
+	SimpleHeap heap;
+	SimpleAllocator<int> allocator(&heap);
+	typedef segmented_list<int, 1024, SimpleAllocator<int>> list_t;
+	{
+		list_t empty(allocator);
+		assert(heap.allocations == 0);
+		assert(empty.begin() == empty.end());
+		list_t copy(empty);
+		assert(heap.allocations == 0);
+	}
+
+	list_t list(allocator);
+	list.emplace_back(0);
+	assert(heap.allocations == 1 && heap.bytes == 4 * sizeof(int));
+
+	static const size_t expected_capacity[] = { 4, 4 + 16, 4 + 16 + 64, 4 + 16 + 64 + 256, 340 + 1024, 340 + 2048 };
+	for (int i = 1; i < 3000; i++)
+	{
+		size_t before = heap.allocations;
+		list.emplace_back(i);
+		if (heap.allocations != before)
+		{
+			assert(size_t(i) == expected_capacity[before - 1]);
+		}
+	}
+	assert(heap.allocations == 1 + TBL_SIZE(expected_capacity));
+	for (int i = 0; i < 3000; i++)
+	{
+		assert(list[i] == i);
+		assert(*(list.begin() + i) == i);
+	}
+
+	// a copy only allocates the segments that hold items
+	size_t before = heap.allocations;
+	list_t small(allocator);
+	small.emplace_back(1);
+	small.emplace_back(2);
+	list_t small_copy(small);
+	assert(heap.allocations == before + 2);
+	assert(small_copy == small);
+
+	// clear keeps the first segment
+	small.clear();
+	small.emplace_back(3);
+	assert(heap.allocations == before + 2);
+
+	// reserve allocates up front
+	list_t reserved(allocator);
+	reserved.reserve(100);
+	assert(reserved.capacity() == 340 && reserved.empty());
+	before = heap.allocations;
+	for (int i = 0; i < 340; i++)
+	{
+		reserved.emplace_back(i);
+	}
+	assert(heap.allocations == before);
+}
+
 void TEST_SEGMENTED_LIST()
 {
 	log_printf("start testing segmented list");
+	lazy_segment_test();
 	move_test();
 	segmented_list_allocators();
 	basic_behaviour_test();
-	//threading_tests();
+	threading_tests();
 	log_printf("done testing segmented list");
 }
@@ -4,13 +4,15 @@
 
 #include "slab_allocator.h"
 #include "log.h"
+#include "platform.h"
 #include <memory.h>
 #include <vector>
 #include <thread>
+#include <chrono>
 
 void allocator(slab* s, int num_allocs, int alloc_size, char my_id)
 {
-	std::vector<void *> mine; 
+	std::vector<void *> mine;
 	mine.reserve(num_allocs);
 	for (int i = 0; i < num_allocs; i++)
 	{
@@ -53,9 +55,108 @@ void allocate_from_multiple_threads()
 		thread->join();
     delete thread;
 	}
-	int page_count = std::distance(s.pages.begin(), s.pages.end());
-	int expected_page_count = num_threads * allocs_per_thread * size_per_alloc / page_size;
-	assert(page_count == expected_page_count);
+	// each thread bumps through it's own pages, in blocks of the size class
+	int block_size = int(slab::get_class_bytes(slab::get_size_class(size_per_alloc)));
+	int blocks_per_page = page_size / block_size;
+	int expected_page_count = num_threads * ((allocs_per_thread + blocks_per_page - 1) / blocks_per_page);
+	assert(s.get_num_threads() == num_threads);
+	assert(s.get_num_pages() == expected_page_count);
+	assert(s.get_num_alloc_calls() == uint64_t(num_threads) * allocs_per_thread);
+}
+
+// a vector growing and shrinking away: the buffers it lets go of are reused
+void reuse_freed_blocks()
+{
+	slab s;
+	for (int round = 0; round < 100; round++)
+	{
+		std::vector<int, slab_allocator<int>> v{ slab_allocator<int>(&s) };
+		for (int i = 0; i < 1000; i++)
+		{
+			v.push_back(i);
+		}
+		assert(v[999] == 999);
+	}
+	assert(s.get_num_pages() == 1);
+	assert(s.get_num_reused() > 0);
+	assert(s.get_num_dealloc_calls() == s.get_num_alloc_calls());
+
+	// over the largest class: the heap
+	{
+		std::vector<char, slab_allocator<char>> big{ slab_allocator<char>(&s) };
+		big.resize(slab::MAX_CLASS_BYTES + 1);
+		assert(s.get_num_large() == 1);
+	}
+	assert(s.get_num_large() == 0);
+
+	// copies take the slab that's current where they're made
+	slab t;
+	std::vector<int, slab_allocator<int>> a{ slab_allocator<int>(&s) };
+	a.push_back(1);
+	{
+		slab::scope scope(&t);
+		std::vector<int, slab_allocator<int>> b(a);
+		assert(b.get_allocator().m_slab == &t);
+		assert(slab_allocator<int>().m_slab == &t);
+	}
+	assert(slab_allocator<int>().m_slab == slab_allocator_base::m_temp_slab);
+}
+
+// allocation churn (allocate a few, free them, repeat) from more and more threads at once
+template <typename Alloc, typename Free>
+static double churn_ms(int num_threads, int rounds, Alloc alloc, Free dealloc)
+{
+	static const int BATCH = 64;
+	static const int sizes[] = { 16, 24, 48, 100, 256, 700 };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; t++)
+	{
+		threads.emplace_back([rounds, &alloc, &dealloc, t]()
+		{
+			void *blocks[BATCH];
+			for (int r = 0; r < rounds; r++)
+			{
+				for (int i = 0; i < BATCH; i++)
+				{
+					blocks[i] = alloc(sizes[(i + t) % TBL_SIZE(sizes)]);
+					*static_cast<char *>(blocks[i]) = char(i);
+				}
+				for (int i = 0; i < BATCH; i++)
+				{
+					assert(*static_cast<char *>(blocks[i]) == char(i));
+					dealloc(blocks[i], sizes[(i + t) % TBL_SIZE(sizes)]);
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void contention_benchmark()
+{
+#ifdef _DEBUG
+	int rounds = 1000;
+#else
+	int rounds = 20000;
+#endif
+	for (int num_threads = 1; num_threads <= 8; num_threads *= 2)
+	{
+		slab s;
+		double slab_ms = churn_ms(num_threads, rounds,
+			[&s](size_t size) { return s.slab_alloc(size); },
+			[&s](void *p, size_t size) { s.slab_dealloc(p, size); });
+		double malloc_ms = churn_ms(num_threads, rounds,
+			[](size_t size) { return malloc(size); },
+			[](void *p, size_t) { free(p); });
+		assert(s.get_num_pages() <= num_threads);	// the churn only ever needs the first page
+		log_printf("slab contention: %d threads %.1f ms (malloc %.1f ms) for %d allocations each\n",
+			num_threads, slab_ms, malloc_ms, rounds * 64);
+	}
 }
 
 void TEST_SLAB_ALLOCATOR()
@@ -65,6 +166,7 @@ void TEST_SLAB_ALLOCATOR()
 		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 		log_printf("multi threaded allocations took %lld ms.\n",
 			std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-	
-}
 
+		reuse_freed_blocks();
+		contention_benchmark();
+}
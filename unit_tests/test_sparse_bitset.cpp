@@ -0,0 +1,107 @@
+// test_sparse_bitset
+// * unit test for the per frame update sets: which form assign() picks, iteration and the encodings
+//
+
+#include "sparse_bitset.h"
+#include "VectorStream.h"
+#include "log.h"
+#include <assert.h>
+#include <vector>
+
+typedef boost::dynamic_bitset<uint64_t, std::allocator<uint64_t>> scratch_bitset;
+
+static scratch_bitset make_scratch(const std::vector<size_t> &ids)
+{
+	scratch_bitset bits;
+	for (size_t id : ids)
+	{
+		bits.set(id);		// HACKED_BITSET grows to fit
+	}
+	return bits;
+}
+
+static std::vector<size_t> get_ids(const sparse_bitset &bits)
+{
+	std::vector<size_t> ids;
+	for (size_t id = bits.find_first(); id != sparse_bitset::npos; id = bits.find_next(id))
+	{
+		ids.push_back(id);
+	}
+	return ids;
+}
+
+static sparse_bitset encode_decode(const sparse_bitset &bits, uint64_t *encoded_size)
+{
+	VectorStream stream;
+	bits.encode(stream);
+	*encoded_size = stream.size();
+	stream.reset_buf_pos();
+	sparse_bitset decoded;
+	decoded.decode(stream);
+	assert(stream.get_pos() == stream.size());
+	return decoded;
+}
+
+static void test_forms()
+{
+	scratch_bitset nothing;
+	nothing.resize(1000);
+	sparse_bitset empty(nothing);
+	assert(empty.none());
+	assert(empty.find_first() == sparse_bitset::npos);
+
+	// a controller discovered last in a big graph: a few high ids
+	std::vector<size_t> high = { 249000, 249500, 249999 };
+	sparse_bitset few(make_scratch(high));
+	assert(!few.is_window());
+	assert(get_ids(few) == high);
+	assert(few.test(249500) && !few.test(249501) && !few.test(0));
+
+	// ids far apart stay a list
+	std::vector<size_t> spread = { 3, 125000, 249999 };
+	sparse_bitset apart(make_scratch(spread));
+	assert(!apart.is_window());
+	assert(get_ids(apart) == spread);
+
+	// a run of neighbouring ids is cheaper as bits.  nothing below the first block is stored
+	std::vector<size_t> run;
+	for (size_t id = 200003; id < 200500; id += 2)
+	{
+		run.push_back(id);
+	}
+	sparse_bitset window(make_scratch(run));
+	assert(window.is_window());
+	assert(get_ids(window) == run);
+	assert(window.find_next(5) == run.front());
+	assert(window.test(200003) && !window.test(200004) && !window.test(3));
+	assert(window != few);
+}
+
+static void test_encodings()
+{
+	uint64_t size;
+	std::vector<size_t> high = { 249000, 249500, 249999 };
+	sparse_bitset few(make_scratch(high));
+	assert(encode_decode(few, &size) == few);
+	assert(size < 16);		// form, count and three varints, not the 31k of a bitset this big
+
+	std::vector<size_t> run;
+	for (size_t id = 200003; id < 200500; id += 2)
+	{
+		run.push_back(id);
+	}
+	sparse_bitset window(make_scratch(run));
+	sparse_bitset decoded = encode_decode(window, &size);
+	assert(decoded == window);
+	assert(get_ids(decoded) == run);
+	assert(size < 128);
+
+	sparse_bitset empty;
+	assert(encode_decode(empty, &size) == empty);
+}
+
+void TEST_SPARSE_BITSET()
+{
+	test_forms();
+	test_encodings();
+}
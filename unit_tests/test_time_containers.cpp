@@ -1,6 +1,7 @@
 #include "MemoryStream.h"
 #include "time_containers.h"
 #include "segmented_list.h"
+#include "columnar_list.h"
 #include "result.h"
 
 template <template <typename, typename> class Container>
@@ -153,8 +154,10 @@ void TEST_TIME_CONTAINERS()
 
 	test_ops_on_container<std::vector>();
 	test_ops_on_container<segmented_list_1024>();
+	test_ops_on_container<columnar_list_1024>();
 
 	test_last_item_query_cache<std::vector>();
 	test_last_item_query_cache<segmented_list_1024>();
+	test_last_item_query_cache<columnar_list_1024>();
 
 }
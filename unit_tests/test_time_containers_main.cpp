@@ -2,11 +2,15 @@
 
 extern void TEST_TIME_CONTAINERS();
 extern void TEST_SCHEMA_COMMON();
+extern void TEST_HISTORY_CODEC();
+extern void TEST_COLUMNAR_LIST();
 
 void test_time_containers()
 {
 	TEST_TIME_CONTAINERS();
 	TEST_SCHEMA_COMMON();
+	TEST_HISTORY_CODEC();
+	TEST_COLUMNAR_LIST();
 }
 
 #ifdef TEST_TIME_CONTAINERS_MAIN
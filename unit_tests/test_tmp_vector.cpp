@@ -0,0 +1,120 @@
+// test_tmp_vector
+// * unit test for the temporary buffer pool: size classes, promotion and the thread caches
+//
+
+#include "tmp_vector.h"
+#include "platform.h"
+#include "log.h"
+#include <assert.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef tmp_vector_pool<32 * 1024> test_pool;
+typedef tmp_vector2<char, 32 * 1024> test_string;
+
+// stands in for an OpenVR string query: returns the size it needs, and only writes if it fits
+static uint32_t get_string(const std::string &value, char *buf, uint32_t buf_size)
+{
+	uint32_t required = uint32_t(value.size() + 1);
+	if (required <= buf_size)
+	{
+		memcpy(buf, value.c_str(), required);
+	}
+	return required;
+}
+
+static void query(const std::string &value, test_string *s)
+{
+	uint32_t count = get_string(value, s->data(), uint32_t(s->max_size()));
+	if (count > s->max_size() && s->reserve(count))
+	{
+		count = get_string(value, s->data(), uint32_t(s->max_size()));
+	}
+	s->resize(count);
+}
+
+static void test_promotion()
+{
+	test_pool pool;
+	{
+		test_string s(&pool);
+		assert(s.max_size() == test_pool::get_class_bytes(test_pool::SMALL));
+		query("short", &s);
+		assert(strcmp(s.data(), "short") == 0);
+		assert(pool.get_num_promotions() == 0);
+
+		// too big for the small buffer: promoted and asked again
+		std::string medium(1000, 'm');
+		query(medium, &s);
+		assert(s.max_size() == test_pool::get_class_bytes(test_pool::MEDIUM));
+		assert(medium == s.data());
+
+		std::string large(20000, 'l');
+		query(large, &s);
+		assert(s.max_size() == s.max_capacity());
+		assert(large == s.data());
+		assert(pool.get_num_promotions() == 2);
+
+		// nothing bigger than the largest
+		assert(!s.reserve(s.max_capacity() + 1));
+	}
+
+	// promotion keeps what was there
+	{
+		tmp_vector2<int, 32 * 1024> ints(&pool);
+		for (int i = 0; i < 5000; i++)
+		{
+			ints.push_back(i);
+		}
+		for (int i = 0; i < 5000; i++)
+		{
+			assert(ints[i] == i);
+		}
+	}
+	assert(pool.get_num_allocs() == pool.get_num_frees());
+}
+
+// after the first, a thread's temporaries come from it's cache
+static void test_thread_caches()
+{
+	test_pool pool;
+	std::vector<std::thread> threads;
+	static const int NUM_THREADS = 4;
+	static const int NUM_QUERIES = 10000;
+	for (int t = 0; t < NUM_THREADS; t++)
+	{
+		threads.emplace_back([&pool]()
+		{
+			for (int i = 0; i < NUM_QUERIES; i++)
+			{
+				test_string a(&pool);
+				test_string b(&pool);
+				query("a value", &a);
+				query(std::string(i % 100 == 0 ? 500 : 10, 'x'), &b);
+				assert(a.size() == 8);
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	assert(pool.get_num_threads() == NUM_THREADS);
+	assert(pool.get_num_allocs() == pool.get_num_frees());
+	assert(pool.get_num_promotions() == NUM_THREADS * NUM_QUERIES / 100);
+	assert(pool.get_num_buffers() <= uint64_t(NUM_THREADS * 3));
+	assert(pool.get_num_cache_hits() + pool.get_num_buffers() == pool.get_num_allocs());		// never past the caches
+	log_printf("tmp_vector pool: %llu allocations, %llu from the thread caches, %llu promotions, %llu buffers\n",
+		(unsigned long long)pool.get_num_allocs(),
+		(unsigned long long)pool.get_num_cache_hits(),
+		(unsigned long long)pool.get_num_promotions(),
+		(unsigned long long)pool.get_num_buffers());
+}
+
+void TEST_TMP_VECTOR()
+{
+	test_promotion();
+	test_thread_caches();
+}
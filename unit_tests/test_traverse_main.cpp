@@ -6,14 +6,26 @@
 
 extern void UPDATE_USE_CASE();
 extern void test_capture_serialization();
+extern void test_openvr_sim();
+extern void test_poll_schedule();
+extern void test_resource_cache();
+extern void test_overlay_images();
+extern void test_cold_segments();
 
 void test_traverse()
 {
+	test_openvr_sim();
+	test_poll_schedule();
+	test_resource_cache();
+	test_overlay_images();
+	test_cold_segments();
 	test_capture_serialization();
 	UPDATE_USE_CASE();
 }
 
 #ifdef TEST_TRAVERSE_MAIN
+int hack_vr_init_called = 0;
+
 int main()
 {
 	test_traverse();
@@ -0,0 +1,178 @@
+// test_url_named
+// * unit test for the path trie: concurrent discovery, full paths, ordering, the two encodings
+//   and freeing the trie with the last reference
+//
+
+#include "url_named.h"
+#include "VectorStream.h"
+#include "log.h"
+#include <assert.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using base::URL;
+
+// threads discovering the same children at once get the same URLs
+static void test_concurrent_children()
+{
+	static const int NUM_THREADS = 8;
+	static const int NUM_DEVICES = 64;
+	static const char *props[] = { "bool_props", "string_props", "float_props", "int32_props", "mat34_props", "uint64_props" };
+	URL devices = URL("vr", "/vr").make_child("system").make_child("controllers");
+	std::vector<std::vector<URL>> urls(NUM_THREADS);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUM_THREADS; t++)
+	{
+		std::vector<URL> *mine = &urls[t];
+		threads.emplace_back([mine, devices]()
+		{
+			for (int i = 0; i < NUM_DEVICES; i++)
+			{
+				URL device = devices.make_child(std::to_string(i));
+				for (const char *prop : props)
+				{
+					mine->push_back(device.make_child(prop));
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	for (int t = 1; t < NUM_THREADS; t++)
+	{
+		assert(urls[t] == urls[0]);
+	}
+	assert(urls[0][0].get_full_path() == "/vr/system/controllers/0/bool_props");
+	assert(urls[0].back().get_name() == "uint64_props");
+	assert(urls[0].back().get_full_path() == "/vr/system/controllers/63/uint64_props");
+
+	// the names are shared between paths
+	assert(base::path_table::global().get_name_id(urls[0][0].get_path_id()) ==
+		base::path_table::global().get_name_id(urls[0][TBL_SIZE(props)].get_path_id()));
+}
+
+static void test_urls()
+{
+	URL empty;
+	assert(empty.get_name() == "" && empty.get_full_path() == "");
+	assert(empty == URL::EMPTY_URL);
+
+	URL foo("foo", "/root/foo");
+	assert(foo.get_name() == "foo");
+	assert(foo.get_full_path() == "/root/foo");
+	assert(foo == URL("root", "/root").make_child("foo"));
+	assert(foo != URL("root", "/root").make_child("bar"));
+	assert(URL("x", "/x").make_child("y") != URL("y", "/y"));
+
+	// by path, whatever order they were interned in
+	URL later_b = URL("order", "/order").make_child("b");
+	URL later_a = URL("order", "/order").make_child("a");
+	URL later_a_b = later_a.make_child("b");
+	URL later_a_dash = URL("order", "/order").make_child("a-");
+	assert(later_a < later_b && !(later_b < later_a));
+	assert(later_a < later_a_b && later_a_b < later_b);
+	assert(later_a_dash < later_a_b);		// '-' sorts before '/', as in the strings
+	assert(!(later_a < later_a));
+	assert(empty < later_a);
+}
+
+static void test_encodings()
+{
+	std::vector<URL> urls;
+	URL root("vr", "/vr");
+	urls.push_back(root);
+	urls.push_back(root.make_child("applications").make_child("steam.app.250820"));
+	urls.push_back(root.make_child("applications"));
+	urls.push_back(URL());
+
+	// inline: the names from the root
+	{
+		VectorStream stream;
+		for (const URL &url : urls)
+		{
+			url.encode(stream);
+		}
+		stream.reset_buf_pos();
+		for (const URL &url : urls)
+		{
+			URL decoded;
+			decoded.decode(stream);
+			assert(decoded == url);
+		}
+	}
+
+	// ids, and the trie once
+	VectorStream state;
+	base::path_section saved;
+	state.paths = &saved;
+	for (const URL &url : urls)
+	{
+		url.encode(state);
+	}
+	assert(saved.size() == 3);		// vr, applications and steam.app.250820
+	VectorStream paths;
+	saved.encode(paths);
+
+	base::path_section loaded;
+	paths.reset_buf_pos();
+	assert(loaded.decode(paths));
+	state.reset_buf_pos();
+	state.paths = &loaded;
+	for (const URL &url : urls)
+	{
+		URL decoded;
+		decoded.decode(state);
+		assert(decoded == url);
+	}
+	assert(state.get_pos() == state.size());
+
+	// sections filled by separate tasks and merged write each path once
+	VectorStream task_a, task_b;
+	base::path_section section_a, section_b;
+	task_a.paths = &section_a;
+	task_b.paths = &section_b;
+	urls[0].encode(task_a);
+	urls[1].encode(task_b);
+	urls[2].encode(task_b);
+	section_a.merge(section_b);
+	assert(section_a.size() == 3);
+	VectorStream merged;
+	section_a.encode(merged);
+	assert(merged.buf == paths.buf);
+}
+
+// the trie goes with the last reference, and the ids start over
+static void test_references()
+{
+	{
+		base::path_table::reference capture_a;
+		URL kept("kept", "/vr/kept");
+		{
+			base::path_table::reference capture_b(capture_a);
+			URL("other", "/vr/other");
+		}
+		assert(kept.get_full_path() == "/vr/kept");
+		assert(base::path_table::global().get_num_paths() > 1);
+	}
+	assert(base::path_table::global().get_num_paths() == 1);		// ROOT
+	assert(base::path_table::global().get_num_names() == 1);
+
+	base::path_table::reference capture_c;
+	URL again("kept", "/vr/kept");
+	assert(again.get_path_id() == 2);
+	assert(again.get_full_path() == "/vr/kept");
+}
+
+void TEST_URL_NAMED()
+{
+	test_concurrent_children();
+	test_urls();
+	test_encodings();
+	log_printf("path table: %u paths, %u names\n",
+		base::path_table::global().get_num_paths(),
+		base::path_table::global().get_num_names());
+	test_references();
+}
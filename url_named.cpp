@@ -1,5 +1,258 @@
 #include "url_named.h"
+#include "log.h"
+#include <algorithm>
+#include <functional>
 
+using namespace base;
 
+path_table &path_table::global()
+{
+	static path_table table;
+	return table;
+}
+
+path_table::path_table()
+	: m_num_references(0)
+{
+	m_names.push_back(std::string());
+	m_paths.push_back({ ROOT, 0 });		// ROOT
+}
+
+void path_table::acquire()
+{
+	std::lock_guard<std::mutex> lock(m_references_lock);
+	m_num_references++;
+}
+
+void path_table::release()
+{
+	std::lock_guard<std::mutex> lock(m_references_lock);
+	assert(m_num_references > 0);
+	if (--m_num_references == 0)
+	{
+		clear();
+	}
+}
+
+// m_references_lock is held.  the memory goes back too, not just the entries
+void path_table::clear()
+{
+	for (name_shard &s : m_name_shards)
+	{
+		tbb::spin_mutex::scoped_lock lock(s.lock);
+		std::unordered_map<std::string, uint32_t>().swap(s.ids);
+	}
+	for (path_shard &s : m_path_shards)
+	{
+		tbb::spin_mutex::scoped_lock lock(s.lock);
+		std::unordered_map<uint64_t, uint32_t>().swap(s.ids);
+	}
+	tbb::concurrent_vector<std::string>().swap(m_names);
+	tbb::concurrent_vector<node>().swap(m_paths);
+	m_names.push_back(std::string());
+	m_paths.push_back({ ROOT, 0 });		// ROOT
+}
+
+uint32_t path_table::intern_name(const std::string &name)
+{
+	name_shard &s = m_name_shards[std::hash<std::string>()(name) % NUM_SHARDS];
+	tbb::spin_mutex::scoped_lock lock(s.lock);
+	auto iter = s.ids.find(name);
+	if (iter != s.ids.end())
+	{
+		return iter->second;
+	}
+	uint32_t id = uint32_t(m_names.push_back(name) - m_names.begin());
+	s.ids.insert({ name, id });
+	return id;
+}
+
+uint32_t path_table::intern_child(uint32_t parent, const std::string &name)
+{
+	assert(parent < m_paths.size());
+	uint32_t name_id = intern_name(name);
+	uint64_t key = (uint64_t(parent) << 32) | name_id;
+	path_shard &s = m_path_shards[std::hash<uint64_t>()(key * 0x9E3779B97F4A7C15ULL) % NUM_SHARDS];
+	tbb::spin_mutex::scoped_lock lock(s.lock);
+	auto iter = s.ids.find(key);
+	if (iter != s.ids.end())
+	{
+		return iter->second;
+	}
+	uint32_t id = uint32_t(m_paths.push_back({ parent, name_id }) - m_paths.begin());
+	s.ids.insert({ key, id });
+	return id;
+}
+
+std::string path_table::get_full_path(uint32_t path) const
+{
+	std::vector<uint32_t> chain;
+	size_t size = 0;
+	for (uint32_t p = path; p != ROOT; p = m_paths[p].parent)
+	{
+		chain.push_back(p);
+		size += 1 + m_names[m_paths[p].name].size();
+	}
+
+	std::string full_path;
+	full_path.reserve(size);
+	for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter)
+	{
+		full_path += '/';
+		full_path += m_names[m_paths[*iter].name];
+	}
+	return full_path;
+}
+
+void path_section::add(uint32_t path)
+{
+	// the parents go in too.  once one is already there, so are it's parents
+	while (path != path_table::ROOT && m_paths.insert(path).second)
+	{
+		path = path_table::global().get_parent(path);
+	}
+}
+
+void path_section::merge(const path_section &rhs)
+{
+	m_paths.insert(rhs.m_paths.begin(), rhs.m_paths.end());
+}
+
+//	int num_paths, { uint32_t id, uint32_t parent id, int size, char name[size] } * num_paths
+//
+// sorted by id so parents come before their children
+void path_section::encode(BaseStream &e) const
+{
+	std::vector<uint32_t> paths(m_paths.begin(), m_paths.end());
+	std::sort(paths.begin(), paths.end());
+	int num_paths = size_as_int(paths.size());
+	e.write_to_stream(&num_paths, sizeof(num_paths));
+	const path_table &table = path_table::global();
+	for (uint32_t path : paths)
+	{
+		uint32_t parent = table.get_parent(path);
+		e.write_to_stream(&path, sizeof(path));
+		e.write_to_stream(&parent, sizeof(parent));
+		e.contiguous_container_out_to_stream(table.get_name(path));
+	}
+}
+
+bool path_section::decode(BaseStream &e)
+{
+	int num_paths;
+	e.read_from_stream(&num_paths, sizeof(num_paths));
+	if (num_paths < 0)
+	{
+		return false;
+	}
+	m_saved_paths.reserve(num_paths);
+	std::string name;
+	for (int i = 0; i < num_paths; i++)
+	{
+		uint32_t saved_path;
+		uint32_t saved_parent;
+		e.read_from_stream(&saved_path, sizeof(saved_path));
+		e.read_from_stream(&saved_parent, sizeof(saved_parent));
+		e.contiguous_container_from_stream(name);
+		uint32_t parent = path_table::ROOT;
+		if (saved_parent != path_table::ROOT)
+		{
+			auto iter = m_saved_paths.find(saved_parent);
+			if (iter == m_saved_paths.end())
+			{
+				return false;	// parents are written first
+			}
+			parent = iter->second;
+		}
+		m_saved_paths[saved_path] = path_table::global().intern_child(parent, name);
+	}
+	return true;
+}
+
+uint32_t path_section::lookup(uint32_t saved_path) const
+{
+	if (saved_path == path_table::ROOT)
+	{
+		return path_table::ROOT;
+	}
+	auto iter = m_saved_paths.find(saved_path);
+	if (iter == m_saved_paths.end())
+	{
+		log_printf("path %u isn't in the paths section\n", saved_path);
+		return path_table::ROOT;
+	}
+	return iter->second;
+}
+
+URL::URL(const std::string &name, const std::string &full_path)
+	: m_path(path_table::ROOT)
+{
+	size_t pos = 0;
+	while (pos < full_path.size())
+	{
+		assert(full_path[pos] == '/');
+		size_t end = full_path.find('/', pos + 1);
+		if (end == std::string::npos)
+		{
+			end = full_path.size();
+		}
+		m_path = path_table::global().intern_child(m_path, full_path.substr(pos + 1, end - pos - 1));
+		pos = end;
+	}
+	assert(get_name() == name);
+}
+
+bool URL::operator < (const URL &rhs) const
+{
+	if (m_path == rhs.m_path)
+	{
+		return false;
+	}
+	return get_full_path() < rhs.get_full_path();
+}
+
+//	int depth, names root first
+void URL::encode(BaseStream &stream) const
+{
+	if (stream.paths)
+	{
+		stream.paths->add(m_path);
+		stream.write_to_stream(&m_path, sizeof(m_path));
+		return;
+	}
+	const path_table &table = path_table::global();
+	std::vector<uint32_t> chain;
+	for (uint32_t p = m_path; p != path_table::ROOT; p = table.get_parent(p))
+	{
+		chain.push_back(p);
+	}
+	int depth = size_as_int(chain.size());
+	stream.write_to_stream(&depth, sizeof(depth));
+	for (int i = depth - 1; i >= 0; i--)
+	{
+		stream.contiguous_container_out_to_stream(table.get_name(chain[i]));
+	}
+}
+
+void URL::decode(BaseStream &stream)
+{
+	if (stream.paths)
+	{
+		uint32_t saved_path;
+		stream.read_from_stream(&saved_path, sizeof(saved_path));
+		m_path = stream.paths->lookup(saved_path);
+		return;
+	}
+	int depth;
+	stream.read_from_stream(&depth, sizeof(depth));
+	assert(depth >= 0);
+	m_path = path_table::ROOT;
+	std::string name;
+	for (int i = 0; i < depth; i++)
+	{
+		stream.contiguous_container_from_stream(name);
+		m_path = path_table::global().intern_child(m_path, name);
+	}
+}
 
 const base::URL& base::URL::EMPTY_URL = base::URL();
@@ -1,64 +1,158 @@
+//
+// URLs of the schema nodes
+//
+//  * a URL is a node in a trie of paths: (parent, name).  path_table holds the trie for the
+//    process, so a URL is just it's path id and two URLs are equal exactly when their ids are.
+//  * the trie is kept while anything holds a path_table::reference.  each capture does, so once
+//    the last capture goes the names and paths are freed and the ids start over
+//  * names are interned too.  get_name() refers into the table, get_full_path() is built when
+//    asked for ("/parent/.../name").
+//  * discovery interns concurrently.  the table is split into shards, each with it's own lock.
+//    lookups by id don't lock.
+//  * on a stream a URL is written inline (it's names, root first) unless the stream has a
+//    path_section (BaseStream::paths): then it's just the id, and the section writes the trie
+//    once.  a saved capture has a paths section (see capture_traverser.cpp).  like a
+//    string_section, a section belongs to one stream at a time and parallel tasks merge theirs
+//  * URLs order by full path, not by id, so ordered containers of them don't depend on the
+//    order the paths were interned in
+//
 #pragma once
 #include <string>
 #include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include "BaseStream.h"
+#include "tbb/concurrent_vector.h"
+#include "tbb/spin_mutex.h"
 
 namespace base
 {
+	struct path_table
+	{
+		static const uint32_t ROOT = 0;		// the empty path.  it's name and full path are ""
+
+		static path_table &global();
+
+		// keeps the global trie.  copies are references too
+		struct reference
+		{
+			reference() { global().acquire(); }
+			reference(const reference &) { global().acquire(); }
+			reference &operator=(const reference &) { return *this; }
+			~reference() { global().release(); }
+		};
+
+		path_table();
+		path_table(const path_table &) = delete;
+		path_table& operator=(const path_table &) = delete;
+
+		uint32_t intern_child(uint32_t parent, const std::string &name);
+
+		uint32_t get_parent(uint32_t path) const { return m_paths[path].parent; }
+		uint32_t get_name_id(uint32_t path) const { return m_paths[path].name; }
+		const std::string &get_name(uint32_t path) const { return m_names[m_paths[path].name]; }
+		std::string get_full_path(uint32_t path) const;
+
+		uint32_t get_num_paths() const { return uint32_t(m_paths.size()); }
+		uint32_t get_num_names() const { return uint32_t(m_names.size()); }
+
+	private:
+		static const int NUM_SHARDS = 64;
+
+		struct node
+		{
+			uint32_t parent;	// always a smaller id than the node
+			uint32_t name;
+		};
+
+		struct name_shard
+		{
+			tbb::spin_mutex lock;
+			std::unordered_map<std::string, uint32_t> ids;
+		};
+
+		struct path_shard
+		{
+			tbb::spin_mutex lock;
+			std::unordered_map<uint64_t, uint32_t> ids;		// parent << 32 | name
+		};
+
+		uint32_t intern_name(const std::string &name);
+		void acquire();
+		void release();
+		void clear();
+
+		name_shard m_name_shards[NUM_SHARDS];
+		path_shard m_path_shards[NUM_SHARDS];
+		tbb::concurrent_vector<std::string> m_names;	// by name id
+		tbb::concurrent_vector<node> m_paths;			// by path id
+		std::mutex m_references_lock;
+		int m_num_references;
+	};
+
+	// the paths a stream's URLs refer to.  a writer collects the paths it writes and then encodes
+	// them, parents first.  a reader decodes them first and then maps the ids it reads to the ids
+	// in the table.  neither locks, see string_section
+	struct path_section
+	{
+		// writing
+		void add(uint32_t path);
+		void merge(const path_section &rhs);
+		void encode(BaseStream &e) const;
+
+		// reading
+		bool decode(BaseStream &e);
+		uint32_t lookup(uint32_t saved_path) const;
+
+		size_t size() const { return m_paths.size() + m_saved_paths.size(); }
+
+	private:
+		std::unordered_set<uint32_t> m_paths;
+		std::unordered_map<uint32_t, uint32_t> m_saved_paths;		// saved id to id
+	};
+
 	struct URL
 	{
 		const static URL& EMPTY_URL;
 
-		URL() = default;
-
-		URL(const URL &rhs)
-			:	m_name(rhs.m_name),
-				m_full_path(rhs.m_full_path)
+		URL()
+			: m_path(path_table::ROOT)
 		{}
 
-		URL(const std::string &name, const std::string &full_path)
-			:
-			m_name(name),
-			m_full_path(full_path)
+		explicit URL(uint32_t path)
+			: m_path(path)
 		{}
 
-		bool operator < (const URL &rhs) const
-		{
-			return m_full_path < rhs.m_full_path;
-		}
+		// full_path is "/a/b/.../name"
+		URL(const std::string &name, const std::string &full_path);
+
+		// by full path, like the strings URLs used to hold.  builds both paths, so it's for
+		// SerializableRegistry's debug map and tests rather than updates
+		bool operator < (const URL &rhs) const;
 		bool operator ==(const URL &rhs) const
 		{
-			if (this == &rhs)
-				return true;
-			return (m_name == rhs.m_name) && (m_full_path == rhs.m_full_path);
+			return m_path == rhs.m_path;
 		}
 		bool operator !=(const URL &rhs) const
 		{
-			return (m_name != rhs.m_name) || (m_full_path != rhs.m_full_path);
+			return m_path != rhs.m_path;
 		}
 
-		const std::string &get_name() const { return m_name; };
-		const std::string &get_full_path() const { return m_full_path; };
+		uint32_t get_path_id() const { return m_path; }
+		const std::string &get_name() const { return path_table::global().get_name(m_path); };
+		std::string get_full_path() const { return path_table::global().get_full_path(m_path); };
 
 		URL make_child(const std::string &child_name) const
 		{
-			return URL(child_name, m_full_path + "/" + child_name);
+			return URL(path_table::global().intern_child(m_path, child_name));
 		}
 
-		void encode(BaseStream &stream) const
-		{
-			stream.contiguous_container_out_to_stream(m_name);
-			stream.contiguous_container_out_to_stream(m_full_path);
-		}
-		void decode(BaseStream &stream)
-		{
-			stream.contiguous_container_from_stream(m_name);
-			stream.contiguous_container_from_stream(m_full_path);
-		}
+		void encode(BaseStream &stream) const;
+		void decode(BaseStream &stream);
 
 	private:
-		std::string m_name;
-		std::string m_full_path;
+		uint32_t m_path;
 	};
 
 	struct url_named
@@ -70,7 +164,7 @@ namespace base
 			: m_url(url)
 		{}
 		const std::string &get_name() const { return m_url.get_name(); };
-		const std::string &get_path() const { return m_url.get_full_path(); };
+		std::string get_path() const { return m_url.get_full_path(); };
 		const URL &get_url() const { return m_url; }
 
 		void set_url(const URL&url) { m_url = url; }
@@ -89,6 +183,6 @@ namespace base
 		URL m_url;
 	};
 
-	
 
-};
\ No newline at end of file
+
+};
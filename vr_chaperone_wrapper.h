@@ -39,6 +39,7 @@ namespace vr_result
 			float fade_distance,
 			HmdColor<> *camera_color)
 		{
+			colors->val.reserve(num_output_colors);
 			assert(size_as_int(colors->val.max_size()) >= num_output_colors);
 			num_output_colors = std::min(num_output_colors, size_as_int(colors->val.max_size()));
 			chapi->GetBoundsColor(colors->val.data(), num_output_colors, fade_distance, &camera_color->val);
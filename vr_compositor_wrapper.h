@@ -25,6 +25,7 @@ namespace vr_result
 
 		inline TMPCompositorFrameTimingString<> &GetFrameTimings(uint32_t num_frames, TMPCompositorFrameTimingString<> *timings)
 		{
+			timings->val.reserve(num_frames);
 			assert(timings->val.max_size() >= num_frames);
 			num_frames = std::min(num_frames, (uint32_t)timings->val.max_size());
 			vr::Compositor_FrameTiming *p = timings->val.data();
@@ -62,7 +63,11 @@ namespace vr_result
 		inline TMPString<> &GetVulkanInstanceExtensionsRequired(TMPString<> *result)
 		{
 			result->val.data()[0] = 0;
-			compi->GetVulkanInstanceExtensionsRequired(result->val.data(), size_as_int(result->val.max_size()));
+			uint32_t required = compi->GetVulkanInstanceExtensionsRequired(result->val.data(), size_as_int(result->val.max_size()));
+			if (promote_for_count(&result->val, required))
+			{
+				compi->GetVulkanInstanceExtensionsRequired(result->val.data(), size_as_int(result->val.max_size()));
+			}
 			result->val.resize(strlen(result->val.data()) + 1);
 			return *result;
 		}
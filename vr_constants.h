@@ -8,8 +8,9 @@ const size_t VRTMPSize = vr::k_unMaxPropertyStringSize;
 
 const size_t VR_LARGE_SEGMENT_SIZE = 8192;		// segment size for per/frame data.  e.g. 1minute at 90 fps - 5400
 
+// the capture's slab (see slab_allocator.h)
 template <typename T>
-using VRAllocatorTemplate = std::allocator<T>;
+using VRAllocatorTemplate = slab_allocator<T>;
 
 #include "result.h"
 
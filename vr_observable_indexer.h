@@ -1,5 +1,6 @@
 #pragma once
 #include <vr_types.h>
+#include <algorithm>
 
 struct KeysObserver
 {
@@ -20,7 +21,7 @@ struct BasicObservableKeysIndexer : public ObservableKeysIndexer
 	}
 	virtual void UnRegisterObserver(KeysObserver *observer) override
 	{
-		std::remove(observers.begin(), observers.end(), observer);
+		observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
 	}
 protected:
 	void NotifyObservers(const VRKeysUpdate &e)
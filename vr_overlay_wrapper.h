@@ -3,6 +3,8 @@
 
 #include "vr_types.h"
 #include "vr_wrappers_common.h"
+#include "overlay_image_scheduler.h"
+#include <vector>
 
 namespace vr_result
 {
@@ -10,8 +12,9 @@ namespace vr_result
 
 	struct OverlayWrapper
 	{
-		explicit OverlayWrapper(IVROverlay *ovi_in)
-			: ovi(ovi_in)
+		explicit OverlayWrapper(IVROverlay *ovi_in, overlay_image_scheduler *images_in = nullptr)
+			: ovi(ovi_in),
+			  images(images_in)
 		{}
 
 		OverlayWrapper(const OverlayWrapper &rhs) = delete;
@@ -110,6 +113,35 @@ namespace vr_result
 			free(ptr);
 		}
 
+		// same as above, into a buffer that's reused between calls.  the buffer is empty on errors
+		vr::EVROverlayError GetImageData(VROverlayHandle_t ulOverlayHandle,
+			Uint32<EVROverlayError> *width_out,
+			Uint32<EVROverlayError> *height_out,
+			std::vector<uint8_t> *buffer)
+		{
+			uint32_t width_query;
+			uint32_t height_query;
+			buffer->clear();
+			vr::EVROverlayError err = ovi->GetOverlayImageData(ulOverlayHandle, nullptr, 0, &width_query, &height_query);
+			if (err == vr::VROverlayError_ArrayTooSmall)
+			{
+				buffer->resize(width_query * height_query * 4);
+				err = ovi->GetOverlayImageData(ulOverlayHandle, buffer->data(), size_as_uint32(buffer->size()), &width_query, &height_query);
+				if (err != vr::VROverlayError_None)
+				{
+					buffer->clear();
+				}
+			}
+			if (err != vr::VROverlayError_None)
+			{
+				width_query = 0;
+				height_query = 0;
+			}
+			*width_out = make_result<uint32_t, EVROverlayError>(width_query, err);
+			*height_out = make_result<uint32_t, EVROverlayError>(height_query, err);
+			return err;
+		}
+
 		SCALAR_WRAP_INDEXED(IVROverlay, ovi, uint32_t, GetOverlayRenderingPid, VROverlayHandle_t);
 
 		SCALAR_WRAP_INDEXED(IVROverlay, ovi, bool, IsOverlayVisible, VROverlayHandle_t);
@@ -178,6 +210,7 @@ namespace vr_result
 		}
 
 		IVROverlay *ovi;
+		overlay_image_scheduler *images;	// for the image task.  optional
 	};
 
 }
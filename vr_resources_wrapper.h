@@ -3,6 +3,9 @@
 
 #include "vr_types.h"
 #include "vr_wrappers_common.h"
+#include "resource_cache.h"
+#include <vector>
+#include <algorithm>
 
 namespace vr_result
 {
@@ -10,8 +13,9 @@ namespace vr_result
 
 	struct ResourcesWrapper
 	{
-		explicit ResourcesWrapper(IVRResources *resi_in)
-			: resi(resi_in)
+		explicit ResourcesWrapper(IVRResources *resi_in, resource_cache *cache_in = nullptr)
+			: resi(resi_in),
+			  cache(cache_in)
 		{}
 
 		TMPString<> & GetFullPath(const char *filename, const char *directory, TMPString<> *result)
@@ -46,6 +50,20 @@ namespace vr_result
 				free(data);
 			}
 		}
+
+		// same as above, into a buffer that's reused between calls
+		uint32_t GetImageData(const char *joinedfilename, std::vector<uint8_t> *buffer)
+		{
+			uint32_t image_size = resi->LoadSharedResource(joinedfilename, nullptr, 0);
+			buffer->resize(image_size);
+			if (image_size > 0)
+			{
+				image_size = resi->LoadSharedResource(joinedfilename, reinterpret_cast<char *>(buffer->data()), image_size);
+				buffer->resize(std::min(size_t(image_size), buffer->size()));
+			}
+			return size_as_uint32(buffer->size());
+		}
 		IVRResources *resi;
+		resource_cache *cache;		// skips loads of unchanged resources.  optional
 	};
 }
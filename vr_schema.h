@@ -22,7 +22,10 @@ namespace vr_result
 	struct vr_schema : schema<is_iterator>
 	{
 		template <typename ResultType>
-		using TIMENODE = time_node<ResultType, segmented_list_1024, is_iterator, AllocatorTemplate>;
+		using TIMENODE = time_node<ResultType, columnar_list_1024, is_iterator, AllocatorTemplate>;
+
+	//	template <typename ResultType>
+	//	using TIMENODE = time_node<ResultType, segmented_list_1024, is_iterator, AllocatorTemplate>;
 
 	//	template <typename ResultType>
 	//	using TIMENODE = time_node<ResultType, std::vector, is_iterator, AllocatorTemplate>;
@@ -52,7 +52,7 @@ void StringIndexer::maybe_swap_live_indexes(std::vector<int> * v)
 	if (*v != live_indexes)
 	{
 		live_index_lock.lock(); // writer lock
-		live_indexes.swap(*v);
+		live_indexes = *v;
 		live_index_lock.unlock();
 	}
 }
\ No newline at end of file
@@ -101,7 +101,8 @@ public:
 	}
 
 	// maybe swap current_index_set
-	// if v does not match the current set, lock and swap it
+	// if v does not match the current set, lock and copy it in.  copying keeps both buffers, so
+	// the caller can refill v without allocating
 	void maybe_swap_live_indexes(std::vector<int> * v);
 
 	// return an index.  if the key doesn't exist yet add it.
@@ -69,10 +69,18 @@ struct SystemWrapper
 		vr::TrackedDeviceIndex_t unRelativeToTrackedDeviceIndex,
 		TMPDeviceIndexes *result)
 	{
-		result->val.resize(sysi->GetSortedTrackedDeviceIndicesOfClass(
+		uint32_t count = sysi->GetSortedTrackedDeviceIndicesOfClass(
 			device_class, result->val.data(),
 			size_as_int(result->val.max_size()),
-			unRelativeToTrackedDeviceIndex));
+			unRelativeToTrackedDeviceIndex);
+		if (promote_for_count(&result->val, count))
+		{
+			count = sysi->GetSortedTrackedDeviceIndicesOfClass(
+				device_class, result->val.data(),
+				size_as_int(result->val.max_size()),
+				unRelativeToTrackedDeviceIndex);
+		}
+		result->val.resize(count);
 		return *result;
 	}
 
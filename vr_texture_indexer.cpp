@@ -95,7 +95,7 @@ void TextureIndexer::ReadFromStream(BaseStream &s)
 
 // if this is a new texture_session_id,
 //	* start loading this texture
-int TextureIndexer::add_texture(int texture_session_id, const char *render_model_name)
+int TextureIndexer::add_texture(int texture_session_id, const char *render_model_name, vr::IVRRenderModels *remi)
 {
 	std::lock_guard<std::mutex> lock(m_list_lock);	// prevent simultaneous updates to the list
 
@@ -105,7 +105,7 @@ int TextureIndexer::add_texture(int texture_session_id, const char *render_model
 	{
 		internal_id = size_as_int(m_textures.size());
 		m_textures.emplace_back(std::make_shared<texture>(texture_session_id));
-		m_texture_service.start();
+		m_texture_service.start(remi);
 		m_texture_service.process_texture(m_textures[internal_id]);
 		log_printf("processing texture %d\n", internal_id);
 		m_session2internal_id.insert({ texture_session_id, internal_id });
@@ -37,8 +37,9 @@ struct TextureIndexer
 	void ReadFromStream(BaseStream &s);
 
 	// add_texture: add the following texture to the indexer database
+	//	remi: the render models the texture_session_id came from.  null loads from the raw runtime
 	//
-	int add_texture(int texture_session_id, const char *render_model_name);
+	int add_texture(int texture_session_id, const char *render_model_name, vr::IVRRenderModels *remi = nullptr);
 
 	// given a texture session id, return the texture map and the return code
 	vr::EVRRenderModelError get_texture(int texture_session_id, vr::RenderModel_TextureMap_t **);
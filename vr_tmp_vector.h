@@ -1,6 +1,6 @@
 // vr_tmp_vector
 //	specializes tmp_vector in two ways:
-//		* commits to the size of the temporary vectors used
+//		* commits to the largest size of the temporary vectors used (they start smaller, see tmp_vector.h)
 //		* provides access to a global pool
 //     
 #pragma once
@@ -8,20 +8,25 @@
 #include "vr_tmp_vector.h"
 #include "time_containers.h"
 #include "result.h"
+#include "interned_strings.h"
 #include "segmented_list.h"
+#include "columnar_list.h"
 #include "dynamic_bitset.hpp"
+#include "sparse_bitset.h"
 #include "vr_settings_indexer.h"
 #include "vr_properties_indexer.h"
 #include <openvr.h>
+#include <stddef.h>
 
 using VRTimestampVector = segmented_list<time_stamp_t, VR_LARGE_SEGMENT_SIZE, VRAllocatorTemplate<time_stamp_t>>;
 
+// scratch bitset the updaters mark changed nodes in.  what's kept for each frame is a sparse_bitset
 struct  VRBitset : public boost::dynamic_bitset<uint64_t, std::allocator<uint64_t>>
 {
 	void encode(BaseStream &e) const
 	{
-		serialization_id num_bits;
-		num_bits = static_cast<serialization_id>(size());
+		uint32_t num_bits;
+		num_bits = size_as_uint32(size());
 		e.write_to_stream(&num_bits, sizeof(num_bits));
 
 		std::vector<uint64_t> tmp;
@@ -31,7 +36,7 @@ struct  VRBitset : public boost::dynamic_bitset<uint64_t, std::allocator<uint64_
 
 	void decode(BaseStream &e)
 	{
-		serialization_id num_bits;
+		uint32_t num_bits;
 		e.read_from_stream(&num_bits, sizeof(num_bits));
 		resize(num_bits); // resize container to be able to store whatever is in the vector
 
@@ -179,7 +184,43 @@ struct VRKeysUpdate
 };
 
 using VRKeysUpdateVector = time_indexed_vector<VRKeysUpdate, segmented_list_1024, VRAllocatorTemplate>;
-using VRUpdateVector = time_indexed_vector<VRBitset, segmented_list_1024, VRAllocatorTemplate>;
+using VRUpdateVector = time_indexed_vector<sparse_bitset, segmented_list_1024, VRAllocatorTemplate>;	// see sparse_bitset.h
+
+// a child that was spawned into a named_vector during an update.
+// the journal needs these so a reader can re-create the structure before applying node values
+struct VRSpawnRecord
+{
+	VRSpawnRecord() {}
+	VRSpawnRecord(const std::string &parent_path_in, const std::string &child_name_in)
+		: parent_path(parent_path_in), child_name(child_name_in)
+	{}
+
+	std::string parent_path;		// full url path of the parent vector
+	std::string child_name;
+
+	bool operator==(const VRSpawnRecord &rhs) const
+	{
+		return parent_path == rhs.parent_path && child_name == rhs.child_name;
+	}
+	bool operator!=(const VRSpawnRecord &rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	void encode(BaseStream &e) const
+	{
+		e.contiguous_container_out_to_stream(parent_path);
+		e.contiguous_container_out_to_stream(child_name);
+	}
+
+	void decode(BaseStream &e)
+	{
+		e.contiguous_container_from_stream(parent_path);
+		e.contiguous_container_from_stream(child_name);
+	}
+};
+
+using VRSpawnVector = time_indexed_vector<VRSpawnRecord, segmented_list_1024, VRAllocatorTemplate>;
 
 namespace vr
 {
@@ -392,8 +433,9 @@ namespace vr_result
 	using  ResultVector = Result<std::vector<T, VRAllocatorTemplate<T>>, ReturnCode>;
 
 
+	// string histories hold ids into the string table (see interned_strings.h)
 	template <typename ReturnCode = NoReturnCode>
-	using String = ResultVector<char, ReturnCode>;
+	using String = Result<interned_string, ReturnCode>;
 
 	template <typename ReturnCode = NoReturnCode>
 	using Int32String = ResultVector<int32_t, ReturnCode>;
@@ -495,6 +537,41 @@ MEMCMP_OPERATOR_EQ(vr::RenderModel_ComponentState_t)
 MEMCMP_OPERATOR_EQ(vr::RenderModel_Vertex_t)
 MEMCMP_OPERATOR_EQ(vr::VRTextureBounds_t)
 
+// pose and matrix histories are delta encoded (see history_codec.h)
+template <>
+struct float_history_traits<vr::HmdMatrix34_t>
+{
+	static const bool enabled = true;
+	static bool is_float_word(int word) { return true; }
+};
+
+template <>
+struct float_history_traits<vr::HmdMatrix44_t>
+{
+	static const bool enabled = true;
+	static bool is_float_word(int word) { return true; }
+};
+
+template <>
+struct float_history_traits<vr::TrackedDevicePose_t>
+{
+	static const bool enabled = true;
+	// matrix, velocity and angular velocity.  the tracking result and flags are kept exact
+	static bool is_float_word(int word) { return word < int(offsetof(vr::TrackedDevicePose_t, eTrackingResult) / sizeof(uint32_t)); }
+};
+
+template <>
+struct float_history_traits<vr::VRControllerState_t>
+{
+	static const bool enabled = true;
+	// just the axes.  the packet number and button masks are kept exact
+	static bool is_float_word(int word)
+	{
+		return word >= int(offsetof(vr::VRControllerState_t, rAxis) / sizeof(uint32_t)) &&
+			word < int((offsetof(vr::VRControllerState_t, rAxis) + sizeof(vr::VRControllerState_t::rAxis)) / sizeof(uint32_t));
+	}
+};
+
 namespace vr
 {
 	inline bool operator == (const vr::TrackedDevicePose_t &lhs, const vr::TrackedDevicePose_t &rhs)
@@ -505,8 +582,9 @@ namespace vr
 			return true;
 		if (lhs.bPoseIsValid != rhs.bPoseIsValid)
 			return false;
-		// otherwise both poses are valid - go big:
-		return (memcmp(&lhs, &rhs, sizeof(lhs)) == 0);
+		// otherwise both poses are valid - go big.  but stop at the last member: copies don't keep
+		// the padding after it
+		return (memcmp(&lhs, &rhs, offsetof(vr::TrackedDevicePose_t, bDeviceIsConnected) + sizeof(lhs.bDeviceIsConnected)) == 0);
 	}
 	inline bool operator != (const vr::TrackedDevicePose_t &lhs, const vr::TrackedDevicePose_t &rhs)
 	{
@@ -1,5 +1,7 @@
 #pragma once
 #include "vr_types.h"
+#include <string.h>
+#include <algorithm>
 
 #define SCALAR_WRAP(handle_type, handle, function) \
 	inline Result<decltype(((handle_type*)nullptr)->function()),NoReturnCode> function() \
@@ -24,6 +26,31 @@
 
 namespace vr_result
 {
+	// the temporaries start with a small buffer (see tmp_vector.h).  when a query says it
+	// needed more, they're promoted to a buffer that fits and it's asked again
+
+	// the error codes that mean the buffer was too small
+	template <typename ReturnType>
+	inline bool buffer_too_small(ReturnType) { return false; }
+	inline bool buffer_too_small(vr::ETrackedPropertyError e) { return e == vr::TrackedProp_BufferTooSmall; }
+	inline bool buffer_too_small(vr::EVRApplicationError e) { return e == vr::VRApplicationError_BufferTooSmall; }
+	inline bool buffer_too_small(vr::EVRRenderModelError e) { return e == vr::VRRenderModelError_BufferTooSmall; }
+	inline bool buffer_too_small(vr::EVROverlayError e) { return e == vr::VROverlayError_ArrayTooSmall; }
+
+	// queries that return the count they needed: a count that fills the buffer may not have fit
+	template <typename VectorType>
+	inline bool promote_for_count(VectorType *v, uint32_t count)
+	{
+		return count >= v->max_size() && v->max_size() < v->max_capacity() && v->reserve(std::min<size_t>(count + 1, v->max_capacity()));
+	}
+
+	// string queries that don't return a count: a string that fills the buffer may have been cut off
+	template <typename ReturnType>
+	inline bool promote_for_string(TMPStringVectorOnly *v, ReturnType return_code)
+	{
+		bool maybe_cut = strnlen(v->data(), v->max_size()) + 1 >= v->max_size();
+		return (maybe_cut || buffer_too_small(return_code)) && v->max_size() < v->max_capacity() && v->reserve(v->max_capacity());
+	}
 
 	//		             Inputs: 0,1
 	//		ERROR DETAILS PARAM: 0
@@ -31,7 +58,12 @@ namespace vr_result
 	template<typename InterfaceHandle, typename FunctionPtr, typename ...Params>
 	void query_vector_rccount(TMPString<> *result, InterfaceHandle *ifh, FunctionPtr function_ptr, Params... params)
 	{
-		result->val.resize((ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size())));
+		uint32_t count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		if (promote_for_count(&result->val, count))
+		{
+			count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		}
+		result->val.resize(count);
 		assert(result->val.size() < result->val.max_size());
 	}
 
@@ -42,14 +74,24 @@ namespace vr_result
 	template<typename ReturnType, typename InterfaceHandle, typename FunctionPtr, typename ...Params>
 	inline void query_vector_rccount(Result<TMPStringVectorOnly, ReturnType> *result, InterfaceHandle *ifh, FunctionPtr function_ptr, Params... params)
 	{
-		result->val.resize((ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()), &result->return_code));
+		uint32_t count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()), &result->return_code);
+		if (promote_for_count(&result->val, count))
+		{
+			count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()), &result->return_code);
+		}
+		result->val.resize(count);
 		assert(result->val.size() < result->val.max_size());
 	}
 
 	template<typename ElementType, typename InterfaceHandle, typename FunctionPtr, typename ...Params>
 	inline void query_vector_zero_means_not_present(Result<ElementType, bool> *result, InterfaceHandle *ifh, FunctionPtr function_ptr, Params... params)
 	{
-		result->val.resize((ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size())));
+		uint32_t count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		if (promote_for_count(&result->val, count))
+		{
+			count = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		}
+		result->val.resize(count);
 		result->return_code = result->val.size() != 0;
 		assert(result->val.size() < result->val.max_size());
 	}
@@ -63,6 +105,10 @@ namespace vr_result
 	void query_vector_rcerror(Result<TMPStringVectorOnly, ReturnType> *result, InterfaceHandle *ifh, FunctionPtr function_ptr, Params... params)
 	{
 		result->return_code = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		if (promote_for_string(&result->val, result->return_code))
+		{
+			result->return_code = (ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()));
+		}
 		result->val.resize(strlen(result->val.data()) + 1);
 	}
 
@@ -76,6 +122,10 @@ namespace vr_result
 	void query_vector_rcvoid(Result<TMPStringVectorOnly, ReturnType> *result, InterfaceHandle *ifh, FunctionPtr function_ptr, Params... params)
 	{
 		(ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()), &result->return_code);
+		if (promote_for_string(&result->val, result->return_code))
+		{
+			(ifh->*function_ptr)(params..., result->val.data(), size_as_int(result->val.max_size()), &result->return_code);
+		}
 		result->val.resize(strlen(result->val.data()) + 1); 
 	}
 
@@ -91,8 +141,9 @@ namespace vr_result
 		uint32_t instance_count = 0;  // it is important that this is set to zero
 		/*bool rc =*/ (ifh->*function_ptr)(params..., nullptr, &instance_count);
 		{
-			// I don't expect the following assert to be hit, since the tmp buffer is currently 16Kb
+			// I don't expect the following assert to be hit, since the largest tmp buffer is 32Kb
 			// however put it here in case I need to handle this case
+			result->val.reserve(instance_count + 1);
 			assert(instance_count < result->val.max_size());
 			uint32_t count = instance_count;
 			bool rc = (ifh->*function_ptr)(params..., result->val.data(), &count);